@@ -0,0 +1,131 @@
+#
+# Copyright (c) 2022, INRIA
+#
+"""
+Compares two reports of benchmark-cpp-maros-meszaros (CSV or JSON), e.g. the
+ones of a release and of a candidate upgrade. The rows are matched by problem,
+backend, mode and number of threads, and the ratios of their median times
+(new / reference) are reported. The script exits with status 1 when some
+problem is slower than the threshold, or is no longer solved, so that it can
+gate an upgrade.
+
+usage: python compare.py reference.csv new.csv [--threshold 1.1] [--min-time 50]
+"""
+import argparse
+import csv
+import json
+import math
+import sys
+
+KEY = ("problem", "backend", "mode", "threads")
+TIMES = ("setup_time_median", "solve_time_median")
+
+
+def load(path):
+    if path.endswith(".json"):
+        with open(path) as f:
+            rows = json.load(f)
+    else:
+        with open(path, newline="") as f:
+            rows = list(csv.DictReader(f))
+    report = {}
+    for row in rows:
+        for name in TIMES + ("iter",):
+            value = row.get(name)
+            row[name] = float("nan") if value in (None, "") else float(value)
+        report[tuple(str(row[k]) for k in KEY)] = row
+    return report
+
+
+def geometric_mean(values):
+    values = [v for v in values if v > 0 and math.isfinite(v)]
+    if not values:
+        return float("nan")
+    return math.exp(sum(math.log(v) for v in values) / len(values))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("reference", help="report of the reference version")
+    parser.add_argument("new", help="report of the new version")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=1.1,
+        help="time ratio above which a problem is reported as a regression",
+    )
+    parser.add_argument(
+        "--min-time",
+        type=float,
+        default=50.0,
+        help="times (in microseconds) below which the ratios are not checked, "
+        "being dominated by noise",
+    )
+    args = parser.parse_args()
+
+    reference = load(args.reference)
+    new = load(args.new)
+    common = sorted(reference.keys() & new.keys())
+    for name, keys in (
+        ("only in the reference", reference.keys() - new.keys()),
+        ("only in the new report", new.keys() - reference.keys()),
+    ):
+        if keys:
+            print("{} rows {}".format(len(keys), name))
+
+    regressions = []
+    ratios = {name: [] for name in TIMES}
+    print(
+        "{:<12} {:<7} {:<5} {:>3} {:>10} {:>10} {:>7} {:>9}".format(
+            "problem", "backend", "mode", "thr", "setup", "solve", "iter", "status"
+        )
+    )
+    for key in common:
+        ref, cur = reference[key], new[key]
+        row_ratios = {}
+        for name in TIMES:
+            ratio = cur[name] / ref[name] if ref[name] > 0 else float("nan")
+            row_ratios[name] = ratio
+            ratios[name].append(ratio)
+        solved = ref["status"] != "PROXQP_SOLVED" or cur["status"] == "PROXQP_SOLVED"
+        slower = [
+            name
+            for name in TIMES
+            if max(ref[name], cur[name]) >= args.min_time
+            and row_ratios[name] > args.threshold
+        ]
+        if slower or not solved:
+            regressions.append(key)
+        print(
+            "{:<12} {:<7} {:<5} {:>3} {:>10.3f} {:>10.3f} {:>+7.0f} {:>9}{}".format(
+                *key,
+                row_ratios["setup_time_median"],
+                row_ratios["solve_time_median"],
+                cur["iter"] - ref["iter"],
+                "ok" if solved else "UNSOLVED",
+                "  <- regression" if slower or not solved else "",
+            )
+        )
+
+    print(
+        "\n{} rows compared, geometric mean of the time ratios: setup {:.3f}, "
+        "solve {:.3f}".format(
+            len(common),
+            geometric_mean(ratios["setup_time_median"]),
+            geometric_mean(ratios["solve_time_median"]),
+        )
+    )
+    if regressions:
+        print(
+            "{} regressions (ratio above {} or no longer solved):".format(
+                len(regressions), args.threshold
+            )
+        )
+        for key in regressions:
+            print("  " + " ".join(key))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,505 @@
+//
+// Copyright (c) 2022 INRIA
+//
+/**
+ * Runs the dense and sparse backends over the Maros-Meszaros test set and
+ * reports, for each problem, the setup and solve times, the number of
+ * iterations and the residuals, in CSV or JSON. Two reports are compared with
+ * benchmark/compare.py. Run with --help for the options.
+ */
+#include <maros_meszaros.hpp>
+#include <proxsuite/helpers/omp.hpp>
+#include <proxsuite/proxqp/dense/dense.hpp>
+#include <proxsuite/proxqp/sparse/sparse.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace proxsuite;
+using T = double;
+using I = mat_int32_t;
+using proxsuite::linalg::veg::isize;
+
+namespace {
+
+char const* usage = R"(usage: benchmark-cpp-maros-meszaros [options]
+
+  --data-dir DIR        directory of the .mat files of the test set
+                        (default: test/data/maros_meszaros_data)
+  --problems A,B,...    names of the problems to run (default: all of them)
+  --backends LIST       dense,sparse (default: both)
+  --modes LIST          cold,warm (default: both)
+  --threads LIST        numbers of threads of the parallel kernels, e.g. 1,4
+                        (default: 1)
+  --repeats N           number of timed solves per problem (default: 3)
+  --max-dim N           skips the problems whose primal dimension or number
+                        of constraints is larger than N, 0 for no limit
+                        (default: 1000)
+  --eps-abs EPS         absolute stopping criterion (default: solver's)
+  --eps-rel EPS         relative stopping criterion (default: solver's)
+  --max-iter N          maximal number of iterations (default: solver's)
+  --output FILE         report file (default: standard output)
+  --format csv|json     format of the report (default: from the extension of
+                        the output file, csv otherwise)
+
+In the cold mode, each repeat builds a new QP object, initializes it and
+solves the problem. In the warm mode, each repeat solves the problem once
+(untimed), perturbs the linear cost g by a relative 1e-3 and solves it again
+from the previous results: the reported times are the ones of this update
+and of this second solve. The times are in microseconds, as measured by the
+solver (compute_timings), and their median and minimum over the repeats are
+reported.
+)";
+
+enum struct Mode
+{
+  COLD,
+  WARM
+};
+
+struct Options
+{
+  std::string data_dir = PROBLEM_PATH "/data/maros_meszaros_data";
+  std::vector<std::string> problems;
+  std::vector<std::string> backends{ "dense", "sparse" };
+  std::vector<std::string> modes{ "cold", "warm" };
+  std::vector<int> threads{ 1 };
+  isize repeats = 3;
+  isize max_dim = 1000;
+  std::optional<T> eps_abs;
+  std::optional<T> eps_rel;
+  std::optional<isize> max_iter;
+  std::string output;
+  std::string format;
+};
+
+/// one line of the report
+struct Row
+{
+  std::string problem;
+  std::string backend;
+  std::string mode;
+  int threads = 1;
+  isize n = 0;
+  isize n_eq = 0;
+  isize n_in = 0;
+  isize repeats = 0;
+  std::string status;
+  isize iter = 0;
+  isize iter_ext = 0;
+  T setup_time_median = 0;
+  T setup_time_min = 0;
+  T solve_time_median = 0;
+  T solve_time_min = 0;
+  T objective = 0;
+  T pri_res = 0;
+  T dua_res = 0;
+};
+
+auto
+split(std::string const& list) -> std::vector<std::string>
+{
+  std::vector<std::string> out;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      out.push_back(item);
+    }
+  }
+  return out;
+}
+
+auto
+parse_options(int argc, char** argv) -> Options
+{
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      std::cout << usage;
+      std::exit(0);
+    }
+    if (i + 1 == argc) {
+      throw std::invalid_argument("missing value of the option " + arg);
+    }
+    std::string value = argv[++i];
+    if (arg == "--data-dir") {
+      options.data_dir = value;
+    } else if (arg == "--problems") {
+      options.problems = split(value);
+    } else if (arg == "--backends") {
+      options.backends = split(value);
+      for (auto const& backend : options.backends) {
+        if (backend != "dense" && backend != "sparse") {
+          throw std::invalid_argument("unknown backend " + backend);
+        }
+      }
+    } else if (arg == "--modes") {
+      options.modes = split(value);
+      for (auto const& mode : options.modes) {
+        if (mode != "cold" && mode != "warm") {
+          throw std::invalid_argument("unknown mode " + mode);
+        }
+      }
+    } else if (arg == "--threads") {
+      options.threads.clear();
+      for (auto const& item : split(value)) {
+        options.threads.push_back(std::max(std::stoi(item), 1));
+      }
+    } else if (arg == "--repeats") {
+      options.repeats = std::max(isize(std::stol(value)), isize(1));
+    } else if (arg == "--max-dim") {
+      options.max_dim = isize(std::stol(value));
+    } else if (arg == "--eps-abs") {
+      options.eps_abs = std::stod(value);
+    } else if (arg == "--eps-rel") {
+      options.eps_rel = std::stod(value);
+    } else if (arg == "--max-iter") {
+      options.max_iter = isize(std::stol(value));
+    } else if (arg == "--output") {
+      options.output = value;
+    } else if (arg == "--format") {
+      options.format = value;
+    } else {
+      throw std::invalid_argument("unknown option " + arg);
+    }
+  }
+  if (options.format.empty()) {
+    std::string extension = std::filesystem::path(options.output).extension();
+    options.format = extension == ".json" ? "json" : "csv";
+  }
+  if (options.format != "csv" && options.format != "json") {
+    throw std::invalid_argument("unknown format " + options.format);
+  }
+  return options;
+}
+
+/// paths of the problems to run, sorted by name
+auto
+problem_files(Options const& options) -> std::vector<std::filesystem::path>
+{
+  std::vector<std::filesystem::path> files;
+  if (options.problems.empty()) {
+    for (auto const& entry :
+         std::filesystem::directory_iterator(options.data_dir)) {
+      if (entry.path().extension() == ".mat") {
+        files.push_back(entry.path());
+      }
+    }
+    std::sort(files.begin(), files.end());
+  } else {
+    for (auto const& name : options.problems) {
+      files.push_back(std::filesystem::path(options.data_dir) /
+                      (name + ".mat"));
+    }
+  }
+  return files;
+}
+
+template<typename QP>
+void
+configure(QP& qp, Options const& options)
+{
+  qp.settings.verbose = false;
+  qp.settings.compute_timings = true;
+  if (options.eps_abs) {
+    qp.settings.eps_abs = *options.eps_abs;
+  }
+  if (options.eps_rel) {
+    qp.settings.eps_rel = *options.eps_rel;
+  }
+  if (options.max_iter) {
+    qp.settings.max_iter = *options.max_iter;
+  }
+}
+
+/// linear cost of the warm mode, perturbed deterministically
+auto
+perturbed(MarosMeszarosQp::Vec const& g) -> MarosMeszarosQp::Vec
+{
+  MarosMeszarosQp::Vec out = g;
+  for (isize i = 0; i < out.rows(); ++i) {
+    T sign = i % 2 == 0 ? T(1) : T(-1);
+    out[i] += T(1e-3) * sign * std::max(std::abs(g[i]), T(1));
+  }
+  return out;
+}
+
+/// setup and solve times of the repeats, and results of the last one
+struct Measurement
+{
+  std::vector<T> setup_times;
+  std::vector<T> solve_times;
+  proxqp::Info<T> info;
+
+  /// the setup time is read before solving, which may reset it
+  void add(T setup_time, proxqp::Info<T> const& solved)
+  {
+    setup_times.push_back(setup_time);
+    solve_times.push_back(solved.solve_time);
+    info = solved;
+  }
+};
+
+auto
+run_dense(PreprocessedQp const& qp, Options const& options, Mode mode)
+  -> Measurement
+{
+  std::optional<proxqp::dense::MatRef<T>> unchanged;
+  Measurement measurement;
+  for (isize r = 0; r < options.repeats; ++r) {
+    proxqp::dense::QP<T> solver(qp.H.rows(), qp.A.rows(), qp.C.rows());
+    configure(solver, options);
+    solver.init(qp.H, qp.g, qp.A, qp.b, qp.C, qp.u, qp.l);
+    if (mode == Mode::WARM) {
+      solver.solve();
+      solver.settings.initial_guess =
+        proxqp::InitialGuessStatus::WARM_START_WITH_PREVIOUS_RESULT;
+      solver.update(unchanged,
+                    perturbed(qp.g),
+                    unchanged,
+                    std::nullopt,
+                    unchanged,
+                    std::nullopt,
+                    std::nullopt,
+                    false);
+    }
+    T setup_time = solver.results.info.setup_time;
+    solver.solve();
+    measurement.add(setup_time, solver.results.info);
+  }
+  return measurement;
+}
+
+auto
+run_sparse(PreprocessedQpSparse const& qp, Options const& options, Mode mode)
+  -> Measurement
+{
+  using SparseMat = proxqp::sparse::SparseMat<T, I>;
+  SparseMat A = qp.AT.transpose();
+  SparseMat C = qp.CT.transpose();
+  Measurement measurement;
+  for (isize r = 0; r < options.repeats; ++r) {
+    proxqp::sparse::QP<T, I> solver(
+      qp.H.cast<bool>(), A.cast<bool>(), C.cast<bool>());
+    configure(solver, options);
+    solver.init(qp.H, qp.g, A, qp.b, C, qp.u, qp.l);
+    if (mode == Mode::WARM) {
+      solver.solve();
+      solver.settings.initial_guess =
+        proxqp::InitialGuessStatus::WARM_START_WITH_PREVIOUS_RESULT;
+      MarosMeszarosQp::Vec g = perturbed(qp.g);
+      solver.update(std::nullopt,
+                    g,
+                    std::nullopt,
+                    std::nullopt,
+                    std::nullopt,
+                    std::nullopt,
+                    std::nullopt,
+                    false);
+    }
+    T setup_time = solver.results.info.setup_time;
+    solver.solve();
+    measurement.add(setup_time, solver.results.info);
+  }
+  return measurement;
+}
+
+auto
+median(std::vector<T> values) -> T
+{
+  std::sort(values.begin(), values.end());
+  std::size_t mid = values.size() / 2;
+  return values.size() % 2 == 1 ? values[mid]
+                                : (values[mid - 1] + values[mid]) / 2;
+}
+
+auto
+status_name(proxqp::QPSolverOutput status) -> std::string
+{
+  switch (status) {
+    case proxqp::QPSolverOutput::PROXQP_SOLVED:
+      return "PROXQP_SOLVED";
+    case proxqp::QPSolverOutput::PROXQP_MAX_ITER_REACHED:
+      return "PROXQP_MAX_ITER_REACHED";
+    case proxqp::QPSolverOutput::PROXQP_PRIMAL_INFEASIBLE:
+      return "PROXQP_PRIMAL_INFEASIBLE";
+    case proxqp::QPSolverOutput::PROXQP_DUAL_INFEASIBLE:
+      return "PROXQP_DUAL_INFEASIBLE";
+  }
+  return "UNKNOWN";
+}
+
+void
+fill(Row& row, Measurement const& measurement)
+{
+  row.repeats = isize(measurement.solve_times.size());
+  row.status = status_name(measurement.info.status);
+  row.iter = measurement.info.iter;
+  row.iter_ext = measurement.info.iter_ext;
+  row.setup_time_median = median(measurement.setup_times);
+  row.setup_time_min = *std::min_element(measurement.setup_times.begin(),
+                                         measurement.setup_times.end());
+  row.solve_time_median = median(measurement.solve_times);
+  row.solve_time_min = *std::min_element(measurement.solve_times.begin(),
+                                         measurement.solve_times.end());
+  row.objective = measurement.info.objValue;
+  row.pri_res = measurement.info.pri_res;
+  row.dua_res = measurement.info.dua_res;
+}
+
+/// number in a JSON document, which has no representation of nan and infinity
+auto
+json_number(T value) -> std::string
+{
+  if (!std::isfinite(value)) {
+    return "null";
+  }
+  std::ostringstream out;
+  out.precision(10);
+  out << value;
+  return out.str();
+}
+
+void
+write_csv(std::ostream& out, std::vector<Row> const& rows)
+{
+  out.precision(10);
+  out << "problem,backend,mode,threads,n,n_eq,n_in,repeats,status,iter,"
+         "iter_ext,setup_time_median,setup_time_min,solve_time_median,"
+         "solve_time_min,objective,pri_res,dua_res\n";
+  for (auto const& row : rows) {
+    out << row.problem << ',' << row.backend << ',' << row.mode << ','
+        << row.threads << ',' << row.n << ',' << row.n_eq << ',' << row.n_in
+        << ',' << row.repeats << ',' << row.status << ',' << row.iter << ','
+        << row.iter_ext << ',' << row.setup_time_median << ','
+        << row.setup_time_min << ',' << row.solve_time_median << ','
+        << row.solve_time_min << ',' << row.objective << ',' << row.pri_res
+        << ',' << row.dua_res << '\n';
+  }
+}
+
+void
+write_json(std::ostream& out, std::vector<Row> const& rows)
+{
+  out << "[\n";
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    Row const& row = rows[i];
+    out << "  {\"problem\": \"" << row.problem << "\", \"backend\": \""
+        << row.backend << "\", \"mode\": \"" << row.mode
+        << "\", \"threads\": " << row.threads << ", \"n\": " << row.n
+        << ", \"n_eq\": " << row.n_eq << ", \"n_in\": " << row.n_in
+        << ", \"repeats\": " << row.repeats << ", \"status\": \""
+        << row.status << "\", \"iter\": " << row.iter
+        << ", \"iter_ext\": " << row.iter_ext
+        << ", \"setup_time_median\": " << json_number(row.setup_time_median)
+        << ", \"setup_time_min\": " << json_number(row.setup_time_min)
+        << ", \"solve_time_median\": " << json_number(row.solve_time_median)
+        << ", \"solve_time_min\": " << json_number(row.solve_time_min)
+        << ", \"objective\": " << json_number(row.objective)
+        << ", \"pri_res\": " << json_number(row.pri_res)
+        << ", \"dua_res\": " << json_number(row.dua_res) << "}"
+        << (i + 1 < rows.size() ? ",\n" : "\n");
+  }
+  out << "]\n";
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  Options options;
+  try {
+    options = parse_options(argc, argv);
+  } catch (std::exception const& error) {
+    std::cerr << error.what() << "\n\n" << usage;
+    return 2;
+  }
+  if (helpers::get_max_threads() == 1 &&
+      std::any_of(options.threads.begin(),
+                  options.threads.end(),
+                  [](int threads) { return threads > 1; })) {
+    std::cerr << "warning: ProxSuite is compiled without OpenMP support, the "
+                 "parallel kernels use a single thread."
+              << std::endl;
+  }
+
+  std::vector<Row> rows;
+  for (auto const& file : problem_files(options)) {
+    MarosMeszarosQp raw = load_qp(file.c_str());
+    isize n = raw.P.rows();
+    isize n_eq_in = raw.A.rows();
+    std::string name = file.stem();
+    if (options.max_dim > 0 &&
+        (n > options.max_dim || n_eq_in > options.max_dim)) {
+      std::cerr << name << " n: " << n << " n_eq+n_in: " << n_eq_in
+                << " - skipping" << std::endl;
+      continue;
+    }
+    std::optional<PreprocessedQp> dense;
+    std::optional<PreprocessedQpSparse> sparse;
+    for (auto const& backend : options.backends) {
+      // the preprocessing moves the vectors out of the problem it is given
+      if (backend == "dense" && !dense) {
+        MarosMeszarosQp copy = raw;
+        dense = preprocess_qp(copy);
+      }
+      if (backend == "sparse" && !sparse) {
+        sparse = preprocess_qp_sparse(MarosMeszarosQp(raw));
+      }
+      for (auto const& mode_name : options.modes) {
+        Mode mode = mode_name == "warm" ? Mode::WARM : Mode::COLD;
+        for (int threads : options.threads) {
+          helpers::set_max_threads(threads);
+          Row row;
+          row.problem = name;
+          row.backend = backend;
+          row.mode = mode_name;
+          row.threads = threads;
+          if (backend == "dense") {
+            row.n = dense->H.rows();
+            row.n_eq = dense->A.rows();
+            row.n_in = dense->C.rows();
+            fill(row, run_dense(*dense, options, mode));
+          } else {
+            row.n = sparse->H.rows();
+            row.n_eq = sparse->AT.cols();
+            row.n_in = sparse->CT.cols();
+            fill(row, run_sparse(*sparse, options, mode));
+          }
+          std::cerr << name << " " << backend << " " << mode_name << " "
+                    << threads << " thread(s): " << row.status << " in "
+                    << row.iter << " iterations, solve time "
+                    << row.solve_time_median << " us" << std::endl;
+          rows.push_back(row);
+        }
+      }
+    }
+  }
+
+  std::ofstream file;
+  if (!options.output.empty()) {
+    file.open(options.output);
+    if (!file) {
+      std::cerr << "cannot open " << options.output << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& out = options.output.empty() ? std::cout : file;
+  if (options.format == "json") {
+    write_json(out, rows);
+  } else {
+    write_csv(out, rows);
+  }
+  return 0;
+}
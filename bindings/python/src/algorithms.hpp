@@ -8,7 +8,9 @@
 #include "expose-results.hpp"
 #include "expose-settings.hpp"
 #include "expose-workspace.hpp"
+#include "expose-serialization.hpp"
 #include "expose-qpobject.hpp"
 #include "expose-solve.hpp"
+#include "expose-batch.hpp"
 
 #endif /* end of include guard proxsuite_python_algorithms_hpp */
@@ -7,6 +7,8 @@
 
 #include "algorithms.hpp"
 #include <proxsuite/proxqp/dense/utils.hpp>
+#include <proxsuite/linalg/dense/autotune.hpp>
+#include <proxsuite/helpers/huge-pages.hpp>
 #include <proxsuite/helpers/version.hpp>
 
 namespace proxsuite {
@@ -21,13 +23,31 @@ exposeCommon(pybind11::module_ m)
   exposeSettings<T>(m);
 }
 
-template<typename T, typename I>
+template<typename T>
 void
 exposeSparseAlgorithms(pybind11::module_ m)
 {
-  sparse::python::exposeSparseModel<T, I>(m);
-  sparse::python::exposeQpObjectSparse<T, I>(m);
-  sparse::python::solveSparseQp<T, I>(m);
+  // 32 bit indices save memory and bandwidth on moderate problems, while 64
+  // bit ones are required when the LDLT factor has more than 2^31 entries
+  sparse::python::exposeSparseModel<T, int32_t>(m, "model");
+  sparse::python::exposeSparseModel<T, i64>(m, "model_int64");
+  sparse::python::exposeQpObjectSparse<T, int32_t>(m, "QP");
+  sparse::python::exposeQpObjectSparse<T, i64>(m, "QP_int64");
+  m.attr("model_int32") = m.attr("model");
+  m.attr("QP_int32") = m.attr("QP");
+  sparse::python::exposeSparseIndexChoice<T>(m);
+  sparse::python::solveSparseQp<T>(m);
+  sparse::python::solveSparseQpBatch<T>(m);
+}
+
+/// single precision sparse backend, with 32 bit indices only
+inline void
+exposeSparseAlgorithmsFloat32(pybind11::module_ m)
+{
+  sparse::python::exposeSparseModel<f32, int32_t>(m, "model_float32");
+  sparse::python::exposeQpObjectSparse<f32, int32_t>(m, "QP_float32");
+  sparse::python::solveSparseQp<f32>(m);
+  sparse::python::solveSparseQpBatch<f32>(m);
 }
 
 template<typename T>
@@ -37,6 +57,7 @@ exposeDenseAlgorithms(pybind11::module_ m)
   dense::python::exposeDenseModel<T>(m);
   dense::python::exposeQpObjectDense<T>(m);
   dense::python::solveDenseQp<T>(m);
+  dense::python::solveDenseQpBatch<T>(m);
 }
 
 PYBIND11_MODULE(PYTHON_MODULE_NAME, m)
@@ -54,13 +75,21 @@ PYBIND11_MODULE(PYTHON_MODULE_NAME, m)
 
   pybind11::module_ proxqp_module =
     m.def_submodule("proxqp", "The proxQP solvers of the proxSuite library");
+  exposeSolverOutput(proxqp_module);
+  exposeSettingsEnums(proxqp_module);
   exposeCommon<f64>(proxqp_module);
+  // single precision variants (Results_float32, QP_float32, solve_float32...)
+  // solve float32 NumPy data without converting it to double precision
+  exposeCommon<f32>(proxqp_module);
   pybind11::module_ dense_module =
     proxqp_module.def_submodule("dense", "Dense solver of proxQP");
   exposeDenseAlgorithms<f64>(dense_module);
+  exposeDenseAlgorithms<f32>(dense_module);
   pybind11::module_ sparse_module =
     proxqp_module.def_submodule("sparse", "Sparse solver of proxQP");
-  exposeSparseAlgorithms<f64, int32_t>(sparse_module);
+  exposeSparseAlgorithms<f64>(sparse_module);
+  exposeSparseAlgorithmsFloat32(sparse_module);
+  exposeQpObject<f64, int32_t>(proxqp_module);
 
   // Add version
   m.attr("__version__") = helpers::printVersion();
@@ -79,6 +108,65 @@ PYBIND11_MODULE(PYTHON_MODULE_NAME, m)
                      pybind11::arg("patch_version"),
                      "Check version of the package is at least greater than "
                      "the one provided as input.");
+  helpers_module.def(
+    "autotuneDenseKernels",
+    [](proxsuite::linalg::veg::isize max_dim, bool save) -> pybind11::dict {
+      using namespace proxsuite::linalg::dense;
+      DenseTuning tuning = autotune_dense_kernels<f64>(max_dim);
+      set_dense_tuning(tuning);
+      std::string path = dense_tuning_cache_path();
+      if (save && !path.empty()) {
+        std::string::size_type slash = path.find_last_of('/');
+        if (slash != std::string::npos && slash != 0) {
+          pybind11::module_::import("os").attr("makedirs")(
+            path.substr(0, slash), pybind11::arg("exist_ok") = true);
+        }
+        save_dense_tuning(path, tuning);
+      }
+      pybind11::dict result;
+      result["factorize_block_size"] = tuning.factorize_block_size;
+      result["factorize_recursive_threshold"] =
+        tuning.factorize_recursive_threshold;
+      result["factorize_blocked_min_dim"] = tuning.factorize_blocked_min_dim;
+      result["rank_r_update_chunk"] = tuning.rank_r_update_chunk;
+      return result;
+    },
+    pybind11::arg("max_dim") = 2048,
+    pybind11::arg("save") = true,
+    "Measure the fastest block sizes and algorithm variants of the dense "
+    "factorization and rank updates on this machine, use them in this process "
+    "and, if save is true, write them to the tuning cache file, from which "
+    "the next processes can load them with loadDenseTuning.");
+  helpers_module.def(
+    "loadDenseTuning",
+    []() -> bool { return proxsuite::linalg::dense::load_dense_tuning(); },
+    "Use the block sizes and algorithm variants of the dense factorization and "
+    "rank updates saved in the tuning cache file by autotuneDenseKernels, if "
+    "it exists. Returns whether it could be read. This should be called before "
+    "the dense QP objects are created.");
+  helpers_module.def(
+    "setLargeBufferPolicy",
+    [](std::string const& huge_pages, bool numa_first_touch) {
+      using namespace proxsuite::helpers;
+      LargeBufferPolicy policy;
+      if (huge_pages == "transparent") {
+        policy.huge_pages = HugePages::TRANSPARENT;
+      } else if (huge_pages == "explicit") {
+        policy.huge_pages = HugePages::EXPLICIT;
+      } else if (huge_pages != "disabled") {
+        throw pybind11::value_error(
+          "huge_pages must be \"disabled\", \"transparent\" or \"explicit\".");
+      }
+      policy.numa_first_touch = numa_first_touch;
+      set_large_buffer_policy(policy);
+    },
+    pybind11::arg("huge_pages") = "transparent",
+    pybind11::arg("numa_first_touch") = false,
+    "Place the buffers of the solvers spanning at least one 2 MB page on huge "
+    "pages (\"disabled\", \"transparent\" or \"explicit\"), and optionally "
+    "place the pages of the dense LDLT factor on the NUMA node of the thread "
+    "which first touches them. Applies to the solvers constructed or "
+    "initialized afterwards, on Linux only.");
 }
 
 } // namespace python
@@ -0,0 +1,539 @@
+//
+// Copyright (c) 2022 INRIA
+//
+#include <proxsuite/proxqp/dense/wrapper.hpp>
+#include <proxsuite/proxqp/sparse/wrapper.hpp>
+#include <pybind11/pybind11.h>
+#include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "helpers.hpp"
+
+namespace proxsuite {
+namespace proxqp {
+using proxsuite::linalg::veg::isize;
+
+namespace python {
+
+/// NumPy array holding the inputs of a batch of problems, stacked along its
+/// first dimension.
+template<typename T>
+using StackedArray =
+  pybind11::array_t<T, pybind11::array::c_style | pybind11::array::forcecast>;
+
+/*!
+ * Dimensions of a batch of problems, and pointers to their stacked inputs
+ * (nullptr when an input is not provided). Each problem is stored contiguously
+ * and the matrices are row major, as in C ordered NumPy arrays.
+ */
+template<typename T>
+struct StackedQp
+{
+  isize batch_size = 0;
+  isize n = 0;
+  isize n_eq = 0;
+  isize n_in = 0;
+  T const* H = nullptr;
+  T const* g = nullptr;
+  T const* A = nullptr;
+  T const* b = nullptr;
+  T const* C = nullptr;
+  T const* u = nullptr;
+  T const* l = nullptr;
+};
+
+/*!
+ * Options of the solver common to the problems of a batch.
+ */
+template<typename T>
+struct BatchOptions
+{
+  std::optional<T> eps_abs;
+  std::optional<T> eps_rel;
+  std::optional<T> rho;
+  std::optional<T> mu_eq;
+  std::optional<T> mu_in;
+  bool compute_preconditioner;
+  std::optional<isize> max_iter;
+  InitialGuessStatus initial_guess;
+  isize num_threads;
+
+  void apply(Settings<T>& settings) const
+  {
+    settings.initial_guess = initial_guess;
+    // the timings of the members are not returned
+    settings.compute_timings = false;
+    if (eps_abs != std::nullopt) {
+      settings.eps_abs = eps_abs.value();
+    }
+    if (eps_rel != std::nullopt) {
+      settings.eps_rel = eps_rel.value();
+    }
+    if (max_iter != std::nullopt) {
+      settings.max_iter = max_iter.value();
+    }
+  }
+};
+
+/*!
+ * Stacked solutions of a batch of problems. The NumPy arrays are allocated
+ * with the GIL, and filled by the solver threads without it.
+ */
+template<typename T>
+struct BatchSolutions
+{
+  pybind11::array_t<T> x;
+  pybind11::array_t<T> y;
+  pybind11::array_t<T> z;
+  pybind11::array_t<i64> iter;
+  std::vector<QPSolverOutput> status;
+  T* x_data;
+  T* y_data;
+  T* z_data;
+  i64* iter_data;
+
+  BatchSolutions(isize batch_size, isize n, isize n_eq, isize n_in)
+    : x(std::vector<pybind11::ssize_t>{ batch_size, n })
+    , y(std::vector<pybind11::ssize_t>{ batch_size, n_eq })
+    , z(std::vector<pybind11::ssize_t>{ batch_size, n_in })
+    , iter(std::vector<pybind11::ssize_t>{ batch_size })
+    , status(std::size_t(batch_size), QPSolverOutput::PROXQP_MAX_ITER_REACHED)
+    , x_data(x.mutable_data())
+    , y_data(y.mutable_data())
+    , z_data(z.mutable_data())
+    , iter_data(iter.mutable_data())
+  {
+  }
+
+  void store(isize i, Results<T> const& results)
+  {
+    isize n = results.x.size();
+    isize n_eq = results.y.size();
+    isize n_in = results.z.size();
+    std::copy_n(results.x.data(), n, x_data + i * n);
+    std::copy_n(results.y.data(), n_eq, y_data + i * n_eq);
+    std::copy_n(results.z.data(), n_in, z_data + i * n_in);
+    iter_data[i] = i64(results.info.iter);
+    status[std::size_t(i)] = results.info.status;
+  }
+
+  auto to_dict() const -> pybind11::dict
+  {
+    pybind11::dict solutions;
+    solutions["x"] = x;
+    solutions["y"] = y;
+    solutions["z"] = z;
+    solutions["iter"] = iter;
+    solutions["status"] = status;
+    return solutions;
+  }
+};
+
+/*!
+ * Returns the data of an optional stacked input after checking its shape, or
+ * nullptr if it is not provided.
+ */
+template<typename T>
+auto
+stacked_data(std::optional<StackedArray<T>> const& array,
+             char const* name,
+             std::vector<isize> const& shape) -> T const*
+{
+  if (array == std::nullopt) {
+    return nullptr;
+  }
+  bool valid = array.value().ndim() == pybind11::ssize_t(shape.size());
+  std::string expected = "(";
+  for (std::size_t k = 0; k < shape.size(); ++k) {
+    valid = valid && array.value().shape(pybind11::ssize_t(k)) == shape[k];
+    expected += (k == 0 ? "" : ", ") + std::to_string(shape[k]);
+  }
+  expected += ")";
+  PROXSUITE_THROW_PRETTY(!valid,
+                         std::invalid_argument,
+                         std::string("wrong argument size: ") + name +
+                           " should be of shape " + expected + ".");
+  return array.value().data();
+}
+
+/*!
+ * Returns the size of the dimension k of an optional stacked input, or zero if
+ * it is not provided.
+ */
+template<typename T>
+auto
+stacked_dim(std::optional<StackedArray<T>> const& array,
+            char const* name,
+            pybind11::ssize_t ndim,
+            pybind11::ssize_t k) -> isize
+{
+  if (array == std::nullopt) {
+    return 0;
+  }
+  PROXSUITE_THROW_PRETTY(array.value().ndim() != ndim,
+                         std::invalid_argument,
+                         std::string("wrong argument size: ") + name +
+                           " should have " + std::to_string(ndim) +
+                           " dimensions, the first one indexing the problems "
+                           "of the batch.");
+  return isize(array.value().shape(k));
+}
+
+} // namespace python
+
+namespace dense {
+namespace python {
+
+/*!
+ * Solves a batch of dense problems of the same dimensions, given as stacked
+ * NumPy arrays, see solveDenseQpBatch.
+ */
+template<typename T>
+auto
+solve_batch(proxqp::python::StackedQp<T> const& qp,
+            proxqp::python::BatchOptions<T> const& options)
+  -> proxqp::python::BatchSolutions<T>
+{
+  using RowMat =
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  // column major, so that MatRef binds to the matrices without a copy
+  using ColMat = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+  proxqp::python::BatchSolutions<T> solutions(
+    qp.batch_size, qp.n, qp.n_eq, qp.n_in);
+  {
+    pybind11::gil_scoped_release release;
+    dense::BatchQP<T> batch(qp.batch_size, qp.n, qp.n_eq, qp.n_in);
+    batch.for_each(
+      [&](isize i, dense::QP<T>& member) {
+        ColMat H, A, C;
+        auto mat = [&](T const* data, isize rows, isize cols, ColMat& m)
+          -> std::optional<dense::MatRef<T>> {
+          if (data == nullptr) {
+            return std::nullopt;
+          }
+          m = Eigen::Map<RowMat const>(data + i * rows * cols, rows, cols);
+          return dense::MatRef<T>(m);
+        };
+        auto vec = [&](T const* data,
+                       isize rows) -> std::optional<dense::VecRef<T>> {
+          if (data == nullptr) {
+            return std::nullopt;
+          }
+          return dense::VecRef<T>(
+            Eigen::Map<dense::Vec<T> const>(data + i * rows, rows));
+        };
+        options.apply(member.settings);
+        member.init(mat(qp.H, qp.n, qp.n, H),
+                    vec(qp.g, qp.n),
+                    mat(qp.A, qp.n_eq, qp.n, A),
+                    vec(qp.b, qp.n_eq),
+                    mat(qp.C, qp.n_in, qp.n, C),
+                    vec(qp.u, qp.n_in),
+                    vec(qp.l, qp.n_in),
+                    options.compute_preconditioner,
+                    options.rho,
+                    options.mu_eq,
+                    options.mu_in);
+        member.solve();
+        solutions.store(i, member.results);
+      },
+      options.num_threads);
+  }
+  return solutions;
+}
+
+template<typename T>
+void
+solveDenseQpBatch(pybind11::module_ m)
+{
+  using proxqp::python::StackedArray;
+  m.def(
+    proxsuite::proxqp::python::scalar_name<T>("solve_batch").c_str(),
+    [](StackedArray<T> const& H,
+       std::optional<StackedArray<T>> const& g,
+       std::optional<StackedArray<T>> const& A,
+       std::optional<StackedArray<T>> const& b,
+       std::optional<StackedArray<T>> const& C,
+       std::optional<StackedArray<T>> const& u,
+       std::optional<StackedArray<T>> const& l,
+       std::optional<T> eps_abs,
+       std::optional<T> eps_rel,
+       std::optional<T> rho,
+       std::optional<T> mu_eq,
+       std::optional<T> mu_in,
+       bool compute_preconditioner,
+       std::optional<isize> max_iter,
+       proxsuite::proxqp::InitialGuessStatus initial_guess,
+       isize num_threads) -> pybind11::dict {
+      using namespace proxsuite::proxqp::python;
+      std::optional<StackedArray<T>> H_ = H;
+      StackedQp<T> qp;
+      qp.batch_size = stacked_dim(H_, "H", 3, 0);
+      qp.n = stacked_dim(H_, "H", 3, 1);
+      qp.n_eq = stacked_dim(A, "A", 3, 1);
+      qp.n_in = stacked_dim(C, "C", 3, 1);
+      isize bs = qp.batch_size;
+      qp.H = stacked_data(H_, "H", { bs, qp.n, qp.n });
+      qp.g = stacked_data(g, "g", { bs, qp.n });
+      qp.A = stacked_data(A, "A", { bs, qp.n_eq, qp.n });
+      qp.b = stacked_data(b, "b", { bs, qp.n_eq });
+      qp.C = stacked_data(C, "C", { bs, qp.n_in, qp.n });
+      qp.u = stacked_data(u, "u", { bs, qp.n_in });
+      qp.l = stacked_data(l, "l", { bs, qp.n_in });
+      BatchOptions<T> options{ eps_abs,        eps_rel,
+                               rho,            mu_eq,
+                               mu_in,          compute_preconditioner,
+                               max_iter,       initial_guess,
+                               num_threads };
+      return dense::python::solve_batch(qp, options).to_dict();
+    },
+    "Function for solving a batch of QP problems of the same dimensions with "
+    "the dense backend, given as stacked arrays whose first dimension indexes "
+    "the problems (H of shape (batch_size, n, n), g of shape (batch_size, n), "
+    "A of shape (batch_size, n_eq, n), etc.). The problems are solved in "
+    "parallel without the GIL when OpenMP support is enabled. Returns a "
+    "dictionary of the stacked solutions x, y and z, and of the number of "
+    "iterations and status of each problem.",
+    pybind11::arg("H"),
+    pybind11::arg_v("g", std::nullopt, "stacked linear costs."),
+    pybind11::arg_v(
+      "A", std::nullopt, "stacked equality constraint matrices."),
+    pybind11::arg_v("b", std::nullopt, "stacked equality constraint vectors."),
+    pybind11::arg_v(
+      "C", std::nullopt, "stacked inequality constraint matrices."),
+    pybind11::arg_v(
+      "u", std::nullopt, "stacked upper inequality constraint vectors."),
+    pybind11::arg_v(
+      "l", std::nullopt, "stacked lower inequality constraint vectors."),
+    pybind11::arg_v(
+      "eps_abs",
+      std::nullopt,
+      "absolute accuracy level used for the solver stopping criterion."),
+    pybind11::arg_v("eps_rel",
+                    std::nullopt,
+                    "relative accuracy level used for the solver stopping "
+                    "criterion. Deactivated in standard settings."),
+    pybind11::arg_v("rho", std::nullopt, "primal proximal parameter"),
+    pybind11::arg_v(
+      "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
+    pybind11::arg_v(
+      "mu_in", std::nullopt, "dual inequality constraint proximal parameter"),
+    pybind11::arg_v("compute_preconditioner",
+                    true,
+                    "executes the default preconditioner for reducing ill "
+                    "conditioning and speeding up the solver."),
+    pybind11::arg_v("max_iter", std::nullopt, "maximum number of iteration."),
+    pybind11::arg_v(
+      "initial_guess",
+      proxsuite::proxqp::InitialGuessStatus::EQUALITY_CONSTRAINED_INITIAL_GUESS,
+      "initial guess option."),
+    pybind11::arg_v("num_threads",
+                    0,
+                    "largest number of threads used, all the available ones "
+                    "when it is not positive."));
+}
+
+} // namespace python
+} // namespace dense
+
+namespace sparse {
+namespace python {
+
+/*!
+ * Solves a batch of sparse problems sharing the sparsity structure of H, A and
+ * C, whose stacked values are given in the order of the compressed storage of
+ * these matrices, see solveSparseQpBatch.
+ */
+template<typename T, typename I>
+auto
+solve_batch(SparseMat<T, I> const& H,
+            SparseMat<T, I> const& A,
+            SparseMat<T, I> const& C,
+            proxqp::python::StackedQp<T> const& qp,
+            proxqp::python::BatchOptions<T> const& options)
+  -> proxqp::python::BatchSolutions<T>
+{
+  proxqp::python::BatchSolutions<T> solutions(
+    qp.batch_size, qp.n, qp.n_eq, qp.n_in);
+  {
+    pybind11::gil_scoped_release release;
+    sparse::BatchQP<T, I> batch(qp.batch_size,
+                                H.template cast<bool>(),
+                                A.template cast<bool>(),
+                                C.template cast<bool>());
+    batch.for_each(
+      [&](isize i, sparse::QP<T, I>& member) {
+        auto mat = [&](SparseMat<T, I> const& pattern,
+                       T const* values) -> SparseMat<T, I> {
+          SparseMat<T, I> m = pattern;
+          if (values != nullptr) {
+            std::copy_n(values + i * m.nonZeros(), m.nonZeros(), m.valuePtr());
+          }
+          return m;
+        };
+        auto vec = [&](T const* data,
+                       isize rows) -> std::optional<VecRef<T>> {
+          if (data == nullptr) {
+            return std::nullopt;
+          }
+          return VecRef<T>(Eigen::Map<Vec<T> const>(data + i * rows, rows));
+        };
+        options.apply(member.settings);
+        member.init(mat(H, qp.H),
+                    vec(qp.g, qp.n),
+                    mat(A, qp.A),
+                    vec(qp.b, qp.n_eq),
+                    mat(C, qp.C),
+                    vec(qp.u, qp.n_in),
+                    vec(qp.l, qp.n_in),
+                    options.compute_preconditioner,
+                    options.rho,
+                    options.mu_eq,
+                    options.mu_in);
+        member.solve();
+        solutions.store(i, member.results);
+      },
+      options.num_threads);
+  }
+  return solutions;
+}
+
+template<typename T>
+void
+solveSparseQpBatch(pybind11::module_ m)
+{
+  using proxqp::python::StackedArray;
+  m.def(
+    proxsuite::proxqp::python::scalar_name<T>("solve_batch").c_str(),
+    [](SparseMat<T, i64> const& H,
+       std::optional<StackedArray<T>> const& H_values,
+       std::optional<StackedArray<T>> const& g,
+       std::optional<SparseMat<T, i64>> const& A,
+       std::optional<StackedArray<T>> const& A_values,
+       std::optional<StackedArray<T>> const& b,
+       std::optional<SparseMat<T, i64>> const& C,
+       std::optional<StackedArray<T>> const& C_values,
+       std::optional<StackedArray<T>> const& u,
+       std::optional<StackedArray<T>> const& l,
+       std::optional<T> eps_abs,
+       std::optional<T> eps_rel,
+       std::optional<T> rho,
+       std::optional<T> mu_eq,
+       std::optional<T> mu_in,
+       bool compute_preconditioner,
+       std::optional<isize> max_iter,
+       proxsuite::proxqp::InitialGuessStatus initial_guess,
+       isize num_threads) -> pybind11::dict {
+      using namespace proxsuite::proxqp::python;
+      StackedQp<T> qp;
+      qp.n = H.rows();
+      SparseMat<T, i64> A_ = A.value_or(SparseMat<T, i64>(0, qp.n));
+      SparseMat<T, i64> C_ = C.value_or(SparseMat<T, i64>(0, qp.n));
+      qp.n_eq = A_.rows();
+      qp.n_in = C_.rows();
+      // the batch size is given by the first stacked input
+      for (auto const* input :
+           { &H_values, &g, &A_values, &b, &C_values, &u, &l }) {
+        if (qp.batch_size == 0 && *input != std::nullopt) {
+          qp.batch_size = isize(input->value().shape(0));
+        }
+      }
+      PROXSUITE_THROW_PRETTY(qp.batch_size == 0,
+                             std::invalid_argument,
+                             "wrong argument size: at least one stacked "
+                             "input should be provided.");
+      isize bs = qp.batch_size;
+      qp.H = stacked_data(H_values, "H_values", { bs, isize(H.nonZeros()) });
+      qp.g = stacked_data(g, "g", { bs, qp.n });
+      qp.A = stacked_data(A_values, "A_values", { bs, isize(A_.nonZeros()) });
+      qp.b = stacked_data(b, "b", { bs, qp.n_eq });
+      qp.C = stacked_data(C_values, "C_values", { bs, isize(C_.nonZeros()) });
+      qp.u = stacked_data(u, "u", { bs, qp.n_in });
+      qp.l = stacked_data(l, "l", { bs, qp.n_in });
+      BatchOptions<T> options{ eps_abs,        eps_rel,
+                               rho,            mu_eq,
+                               mu_in,          compute_preconditioner,
+                               max_iter,       initial_guess,
+                               num_threads };
+
+      // 32 bit indices are used when they are large enough, see
+      // solve_with_index_choice
+      if (index_type_fits<int32_t>(H.template cast<bool>(),
+                                   A_.template cast<bool>(),
+                                   C_.template cast<bool>())) {
+        return sparse::python::solve_batch<T, int32_t>(
+                 SparseMat<T, int32_t>(H),
+                 SparseMat<T, int32_t>(A_),
+                 SparseMat<T, int32_t>(C_),
+                 qp,
+                 options)
+          .to_dict();
+      }
+      return sparse::python::solve_batch<T, i64>(H, A_, C_, qp, options)
+        .to_dict();
+    },
+    "Function for solving a batch of QP problems sharing the sparsity "
+    "structure of H, A and C with the sparse backend. The ordering and the "
+    "symbolic factorization of the KKT matrix are computed once for the "
+    "batch. The values of the matrices of the problems are given as stacked "
+    "arrays of shape (batch_size, nnz), in the order of the data array of the "
+    "matrices in CSC format (with sorted indices), and the vectors as stacked "
+    "arrays of shape (batch_size, size). A matrix whose values are not given "
+    "is shared by all the problems. The problems are solved in parallel "
+    "without the GIL when OpenMP support is enabled. Returns a dictionary of "
+    "the stacked solutions x, y and z, and of the number of iterations and "
+    "status of each problem.",
+    pybind11::arg("H"),
+    pybind11::arg_v(
+      "H_values", std::nullopt, "stacked quadratic cost values."),
+    pybind11::arg_v("g", std::nullopt, "stacked linear costs."),
+    pybind11::arg_v(
+      "A", std::nullopt, "sparsity structure of the equality constraints."),
+    pybind11::arg_v(
+      "A_values", std::nullopt, "stacked equality constraint matrix values."),
+    pybind11::arg_v("b", std::nullopt, "stacked equality constraint vectors."),
+    pybind11::arg_v(
+      "C", std::nullopt, "sparsity structure of the inequality constraints."),
+    pybind11::arg_v("C_values",
+                    std::nullopt,
+                    "stacked inequality constraint matrix values."),
+    pybind11::arg_v(
+      "u", std::nullopt, "stacked upper inequality constraint vectors."),
+    pybind11::arg_v(
+      "l", std::nullopt, "stacked lower inequality constraint vectors."),
+    pybind11::arg_v(
+      "eps_abs",
+      std::nullopt,
+      "absolute accuracy level used for the solver stopping criterion."),
+    pybind11::arg_v("eps_rel",
+                    std::nullopt,
+                    "relative accuracy level used for the solver stopping "
+                    "criterion. Deactivated in standard settings."),
+    pybind11::arg_v("rho", std::nullopt, "primal proximal parameter"),
+    pybind11::arg_v(
+      "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
+    pybind11::arg_v(
+      "mu_in", std::nullopt, "dual inequality constraint proximal parameter"),
+    pybind11::arg_v("compute_preconditioner",
+                    true,
+                    "executes the default preconditioner for reducing ill "
+                    "conditioning and speeding up the solver."),
+    pybind11::arg_v("max_iter", std::nullopt, "maximum number of iteration."),
+    pybind11::arg_v(
+      "initial_guess",
+      proxsuite::proxqp::InitialGuessStatus::EQUALITY_CONSTRAINED_INITIAL_GUESS,
+      "initial guess option."),
+    pybind11::arg_v("num_threads",
+                    0,
+                    "largest number of threads used, all the available ones "
+                    "when it is not positive."));
+}
+
+} // namespace python
+} // namespace sparse
+} // namespace proxqp
+} // namespace proxsuite
@@ -7,6 +7,8 @@
 #include <pybind11/eigen.h>
 #include <proxsuite/proxqp/dense/utils.hpp>
 
+#include "helpers.hpp"
+
 namespace proxsuite {
 namespace proxqp {
 namespace dense {
@@ -15,7 +17,8 @@ template<typename T>
 void
 exposeDenseModel(pybind11::module_ m)
 {
-  ::pybind11::class_<proxsuite::proxqp::dense::Model<T>>(m, "model")
+  ::pybind11::class_<proxsuite::proxqp::dense::Model<T>>(
+    m, proxsuite::proxqp::python::scalar_name<T>("model").c_str())
     .def(::pybind11::init<i64, i64, i64>(),
          pybind11::arg_v("n", 0, "primal dimension."),
          pybind11::arg_v("n_eq", 0, "number of equality constraints."),
@@ -40,9 +43,9 @@ namespace sparse {
 namespace python {
 template<typename T, typename I>
 void
-exposeSparseModel(pybind11::module_ m)
+exposeSparseModel(pybind11::module_ m, const char* name = "model")
 {
-  ::pybind11::class_<proxsuite::proxqp::sparse::Model<T, I>>(m, "model")
+  ::pybind11::class_<proxsuite::proxqp::sparse::Model<T, I>>(m, name)
     .def(::pybind11::init<i64, i64, i64>(),
          pybind11::arg_v("n", 0, "primal dimension."),
          pybind11::arg_v("n_eq", 0, "number of equality constraints."),
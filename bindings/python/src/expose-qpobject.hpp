@@ -4,6 +4,7 @@
 
 #include <proxsuite/proxqp/dense/wrapper.hpp>
 #include <proxsuite/proxqp/sparse/wrapper.hpp>
+#include <proxsuite/proxqp/wrapper.hpp>
 #include <proxsuite/proxqp/status.hpp>
 #include <pybind11/pybind11.h>
 #include <pybind11/eigen.h>
@@ -21,39 +22,86 @@ template<typename T>
 void
 exposeQpObjectDense(pybind11::module_ m)
 {
+  using proxsuite::proxqp::python::without_gil;
+  using proxsuite::proxqp::python::deserialize_from_buffer;
+  using proxsuite::proxqp::python::deserialize_from_shared_memory;
+  using proxsuite::proxqp::python::pickle;
+  using proxsuite::proxqp::python::serialize_into_buffer;
+  using proxsuite::proxqp::python::serialize_to_bytes;
+  using proxsuite::proxqp::python::serialize_to_shared_memory;
+  using proxsuite::proxqp::python::field_getter;
+  using proxsuite::proxqp::python::in_place_setter;
 
-  ::pybind11::class_<dense::QP<T>>(m, "QP")
+  auto results_shape = [](const Results<T>& results) {
+    return std::make_tuple(
+      results.x.size(), results.y.size(), results.z.size());
+  };
+  auto model_shape = [](const dense::Model<T>& model) {
+    return std::make_tuple(model.dim, model.n_eq, model.n_in);
+  };
+
+  ::pybind11::class_<dense::QP<T>>(
+    m, proxsuite::proxqp::python::scalar_name<T>("QP").c_str())
     .def(::pybind11::init<i64, i64, i64>(),
          pybind11::arg_v("n", 0, "primal dimension."),
          pybind11::arg_v("n_eq", 0, "number of equality constraints."),
          pybind11::arg_v("n_in", 0, "number of inequality constraints."),
          "Default constructor using QP model dimensions.") // constructor
-    .def_readwrite(
+    // the results and the model are assigned in place, so that the arrays
+    // aliasing them remain valid
+    .def_property(
       "results",
-      &dense::QP<T>::results,
+      field_getter(&dense::QP<T>::results),
+      in_place_setter(&dense::QP<T>::results, results_shape, "results"),
       "class containing the solution or certificate of infeasibility, "
       "and "
       "information statistics in an info subclass.")
     .def_readwrite("settings",
                    &dense::QP<T>::settings,
                    "class with settings option of the solver.")
-    .def_readwrite(
-      "model", &dense::QP<T>::model, "class containing the QP model")
+    .def_property("model",
+                  field_getter(&dense::QP<T>::model),
+                  in_place_setter(&dense::QP<T>::model, model_shape, "model"),
+                  "class containing the QP model")
 
+    // the overloads taking row major matrices come first, so that C ordered
+    // arrays are copied into the model without conversion, the column major
+    // ones binding Fortran ordered arrays without conversion either
     .def(
       "init",
-      static_cast<void (dense::QP<T>::*)(std::optional<dense::MatRef<T>>,
-                                         std::optional<dense::VecRef<T>>,
-                                         std::optional<dense::MatRef<T>>,
-                                         std::optional<dense::VecRef<T>>,
-                                         std::optional<dense::MatRef<T>>,
-                                         std::optional<dense::VecRef<T>>,
-                                         std::optional<dense::VecRef<T>>,
-                                         bool compute_preconditioner,
-                                         std::optional<T>,
-                                         std::optional<T>,
-                                         std::optional<T>)>(
-        &dense::QP<T>::init),
+      without_gil(&dense::QP<T>::template init<dense::RowMatRef<T>>),
+      "function for initialize the QP model.",
+      pybind11::arg_v("H", std::nullopt, "quadratic cost"),
+      pybind11::arg_v("g", std::nullopt, "linear cost"),
+      pybind11::arg_v("A", std::nullopt, "equality constraint matrix"),
+      pybind11::arg_v("b", std::nullopt, "equality constraint vector"),
+      pybind11::arg_v("C", std::nullopt, "inequality constraint matrix"),
+      pybind11::arg_v("u", std::nullopt, "upper inequality constraint vector"),
+      pybind11::arg_v("l", std::nullopt, "lower inequality constraint vector"),
+      pybind11::arg_v("compute_preconditioner",
+                      true,
+                      "execute the preconditioner for reducing "
+                      "ill-conditioning and speeding up solver execution."),
+      pybind11::arg_v("rho", std::nullopt, "primal proximal parameter"),
+      pybind11::arg_v(
+        "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
+      pybind11::arg_v(
+        "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
+    .def(
+      "init",
+      without_gil(
+        static_cast<void (dense::QP<T>::*)(std::optional<dense::MatRef<T>>,
+                                           std::optional<dense::VecRef<T>>,
+                                           std::optional<dense::MatRef<T>>,
+                                           std::optional<dense::VecRef<T>>,
+                                           std::optional<dense::MatRef<T>>,
+                                           std::optional<dense::VecRef<T>>,
+                                           std::optional<dense::VecRef<T>>,
+                                           bool compute_preconditioner,
+                                           std::optional<T>,
+                                           std::optional<T>,
+                                           std::optional<T>)>(
+          &dense::QP<T>::init)),
       "function for initialize the QP model.",
       pybind11::arg_v("H", std::nullopt, "quadratic cost"),
       pybind11::arg_v("g", std::nullopt, "linear cost"),
@@ -74,18 +122,19 @@ exposeQpObjectDense(pybind11::module_ m)
 
     .def(
       "init",
-      static_cast<void (dense::QP<T>::*)(std::optional<dense::SparseMat<T>>,
-                                         std::optional<dense::VecRef<T>>,
-                                         std::optional<dense::SparseMat<T>>,
-                                         std::optional<dense::VecRef<T>>,
-                                         std::optional<dense::SparseMat<T>>,
-                                         std::optional<dense::VecRef<T>>,
-                                         std::optional<dense::VecRef<T>>,
-                                         bool compute_preconditioner,
-                                         std::optional<T>,
-                                         std::optional<T>,
-                                         std::optional<T>)>(
-        &dense::QP<T>::init),
+      without_gil(
+        static_cast<void (dense::QP<T>::*)(std::optional<dense::SparseMat<T>>,
+                                           std::optional<dense::VecRef<T>>,
+                                           std::optional<dense::SparseMat<T>>,
+                                           std::optional<dense::VecRef<T>>,
+                                           std::optional<dense::SparseMat<T>>,
+                                           std::optional<dense::VecRef<T>>,
+                                           std::optional<dense::VecRef<T>>,
+                                           bool compute_preconditioner,
+                                           std::optional<T>,
+                                           std::optional<T>,
+                                           std::optional<T>)>(
+          &dense::QP<T>::init)),
       "function for initialize the QP model.",
       pybind11::arg_v("H", std::nullopt, "quadratic cost"),
       pybind11::arg_v("g", std::nullopt, "linear cost"),
@@ -105,29 +154,55 @@ exposeQpObjectDense(pybind11::module_ m)
         "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
 
     .def("solve",
-         static_cast<void (dense::QP<T>::*)()>(&dense::QP<T>::solve),
+         without_gil(
+           static_cast<void (dense::QP<T>::*)()>(&dense::QP<T>::solve)),
          "function used for solving the QP problem, using default parameters.")
     .def("solve",
-         static_cast<void (dense::QP<T>::*)(std::optional<dense::VecRef<T>> x,
-                                            std::optional<dense::VecRef<T>> y,
-                                            std::optional<dense::VecRef<T>> z)>(
-           &dense::QP<T>::solve),
+         without_gil(
+           static_cast<void (dense::QP<T>::*)(
+             std::optional<dense::VecRef<T>> x,
+             std::optional<dense::VecRef<T>> y,
+             std::optional<dense::VecRef<T>> z)>(&dense::QP<T>::solve)),
          "function used for solving the QP problem, when passing a warm start.")
 
     .def(
       "update",
-      static_cast<void (dense::QP<T>::*)(std::optional<dense::MatRef<T>>,
-                                         std::optional<dense::Vec<T>>,
-                                         std::optional<dense::MatRef<T>>,
-                                         std::optional<dense::Vec<T>>,
-                                         std::optional<dense::MatRef<T>>,
-                                         std::optional<dense::Vec<T>>,
-                                         std::optional<dense::Vec<T>>,
-                                         bool update_preconditioner,
-                                         std::optional<T>,
-                                         std::optional<T>,
-                                         std::optional<T>)>(
-        &dense::QP<T>::update),
+      without_gil(&dense::QP<T>::template update<dense::RowMatRef<T>>),
+      "function used for updating matrix or vector entry of the model using "
+      "dense matrix entries.",
+      pybind11::arg_v("H", std::nullopt, "quadratic cost"),
+      pybind11::arg_v("g", std::nullopt, "linear cost"),
+      pybind11::arg_v("A", std::nullopt, "equality constraint matrix"),
+      pybind11::arg_v("b", std::nullopt, "equality constraint vector"),
+      pybind11::arg_v("C", std::nullopt, "inequality constraint matrix"),
+      pybind11::arg_v("u", std::nullopt, "upper inequality constraint vector"),
+      pybind11::arg_v("l", std::nullopt, "lower inequality constraint vector"),
+      pybind11::arg_v(
+        "update_preconditioner",
+        true,
+        "update the preconditioner considering new matrices entries for "
+        "reducing ill-conditioning and speeding up solver execution. If set up "
+        "to false, use previous derived preconditioner."),
+      pybind11::arg_v("rho", std::nullopt, "primal proximal parameter"),
+      pybind11::arg_v(
+        "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
+      pybind11::arg_v(
+        "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
+    .def(
+      "update",
+      without_gil(
+        static_cast<void (dense::QP<T>::*)(std::optional<dense::MatRef<T>>,
+                                           std::optional<dense::Vec<T>>,
+                                           std::optional<dense::MatRef<T>>,
+                                           std::optional<dense::Vec<T>>,
+                                           std::optional<dense::MatRef<T>>,
+                                           std::optional<dense::Vec<T>>,
+                                           std::optional<dense::Vec<T>>,
+                                           bool update_preconditioner,
+                                           std::optional<T>,
+                                           std::optional<T>,
+                                           std::optional<T>)>(
+          &dense::QP<T>::update)),
       "function used for updating matrix or vector entry of the model using "
       "dense matrix entries.",
       pybind11::arg_v("H", std::nullopt, "quadratic cost"),
@@ -150,18 +225,19 @@ exposeQpObjectDense(pybind11::module_ m)
         "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
     .def(
       "update",
-      static_cast<void (dense::QP<T>::*)(
-        const std::optional<dense::SparseMat<T>>,
-        std::optional<dense::Vec<T>>,
-        const std::optional<dense::SparseMat<T>>,
-        std::optional<dense::Vec<T>>,
-        const std::optional<dense::SparseMat<T>>,
-        std::optional<dense::Vec<T>>,
-        std::optional<dense::Vec<T>>,
-        bool update_preconditioner,
-        std::optional<T>,
-        std::optional<T>,
-        std::optional<T>)>(&dense::QP<T>::update),
+      without_gil(
+        static_cast<void (dense::QP<T>::*)(
+          const std::optional<dense::SparseMat<T>>,
+          std::optional<dense::Vec<T>>,
+          const std::optional<dense::SparseMat<T>>,
+          std::optional<dense::Vec<T>>,
+          const std::optional<dense::SparseMat<T>>,
+          std::optional<dense::Vec<T>>,
+          std::optional<dense::Vec<T>>,
+          bool update_preconditioner,
+          std::optional<T>,
+          std::optional<T>,
+          std::optional<T>)>(&dense::QP<T>::update)),
       "function used for updating matrix or vector entry of the model using "
       "sparse matrix entries.",
       pybind11::arg_v("H", std::nullopt, "quadratic cost"),
@@ -182,6 +258,47 @@ exposeQpObjectDense(pybind11::module_ m)
         "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
       pybind11::arg_v(
         "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
+    .def("stack_usage",
+         &dense::QP<T>::stack_usage,
+         "function returning the size of the stack of the workspace and the "
+         "largest number of bytes of it used so far.")
+    .def("trim_stack",
+         &dense::QP<T>::trim_stack,
+         "function shrinking the stack of the workspace to the largest number "
+         "of bytes of it used so far. It grows back on demand.")
+    .def(pickle<dense::QP<T>, &dense::deserialize<T>>())
+    .def("serialize",
+         &serialize_to_bytes<dense::QP<T>>,
+         "function returning the settings, model, preconditioner and results "
+         "of the QP object as bytes, from which deserialize rebuilds it "
+         "without equilibrating the model again.")
+    .def("serialized_size",
+         [](const dense::QP<T>& qp) { return serialized_size(qp); },
+         "function returning the number of bytes written by serialize.")
+    .def("serialize_into",
+         &serialize_into_buffer<dense::QP<T>>,
+         "function writing the serialized QP object into a writable buffer of "
+         "at least serialized_size() bytes, and returning the number of "
+         "written bytes.",
+         pybind11::arg("buffer"))
+    .def_static("deserialize",
+                &deserialize_from_buffer<dense::QP<T>, &dense::deserialize<T>>,
+                "function rebuilding a QP object from any buffer (bytes, "
+                "memoryview, shared memory...) written by serialize or "
+                "serialize_into.",
+                pybind11::arg("buffer"))
+    .def("to_shared_memory",
+         &serialize_to_shared_memory<dense::QP<T>>,
+         "function serializing the QP object into a new "
+         "multiprocessing.shared_memory.SharedMemory segment, which is "
+         "returned. The caller is responsible for closing and unlinking it.",
+         pybind11::arg_v("name", std::nullopt, "name of the segment."))
+    .def_static(
+      "from_shared_memory",
+      &deserialize_from_shared_memory<dense::QP<T>, &dense::deserialize<T>>,
+      "function rebuilding a QP object from a SharedMemory segment written by "
+      "to_shared_memory, or from its name.",
+      pybind11::arg("shm"))
     .def("cleanup",
          &dense::QP<T>::cleanup,
          "function used for cleaning the workspace and result "
@@ -196,10 +313,33 @@ namespace python {
 
 template<typename T, typename I>
 void
-exposeQpObjectSparse(pybind11::module_ m)
+exposeQpObjectSparse(pybind11::module_ m, const char* name = "QP")
 {
+  using proxsuite::proxqp::python::without_gil;
+  using proxsuite::proxqp::python::deserialize_from_buffer;
+  using proxsuite::proxqp::python::deserialize_from_shared_memory;
+  using proxsuite::proxqp::python::pickle;
+  using proxsuite::proxqp::python::serialize_into_buffer;
+  using proxsuite::proxqp::python::serialize_to_bytes;
+  using proxsuite::proxqp::python::serialize_to_shared_memory;
+  using proxsuite::proxqp::python::field_getter;
+  using proxsuite::proxqp::python::in_place_setter;
 
-  ::pybind11::class_<sparse::QP<T, I>>(m, "QP") //,pybind11::module_local()
+  auto results_shape = [](const Results<T>& results) {
+    return std::make_tuple(
+      results.x.size(), results.y.size(), results.z.size());
+  };
+  // the workspace relies on the sparsity structure of the model
+  auto model_shape = [](const sparse::Model<T, I>& model) {
+    return std::make_tuple(model.dim,
+                           model.n_eq,
+                           model.n_in,
+                           model.H_nnz,
+                           model.A_nnz,
+                           model.C_nnz);
+  };
+
+  ::pybind11::class_<sparse::QP<T, I>>(m, name) //,pybind11::module_local()
     .def(::pybind11::init<i64, i64, i64>(),
          pybind11::arg_v("n", 0, "primal dimension."),
          pybind11::arg_v("n_eq", 0, "number of equality constraints."),
@@ -214,11 +354,17 @@ exposeQpObjectSparse(pybind11::module_ m)
         "A_mask", std::nullopt, "mask of the equality constraint matrix."),
       pybind11::arg_v("C_mask", 0, "mask of the inequality constraint matrix."),
       "Constructor using QP model sparsity structure.") // constructor
-    .def_readwrite(
-      "model", &sparse::QP<T, I>::model, "class containing the QP model")
-    .def_readwrite(
+    // the model and the results are assigned in place, so that the arrays
+    // aliasing them remain valid
+    .def_property(
+      "model",
+      field_getter(&sparse::QP<T, I>::model),
+      in_place_setter(&sparse::QP<T, I>::model, model_shape, "model"),
+      "class containing the QP model")
+    .def_property(
       "results",
-      &sparse::QP<T, I>::results,
+      field_getter(&sparse::QP<T, I>::results),
+      in_place_setter(&sparse::QP<T, I>::results, results_shape, "results"),
       "class containing the solution or certificate of infeasibility, "
       "and "
       "information statistics in an info subclass.")
@@ -227,7 +373,7 @@ exposeQpObjectSparse(pybind11::module_ m)
                    "class with settings option of the solver.")
     .def(
       "init",
-      &sparse::QP<T, I>::init,
+      without_gil(&sparse::QP<T, I>::init),
       "function for initializing the model when passing sparse matrices in "
       "entry.",
       pybind11::arg_v("H", std::nullopt, "quadratic cost"),
@@ -249,7 +395,7 @@ exposeQpObjectSparse(pybind11::module_ m)
 
     .def(
       "update",
-      &sparse::QP<T, I>::update,
+      without_gil(&sparse::QP<T, I>::update),
       "function for updating the model when passing sparse matrices in "
       "entry.",
       pybind11::arg_v("H", std::nullopt, "quadratic cost"),
@@ -269,23 +415,331 @@ exposeQpObjectSparse(pybind11::module_ m)
         "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
       pybind11::arg_v(
         "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
+    .def("H_structure",
+         &sparse::QP<T, I>::H_structure,
+         "sparsity structure of the upper triangular part of H, in the order "
+         "expected by update_values.")
+    .def("AT_structure",
+         &sparse::QP<T, I>::AT_structure,
+         "sparsity structure of the transposed equality constraint matrix, in "
+         "the order expected by update_values.")
+    .def("CT_structure",
+         &sparse::QP<T, I>::CT_structure,
+         "sparsity structure of the transposed inequality constraint matrix, "
+         "in the order expected by update_values.")
+    .def(
+      "update_values",
+      without_gil(&sparse::QP<T, I>::update_values),
+      "function for updating the model when passing the values of its "
+      "matrices in the internal order, without checking their sparsity "
+      "structure.",
+      pybind11::arg_v("H_values", std::nullopt, "quadratic cost values"),
+      pybind11::arg_v("g", std::nullopt, "linear cost"),
+      pybind11::arg_v(
+        "A_values", std::nullopt, "equality constraint matrix values"),
+      pybind11::arg_v("b", std::nullopt, "equality constraint vector"),
+      pybind11::arg_v(
+        "C_values", std::nullopt, "inequality constraint matrix values"),
+      pybind11::arg_v("u", std::nullopt, "upper inequality constraint vector"),
+      pybind11::arg_v("l", std::nullopt, "lower inequality constraint vector"),
+      pybind11::arg_v(
+        "update_preconditioner",
+        true,
+        "update the preconditioner or re-use previous derived for reducing "
+        "ill-conditioning and speeding up solver execution."),
+      pybind11::arg_v("rho", std::nullopt, "primal proximal parameter"),
+      pybind11::arg_v(
+        "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
+      pybind11::arg_v(
+        "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
     .def("solve",
-         static_cast<void (sparse::QP<T, I>::*)()>(&sparse::QP<T, I>::solve),
+         without_gil(
+           static_cast<void (sparse::QP<T, I>::*)()>(&sparse::QP<T, I>::solve)),
          "function used for solving the QP problem, using default parameters.")
     .def("solve",
-         static_cast<void (sparse::QP<T, I>::*)(
-           std::optional<sparse::VecRef<T>> x,
-           std::optional<sparse::VecRef<T>> y,
-           std::optional<sparse::VecRef<T>> z)>(&sparse::QP<T, I>::solve),
+         without_gil(
+           static_cast<void (sparse::QP<T, I>::*)(
+             std::optional<sparse::VecRef<T>> x,
+             std::optional<sparse::VecRef<T>> y,
+             std::optional<sparse::VecRef<T>> z)>(&sparse::QP<T, I>::solve)),
          "function used for solving the QP problem, when passing a warm start.")
+    .def("stack_usage",
+         &sparse::QP<T, I>::stack_usage,
+         "function returning the size of the stack of the workspace and the "
+         "largest number of bytes of it used so far.")
+    .def(pickle<sparse::QP<T, I>, &sparse::deserialize<T, I>>())
+    .def("serialize",
+         &serialize_to_bytes<sparse::QP<T, I>>,
+         "function returning the settings, model, preconditioner and results "
+         "of the QP object as bytes, from which deserialize rebuilds it "
+         "without equilibrating the model again.")
+    .def("serialized_size",
+         [](const sparse::QP<T, I>& qp) { return serialized_size(qp); },
+         "function returning the number of bytes written by serialize.")
+    .def("serialize_into",
+         &serialize_into_buffer<sparse::QP<T, I>>,
+         "function writing the serialized QP object into a writable buffer of "
+         "at least serialized_size() bytes, and returning the number of "
+         "written bytes.",
+         pybind11::arg("buffer"))
+    .def_static(
+      "deserialize",
+      &deserialize_from_buffer<sparse::QP<T, I>, &sparse::deserialize<T, I>>,
+      "function rebuilding a QP object from any buffer (bytes, memoryview, "
+      "shared memory...) written by serialize or serialize_into.",
+      pybind11::arg("buffer"))
+    .def("to_shared_memory",
+         &serialize_to_shared_memory<sparse::QP<T, I>>,
+         "function serializing the QP object into a new "
+         "multiprocessing.shared_memory.SharedMemory segment, which is "
+         "returned. The caller is responsible for closing and unlinking it.",
+         pybind11::arg_v("name", std::nullopt, "name of the segment."))
+    .def_static(
+      "from_shared_memory",
+      &deserialize_from_shared_memory<sparse::QP<T, I>,
+                                      &sparse::deserialize<T, I>>,
+      "function rebuilding a QP object from a SharedMemory segment written by "
+      "to_shared_memory, or from its name.",
+      pybind11::arg("shm"))
     .def("cleanup",
          &sparse::QP<T, I>::cleanup,
          "function used for cleaning the result "
          "class.");
 }
 
+/*!
+ * Exposes the choice of the index type of the sparse solver from the sparsity
+ * structure of a problem.
+ */
+template<typename T>
+void
+exposeSparseIndexChoice(pybind11::module_ m)
+{
+  m.def("predicted_ldlt_nnz",
+        &sparse::predicted_ldlt_nnz<i64>,
+        "number of non zeros of the LDLT factor of the KKT matrix of a QP "
+        "with the given sparsity structure, as predicted by the symbolic "
+        "factorization of the solver.",
+        pybind11::arg("H"),
+        pybind11::arg("A"),
+        pybind11::arg("C"));
+  m.def(
+    "make_qp",
+    [](const sparse::SparseMat<bool, i64>& H,
+       const sparse::SparseMat<bool, i64>& A,
+       const sparse::SparseMat<bool, i64>& C) -> pybind11::object {
+      if (sparse::index_type_fits<int32_t>(H, A, C)) {
+        return pybind11::cast(
+          new sparse::QP<T, int32_t>(sparse::SparseMat<bool, int32_t>(H),
+                                     sparse::SparseMat<bool, int32_t>(A),
+                                     sparse::SparseMat<bool, int32_t>(C)),
+          pybind11::return_value_policy::take_ownership);
+      }
+      return pybind11::cast(new sparse::QP<T, i64>(H, A, C),
+                            pybind11::return_value_policy::take_ownership);
+    },
+    "builds a QP object from the sparsity structure of the problem, using 32 "
+    "bit indices (QP) when they are large enough for the predicted LDLT "
+    "factor of the KKT matrix, and 64 bit indices (QP_int64) otherwise.",
+    pybind11::arg("H_mask"),
+    pybind11::arg("A_mask"),
+    pybind11::arg("C_mask"));
+}
+
 } // namespace python
 } // namespace sparse
 
+namespace python {
+/*!
+ * Exposes the QP object choosing its backend at initialization.
+ */
+template<typename T, typename I>
+void
+exposeQpObject(pybind11::module_ m)
+{
+  using proxsuite::proxqp::python::without_gil;
+  using proxsuite::proxqp::python::deserialize_from_buffer;
+  using proxsuite::proxqp::python::deserialize_from_shared_memory;
+  using proxsuite::proxqp::python::pickle;
+  using proxsuite::proxqp::python::serialize_into_buffer;
+  using proxsuite::proxqp::python::serialize_to_bytes;
+  using proxsuite::proxqp::python::serialize_to_shared_memory;
+  ::pybind11::class_<proxqp::QP<T, I>>(m, "QP")
+    .def(::pybind11::init<i64, i64, i64>(),
+         pybind11::arg_v("n", 0, "primal dimension."),
+         pybind11::arg_v("n_eq", 0, "number of equality constraints."),
+         pybind11::arg_v("n_in", 0, "number of inequality constraints."),
+         "Default constructor using QP model dimensions.") // constructor
+    .def_readwrite("settings",
+                   &proxqp::QP<T, I>::settings,
+                   "class with settings option of the solver. Its backend "
+                   "field selects the backend used at initialization.")
+    .def_property_readonly(
+      "results",
+      &proxqp::QP<T, I>::results,
+      pybind11::return_value_policy::reference_internal,
+      "class containing the solution or certificate of infeasibility, and "
+      "information statistics in an info subclass.")
+    .def("backend",
+         &proxqp::QP<T, I>::backend,
+         "backend chosen at initialization (AUTOMATIC before it).")
+    .def(
+      "init",
+      without_gil(
+        static_cast<void (proxqp::QP<T, I>::*)(std::optional<dense::MatRef<T>>,
+                                               std::optional<dense::VecRef<T>>,
+                                               std::optional<dense::MatRef<T>>,
+                                               std::optional<dense::VecRef<T>>,
+                                               std::optional<dense::MatRef<T>>,
+                                               std::optional<dense::VecRef<T>>,
+                                               std::optional<dense::VecRef<T>>,
+                                               bool,
+                                               std::optional<T>,
+                                               std::optional<T>,
+                                               std::optional<T>)>(
+          &proxqp::QP<T, I>::init)),
+      "function for initializing the model and choosing its backend when "
+      "passing dense matrices in entry.",
+      pybind11::arg_v("H", std::nullopt, "quadratic cost"),
+      pybind11::arg_v("g", std::nullopt, "linear cost"),
+      pybind11::arg_v("A", std::nullopt, "equality constraint matrix"),
+      pybind11::arg_v("b", std::nullopt, "equality constraint vector"),
+      pybind11::arg_v("C", std::nullopt, "inequality constraint matrix"),
+      pybind11::arg_v("u", std::nullopt, "upper inequality constraint vector"),
+      pybind11::arg_v("l", std::nullopt, "lower inequality constraint vector"),
+      pybind11::arg_v("compute_preconditioner",
+                      true,
+                      "execute the preconditioner for reducing "
+                      "ill-conditioning and speeding up solver execution."),
+      pybind11::arg_v("rho", std::nullopt, "primal proximal parameter"),
+      pybind11::arg_v(
+        "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
+      pybind11::arg_v(
+        "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
+    .def(
+      "init",
+      without_gil(
+        static_cast<void (proxqp::QP<T, I>::*)(
+          std::optional<sparse::SparseMat<T, I>>,
+          std::optional<dense::VecRef<T>>,
+          std::optional<sparse::SparseMat<T, I>>,
+          std::optional<dense::VecRef<T>>,
+          std::optional<sparse::SparseMat<T, I>>,
+          std::optional<dense::VecRef<T>>,
+          std::optional<dense::VecRef<T>>,
+          bool,
+          std::optional<T>,
+          std::optional<T>,
+          std::optional<T>)>(&proxqp::QP<T, I>::init)),
+      "function for initializing the model and choosing its backend when "
+      "passing sparse matrices in entry.",
+      pybind11::arg_v("H", std::nullopt, "quadratic cost"),
+      pybind11::arg_v("g", std::nullopt, "linear cost"),
+      pybind11::arg_v("A", std::nullopt, "equality constraint matrix"),
+      pybind11::arg_v("b", std::nullopt, "equality constraint vector"),
+      pybind11::arg_v("C", std::nullopt, "inequality constraint matrix"),
+      pybind11::arg_v("u", std::nullopt, "upper inequality constraint vector"),
+      pybind11::arg_v("l", std::nullopt, "lower inequality constraint vector"),
+      pybind11::arg_v("compute_preconditioner",
+                      true,
+                      "execute the preconditioner for reducing "
+                      "ill-conditioning and speeding up solver execution."),
+      pybind11::arg_v("rho", std::nullopt, "primal proximal parameter"),
+      pybind11::arg_v(
+        "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
+      pybind11::arg_v(
+        "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
+    .def(
+      "update",
+      without_gil(
+        static_cast<void (proxqp::QP<T, I>::*)(std::optional<dense::MatRef<T>>,
+                                               std::optional<dense::VecRef<T>>,
+                                               std::optional<dense::MatRef<T>>,
+                                               std::optional<dense::VecRef<T>>,
+                                               std::optional<dense::MatRef<T>>,
+                                               std::optional<dense::VecRef<T>>,
+                                               std::optional<dense::VecRef<T>>,
+                                               bool,
+                                               std::optional<T>,
+                                               std::optional<T>,
+                                               std::optional<T>)>(
+          &proxqp::QP<T, I>::update)),
+      "function used for updating matrix or vector entry of the model using "
+      "dense matrix entries.",
+      pybind11::arg_v("H", std::nullopt, "quadratic cost"),
+      pybind11::arg_v("g", std::nullopt, "linear cost"),
+      pybind11::arg_v("A", std::nullopt, "equality constraint matrix"),
+      pybind11::arg_v("b", std::nullopt, "equality constraint vector"),
+      pybind11::arg_v("C", std::nullopt, "inequality constraint matrix"),
+      pybind11::arg_v("u", std::nullopt, "upper inequality constraint vector"),
+      pybind11::arg_v("l", std::nullopt, "lower inequality constraint vector"),
+      pybind11::arg_v(
+        "update_preconditioner",
+        true,
+        "update the preconditioner considering new matrices entries for "
+        "reducing ill-conditioning and speeding up solver execution. If set up "
+        "to false, use previous derived preconditioner."),
+      pybind11::arg_v("rho", std::nullopt, "primal proximal parameter"),
+      pybind11::arg_v(
+        "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
+      pybind11::arg_v(
+        "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
+    .def(
+      "update",
+      without_gil(
+        static_cast<void (proxqp::QP<T, I>::*)(
+          std::optional<sparse::SparseMat<T, I>>,
+          std::optional<dense::VecRef<T>>,
+          std::optional<sparse::SparseMat<T, I>>,
+          std::optional<dense::VecRef<T>>,
+          std::optional<sparse::SparseMat<T, I>>,
+          std::optional<dense::VecRef<T>>,
+          std::optional<dense::VecRef<T>>,
+          bool,
+          std::optional<T>,
+          std::optional<T>,
+          std::optional<T>)>(&proxqp::QP<T, I>::update)),
+      "function used for updating matrix or vector entry of the model using "
+      "sparse matrix entries.",
+      pybind11::arg_v("H", std::nullopt, "quadratic cost"),
+      pybind11::arg_v("g", std::nullopt, "linear cost"),
+      pybind11::arg_v("A", std::nullopt, "equality constraint matrix"),
+      pybind11::arg_v("b", std::nullopt, "equality constraint vector"),
+      pybind11::arg_v("C", std::nullopt, "inequality constraint matrix"),
+      pybind11::arg_v("u", std::nullopt, "upper inequality constraint vector"),
+      pybind11::arg_v("l", std::nullopt, "lower inequality constraint vector"),
+      pybind11::arg_v(
+        "update_preconditioner",
+        true,
+        "update the preconditioner considering new matrices entries for "
+        "reducing ill-conditioning and speeding up solver execution. If set up "
+        "to false, use previous derived preconditioner."),
+      pybind11::arg_v("rho", std::nullopt, "primal proximal parameter"),
+      pybind11::arg_v(
+        "mu_eq", std::nullopt, "dual equality constraint proximal parameter"),
+      pybind11::arg_v(
+        "mu_in", std::nullopt, "dual inequality constraint proximal parameter"))
+    .def("solve",
+         without_gil(
+           static_cast<void (proxqp::QP<T, I>::*)()>(&proxqp::QP<T, I>::solve)),
+         "function used for solving the QP problem, using default parameters.")
+    .def("solve",
+         without_gil(
+           static_cast<void (proxqp::QP<T, I>::*)(
+             std::optional<dense::VecRef<T>> x,
+             std::optional<dense::VecRef<T>> y,
+             std::optional<dense::VecRef<T>> z)>(&proxqp::QP<T, I>::solve)),
+         "function used for solving the QP problem, when passing a warm start.")
+    .def("stack_usage",
+         &proxqp::QP<T, I>::stack_usage,
+         "function returning the size of the stack of the workspace of the "
+         "backend and the largest number of bytes of it used so far.")
+    .def("cleanup",
+         &proxqp::QP<T, I>::cleanup,
+         "function used for cleaning the result "
+         "class.");
+}
+} // namespace python
+
 } // namespace proxqp
 } // namespace proxsuite
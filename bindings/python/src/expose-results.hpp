@@ -11,9 +11,8 @@ namespace proxsuite {
 namespace proxqp {
 namespace python {
 
-template<typename T>
-void
-exposeResults(pybind11::module_ m)
+inline void
+exposeSolverOutput(pybind11::module_ m)
 {
   ::pybind11::enum_<QPSolverOutput>(
     m, "QPSolverOutput", pybind11::module_local())
@@ -23,7 +22,18 @@ exposeResults(pybind11::module_ m)
     .value("PROXQP_DUAL_INFEASIBLE", QPSolverOutput::PROXQP_DUAL_INFEASIBLE)
     .export_values();
 
-  ::pybind11::class_<Info<T>>(m, "Info", pybind11::module_local())
+  ::pybind11::class_<StackUsage>(m, "StackUsage", pybind11::module_local())
+    .def(::pybind11::init(), "Default constructor.")
+    .def_readwrite("requested_bytes", &StackUsage::requested_bytes)
+    .def_readwrite("used_bytes", &StackUsage::used_bytes);
+}
+
+template<typename T>
+void
+exposeResults(pybind11::module_ m)
+{
+  ::pybind11::class_<Info<T>>(
+    m, scalar_name<T>("Info").c_str(), pybind11::module_local())
     .def(::pybind11::init(), "Default constructor.")
     .def_readwrite("mu_eq", &Info<T>::mu_eq)
     .def_readwrite("mu_in", &Info<T>::mu_in)
@@ -40,7 +50,8 @@ exposeResults(pybind11::module_ m)
     .def_readwrite("rho_updates", &Info<T>::rho_updates)
     .def_readwrite("mu_updates", &Info<T>::mu_updates);
 
-  ::pybind11::class_<Results<T>>(m, "Results", pybind11::module_local())
+  ::pybind11::class_<Results<T>>(
+    m, scalar_name<T>("Results").c_str(), pybind11::module_local())
     .def(::pybind11::init<i64, i64, i64>(),
          pybind11::arg_v("n", 0, "primal dimension."),
          pybind11::arg_v("n_eq", 0, "number of equality constraints."),
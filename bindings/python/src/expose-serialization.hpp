@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2022 INRIA
+//
+#include <proxsuite/proxqp/dense/serialization.hpp>
+#include <proxsuite/proxqp/sparse/serialization.hpp>
+#include <proxsuite/linalg/veg/internal/macros.hpp>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace proxsuite {
+namespace proxqp {
+namespace python {
+
+/*!
+ * Pointer to the contents of a Python object supporting the buffer protocol
+ * (bytes, bytearray, memoryview, shared memory segment, NumPy array...). It
+ * must be contiguous, and writable if requested.
+ */
+struct BufferView
+{
+  pybind11::buffer_info info;
+  unsigned char* data;
+  std::size_t size;
+
+  BufferView(pybind11::buffer buffer, bool writable)
+    : info(buffer.request(writable))
+    , data(static_cast<unsigned char*>(info.ptr))
+    , size(std::size_t(info.size) * std::size_t(info.itemsize))
+  {
+    pybind11::ssize_t stride = info.itemsize;
+    bool contiguous = true;
+    for (pybind11::ssize_t k = info.ndim; k-- > 0;) {
+      contiguous =
+        contiguous && (info.shape[k] <= 1 || info.strides[k] == stride);
+      stride *= info.shape[k];
+    }
+    PROXSUITE_THROW_PRETTY(!contiguous,
+                           std::invalid_argument,
+                           "the buffer of a serialized QP must be contiguous.");
+  }
+};
+
+/*!
+ * Serializes a QP object into a bytes object, see dense::serialize and
+ * sparse::serialize.
+ */
+template<typename QP>
+auto
+serialize_to_bytes(QP const& qp) -> pybind11::bytes
+{
+  std::size_t size = 0;
+  {
+    pybind11::gil_scoped_release release;
+    size = serialized_size(qp);
+  }
+  // the bytes object is filled before being shared with any Python code
+  pybind11::bytes bytes(nullptr, size);
+  auto data =
+    reinterpret_cast<unsigned char*>(PYBIND11_BYTES_AS_STRING(bytes.ptr()));
+  {
+    pybind11::gil_scoped_release release;
+    serialize(qp, data);
+  }
+  return bytes;
+}
+
+/*!
+ * Serializes a QP object into a writable buffer of at least
+ * serialized_size(qp) bytes. Returns the number of written bytes.
+ */
+template<typename QP>
+auto
+serialize_into_buffer(QP const& qp, pybind11::buffer buffer) -> std::size_t
+{
+  BufferView view(buffer, true);
+  pybind11::gil_scoped_release release;
+  std::size_t size = serialized_size(qp);
+  PROXSUITE_THROW_PRETTY(view.size < size,
+                         std::invalid_argument,
+                         "the buffer is too small to serialize the QP object.");
+  serialize(qp, view.data);
+  return size;
+}
+
+/*!
+ * Rebuilds a QP object from a buffer written by serialize_to_bytes or
+ * serialize_into_buffer, with the deserialize function of its backend.
+ */
+template<typename QP, QP (*load)(unsigned char const*, std::size_t)>
+auto
+deserialize_from_buffer(pybind11::buffer buffer) -> QP
+{
+  BufferView view(buffer, false);
+  pybind11::gil_scoped_release release;
+  return load(view.data, view.size);
+}
+
+/*!
+ * Serializes a QP object into a new multiprocessing.shared_memory.SharedMemory
+ * segment, which is returned. Its owner is responsible for closing and
+ * unlinking it.
+ */
+template<typename QP>
+auto
+serialize_to_shared_memory(QP const& qp, std::optional<std::string> name)
+  -> pybind11::object
+{
+  pybind11::object shared_memory_type =
+    pybind11::module_::import("multiprocessing.shared_memory")
+      .attr("SharedMemory");
+  std::size_t size = 0;
+  {
+    pybind11::gil_scoped_release release;
+    size = serialized_size(qp);
+  }
+  pybind11::object shm = shared_memory_type(pybind11::cast(name), true, size);
+  try {
+    serialize_into_buffer(qp, pybind11::buffer(shm.attr("buf")));
+  } catch (...) {
+    shm.attr("close")();
+    shm.attr("unlink")();
+    throw;
+  }
+  return shm;
+}
+
+/*!
+ * Rebuilds a QP object from a shared memory segment written by
+ * serialize_to_shared_memory, given either as a SharedMemory object or by its
+ * name. A segment attached by name is closed once the QP object is rebuilt.
+ */
+template<typename QP, QP (*load)(unsigned char const*, std::size_t)>
+auto
+deserialize_from_shared_memory(pybind11::object shm) -> QP
+{
+  if (pybind11::isinstance<pybind11::str>(shm)) {
+    pybind11::object attached =
+      pybind11::module_::import("multiprocessing.shared_memory")
+        .attr("SharedMemory")(shm);
+    try {
+      QP qp = deserialize_from_buffer<QP, load>(
+        pybind11::buffer(attached.attr("buf")));
+      attached.attr("close")();
+      return qp;
+    } catch (...) {
+      attached.attr("close")();
+      throw;
+    }
+  }
+  return deserialize_from_buffer<QP, load>(
+    pybind11::buffer(shm.attr("buf")));
+}
+
+/*!
+ * Pickling support of a QP object, with the same format as
+ * serialize_to_bytes.
+ */
+template<typename QP, QP (*load)(unsigned char const*, std::size_t)>
+auto
+pickle()
+{
+  return pybind11::pickle(&serialize_to_bytes<QP>,
+                          &deserialize_from_buffer<QP, load>);
+}
+
+} // namespace python
+} // namespace proxqp
+} // namespace proxsuite
@@ -6,14 +6,14 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/eigen.h>
 
+#include "helpers.hpp"
+
 namespace proxsuite {
 namespace proxqp {
 namespace python {
-template<typename T>
-void
-exposeSettings(pybind11::module_ m)
+inline void
+exposeSettingsEnums(pybind11::module_ m)
 {
-
   ::pybind11::enum_<InitialGuessStatus>(
     m, "InitialGuess", pybind11::module_local())
     .value("NO_INITIAL_GUESS", InitialGuessStatus::NO_INITIAL_GUESS)
@@ -26,7 +26,26 @@ exposeSettings(pybind11::module_ m)
            InitialGuessStatus::COLD_START_WITH_PREVIOUS_RESULT)
     .export_values();
 
-  ::pybind11::class_<Settings<T>>(m, "Settings", pybind11::module_local())
+  ::pybind11::enum_<MatrixFreePreconditioner>(
+    m, "MatrixFreePreconditioner", pybind11::module_local())
+    .value("IDENTITY", MatrixFreePreconditioner::IDENTITY)
+    .value("BLOCK_DIAGONAL", MatrixFreePreconditioner::BLOCK_DIAGONAL)
+    .value("INCOMPLETE_LDLT", MatrixFreePreconditioner::INCOMPLETE_LDLT)
+    .export_values();
+
+  ::pybind11::enum_<QPBackend>(m, "QPBackend", pybind11::module_local())
+    .value("AUTOMATIC", QPBackend::AUTOMATIC)
+    .value("DENSE", QPBackend::DENSE)
+    .value("SPARSE", QPBackend::SPARSE)
+    .export_values();
+}
+
+template<typename T>
+void
+exposeSettings(pybind11::module_ m)
+{
+  ::pybind11::class_<Settings<T>>(
+    m, scalar_name<T>("Settings").c_str(), pybind11::module_local())
     .def(::pybind11::init(), "Default constructor.") // constructor
     .def_readwrite("default_rho", &Settings<T>::default_rho)
     .def_readwrite("default_mu_eq", &Settings<T>::default_mu_eq)
@@ -60,7 +79,19 @@ exposeSettings(pybind11::module_ m)
                    &Settings<T>::compute_preconditioner)
     .def_readwrite("update_preconditioner", &Settings<T>::update_preconditioner)
     .def_readwrite("verbose", &Settings<T>::verbose)
-    .def_readwrite("bcl_update", &Settings<T>::bcl_update);
+    .def_readwrite("bcl_update", &Settings<T>::bcl_update)
+    .def_readwrite("sparse_ldlt_memory_budget",
+                   &Settings<T>::sparse_ldlt_memory_budget)
+    .def_readwrite("matrix_free_preconditioner",
+                   &Settings<T>::matrix_free_preconditioner)
+    .def_readwrite("sparse_store_unscaled_kkt",
+                   &Settings<T>::sparse_store_unscaled_kkt)
+    .def_readwrite("incremental_preconditioner",
+                   &Settings<T>::incremental_preconditioner)
+    .def_readwrite("sparse_ldlt_mmap_directory",
+                   &Settings<T>::sparse_ldlt_mmap_directory)
+    .def_readwrite("backend", &Settings<T>::backend)
+    .def_readwrite("dense_packed_ldlt", &Settings<T>::dense_packed_ldlt);
 }
 } // namespace python
 } // namespace proxqp
@@ -7,6 +7,8 @@
 #include <pybind11/eigen.h>
 #include <pybind11/stl.h>
 
+#include "helpers.hpp"
+
 namespace proxsuite {
 namespace proxqp {
 using proxsuite::linalg::veg::isize;
@@ -18,29 +20,32 @@ template<typename T>
 void
 solveDenseQp(pybind11::module_ m)
 {
+  using proxsuite::proxqp::python::solve_verbose_arg;
+  using proxsuite::proxqp::python::without_gil;
   m.def(
-    "solve",
-    pybind11::overload_cast<std::optional<dense::MatRef<T>>,
-                            std::optional<dense::VecRef<T>>,
-                            std::optional<dense::MatRef<T>>,
-                            std::optional<dense::VecRef<T>>,
-                            std::optional<dense::MatRef<T>>,
-                            std::optional<dense::VecRef<T>>,
-                            std::optional<dense::VecRef<T>>,
-                            std::optional<VecRef<T>>,
-                            std::optional<VecRef<T>>,
-                            std::optional<VecRef<T>>,
-                            std::optional<T>,
-                            std::optional<T>,
-                            std::optional<T>,
-                            std::optional<T>,
-                            std::optional<T>,
-                            std::optional<bool>,
-                            bool,
-                            bool,
-                            std::optional<isize>,
-                            proxsuite::proxqp::InitialGuessStatus>(
-      &dense::solve<T>),
+    proxsuite::proxqp::python::scalar_name<T>("solve").c_str(),
+    without_gil<solve_verbose_arg>(
+      pybind11::overload_cast<std::optional<dense::MatRef<T>>,
+                              std::optional<dense::VecRef<T>>,
+                              std::optional<dense::MatRef<T>>,
+                              std::optional<dense::VecRef<T>>,
+                              std::optional<dense::MatRef<T>>,
+                              std::optional<dense::VecRef<T>>,
+                              std::optional<dense::VecRef<T>>,
+                              std::optional<VecRef<T>>,
+                              std::optional<VecRef<T>>,
+                              std::optional<VecRef<T>>,
+                              std::optional<T>,
+                              std::optional<T>,
+                              std::optional<T>,
+                              std::optional<T>,
+                              std::optional<T>,
+                              std::optional<bool>,
+                              bool,
+                              bool,
+                              std::optional<isize>,
+                              proxsuite::proxqp::InitialGuessStatus>(
+        &dense::solve<T>)),
     "Function for solving a QP problem using PROXQP sparse backend directly "
     "without defining a QP object. It is possible to set up some of the solver "
     "parameters (warm start, initial guess option, proximal step sizes, "
@@ -85,28 +90,29 @@ solveDenseQp(pybind11::module_ m)
       proxsuite::proxqp::InitialGuessStatus::EQUALITY_CONSTRAINED_INITIAL_GUESS,
       "maximum number of iteration."));
   m.def(
-    "solve",
-    pybind11::overload_cast<std::optional<dense::SparseMat<T>>,
-                            std::optional<dense::VecRef<T>>,
-                            std::optional<dense::SparseMat<T>>,
-                            std::optional<dense::VecRef<T>>,
-                            std::optional<dense::SparseMat<T>>,
-                            std::optional<dense::VecRef<T>>,
-                            std::optional<dense::VecRef<T>>,
-                            std::optional<VecRef<T>>,
-                            std::optional<VecRef<T>>,
-                            std::optional<VecRef<T>>,
-                            std::optional<T>,
-                            std::optional<T>,
-                            std::optional<T>,
-                            std::optional<T>,
-                            std::optional<T>,
-                            std::optional<bool>,
-                            bool,
-                            bool,
-                            std::optional<isize>,
-                            proxsuite::proxqp::InitialGuessStatus>(
-      &dense::solve<T>),
+    proxsuite::proxqp::python::scalar_name<T>("solve").c_str(),
+    without_gil<solve_verbose_arg>(
+      pybind11::overload_cast<std::optional<dense::SparseMat<T>>,
+                              std::optional<dense::VecRef<T>>,
+                              std::optional<dense::SparseMat<T>>,
+                              std::optional<dense::VecRef<T>>,
+                              std::optional<dense::SparseMat<T>>,
+                              std::optional<dense::VecRef<T>>,
+                              std::optional<dense::VecRef<T>>,
+                              std::optional<VecRef<T>>,
+                              std::optional<VecRef<T>>,
+                              std::optional<VecRef<T>>,
+                              std::optional<T>,
+                              std::optional<T>,
+                              std::optional<T>,
+                              std::optional<T>,
+                              std::optional<T>,
+                              std::optional<bool>,
+                              bool,
+                              bool,
+                              std::optional<isize>,
+                              proxsuite::proxqp::InitialGuessStatus>(
+        &dense::solve<T>)),
     "Function for solving a QP problem using PROXQP dense backend directly "
     "without defining a QP object. It is possible to set up some of the solver "
     "parameters (warm start, initial guess option, proximal step sizes, "
@@ -158,19 +164,135 @@ solveDenseQp(pybind11::module_ m)
 namespace sparse {
 namespace python {
 
+/*!
+ * Narrows the index type of an optional sparse matrix.
+ */
+template<typename J, typename T, typename I>
+auto
+narrow_index(std::optional<SparseMat<T, I>> const& mat)
+  -> std::optional<SparseMat<T, J>>
+{
+  if (mat == std::nullopt) {
+    return std::nullopt;
+  }
+  return SparseMat<T, J>(mat.value());
+}
+
+/*!
+ * Sparsity structure of an optional sparse matrix, an empty matrix of the
+ * given dimensions being used when it is not provided.
+ */
 template<typename T, typename I>
+auto
+mask_of(std::optional<SparseMat<T, I>> const& mat, isize nrows, isize ncols)
+  -> SparseMat<bool, I>
+{
+  if (mat == std::nullopt) {
+    return SparseMat<bool, I>(nrows, ncols);
+  }
+  return mat.value().template cast<bool>();
+}
+
+/*!
+ * Solves the QP problem with the sparse backend, see sparse::solve. The index
+ * type of the solver is chosen from the sparsity structure of the problem: 32
+ * bit indices are used when they are large enough for the KKT matrix and its
+ * predicted LDLT factor, which saves memory and bandwidth, and 64 bit indices
+ * otherwise.
+ */
+template<typename T>
+proxqp::Results<T>
+solve_with_index_choice(
+  std::optional<SparseMat<T, i64>> H,
+  std::optional<VecRef<T>> g,
+  std::optional<SparseMat<T, i64>> A,
+  std::optional<VecRef<T>> b,
+  std::optional<SparseMat<T, i64>> C,
+  std::optional<VecRef<T>> u,
+  std::optional<VecRef<T>> l,
+  std::optional<VecRef<T>> x,
+  std::optional<VecRef<T>> y,
+  std::optional<VecRef<T>> z,
+  std::optional<T> eps_abs,
+  std::optional<T> eps_rel,
+  std::optional<T> rho,
+  std::optional<T> mu_eq,
+  std::optional<T> mu_in,
+  std::optional<bool> verbose,
+  bool compute_preconditioner,
+  bool compute_timings,
+  std::optional<isize> max_iter,
+  proxsuite::proxqp::InitialGuessStatus initial_guess)
+{
+  isize n = H != std::nullopt   ? H.value().rows()
+            : A != std::nullopt ? A.value().cols()
+            : C != std::nullopt ? C.value().cols()
+                                : 0;
+  isize n_eq = A != std::nullopt ? A.value().rows() : 0;
+  isize n_in = C != std::nullopt ? C.value().rows() : 0;
+
+  if (index_type_fits<int32_t>(
+        mask_of(H, n, n), mask_of(A, n_eq, n), mask_of(C, n_in, n))) {
+    return sparse::solve<T, int32_t>(narrow_index<int32_t>(H),
+                                     g,
+                                     narrow_index<int32_t>(A),
+                                     b,
+                                     narrow_index<int32_t>(C),
+                                     u,
+                                     l,
+                                     x,
+                                     y,
+                                     z,
+                                     eps_abs,
+                                     eps_rel,
+                                     rho,
+                                     mu_eq,
+                                     mu_in,
+                                     verbose,
+                                     compute_preconditioner,
+                                     compute_timings,
+                                     max_iter,
+                                     initial_guess);
+  }
+  return sparse::solve<T, i64>(H,
+                               g,
+                               A,
+                               b,
+                               C,
+                               u,
+                               l,
+                               x,
+                               y,
+                               z,
+                               eps_abs,
+                               eps_rel,
+                               rho,
+                               mu_eq,
+                               mu_in,
+                               verbose,
+                               compute_preconditioner,
+                               compute_timings,
+                               max_iter,
+                               initial_guess);
+}
+
+template<typename T>
 void
 solveSparseQp(pybind11::module_ m)
 {
+  using proxsuite::proxqp::python::solve_verbose_arg;
+  using proxsuite::proxqp::python::without_gil;
 
   m.def(
-    "solve",
-    &sparse::solve<T, I>,
-    "Function for solving a QP problem using PROXQP dense backend directly "
+    proxsuite::proxqp::python::scalar_name<T>("solve").c_str(),
+    without_gil<solve_verbose_arg>(&solve_with_index_choice<T>),
+    "Function for solving a QP problem using PROXQP sparse backend directly "
     "without defining a QP object. It is possible to set up some of the solver "
     "parameters (warm start, initial guess option, proximal step sizes, "
     "absolute and relative accuracies, maximum number of iterations, "
-    "preconditioner execution).",
+    "preconditioner execution). The solver uses 32 bit indices when they are "
+    "large enough for the predicted LDLT factor of the KKT matrix, and 64 bit "
+    "indices otherwise.",
     pybind11::arg_v("H", std::nullopt, "quadratic cost with dense format."),
     pybind11::arg_v("g", std::nullopt, "linear cost"),
     pybind11::arg_v(
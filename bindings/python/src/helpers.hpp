@@ -4,13 +4,168 @@
 #ifndef proxsuite_python_helpers_hpp
 #define proxsuite_python_helpers_hpp
 
+#include <proxsuite/linalg/veg/internal/macros.hpp>
+#include <pybind11/pybind11.h>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+// the getter returns a NumPy array aliasing the field, which keeps its owner
+// alive (reference_internal policy of def_property), rather than a copy. The
+// setter copies the values in place, so that the arrays returned before remain
+// valid
 #define PROXSUITE_PYTHON_EIGEN_READWRITE(class, field_name, doc)               \
   def_property(                                                                \
     #field_name,                                                               \
-    [](class& self) { return self.field_name; },                               \
+    [](class& self) -> decltype(class ::field_name)& {                         \
+      return self.field_name;                                                  \
+    },                                                                         \
     [](class& self, const decltype(class ::field_name)& value) {               \
+      PROXSUITE_THROW_PRETTY(value.size() != self.field_name.size(),           \
+                             std::invalid_argument,                            \
+                             "wrong argument size: " #field_name               \
+                             " should keep its size.");                        \
       self.field_name = value;                                                 \
     },                                                                         \
     doc)
 
+namespace proxsuite {
+namespace proxqp {
+namespace python {
+
+/*!
+ * Name of a class or function exposed for the scalar type T: the double
+ * precision ones keep their name, and the single precision ones get a
+ * _float32 suffix (e.g., QP and QP_float32).
+ *
+ * @param name name of the double precision class or function.
+ */
+template<typename T>
+auto
+scalar_name(const char* name) -> std::string
+{
+  if (std::is_same<T, float>::value) {
+    return std::string(name) + "_float32";
+  }
+  return name;
+}
+
+/*!
+ * Releases the GIL while a solver runs, so that several QP objects can be
+ * solved concurrently from python threads. The verbose output of the solvers
+ * is printed on std::cout, whose formatting state is shared: verbose calls
+ * are hence serialized, while the others run concurrently.
+ */
+class SolverGilRelease
+{
+public:
+  explicit SolverGilRelease(bool verbose)
+    : release_()
+    , print_lock_(verbose_mutex(), std::defer_lock)
+  {
+    // locked after releasing the GIL, so that a thread waiting for the lock
+    // does not block the others
+    if (verbose) {
+      print_lock_.lock();
+    }
+  }
+
+private:
+  static auto verbose_mutex() -> std::mutex&
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  pybind11::gil_scoped_release release_;
+  std::unique_lock<std::mutex> print_lock_;
+};
+
+/*!
+ * Wraps a solver method so that it runs without the GIL, see
+ * SolverGilRelease. The arguments are converted from python before the GIL is
+ * released.
+ */
+template<typename QP, typename R, typename... Args>
+auto
+without_gil(R (QP::*fn)(Args...))
+{
+  return [fn](QP& qp, Args... args) -> R {
+    SolverGilRelease guard(qp.settings.verbose);
+    return (qp.*fn)(std::forward<Args>(args)...);
+  };
+}
+
+/*!
+ * Wraps a solve function so that it runs without the GIL, see
+ * SolverGilRelease. Its verbose option is its argument of index verbose_arg,
+ * which must be a std::optional<bool>.
+ */
+template<std::size_t verbose_arg, typename R, typename... Args>
+auto
+without_gil(R (*fn)(Args...))
+{
+  static_assert(
+    std::is_same<std::decay_t<std::tuple_element_t<verbose_arg,
+                                                   std::tuple<Args...>>>,
+                 std::optional<bool>>::value,
+    "the verbose option of a solve function must be a std::optional<bool>.");
+  return [fn](Args... args) -> R {
+    bool verbose = std::get<verbose_arg>(std::forward_as_tuple(args...))
+                     .value_or(false);
+    SolverGilRelease guard(verbose);
+    return fn(std::forward<Args>(args)...);
+  };
+}
+
+/*!
+ * Getter of a field exposed by reference (def_property applies the
+ * reference_internal policy to it), so that the NumPy arrays returned by its
+ * members alias the buffers of the owner, which they keep alive.
+ *
+ * @param field exposed field.
+ */
+template<typename Class, typename Field>
+auto
+field_getter(Field Class::*field)
+{
+  return [field](Class& self) -> Field& { return self.*field; };
+}
+
+/*!
+ * Setter of a field exposed by reference, see field_getter. The value is
+ * assigned in place, and must have the same shape as the field, so that none
+ * of its buffers is reallocated and the NumPy arrays aliasing them remain
+ * valid.
+ *
+ * @param field exposed field.
+ * @param shape function returning the dimensions of a field value, as a
+ * comparable value.
+ * @param name name of the field in the error message.
+ */
+template<typename Class, typename Field, typename Shape>
+auto
+in_place_setter(Field Class::*field, Shape shape, const char* name)
+{
+  return [field, shape, name](Class& self, const Field& value) {
+    PROXSUITE_THROW_PRETTY(shape(value) != shape(self.*field),
+                           std::invalid_argument,
+                           "wrong argument size: " << name
+                                                   << " should keep its "
+                                                      "dimensions.");
+    self.*field = value;
+  };
+}
+
+/// index of the verbose option in the arguments of dense::solve and
+/// sparse::solve
+constexpr std::size_t solve_verbose_arg = 15;
+
+} // namespace python
+} // namespace proxqp
+} // namespace proxsuite
+
 #endif // ifndef proxsuite_python_helpers_hpp
@@ -0,0 +1,29 @@
+#include <proxsuite/linalg/dense/autotune.hpp> // measure the dense tuning
+#include <cstdlib>
+#include <iostream>
+
+using namespace proxsuite::linalg::dense;
+using T = double;
+
+// usage: autotune_dense_kernels [max dimension] [output file]
+// run it once per machine, e.g. at install time, with the output file given
+// by dense_tuning_cache_path() so that the processes calling
+// load_dense_tuning() use the measured tuning
+int
+main(int argc, char** argv)
+{
+  isize max_dim = argc > 1 ? isize(std::atoll(argv[1])) : 256;
+  DenseTuning tuning = autotune_dense_kernels<T>(max_dim);
+  std::cout << "factorize_block_size: " << tuning.factorize_block_size
+            << std::endl;
+  std::cout << "factorize_recursive_threshold: "
+            << tuning.factorize_recursive_threshold << std::endl;
+  std::cout << "factorize_blocked_min_dim: "
+            << tuning.factorize_blocked_min_dim << std::endl;
+  std::cout << "rank_r_update_chunk: " << tuning.rank_r_update_chunk
+            << std::endl;
+  if (argc > 2 && !save_dense_tuning(argv[2], tuning)) {
+    std::cerr << "could not write " << argv[2] << std::endl;
+    return 1;
+  }
+}
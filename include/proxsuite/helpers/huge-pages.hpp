@@ -0,0 +1,317 @@
+//
+// Copyright (c) 2022 INRIA
+//
+/**
+ * @file huge-pages.hpp
+ */
+
+#ifndef PROXSUITE_HELPERS_HUGE_PAGES_HPP
+#define PROXSUITE_HELPERS_HUGE_PAGES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace proxsuite {
+namespace helpers {
+
+// size of the huge pages used for the large buffers
+static constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+enum struct HugePages
+{
+  DISABLED,    // pages of the default size
+  TRANSPARENT, // transparent huge pages, requested with madvise
+  EXPLICIT,    // huge pages reserved by the system administrator, falling
+               // back to transparent huge pages when none is available
+};
+
+/*!
+ * Placement of the buffers of the solvers which span at least one huge page:
+ * the dense KKT matrix and scaled model, the storage of the dense LDLT factor
+ * and the values and row indices of the sparse LDLT factor. Huge pages reduce
+ * the TLB misses of the factorizations on large problems. Only available on
+ * Linux, the policy is ignored on other systems.
+ */
+struct LargeBufferPolicy
+{
+  HugePages huge_pages = HugePages::DISABLED;
+  // whether each page is placed on the NUMA node of the thread which first
+  // touches it, even if the process was started with another memory policy
+  // (e.g. numactl --interleave). only the buffers mapped by the library, i.e.
+  // the storage of the dense LDLT factor, are affected, since the memory
+  // policy of the others would outlive them in the heap
+  bool numa_first_touch = false;
+};
+
+namespace _detail {
+inline auto
+initial_large_buffer_policy() noexcept -> LargeBufferPolicy
+{
+  LargeBufferPolicy policy;
+  if (char const* huge_pages = std::getenv("PROXSUITE_HUGE_PAGES")) {
+    if (std::strcmp(huge_pages, "transparent") == 0) {
+      policy.huge_pages = HugePages::TRANSPARENT;
+    } else if (std::strcmp(huge_pages, "explicit") == 0) {
+      policy.huge_pages = HugePages::EXPLICIT;
+    }
+  }
+  if (char const* first_touch = std::getenv("PROXSUITE_NUMA_FIRST_TOUCH")) {
+    policy.numa_first_touch = std::strcmp(first_touch, "1") == 0;
+  }
+  return policy;
+}
+
+inline auto
+large_buffer_policy_mut() noexcept -> LargeBufferPolicy&
+{
+  static LargeBufferPolicy policy = _detail::initial_large_buffer_policy();
+  return policy;
+}
+
+// applies the policy to the huge pages fully contained in [begin, end), which
+// have not been touched yet
+inline void
+advise_huge_page_range(std::uintptr_t begin,
+                       std::uintptr_t end,
+                       LargeBufferPolicy policy) noexcept
+{
+  begin = (begin + huge_page_size - 1) / huge_page_size * huge_page_size;
+  end = end / huge_page_size * huge_page_size;
+  if (begin >= end) {
+    return;
+  }
+#ifdef MADV_HUGEPAGE
+  if (policy.huge_pages != HugePages::DISABLED) {
+    ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+  }
+#endif
+#if defined(__linux__) && defined(SYS_mbind)
+  if (policy.numa_first_touch) {
+    // MPOL_PREFERRED with an empty node mask: local allocation, on the node
+    // of the thread which triggers the page fault
+    long const mpol_preferred = 1;
+    ::syscall(SYS_mbind,
+              reinterpret_cast<void*>(begin),
+              (unsigned long)(end - begin),
+              mpol_preferred,
+              nullptr,
+              0ul,
+              0u);
+  }
+#endif
+  (void)policy;
+}
+
+#ifndef _WIN32
+// maps an anonymous buffer aligned on a huge page, without applying the
+// policy. the mapping is made one huge page larger, and trimmed so that it
+// starts on a huge page boundary
+inline auto
+map_aligned(std::size_t size) noexcept -> void*
+{
+  void* ptr = ::mmap(nullptr,
+                     size + huge_page_size,
+                     PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS,
+                     -1,
+                     0);
+  if (ptr == MAP_FAILED) {
+    return nullptr;
+  }
+  auto mapped = reinterpret_cast<std::uintptr_t>(ptr);
+  std::uintptr_t begin =
+    (mapped + huge_page_size - 1) / huge_page_size * huge_page_size;
+  if (begin != mapped) {
+    ::munmap(ptr, begin - mapped);
+  }
+  if (begin + size != mapped + size + huge_page_size) {
+    ::munmap(reinterpret_cast<void*>(begin + size),
+             mapped + huge_page_size - begin);
+  }
+  return reinterpret_cast<void*>(begin);
+}
+#endif
+} // namespace _detail
+
+/*!
+ * Returns the placement policy of the large buffers. Its initial value is read
+ * from the PROXSUITE_HUGE_PAGES ("transparent" or "explicit") and
+ * PROXSUITE_NUMA_FIRST_TOUCH ("1") environment variables.
+ */
+inline auto
+large_buffer_policy() noexcept -> LargeBufferPolicy
+{
+  return _detail::large_buffer_policy_mut();
+}
+
+/*!
+ * Overrides the placement policy of the large buffers. It applies to the
+ * buffers allocated after the call, i.e. to the solvers which are constructed
+ * or initialized with new dimensions afterwards.
+ *
+ * @param policy new policy
+ */
+inline void
+set_large_buffer_policy(LargeBufferPolicy policy) noexcept
+{
+  _detail::large_buffer_policy_mut() = policy;
+}
+
+/*!
+ * Returns whether the library maps its own buffers spanning at least one huge
+ * page, so that the placement policy applies to them: this is the case when
+ * huge pages or the NUMA first touch placement are requested. Otherwise, they
+ * are allocated on the heap like the others.
+ */
+inline auto
+maps_large_buffers() noexcept -> bool
+{
+#ifndef _WIN32
+  LargeBufferPolicy policy = large_buffer_policy();
+  return policy.huge_pages != HugePages::DISABLED || policy.numa_first_touch;
+#else
+  return false;
+#endif
+}
+
+/*!
+ * Applies the huge page policy to a buffer allocated by another allocator,
+ * before its memory is first touched. Only the huge pages fully contained in
+ * the buffer are affected, and explicit huge pages are replaced by transparent
+ * ones since the buffer is already mapped. The NUMA first touch placement is
+ * not applied, since the allocator may reuse the memory for other purposes
+ * afterwards.
+ *
+ * @param ptr beginning of the buffer
+ * @param size size of the buffer, in bytes
+ */
+inline void
+advise_large_buffer(void* ptr, std::size_t size) noexcept
+{
+#ifndef _WIN32
+  if (ptr == nullptr || size < huge_page_size) {
+    return;
+  }
+  auto begin = reinterpret_cast<std::uintptr_t>(ptr);
+  LargeBufferPolicy policy = large_buffer_policy();
+  policy.numa_first_touch = false;
+  _detail::advise_huge_page_range(begin, begin + size, policy);
+#else
+  (void)ptr;
+  (void)size;
+#endif
+}
+
+/*!
+ * Maps an anonymous buffer aligned on a huge page, following the placement
+ * policy. Returns nullptr if the memory can not be mapped. The buffer must be
+ * released with unmap_large_buffer.
+ *
+ * @param size size of the buffer, in bytes, which must be a multiple of
+ * huge_page_size
+ */
+inline auto
+map_large_buffer(std::size_t size) noexcept -> void*
+{
+#ifndef _WIN32
+  LargeBufferPolicy policy = large_buffer_policy();
+#ifdef MAP_HUGETLB
+  if (policy.huge_pages == HugePages::EXPLICIT) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_2MB
+    flags |= MAP_HUGE_2MB;
+#endif
+    void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (ptr != MAP_FAILED) {
+      auto begin = reinterpret_cast<std::uintptr_t>(ptr);
+      policy.huge_pages = HugePages::DISABLED;
+      _detail::advise_huge_page_range(begin, begin + size, policy);
+      return ptr;
+    }
+  }
+#endif
+  void* ptr = _detail::map_aligned(size);
+  if (ptr != nullptr) {
+    auto begin = reinterpret_cast<std::uintptr_t>(ptr);
+    _detail::advise_huge_page_range(begin, begin + size, policy);
+  }
+  return ptr;
+#else
+  (void)size;
+  return nullptr;
+#endif
+}
+
+/*!
+ * Resizes a buffer mapped by map_large_buffer without copying its contents,
+ * by remapping its pages, and returns its new beginning, still aligned on a
+ * huge page. The added pages keep the advice of the initial mapping. Returns
+ * nullptr if the buffer can not be remapped, in which case it is left
+ * unchanged. Only available on Linux, it always fails on other systems.
+ *
+ * @param ptr beginning of the buffer
+ * @param old_size size of the buffer, in bytes
+ * @param new_size new size of the buffer, in bytes, which must be a multiple
+ * of huge_page_size
+ */
+inline auto
+remap_large_buffer(void* ptr,
+                   std::size_t old_size,
+                   std::size_t new_size) noexcept -> void*
+{
+#if defined(__linux__) && defined(MREMAP_MAYMOVE) && defined(MREMAP_FIXED)
+  // in place if the following addresses are free
+  void* out = ::mremap(ptr, old_size, new_size, 0);
+  if (out != MAP_FAILED) {
+    return out;
+  }
+  // otherwise, the pages are moved to a new range aligned on a huge page
+  void* dest = _detail::map_aligned(new_size);
+  if (dest == nullptr) {
+    return nullptr;
+  }
+  out = ::mremap(ptr, old_size, new_size, MREMAP_MAYMOVE | MREMAP_FIXED, dest);
+  if (out == MAP_FAILED) {
+    ::munmap(dest, new_size);
+    return nullptr;
+  }
+  return out;
+#else
+  (void)ptr;
+  (void)old_size;
+  (void)new_size;
+  return nullptr;
+#endif
+}
+
+/*!
+ * Releases a buffer mapped by map_large_buffer.
+ *
+ * @param ptr beginning of the buffer
+ * @param size size of the buffer, in bytes
+ */
+inline void
+unmap_large_buffer(void* ptr, std::size_t size) noexcept
+{
+#ifndef _WIN32
+  ::munmap(ptr, size);
+#else
+  (void)ptr;
+  (void)size;
+#endif
+}
+
+} // namespace helpers
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_HELPERS_HUGE_PAGES_HPP */
@@ -11,6 +11,8 @@
 #include <vector>
 #include <bitset>
 #include <array>
+#include <cstring>
+#include <string>
 
 #ifndef _WIN32
 #include <cpuid.h>
@@ -41,6 +43,19 @@ cpuidex(std::array<int, 4>& cpui, int level, int count)
   __cpuidex(cpui.data(), level, count);
 #endif
 }
+
+// reads an extended control register, which requires OSXSAVE support
+inline unsigned long long
+xgetbv(unsigned int index)
+{
+#ifndef _WIN32
+  unsigned int eax, edx;
+  __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+  return (static_cast<unsigned long long>(edx) << 32) | eax;
+#else
+  return _xgetbv(index);
+#endif
+}
 }
 
 // Adapted from
@@ -67,6 +82,17 @@ struct InstructionSet
   static bool has_F16C(void) { return data.f_1_ECX_[29]; }
   static bool has_RDRAND(void) { return data.f_1_ECX_[30]; }
 
+  // whether the operating system saves the AVX (resp. AVX-512) registers on
+  // context switches, which is required for using these instructions
+  static bool has_OS_AVX(void)
+  {
+    return has_OSXSAVE() && (internal::xgetbv(0) & 0x6) == 0x6;
+  }
+  static bool has_OS_AVX512(void)
+  {
+    return has_OSXSAVE() && (internal::xgetbv(0) & 0xe6) == 0xe6;
+  }
+
   static bool has_MSR(void) { return data.f_1_EDX_[5]; }
   static bool has_CX8(void) { return data.f_1_EDX_[8]; }
   static bool has_SEP(void) { return data.f_1_EDX_[11]; }
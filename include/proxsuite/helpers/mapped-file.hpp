@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2022 INRIA
+//
+/**
+ * @file mapped-file.hpp
+ */
+
+#ifndef PROXSUITE_HELPERS_MAPPED_FILE_HPP
+#define PROXSUITE_HELPERS_MAPPED_FILE_HPP
+
+#include "proxsuite/linalg/veg/internal/macros.hpp"
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace proxsuite {
+namespace helpers {
+
+/*!
+ * Storage of a given size backed by a temporary file, which is mapped in
+ * memory so that the operating system pages it in and out on demand. The file
+ * is removed from its directory as soon as it is mapped: its disk space is
+ * released with the mapping, even if the process does not terminate normally.
+ * Only available on POSIX systems.
+ */
+class MappedFile
+{
+public:
+  /*!
+   * Creates and maps a temporary file.
+   * @param directory directory in which the file is created.
+   * @param size size of the file, in bytes.
+   */
+  MappedFile(std::string const& directory, std::size_t size)
+    : ptr_(nullptr)
+    , size_(size)
+  {
+#ifndef _WIN32
+    if (size_ == 0) {
+      return;
+    }
+    std::string path = directory + "/proxsuite-XXXXXX";
+    std::vector<char> path_buf(path.begin(), path.end());
+    path_buf.push_back('\0');
+
+    int fd = ::mkstemp(path_buf.data());
+    PROXSUITE_THROW_PRETTY(fd == -1,
+                           std::runtime_error,
+                           "could not create a temporary file in " +
+                             directory + ".");
+    ::unlink(path_buf.data());
+
+    bool truncated = ::ftruncate(fd, off_t(size_)) == 0;
+    void* ptr = truncated ? ::mmap(nullptr,
+                                   size_,
+                                   PROT_READ | PROT_WRITE,
+                                   MAP_SHARED,
+                                   fd,
+                                   0)
+                          : MAP_FAILED;
+    ::close(fd);
+    PROXSUITE_THROW_PRETTY(ptr == MAP_FAILED,
+                           std::runtime_error,
+                           "could not map a temporary file of " << size_
+                                                                << " bytes.");
+    ptr_ = ptr;
+#else
+    (void)directory;
+    PROXSUITE_THROW_PRETTY(size_ != 0,
+                           std::runtime_error,
+                           "memory mapped files are not supported on this "
+                           "platform.");
+#endif
+  }
+  MappedFile(MappedFile const&) = delete;
+  auto operator=(MappedFile const&) -> MappedFile& = delete;
+  ~MappedFile()
+  {
+#ifndef _WIN32
+    if (ptr_ != nullptr) {
+      ::munmap(ptr_, size_);
+    }
+#endif
+  }
+
+  /*!
+   * Returns a pointer to the mapped storage.
+   */
+  auto data() const -> void* { return ptr_; }
+  /*!
+   * Returns the size of the mapped storage, in bytes.
+   */
+  auto size() const -> std::size_t { return size_; }
+
+private:
+  void* ptr_;
+  std::size_t size_;
+};
+
+} // namespace helpers
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_HELPERS_MAPPED_FILE_HPP */
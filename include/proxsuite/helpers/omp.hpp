@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2022 INRIA
+//
+/**
+ * @file omp.hpp
+ */
+
+#ifndef PROXSUITE_HELPERS_OMP_HPP
+#define PROXSUITE_HELPERS_OMP_HPP
+
+#include <cstddef>
+#include <exception>
+
+#ifdef PROXSUITE_WITH_OPENMP
+#include <omp.h>
+#endif
+
+namespace proxsuite {
+namespace helpers {
+
+/*!
+ * Returns the maximal number of threads the parallel kernels of the library
+ * may use. Without OpenMP support, this is always one.
+ */
+inline int
+get_max_threads()
+{
+#ifdef PROXSUITE_WITH_OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+/*!
+ * Sets the maximal number of threads the parallel kernels of the library may
+ * use afterwards, from the calling thread. Without OpenMP support, this has no
+ * effect.
+ */
+inline void
+set_max_threads(int num_threads)
+{
+#ifdef PROXSUITE_WITH_OPENMP
+  omp_set_num_threads(num_threads);
+#else
+  (void)num_threads;
+#endif
+}
+
+/*!
+ * Returns the index of the calling thread inside the current parallel region.
+ * Without OpenMP support, this is always zero.
+ */
+inline int
+get_thread_num()
+{
+#ifdef PROXSUITE_WITH_OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+/*!
+ * Returns whether the caller is inside an active parallel region, in which case
+ * the parallel kernels of the library should run serially.
+ */
+inline bool
+in_parallel()
+{
+#ifdef PROXSUITE_WITH_OPENMP
+  return omp_in_parallel() != 0;
+#else
+  return false;
+#endif
+}
+
+/*!
+ * Returns the number of threads a parallel kernel processing `work` elements
+ * should use, so that each thread is given at least `min_work_per_thread` of
+ * them. Inside an active parallel region, this is always one.
+ */
+inline std::ptrdiff_t
+get_num_threads_for(std::ptrdiff_t work, std::ptrdiff_t min_work_per_thread)
+{
+  if (in_parallel()) {
+    return 1;
+  }
+  std::ptrdiff_t nthreads = work / min_work_per_thread;
+  std::ptrdiff_t max_threads = std::ptrdiff_t(get_max_threads());
+  return nthreads < 1 ? 1 : (nthreads > max_threads ? max_threads : nthreads);
+}
+
+/*!
+ * Calls fn(i) for each i in [0, n), distributing the calls over at most
+ * `num_threads` threads, or all the available ones when it is not positive.
+ * Without OpenMP support, the calls are serial. An exception thrown by one of
+ * the calls does not interrupt the others: the one of the lowest index is
+ * rethrown once they are all done.
+ */
+template<typename Fn>
+void
+parallel_for(std::ptrdiff_t n, std::ptrdiff_t num_threads, Fn&& fn)
+{
+  std::ptrdiff_t max_threads = std::ptrdiff_t(get_max_threads());
+  if (num_threads <= 0 || num_threads > max_threads) {
+    num_threads = max_threads;
+  }
+  if (num_threads > n) {
+    num_threads = n < 1 ? 1 : n;
+  }
+  std::exception_ptr error = nullptr;
+  std::ptrdiff_t error_index = n;
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp parallel for num_threads(int(num_threads)) schedule(dynamic)
+#endif
+  for (std::ptrdiff_t i = 0; i < n; ++i) {
+    try {
+      fn(i);
+    } catch (...) {
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp critical(proxsuite_parallel_for)
+#endif
+      if (i < error_index) {
+        error = std::current_exception();
+        error_index = i;
+      }
+    }
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace helpers
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_HELPERS_OMP_HPP */
@@ -0,0 +1,191 @@
+/** \file */
+//
+// Copyright (c) 2022 INRIA
+//
+#ifndef PROXSUITE_LINALG_DENSE_LDLT_AUTOTUNE_HPP
+#define PROXSUITE_LINALG_DENSE_LDLT_AUTOTUNE_HPP
+
+#include "proxsuite/linalg/dense/factorize.hpp"
+#include "proxsuite/linalg/dense/update.hpp"
+#include "proxsuite/linalg/dense/tuning.hpp"
+#include <proxsuite/linalg/veg/vec.hpp>
+#include <chrono>
+
+namespace proxsuite {
+namespace linalg {
+namespace dense {
+namespace _detail {
+
+// smallest running time of a few runs of fn, in seconds. setup is called
+// before each run, outside of the timed region
+template<typename Setup, typename Fn>
+auto
+best_time(Setup setup, Fn fn) -> double
+{
+  double best = 0;
+  for (isize run = 0; run < 3; ++run) {
+    setup();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto stop = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(stop - start).count();
+    if (run == 0 || elapsed < best) {
+      best = elapsed;
+    }
+  }
+  return best;
+}
+
+template<typename T>
+auto
+autotune_matrix(isize n) -> Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>
+{
+  using ColMat = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+  ColMat b = ColMat::Random(n, n);
+  ColMat a = b * b.transpose();
+  a.diagonal().array() += T(n);
+  return a;
+}
+} // namespace _detail
+
+/*!
+ * Measures the block sizes and algorithm variants of the dense factorization
+ * and rank updates which are the fastest on this machine, by timing them on
+ * random matrices of dimension up to max_dim. This takes from a fraction of
+ * a second to a few seconds, depending on max_dim. The candidates are passed
+ * explicitly to the benchmarked kernels, so that the tuning in use is neither
+ * modified nor read by them, and solvers may run concurrently: the result can
+ * be passed to set_dense_tuning, or saved with save_dense_tuning to the file
+ * returned by dense_tuning_cache_path so that the next processes can use it
+ * with load_dense_tuning.
+ *
+ * @param max_dim largest dimension of the benchmarked matrices
+ */
+template<typename T>
+auto
+autotune_dense_kernels(isize max_dim = 2048) -> DenseTuning
+{
+  using ColMat = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+  using proxsuite::linalg::veg::dynstack::DynStackMut;
+
+  constexpr isize block_sizes[] = { 32, 64, 128, 256 };
+  DenseTuning tuning = proxsuite::linalg::dense::dense_tuning();
+  max_dim = _detail::max2(max_dim, isize(64));
+  proxsuite::linalg::veg::Tag<T> tag;
+
+  proxsuite::linalg::veg::dynstack::StackReq req =
+    proxsuite::linalg::dense::factorize_recursive_req(tag, max_dim);
+  for (isize block_size : block_sizes) {
+    req = req | proxsuite::linalg::dense::factorize_blocked_req(
+                  tag, max_dim, _detail::min2(max_dim, block_size));
+  }
+  proxsuite::linalg::veg::Vec<unsigned char> stack_storage;
+  stack_storage.resize_for_overwrite(req.alloc_req());
+  DynStackMut stack{ proxsuite::linalg::veg::from_slice_mut,
+                     stack_storage.as_mut() };
+
+  // recursion threshold, on a matrix fitting in the last level caches
+  {
+    isize n = _detail::min2(max_dim, isize(384));
+    ColMat a = _detail::autotune_matrix<T>(n);
+    ColMat ld(n, n);
+    double best = -1;
+    for (isize threshold : { 8, 16, 32, 64, 128 }) {
+      double time = _detail::best_time(
+        [&] { ld = a; },
+        [&] {
+          _detail::factorize_recursive_impl(
+            util::to_view_dyn(ld), threshold, stack);
+        });
+      if (best < 0 || time < best) {
+        best = time;
+        tuning.factorize_recursive_threshold = threshold;
+      }
+    }
+  }
+
+  // block size, on the largest matrix
+  {
+    isize n = max_dim;
+    ColMat a = _detail::autotune_matrix<T>(n);
+    ColMat ld(n, n);
+    double best = -1;
+    for (isize block_size : block_sizes) {
+      double time = _detail::best_time(
+        [&] { ld = a; },
+        [&] {
+          _detail::factorize_blocked_impl(
+            util::to_view_dyn(ld), block_size, stack);
+        });
+      if (best < 0 || time < best) {
+        best = time;
+        tuning.factorize_block_size = block_size;
+      }
+    }
+  }
+
+  // dimension from which the blocked factorization beats the recursive one.
+  // when it never does, it is only used above the largest tested dimension
+  tuning.factorize_blocked_min_dim = max_dim;
+  for (isize n = 128; n <= max_dim; n *= 2) {
+    ColMat a = _detail::autotune_matrix<T>(n);
+    ColMat ld(n, n);
+    double blocked = _detail::best_time(
+      [&] { ld = a; },
+      [&] {
+        _detail::factorize_blocked_impl(
+          util::to_view_dyn(ld), tuning.factorize_block_size, stack);
+      });
+    double recursive = _detail::best_time(
+      [&] { ld = a; },
+      [&] {
+        _detail::factorize_recursive_impl(
+          util::to_view_dyn(ld), tuning.factorize_recursive_threshold, stack);
+      });
+    if (blocked < recursive) {
+      tuning.factorize_blocked_min_dim = n / 2;
+      break;
+    }
+  }
+
+  // number of rank one updates per sweep, for a rank 4 update
+  {
+    isize n = _detail::min2(max_dim, isize(1024));
+    isize r = 4;
+    ColMat a = _detail::autotune_matrix<T>(n);
+    proxsuite::linalg::dense::factorize(a, stack);
+    ColMat w0 = ColMat::Random(n, r);
+    ColMat ld(n, n);
+    ColMat w(n, r);
+    Eigen::Matrix<T, Eigen::Dynamic, 1> alpha(r);
+    double best = -1;
+    for (isize chunk = 1; chunk <= r; ++chunk) {
+      double time = _detail::best_time(
+        [&] {
+          ld = a;
+          w = w0;
+          alpha.setOnes();
+        },
+        [&] {
+          _detail::rank_r_update_clobber_w_chunked_impl(util::to_view_dyn(ld),
+                                                        w.data(),
+                                                        w.outerStride(),
+                                                        alpha.data(),
+                                                        _detail::ConstantR{ r },
+                                                        chunk);
+        });
+      if (best < 0 || time < best) {
+        best = time;
+        tuning.rank_r_update_chunk = chunk;
+      }
+    }
+  }
+
+  return tuning;
+}
+
+} // namespace dense
+} // namespace linalg
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_LINALG_DENSE_LDLT_AUTOTUNE_HPP */
@@ -0,0 +1,356 @@
+/** \file */
+//
+// Copyright (c) 2022 INRIA
+//
+#ifndef PROXSUITE_LINALG_DENSE_LDLT_DISPATCH_HPP
+#define PROXSUITE_LINALG_DENSE_LDLT_DISPATCH_HPP
+
+#include "proxsuite/linalg/dense/core.hpp"
+#include <cstring>
+
+// the dense kernels are compiled for several instruction sets, one of which is
+// selected at runtime, unless PROXSUITE_DONT_DISPATCH_SIMD is defined. this
+// relies on the target attribute and on vector extensions of gcc and clang
+#if !defined(PROXSUITE_DONT_DISPATCH_SIMD) &&                                  \
+  (defined(__GNUC__) || defined(__clang__)) &&                                 \
+  (defined(__x86_64__) || defined(__i386__))
+#define PROXSUITE_DISPATCH_SIMD
+#include <proxsuite/helpers/instruction-set.hpp>
+#define PROXSUITE_TARGET_SSE2 __attribute__((target("sse2")))
+#define PROXSUITE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define PROXSUITE_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+namespace proxsuite {
+namespace linalg {
+namespace dense {
+
+/// instruction sets the dense kernels can be dispatched to
+enum struct SimdLevel
+{
+  SCALAR, // no vectorization
+  SSE2,   // 128 bit vectors
+  AVX2,   // 256 bit vectors, with fused multiply-add
+  AVX512  // 512 bit vectors, with fused multiply-add
+};
+
+namespace _detail {
+inline auto
+detected_simd_level() noexcept -> SimdLevel
+{
+#ifdef PROXSUITE_DISPATCH_SIMD
+  using proxsuite::helpers::InstructionSet;
+  if (InstructionSet::has_AVX512F() && InstructionSet::has_OS_AVX512()) {
+    return SimdLevel::AVX512;
+  }
+  if (InstructionSet::has_AVX2() && InstructionSet::has_FMA() &&
+      InstructionSet::has_OS_AVX()) {
+    return SimdLevel::AVX2;
+  }
+  if (InstructionSet::has_SSE2()) {
+    return SimdLevel::SSE2;
+  }
+#endif
+  return SimdLevel::SCALAR;
+}
+
+inline auto
+simd_level_mut() noexcept -> SimdLevel&
+{
+  static SimdLevel level = _detail::detected_simd_level();
+  return level;
+}
+} // namespace _detail
+
+/*!
+ * Returns the instruction set the dense kernels (factorization, rank updates
+ * and solves) are dispatched to. It is the widest one supported by the
+ * processor and the operating system, unless it was restricted with
+ * set_simd_level. Without runtime dispatch (non x86 targets or
+ * PROXSUITE_DONT_DISPATCH_SIMD), this is SCALAR and the kernels are vectorized
+ * according to the compilation flags instead.
+ */
+inline auto
+simd_level() noexcept -> SimdLevel
+{
+  return _detail::simd_level_mut();
+}
+
+/*!
+ * Restricts the instruction set the dense kernels are dispatched to. A level
+ * which is not supported by the machine is replaced by the widest supported
+ * one. This must not be called while a dense kernel is running.
+ *
+ * @param level widest instruction set to use
+ */
+inline void
+set_simd_level(SimdLevel level) noexcept
+{
+  SimdLevel detected = _detail::detected_simd_level();
+  _detail::simd_level_mut() = level < detected ? level : detected;
+}
+
+namespace _detail {
+namespace _simd {
+#ifdef PROXSUITE_DISPATCH_SIMD
+// vector of N scalars, whose instructions are chosen by the target of the
+// function it is inlined in. the arguments are taken by reference, since the
+// abi for passing wide vectors by value depends on the target
+template<typename T, usize N>
+struct VecPack
+{
+  using ScalarType = T;
+  typedef T Inner __attribute__((vector_size(N * sizeof(T))));
+
+  Inner inner;
+
+  VEG_INLINE static auto fmadd(VecPack const& a,
+                               VecPack const& b,
+                               VecPack const& c) noexcept -> VecPack
+  {
+    DENSE_LDLT_FP_PRAGMA
+    return { a.inner * b.inner + c.inner };
+  }
+  VEG_INLINE static auto fnmadd(VecPack const& a,
+                                VecPack const& b,
+                                VecPack const& c) noexcept -> VecPack
+  {
+    DENSE_LDLT_FP_PRAGMA
+    return { c.inner - a.inner * b.inner };
+  }
+  VEG_INLINE static auto load_unaligned(ScalarType const* ptr) noexcept
+    -> VecPack
+  {
+    VecPack pack;
+    std::memcpy(&pack.inner, ptr, sizeof(Inner));
+    return pack;
+  }
+  VEG_INLINE static auto broadcast(ScalarType value) noexcept -> VecPack
+  {
+    return { Inner{} + value };
+  }
+  VEG_INLINE void store_unaligned(ScalarType* ptr) const noexcept
+  {
+    std::memcpy(ptr, &inner, sizeof(Inner));
+  }
+};
+#endif
+
+template<typename P>
+struct PackSize
+{
+  static constexpr usize value = sizeof(P) / sizeof(typename P::ScalarType);
+};
+
+template<typename T>
+VEG_INLINE auto
+sum(Pack<T, 1> pack) noexcept -> T
+{
+  return pack.inner;
+}
+template<typename P>
+VEG_INLINE auto
+sum(P const& pack) noexcept -> typename P::ScalarType
+{
+  using T = typename P::ScalarType;
+  T buf[PackSize<P>::value];
+  pack.store_unaligned(buf);
+  T acc = 0;
+  for (usize i = 0; i < PackSize<P>::value; ++i) {
+    acc += buf[i];
+  }
+  return acc;
+}
+} // namespace _simd
+
+#ifdef PROXSUITE_DISPATCH_SIMD
+template<typename T>
+using should_dispatch =
+  proxsuite::linalg::veg::meta::bool_constant<VEG_CONCEPT(same<T, f32>) ||
+                                              VEG_CONCEPT(same<T, f64>)>;
+
+template<typename Kernel, typename T, typename... Args>
+PROXSUITE_TARGET_SSE2 VEG_NO_INLINE auto
+dispatch_sse2(Args... args)
+  -> decltype(Kernel::template fn<_simd::Pack<T, 1>>(args...))
+{
+  return Kernel::template fn<_simd::VecPack<T, 16 / sizeof(T)>>(args...);
+}
+template<typename Kernel, typename T, typename... Args>
+PROXSUITE_TARGET_AVX2 VEG_NO_INLINE auto
+dispatch_avx2(Args... args)
+  -> decltype(Kernel::template fn<_simd::Pack<T, 1>>(args...))
+{
+  return Kernel::template fn<_simd::VecPack<T, 32 / sizeof(T)>>(args...);
+}
+template<typename Kernel, typename T, typename... Args>
+PROXSUITE_TARGET_AVX512 VEG_NO_INLINE auto
+dispatch_avx512(Args... args)
+  -> decltype(Kernel::template fn<_simd::Pack<T, 1>>(args...))
+{
+  return Kernel::template fn<_simd::VecPack<T, 64 / sizeof(T)>>(args...);
+}
+
+template<bool DISPATCH>
+struct DispatchImpl;
+
+template<>
+struct DispatchImpl<true>
+{
+  template<typename Kernel, typename T, typename... Args>
+  VEG_INLINE static auto fn(Args... args)
+    -> decltype(Kernel::template fn<_simd::Pack<T, 1>>(args...))
+  {
+    switch (proxsuite::linalg::dense::simd_level()) {
+      case SimdLevel::AVX512:
+        return _detail::dispatch_avx512<Kernel, T>(args...);
+      case SimdLevel::AVX2:
+        return _detail::dispatch_avx2<Kernel, T>(args...);
+      case SimdLevel::SSE2:
+        return _detail::dispatch_sse2<Kernel, T>(args...);
+      default:
+        return Kernel::template fn<_simd::Pack<T, 1>>(args...);
+    }
+  }
+};
+template<>
+struct DispatchImpl<false>
+{
+  template<typename Kernel, typename T, typename... Args>
+  VEG_INLINE static auto fn(Args... args)
+    -> decltype(Kernel::template fn<_simd::Pack<T, 1>>(args...))
+  {
+    return Kernel::template fn<_simd::Pack<T, 1>>(args...);
+  }
+};
+#else
+template<typename T>
+using should_dispatch = should_vectorize<T>;
+
+template<bool VECTORIZE>
+struct DispatchImpl;
+
+template<>
+struct DispatchImpl<true>
+{
+  template<typename Kernel, typename T, typename... Args>
+  VEG_INLINE static auto fn(Args... args)
+    -> decltype(Kernel::template fn<_simd::Pack<T, 1>>(args...))
+  {
+    return Kernel::template fn<_simd::NativePack<T>>(args...);
+  }
+};
+template<>
+struct DispatchImpl<false>
+{
+  template<typename Kernel, typename T, typename... Args>
+  VEG_INLINE static auto fn(Args... args)
+    -> decltype(Kernel::template fn<_simd::Pack<T, 1>>(args...))
+  {
+    return Kernel::template fn<_simd::Pack<T, 1>>(args...);
+  }
+};
+#endif
+
+/*!
+ * Calls `Kernel::fn<Pack>(args...)`, with the widest vector type `Pack` of
+ * scalars `T` supported by the instruction set returned by simd_level.
+ */
+template<typename Kernel, typename T, typename... Args>
+VEG_INLINE auto
+dispatch(Args... args)
+  -> decltype(Kernel::template fn<_simd::Pack<T, 1>>(args...))
+{
+  return DispatchImpl<should_dispatch<T>::value>::template fn<Kernel, T>(
+    args...);
+}
+
+struct AxpyKernel
+{
+  // y -= alpha * x
+  template<typename Pack, typename T>
+  VEG_INLINE static void fn(isize n, T alpha, T const* x, T* y) noexcept
+  {
+    constexpr usize N = _simd::PackSize<Pack>::value;
+    isize n_vectorized = isize(usize(n) / N * N);
+    Pack p_alpha = Pack::broadcast(alpha);
+    for (isize i = 0; i < n_vectorized; i += isize(N)) {
+      Pack yi = Pack::load_unaligned(y + i);
+      yi = Pack::fnmadd(p_alpha, Pack::load_unaligned(x + i), yi);
+      yi.store_unaligned(y + i);
+    }
+    for (isize i = n_vectorized; i < n; ++i) {
+      y[i] -= alpha * x[i];
+    }
+  }
+};
+
+struct DotKernel
+{
+  // returns x^T y
+  template<typename Pack, typename T>
+  VEG_INLINE static auto fn(isize n, T const* x, T const* y) noexcept -> T
+  {
+    constexpr usize N = _simd::PackSize<Pack>::value;
+    isize n_vectorized = isize(usize(n) / N * N);
+    Pack acc = Pack::broadcast(T(0));
+    for (isize i = 0; i < n_vectorized; i += isize(N)) {
+      acc = Pack::fmadd(
+        Pack::load_unaligned(x + i), Pack::load_unaligned(y + i), acc);
+    }
+    T res = _simd::sum(acc);
+    for (isize i = n_vectorized; i < n; ++i) {
+      res += x[i] * y[i];
+    }
+    return res;
+  }
+};
+
+struct GemvSubKernel
+{
+  // y -= A x, where A is a column major m×k matrix with the given outer stride
+  template<typename Pack, typename T>
+  VEG_INLINE static void fn(isize m,
+                            isize k,
+                            T const* a,
+                            isize a_stride,
+                            T const* x,
+                            T* y) noexcept
+  {
+    constexpr usize N = _simd::PackSize<Pack>::value;
+    isize m_vectorized = isize(usize(m) / N * N);
+    isize j = 0;
+    // four columns at a time, so that y is loaded and stored once for each
+    for (; j + 4 <= k; j += 4) {
+      T const* a0 = a + j * a_stride;
+      T const* a1 = a0 + a_stride;
+      T const* a2 = a1 + a_stride;
+      T const* a3 = a2 + a_stride;
+      Pack x0 = Pack::broadcast(x[j]);
+      Pack x1 = Pack::broadcast(x[j + 1]);
+      Pack x2 = Pack::broadcast(x[j + 2]);
+      Pack x3 = Pack::broadcast(x[j + 3]);
+      for (isize i = 0; i < m_vectorized; i += isize(N)) {
+        Pack yi = Pack::load_unaligned(y + i);
+        yi = Pack::fnmadd(x0, Pack::load_unaligned(a0 + i), yi);
+        yi = Pack::fnmadd(x1, Pack::load_unaligned(a1 + i), yi);
+        yi = Pack::fnmadd(x2, Pack::load_unaligned(a2 + i), yi);
+        yi = Pack::fnmadd(x3, Pack::load_unaligned(a3 + i), yi);
+        yi.store_unaligned(y + i);
+      }
+      for (isize i = m_vectorized; i < m; ++i) {
+        y[i] -= x[j] * a0[i] + x[j + 1] * a1[i] + x[j + 2] * a2[i] +
+                x[j + 3] * a3[i];
+      }
+    }
+    for (; j < k; ++j) {
+      AxpyKernel::fn<Pack>(m, x[j], a + j * a_stride, y);
+    }
+  }
+};
+} // namespace _detail
+} // namespace dense
+} // namespace linalg
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_LINALG_DENSE_LDLT_DISPATCH_HPP */
@@ -6,6 +6,8 @@
 #define PROXSUITE_LINALG_DENSE_LDLT_FACTORIZE_HPP
 
 #include "proxsuite/linalg/dense/core.hpp"
+#include "proxsuite/linalg/dense/dispatch.hpp"
+#include "proxsuite/linalg/dense/tuning.hpp"
 #include <algorithm>
 #include <proxsuite/linalg/veg/memory/dynamic_stack.hpp>
 
@@ -59,31 +61,88 @@ compute_permutation(isize* perm_indices,
     diagonal.innerStride());
 }
 
-template<typename Mat, typename Work>
+// swaps the rows and columns a and b of the symmetric matrix whose lower
+// triangular part is stored in mat, with a < b
+template<typename Mat>
 void
-apply_permutation_tri_lower(Mat&& mat, Work&& work, isize const* perm_indices)
+symmetric_swap_tri_lower(Mat mat, isize a, isize b)
 {
-  using T = typename proxsuite::linalg::veg::uncvref_t<Mat>::Scalar;
+  using std::swap;
+  isize n = mat.rows();
+  for (isize k = 0; k < a; ++k) {
+    swap(mat(a, k), mat(b, k));
+  }
+  swap(mat(a, a), mat(b, b));
+  for (isize k = a + 1; k < b; ++k) {
+    swap(mat(k, a), mat(b, k));
+  }
+  for (isize k = b + 1; k < n; ++k) {
+    swap(mat(k, a), mat(k, b));
+  }
+}
+
+template<typename Mat>
+void
+apply_permutation_tri_lower_impl(
+  Mat mat,
+  isize const* perm_indices,
+  proxsuite::linalg::veg::dynstack::DynStackMut stack)
+{
+  // the permutation is applied as a sequence of at most n - 1 symmetric
+  // swaps, each of which costs O(n), so that only O(n) workspace is needed
 
   isize n = mat.rows();
-  VEG_ASSERT_ALL_OF( //
-    n == mat.rows(),
-    n == mat.cols(),
-    n == work.rows(),
-    n == work.cols());
-
-  auto mat_coeff = [&](isize i, isize j) noexcept -> T& {
-    return i >= j ? mat(i, j) : mat(j, i);
-  };
+  auto _pos = stack.make_new_for_overwrite(
+    proxsuite::linalg::veg::Tag<isize>{}, n);
+  auto _who = stack.make_new_for_overwrite(
+    proxsuite::linalg::veg::Tag<isize>{}, n);
+  // pos[i]: current position of the row and column i of the input
+  // who[k]: row and column of the input currently at position k
+  isize* pos = _pos.ptr_mut();
+  isize* who = _who.ptr_mut();
+
+  for (isize k = 0; k < n; ++k) {
+    pos[k] = k;
+    who[k] = k;
+  }
 
-  for (isize j = 0; j < n; ++j) {
-    for (isize i = j; i < n; ++i) {
-      work(i, j) = mat_coeff(perm_indices[i], perm_indices[j]);
+  for (isize k = 0; k < n; ++k) {
+    isize src = pos[perm_indices[k]];
+    if (src == k) {
+      continue;
     }
+    // positions before k are final, so src > k
+    _detail::symmetric_swap_tri_lower(mat, k, src);
+
+    isize displaced = who[k];
+    who[src] = displaced;
+    pos[displaced] = src;
+    who[k] = perm_indices[k];
+    pos[perm_indices[k]] = k;
   }
+}
+
+// replaces the lower triangular part of mat by the one of P^T mat P, where P
+// is the permutation matrix defined by perm_indices
+template<typename Mat>
+void
+apply_permutation_tri_lower(Mat&& mat,
+                            isize const* perm_indices,
+                            proxsuite::linalg::veg::dynstack::DynStackMut stack)
+{
+  VEG_ASSERT(mat.rows() == mat.cols());
+  _detail::apply_permutation_tri_lower_impl(
+    util::to_view_dyn(mat), perm_indices, stack);
+}
 
-  mat.template triangularView<Eigen::Lower>() =
-    work.template triangularView<Eigen::Lower>();
+inline auto
+apply_permutation_tri_lower_req(isize n) noexcept
+  -> proxsuite::linalg::veg::dynstack::StackReq
+{
+  return proxsuite::linalg::veg::dynstack::StackReq{
+    2 * n * isize{ sizeof(isize) },
+    alignof(isize),
+  };
 }
 
 template<typename Mat>
@@ -141,7 +200,13 @@ factorize_unblocked_impl(Mat mat,
     auto l20 = util::submatrix(mat, j + 1, 0, rem, j);
     auto l21 = util::subrows(util::col(mat, j), j + 1, rem);
 
-    util::noalias_mul_add(l21, l20, work, T(-1));
+    if (!Mat::IsRowMajor && l20.innerStride() == 1 &&
+        l21.innerStride() == 1) {
+      _detail::dispatch<_detail::GemvSubKernel, T>(
+        rem, j, l20.data(), l20.outerStride(), work.data(), l21.data());
+    } else {
+      util::noalias_mul_add(l21, l20, work, T(-1));
+    }
     l21 *= 1 / mat(j, j);
     ++j;
   }
@@ -209,12 +274,10 @@ factorize_blocked_impl(Mat mat,
   }
 }
 
-using factorize_recursive_threshold =
-  proxsuite::linalg::veg::meta::constant<isize, 32>;
-
 template<typename Mat>
 void
 factorize_recursive_impl(Mat mat,
+                         isize threshold,
                          proxsuite::linalg::veg::dynstack::DynStackMut stack)
 {
   // right looking recursive cholesky
@@ -224,7 +287,7 @@ factorize_recursive_impl(Mat mat,
 
   isize n = mat.rows();
 
-  if (n < factorize_recursive_threshold::value) {
+  if (n < threshold) {
     _detail::factorize_unblocked_impl(mat, stack);
   } else {
     /*
@@ -246,7 +309,7 @@ factorize_recursive_impl(Mat mat,
     auto l10 = util::submatrix(mat, bs, 0, rem, bs);
     auto l11 = util::submatrix(mat, bs, bs, rem, rem);
 
-    _detail::factorize_recursive_impl(l00, stack);
+    _detail::factorize_recursive_impl(l00, threshold, stack);
     auto d0 = util::diagonal(l00);
 
     isize work_stride = _detail::adjusted_stride<T>(rem);
@@ -275,7 +338,7 @@ factorize_recursive_impl(Mat mat,
       l11.template triangularView<Eigen::Lower>() -= l10 * util::trans(work);
     }
 
-    _detail::factorize_recursive_impl(l11, stack);
+    _detail::factorize_recursive_impl(l11, threshold, stack);
   }
 }
 } // namespace _detail
@@ -312,9 +375,10 @@ auto
 factorize_recursive_req(proxsuite::linalg::veg::Tag<T> tag, isize n) noexcept
   -> proxsuite::linalg::veg::dynstack::StackReq
 {
+  // valid for any recursion threshold, see set_dense_tuning
   auto req0 = proxsuite::linalg::dense::factorize_unblocked_req(
-    tag, _detail::min2(n, _detail::factorize_recursive_threshold::value));
-  if (n < _detail::factorize_recursive_threshold::value) {
+    tag, _detail::min2(n, _detail::max_factorize_recursive_threshold::value));
+  if (n < 2) {
     return req0;
   }
   isize bs = (n + 1) / 2;
@@ -345,7 +409,10 @@ void
 factorize_recursive(Mat&& mat,
                     proxsuite::linalg::veg::dynstack::DynStackMut stack)
 {
-  _detail::factorize_recursive_impl(util::to_view_dyn(mat), stack);
+  _detail::factorize_recursive_impl(
+    util::to_view_dyn(mat),
+    proxsuite::linalg::dense::dense_tuning().factorize_recursive_threshold,
+    stack);
 }
 
 template<typename T>
@@ -353,17 +420,30 @@ auto
 factorize_req(proxsuite::linalg::veg::Tag<T> tag, isize n) noexcept
   -> proxsuite::linalg::veg::dynstack::StackReq
 {
-  return proxsuite::linalg::dense::factorize_blocked_req(tag, n, 128) |
-         proxsuite::linalg::dense::factorize_recursive_req(tag, n);
+  // the blocked variant is sized for the block size in use, see factorize
+  return proxsuite::linalg::dense::factorize_recursive_req(tag, n) |
+         proxsuite::linalg::dense::factorize_blocked_req(
+           tag,
+           n,
+           _detail::min2(
+             n, proxsuite::linalg::dense::dense_tuning().factorize_block_size));
 }
 
 template<typename Mat>
 void
 factorize(Mat&& mat, proxsuite::linalg::veg::dynstack::DynStackMut stack)
 {
+  using T = typename proxsuite::linalg::veg::uncvref_t<Mat>::Scalar;
   isize n = mat.rows();
-  if (n > 2048) {
-    proxsuite::linalg::dense::factorize_blocked(mat, 128, stack);
+  DenseTuning tuning = proxsuite::linalg::dense::dense_tuning();
+  // the stack may have been sized by factorize_req before the block size was
+  // increased, in which case the recursive variant is used
+  if (n > tuning.factorize_blocked_min_dim &&
+      proxsuite::linalg::dense::factorize_blocked_req(
+        proxsuite::linalg::veg::Tag<T>{}, n, tuning.factorize_block_size)
+          .alloc_req() <= stack.remaining_bytes()) {
+    proxsuite::linalg::dense::factorize_blocked(
+      mat, tuning.factorize_block_size, stack);
   } else {
     proxsuite::linalg::dense::factorize_recursive(mat, stack);
   }
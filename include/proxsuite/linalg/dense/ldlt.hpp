@@ -9,6 +9,8 @@
 #include "proxsuite/linalg/dense/update.hpp"
 #include "proxsuite/linalg/dense/modify.hpp"
 #include "proxsuite/linalg/dense/solve.hpp"
+#include "proxsuite/linalg/dense/packed.hpp"
+#include <proxsuite/helpers/huge-pages.hpp>
 #include <proxsuite/linalg/veg/vec.hpp>
 
 namespace proxsuite {
@@ -17,10 +19,16 @@ namespace dense {
 namespace _detail {
 struct SimdAlignedSystemAlloc
 {
-  friend auto operator==(SimdAlignedSystemAlloc /*unused*/,
-                         SimdAlignedSystemAlloc /*unused*/) noexcept -> bool
+  // whether the current block was mapped directly, following the large buffer
+  // policy, rather than allocated on the heap. the policy may change while the
+  // block is alive, so this is recorded at allocation
+  bool mapped = false;
+
+  // the blocks of equal allocators are interchangeable
+  friend auto operator==(SimdAlignedSystemAlloc lhs,
+                         SimdAlignedSystemAlloc rhs) noexcept -> bool
   {
-    return true;
+    return lhs.mapped == rhs.mapped;
   }
 };
 } // namespace _detail
@@ -52,36 +60,113 @@ struct proxsuite::linalg::veg::mem::Alloc<
     return l;
   }
 
-  VEG_INLINE static void dealloc(RefMut /*alloc*/, void* ptr, Layout l) noexcept
+  // buffers spanning at least one huge page are mapped directly when the large
+  // buffer policy is enabled, so that they are aligned on a huge page and
+  // follow the policy
+  VEG_INLINE static auto maps(usize byte_size) noexcept -> bool
   {
+    return byte_size >= proxsuite::helpers::huge_page_size &&
+           proxsuite::helpers::maps_large_buffers();
+  }
+  VEG_INLINE static auto mapped_size(usize byte_size) noexcept -> usize
+  {
+    usize page = proxsuite::helpers::huge_page_size;
+    return (byte_size + page - 1) / page * page;
+  }
+
+  VEG_INLINE static void dealloc(RefMut alloc, void* ptr, Layout l) noexcept
+  {
+    if (ptr == nullptr) {
+      return;
+    }
+    if (alloc.get().mapped) {
+      alloc.get().mapped = false;
+      return proxsuite::helpers::unmap_large_buffer(ptr,
+                                                    mapped_size(l.byte_size));
+    }
     return Alloc<SystemAlloc>::dealloc(
       mut(SystemAlloc{}), ptr, adjusted_layout(l));
   }
 
-  VEG_NODISCARD VEG_INLINE static auto alloc(RefMut /*alloc*/,
-                                             Layout l) noexcept
+  VEG_NODISCARD VEG_INLINE static auto alloc(RefMut alloc, Layout l) noexcept
     -> mem::AllocBlock
   {
+    if (maps(l.byte_size)) {
+      usize size = mapped_size(l.byte_size);
+      void* ptr = proxsuite::helpers::map_large_buffer(size);
+      if (HEDLEY_UNLIKELY(ptr == nullptr)) {
+        proxsuite::linalg::veg::_detail::terminate();
+      }
+      alloc.get().mapped = true;
+      return { ptr, size };
+    }
+    alloc.get().mapped = false;
     return Alloc<SystemAlloc>::alloc(mut(SystemAlloc{}), adjusted_layout(l));
   }
 
-  VEG_NODISCARD VEG_INLINE static auto grow(RefMut /*alloc*/,
+  // reallocates a block when either the old or the new one is mapped
+  VEG_INLINE static auto realloc_mapped(RefMut alloc,
+                                        void* ptr,
+                                        Layout l,
+                                        usize new_size,
+                                        usize copy_size,
+                                        RelocFn reloc) noexcept
+    -> mem::AllocBlock
+  {
+    if (alloc.get().mapped && maps(new_size)) {
+      usize old_mapped = mapped_size(l.byte_size);
+      usize new_mapped = mapped_size(new_size);
+      if (old_mapped == new_mapped) {
+        return { ptr, old_mapped };
+      }
+      // the pages are moved rather than copied when possible
+      void* out =
+        proxsuite::helpers::remap_large_buffer(ptr, old_mapped, new_mapped);
+      if (out != nullptr) {
+        return { out, new_mapped };
+      }
+    }
+    bool was_mapped = alloc.get().mapped;
+    mem::AllocBlock block = Alloc::alloc(
+      VEG_FWD(alloc), Layout{ new_size, adjusted_layout(l).align });
+    reloc(block.data, ptr, copy_size);
+    if (was_mapped) {
+      proxsuite::helpers::unmap_large_buffer(ptr, mapped_size(l.byte_size));
+    } else {
+      Alloc<SystemAlloc>::dealloc(mut(SystemAlloc{}), ptr, adjusted_layout(l));
+    }
+    return block;
+  }
+
+  VEG_NODISCARD VEG_INLINE static auto grow(RefMut alloc,
                                             void* ptr,
                                             Layout l,
                                             usize new_size,
                                             RelocFn reloc) noexcept
     -> mem::AllocBlock
   {
+    if (ptr == nullptr) {
+      return Alloc::alloc(VEG_FWD(alloc), Layout{ new_size, l.align });
+    }
+    if (alloc.get().mapped || maps(new_size)) {
+      usize copy_size = l.byte_size < new_size ? l.byte_size : new_size;
+      return realloc_mapped(
+        VEG_FWD(alloc), ptr, l, new_size, copy_size, VEG_FWD(reloc));
+    }
     return Alloc<SystemAlloc>::grow(
       mut(SystemAlloc{}), ptr, adjusted_layout(l), new_size, reloc);
   }
-  VEG_NODISCARD VEG_INLINE static auto shrink(RefMut /*alloc*/,
+  VEG_NODISCARD VEG_INLINE static auto shrink(RefMut alloc,
                                               void* ptr,
                                               Layout l,
                                               usize new_size,
                                               RelocFn reloc) noexcept
     -> mem::AllocBlock
   {
+    if (alloc.get().mapped) {
+      return realloc_mapped(
+        VEG_FWD(alloc), ptr, l, new_size, new_size, VEG_FWD(reloc));
+    }
     return Alloc<SystemAlloc>::shrink(
       mut(SystemAlloc{}), ptr, adjusted_layout(l), new_size, reloc);
   }
@@ -199,12 +284,10 @@ private:
   using VecMapISize = Eigen::Map<Eigen::Matrix<isize, DYN, 1> const>;
   using Perm = Eigen::PermutationWrapper<VecMapISize>;
 
+  // the allocator also places the storage of large factors on huge pages,
+  // even when it is not vectorized
   using StorageSimdVec =
-    proxsuite::linalg::veg::Vec<T,
-                                proxsuite::linalg::veg::meta::if_t<
-                                  _detail::should_vectorize<T>::value,
-                                  _detail::SimdAlignedSystemAlloc,
-                                  proxsuite::linalg::veg::mem::SystemAlloc>>;
+    proxsuite::linalg::veg::Vec<T, _detail::SimdAlignedSystemAlloc>;
 
   StorageSimdVec ld_storage;
   isize stride{};
@@ -214,13 +297,42 @@ private:
   // sorted on a best effort basis
   proxsuite::linalg::veg::Vec<T> maybe_sorted_diag;
 
-  VEG_REFLECT(Ldlt, ld_storage, stride, perm, perm_inv, maybe_sorted_diag);
+  // whether ld_storage holds the lower triangular part of the factor in the
+  // packed layout of _detail::PackedLower, instead of a full column major
+  // matrix
+  bool packed{};
+
+  VEG_REFLECT(Ldlt,
+              ld_storage,
+              stride,
+              perm,
+              perm_inv,
+              maybe_sorted_diag,
+              packed);
 
   static auto adjusted_stride(isize n) noexcept -> isize
   {
     return _detail::adjusted_stride<T>(n);
   }
 
+  // number of scalars needed for storing a matrix of size at most `cap×cap`,
+  // with the given stride
+  auto storage_len(isize cap, isize new_stride) const noexcept -> isize
+  {
+    return packed ? _detail::PackedLower<T>::storage_len(new_stride)
+                  : cap * new_stride;
+  }
+
+  auto packed_ld() const noexcept -> _detail::PackedLower<T>
+  {
+    return {
+      const_cast<T*>(ld_storage.ptr()),
+      stride,
+      dim(),
+      0,
+    };
+  }
+
   // soft invariants:
   // - perm.len() == perm_inv.len() == dim
   // - dim < stride
@@ -243,16 +355,16 @@ public:
     static_assert(VEG_CONCEPT(nothrow_constructible<T>), ".");
 
     auto new_stride = adjusted_stride(cap);
-    if (cap <= stride && cap * new_stride <= ld_storage.len()) {
+    if (cap <= stride && storage_len(cap, new_stride) <= ld_storage.len()) {
       return;
     }
 
-    ld_storage.reserve_exact(cap * new_stride);
+    ld_storage.reserve_exact(storage_len(cap, new_stride));
     perm.reserve_exact(cap);
     perm_inv.reserve_exact(cap);
     maybe_sorted_diag.reserve_exact(cap);
 
-    ld_storage.resize_for_overwrite(cap * new_stride);
+    ld_storage.resize_for_overwrite(storage_len(cap, new_stride));
     stride = new_stride;
   }
 
@@ -266,17 +378,32 @@ public:
   void reserve(isize cap) noexcept
   {
     auto new_stride = adjusted_stride(cap);
-    if (cap <= stride && cap * new_stride <= ld_storage.len()) {
+    if (cap <= stride && storage_len(cap, new_stride) <= ld_storage.len()) {
       return;
     }
     auto n = dim();
 
-    ld_storage.reserve_exact(cap * new_stride);
+    ld_storage.reserve_exact(storage_len(cap, new_stride));
     perm.reserve_exact(cap);
     perm_inv.reserve_exact(cap);
     maybe_sorted_diag.reserve_exact(cap);
 
-    ld_storage.resize_for_overwrite(cap * new_stride);
+    ld_storage.resize_for_overwrite(storage_len(cap, new_stride));
+
+    if (packed) {
+      // every element is moved to a higher address
+      auto old_ld = packed_ld();
+      auto new_ld = old_ld;
+      new_ld.stride = new_stride;
+      for (isize j = n - 1; j >= 0; --j) {
+        std::move_backward( //
+          old_ld.elem_addr(j, j),
+          old_ld.elem_addr(n, j),
+          new_ld.elem_addr(n, j));
+      }
+      stride = new_stride;
+      return;
+    }
 
     for (isize i = 0; i < n; ++i) {
       auto col = n - i - 1;
@@ -289,6 +416,69 @@ public:
     stride = new_stride;
   }
 
+  /*!
+   * Chooses how the factor is stored: either as a full column major matrix,
+   * or in a packed layout where only its lower triangular part is kept, split
+   * in panels of consecutive columns. The packed layout needs about half of
+   * the memory of the full one, and can be used for all the operations of
+   * this class, except for the l(), lt(), d() and ld_*() views.
+   * This operation preserves the existing decomposition. It should be called
+   * before reserve_uninit when the matrix is empty, so that the storage is
+   * only allocated in the chosen layout.
+   *
+   * @param packed_storage whether the packed layout should be used
+   */
+  void set_packed_storage(bool packed_storage)
+  {
+    if (packed_storage == packed) {
+      return;
+    }
+    isize n = dim();
+    if (n == 0) {
+      // nothing to preserve, the storage is reserved again in the new layout by
+      // reserve_uninit or factorize
+      ld_storage = StorageSimdVec{};
+      stride = 0;
+      packed = packed_storage;
+      return;
+    }
+
+    StorageSimdVec new_storage;
+    isize new_len = packed_storage
+                      ? _detail::PackedLower<T>::storage_len(stride)
+                      : stride * stride;
+    new_storage.reserve_exact(new_len);
+    new_storage.resize_for_overwrite(new_len);
+
+    using FullMap =
+      Eigen::Map<ColMat, Eigen::Unaligned, Eigen::OuterStride<DYN>>;
+    auto full_ld = FullMap{
+      packed_storage ? ld_storage.ptr_mut() : new_storage.ptr_mut(),
+      n,
+      n,
+      Eigen::OuterStride<DYN>{ stride },
+    };
+    auto packed_ld_ = _detail::PackedLower<T>{
+      packed_storage ? new_storage.ptr_mut() : ld_storage.ptr_mut(),
+      stride,
+      n,
+      0,
+    };
+    if (packed_storage) {
+      _detail::packed_copy_lower_from(packed_ld_, full_ld);
+    } else {
+      _detail::packed_copy_lower_to(full_ld, packed_ld_);
+    }
+
+    ld_storage = static_cast<StorageSimdVec&&>(new_storage);
+    packed = packed_storage;
+  }
+
+  /*!
+   * Returns whether the factor is stored in the packed layout.
+   */
+  auto is_storage_packed() const noexcept -> bool { return packed; }
+
   /*!
    * Returns the memory storage requirements for performing a rank `k` update
    * on a matrix with size at most `n×n`, with `k ≤ r`.
@@ -357,33 +547,56 @@ public:
       indices_actual[k] = perm_inv[indices[k]];
     }
 
-    proxsuite::linalg::dense::ldlt_delete_rows_and_cols_sort_indices( //
-      ld_col_mut(),
-      indices_actual,
-      r,
-      stack);
-
-    // PERF: do this in one pass
-    for (isize k = 0; k < r; ++k) {
-      auto i_actual = indices_actual[r - 1 - k];
-      auto i = indices[r - 1 - k];
-
-      perm.pop_mid(i_actual);
-      perm_inv.pop_mid(i);
-      maybe_sorted_diag.pop_mid(i_actual);
-
-      for (isize j = 0; j < n - 1 - k; ++j) {
-        auto& p_j = perm[j];
-        auto& pinv_j = perm_inv[j];
+    if (packed) {
+      _detail::packed_ldlt_delete_rows_and_cols(
+        packed_ld(), indices_actual, r, stack);
+    } else {
+      proxsuite::linalg::dense::ldlt_delete_rows_and_cols_sort_indices( //
+        ld_col_mut(),
+        indices_actual,
+        r,
+        stack);
+    }
 
-        if (p_j > i) {
-          --p_j;
+    // indices_actual is now sorted as well. the permutations and the diagonal
+    // are compacted in a single pass over each of them:
+    // - perm_inv is first indexed by the original indices, and gets the new
+    //   positions of the kept rows, which is also when the diagonal is moved
+    // - perm_inv is then compacted, skipping the deleted original indices
+    // - perm is finally recomputed as the inverse of perm_inv
+    isize n_new = n - r;
+    {
+      isize k = 0;
+      isize j_new = 0;
+      for (isize j = 0; j < n; ++j) {
+        if (k < r && indices_actual[k] == j) {
+          ++k;
+          continue;
         }
-        if (pinv_j > i_actual) {
-          --pinv_j;
+        perm_inv[perm[j]] = j_new;
+        maybe_sorted_diag[j_new] = maybe_sorted_diag[j];
+        ++j_new;
+      }
+    }
+    {
+      isize k = 0;
+      isize i_new = 0;
+      for (isize i = 0; i < n; ++i) {
+        if (k < r && indices[k] == i) {
+          ++k;
+          continue;
         }
+        perm_inv[i_new] = perm_inv[i];
+        ++i_new;
       }
     }
+    for (isize i = 0; i < n_new; ++i) {
+      perm[perm_inv[i]] = i;
+    }
+
+    perm.pop_several(r);
+    perm_inv.pop_several(r);
+    maybe_sorted_diag.pop_several(r);
   }
 
   auto choose_insertion_position(isize i, Eigen::Ref<Vec const> a) -> isize
@@ -415,8 +628,10 @@ public:
       isize{ sizeof(T) } * (adjusted_stride(n + r) * r),
       _detail::align<T>(),
     } &
-           proxsuite::linalg::dense::ldlt_insert_rows_and_cols_req(
-             proxsuite::linalg::veg::Tag<T>{}, n, r);
+           (proxsuite::linalg::dense::ldlt_insert_rows_and_cols_req(
+              proxsuite::linalg::veg::Tag<T>{}, n, r) |
+            proxsuite::linalg::dense::packed_ldlt_insert_rows_and_cols_req(
+              proxsuite::linalg::veg::Tag<T>{}, n + r, r));
   }
 
   /*!
@@ -470,8 +685,13 @@ public:
       }
     }
 
-    proxsuite::linalg::dense::ldlt_insert_rows_and_cols(
-      ld_col_mut(), i_actual, permuted_a, stack);
+    if (packed) {
+      _detail::packed_ldlt_insert_rows_and_cols(
+        packed_ld(), i_actual, permuted_a, stack);
+    } else {
+      proxsuite::linalg::dense::ldlt_insert_rows_and_cols(
+        ld_col_mut(), i_actual, permuted_a, stack);
+    }
   }
 
   /*!
@@ -556,17 +776,31 @@ public:
       _w(sorted_indices[k] - first, k) = 1;
     }
 
-    proxsuite::linalg::dense::_detail::rank_r_update_clobber_w_impl(
-      util::submatrix(ld_col_mut(), first, first, n, n),
-      _w.data(),
-      _w.outerStride(),
-      _alpha.data(),
-      _detail::IndicesR{
-        first,
-        0,
-        r,
-        sorted_indices,
-      });
+    if (packed) {
+      proxsuite::linalg::dense::_detail::rank_r_update_clobber_w_impl(
+        packed_ld().trailing(first),
+        _w.data(),
+        _w.outerStride(),
+        _alpha.data(),
+        _detail::IndicesR{
+          first,
+          0,
+          r,
+          sorted_indices,
+        });
+    } else {
+      proxsuite::linalg::dense::_detail::rank_r_update_clobber_w_impl(
+        util::submatrix(ld_col_mut(), first, first, n, n),
+        _w.data(),
+        _w.outerStride(),
+        _alpha.data(),
+        _detail::IndicesR{
+          first,
+          0,
+          r,
+          sorted_indices,
+        });
+    }
   }
 
   /*!
@@ -604,8 +838,17 @@ public:
       }
     }
 
-    proxsuite::linalg::dense::rank_r_update_clobber_inputs(
-      ld_col_mut(), _w, _alpha);
+    if (packed) {
+      proxsuite::linalg::dense::_detail::rank_r_update_clobber_w_impl(
+        packed_ld(),
+        _w.data(),
+        _w.outerStride(),
+        _alpha.data(),
+        _detail::ConstantR{ r });
+    } else {
+      proxsuite::linalg::dense::rank_r_update_clobber_inputs(
+        ld_col_mut(), _w, _alpha);
+    }
   }
 
   /*!
@@ -613,6 +856,7 @@ public:
    */
   auto dim() const noexcept -> isize { return perm.len(); }
 
+  // the views below are only valid when the factor is not packed
   auto ld_col() const noexcept -> Eigen::Map< //
     ColMat const,
     Eigen::Unaligned,
@@ -699,11 +943,11 @@ public:
   static auto factorize_req(isize n)
     -> proxsuite::linalg::veg::dynstack::StackReq
   {
-    return proxsuite::linalg::veg::dynstack::StackReq{
-      n * adjusted_stride(n) * isize{ sizeof(T) },
-      _detail::align<T>(),
-    } |
+    return proxsuite::linalg::dense::_detail::apply_permutation_tri_lower_req(
+             n) |
            proxsuite::linalg::dense::factorize_req(
+             proxsuite::linalg::veg::Tag<T>{}, n) |
+           proxsuite::linalg::dense::packed_factorize_req(
              proxsuite::linalg::veg::Tag<T>{}, n);
   }
 
@@ -731,13 +975,20 @@ public:
       perm_inv.ptr_mut(),
       util::diagonal(mat));
 
-    {
-      LDLT_TEMP_MAT_UNINIT(T, work, n, n, stack);
-      ld_col_mut() = mat;
-      proxsuite::linalg::dense::_detail::apply_permutation_tri_lower(
-        ld_col_mut(), work, perm.ptr());
+    if (packed) {
+      auto ld = packed_ld();
+      _detail::packed_copy_lower_permuted_from(ld, mat, perm.ptr());
+      for (isize i = 0; i < n; ++i) {
+        maybe_sorted_diag[i] = ld(i, i);
+      }
+      _detail::packed_factorize(ld, stack);
+      return;
     }
 
+    ld_col_mut() = mat;
+    proxsuite::linalg::dense::_detail::apply_permutation_tri_lower(
+      ld_col_mut(), perm.ptr(), stack);
+
     for (isize i = 0; i < n; ++i) {
       maybe_sorted_diag[i] = ld_col()(i, i);
     }
@@ -776,30 +1027,47 @@ public:
       work[i] = rhs[perm[i]];
     }
 
-    proxsuite::linalg::dense::solve(ld_col(), work);
+    if (packed) {
+      _detail::packed_solve_in_place(packed_ld(), work.data());
+    } else {
+      proxsuite::linalg::dense::solve(ld_col(), work);
+    }
 
     for (isize i = 0; i < n; ++i) {
       rhs[i] = work[perm_inv[i]];
     }
   }
 
+  auto dbg_ld() const -> ColMat
+  {
+    isize n = dim();
+    auto ld = ColMat(n, n);
+    if (packed) {
+      ld.setZero();
+      _detail::packed_copy_lower_to(ld, packed_ld());
+    } else {
+      ld = ld_col();
+    }
+    return ld;
+  }
+
   auto dbg_reconstructed_matrix_internal() const -> ColMat
   {
     isize n = dim();
+    auto ld = dbg_ld();
     auto tmp = ColMat(n, n);
-    tmp = l();
-    tmp = tmp * d().asDiagonal();
-    auto A = ColMat(tmp * lt());
+    tmp = ld.template triangularView<Eigen::UnitLower>();
+    tmp = tmp * ld.diagonal().asDiagonal();
+    auto A = ColMat(
+      tmp * ld.transpose().template triangularView<Eigen::UnitUpper>());
     return A;
   }
 
   auto dbg_reconstructed_matrix() const -> ColMat
   {
     isize n = dim();
+    auto A = dbg_reconstructed_matrix_internal();
     auto tmp = ColMat(n, n);
-    tmp = l();
-    tmp = tmp * d().asDiagonal();
-    auto A = ColMat(tmp * lt());
 
     for (isize i = 0; i < n; i++) {
       tmp.row(i) = A.row(perm_inv[i]);
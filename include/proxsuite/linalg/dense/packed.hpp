@@ -0,0 +1,465 @@
+/** \file */
+//
+// Copyright (c) 2022 INRIA
+//
+#ifndef PROXSUITE_LINALG_DENSE_LDLT_PACKED_HPP
+#define PROXSUITE_LINALG_DENSE_LDLT_PACKED_HPP
+
+#include "proxsuite/linalg/dense/core.hpp"
+#include "proxsuite/linalg/dense/factorize.hpp"
+#include "proxsuite/linalg/dense/update.hpp"
+#include "proxsuite/linalg/dense/modify.hpp"
+#include <algorithm>
+#include <proxsuite/linalg/veg/memory/dynamic_stack.hpp>
+
+namespace proxsuite {
+namespace linalg {
+namespace dense {
+namespace _detail {
+
+// number of columns of a panel of the packed storage. this is a multiple of
+// the simd width, so that every panel starts at an aligned address
+using packed_tile_size = proxsuite::linalg::veg::meta::constant<isize, 64>;
+
+/*
+ * view over the lower triangular part of a matrix of capacity `stride`, stored
+ * in panels of packed_tile_size columns.
+ * the panel p holds the rows [p×B, stride) of the columns [p×B, (p+1)×B), in
+ * column major order with the outer stride (stride - p×B). the diagonal tiles
+ * are stored in full, so that each panel can be handled as a regular strided
+ * matrix by the blas-like kernels, while only about half of the full storage
+ * is needed.
+ *
+ * the view covers the rows and columns [offset, n) of the matrix, and every
+ * column of the view is contiguous from its diagonal element onwards.
+ */
+template<typename T>
+struct PackedLower
+{
+  static constexpr bool IsRowMajor = false;
+  static constexpr int InnerStrideAtCompileTime = 1;
+  using Scalar = T;
+  using PanelMap = Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>,
+                              Eigen::Unaligned,
+                              Eigen::OuterStride<Eigen::Dynamic>>;
+
+  T* ptr;
+  isize stride;
+  isize n;
+  isize offset;
+
+  static auto panel_offset(isize stride, isize p) noexcept -> isize
+  {
+    constexpr isize B = packed_tile_size::value;
+    return B * (p * stride - B * (p * (p - 1) / 2));
+  }
+  // number of scalars needed for storing a matrix of capacity `stride`
+  static auto storage_len(isize stride) noexcept -> isize
+  {
+    constexpr isize B = packed_tile_size::value;
+    return panel_offset(stride, (stride + B - 1) / B);
+  }
+
+  auto rows() const noexcept -> isize { return n - offset; }
+  auto cols() const noexcept -> isize { return n - offset; }
+
+  auto elem_addr(isize i, isize j) const noexcept -> T*
+  {
+    constexpr isize B = packed_tile_size::value;
+    i += offset;
+    j += offset;
+    isize start = j / B * B;
+    return ptr + panel_offset(stride, j / B) + (j - start) * (stride - start) +
+           (i - start);
+  }
+  auto operator()(isize i, isize j) const noexcept -> T&
+  {
+    return *elem_addr(i, j);
+  }
+
+  // view over the rows and columns [k, rows()) of this one
+  auto trailing(isize k) const noexcept -> PackedLower
+  {
+    return { ptr, stride, n, offset + k };
+  }
+  // view over the rows and columns [0, k) of this one, with a null offset
+  auto leading(isize k) const noexcept -> PackedLower
+  {
+    return { ptr, stride, k, 0 };
+  }
+
+  auto n_panels() const noexcept -> isize
+  {
+    constexpr isize B = packed_tile_size::value;
+    return (n + B - 1) / B;
+  }
+  // rows [p×B, n) of the p-th panel, with a null offset
+  auto panel(isize p) const noexcept -> PanelMap
+  {
+    constexpr isize B = packed_tile_size::value;
+    isize start = p * B;
+    return {
+      ptr + panel_offset(stride, p),
+      n - start,
+      min2(B, n - start),
+      Eigen::OuterStride<Eigen::Dynamic>{ stride - start },
+    };
+  }
+};
+
+// ld(i, j) = mat(i, j), for i ≥ j, where ld and mat have the same dimension
+template<typename T, typename Mat>
+void
+packed_copy_lower_from(PackedLower<T> ld, Mat const& mat)
+{
+  isize n = ld.rows();
+  for (isize j = 0; j < n; ++j) {
+    T* col = ld.elem_addr(j, j);
+    for (isize i = j; i < n; ++i) {
+      col[i - j] = mat(i, j);
+    }
+  }
+}
+
+// mat(i, j) = ld(i, j), for i ≥ j, where ld and mat have the same dimension
+template<typename T, typename Mat>
+void
+packed_copy_lower_to(Mat&& mat, PackedLower<T> ld)
+{
+  isize n = ld.rows();
+  for (isize j = 0; j < n; ++j) {
+    T const* col = ld.elem_addr(j, j);
+    for (isize i = j; i < n; ++i) {
+      mat(i, j) = col[i - j];
+    }
+  }
+}
+
+// ld(i, j) = mat(perm[i], perm[j]), for i >= j, where only the lower
+// triangular part of mat is accessed
+template<typename T, typename Mat>
+void
+packed_copy_lower_permuted_from(PackedLower<T> ld,
+                                Mat const& mat,
+                                isize const* perm_indices)
+{
+  isize n = ld.rows();
+  for (isize j = 0; j < n; ++j) {
+    T* col = ld.elem_addr(j, j);
+    isize pj = perm_indices[j];
+    for (isize i = j; i < n; ++i) {
+      isize pi = perm_indices[i];
+      col[i - j] = pi >= pj ? mat(pi, pj) : mat(pj, pi);
+    }
+  }
+}
+
+// solves L×x = rhs in place, where L is the unit lower triangular part of ld
+template<typename T, typename Rhs>
+void
+packed_solve_unit_lower_in_place(PackedLower<T> ld, Rhs rhs)
+{
+  constexpr isize B = packed_tile_size::value;
+  isize n_panels = ld.n_panels();
+  for (isize p = 0; p < n_panels; ++p) {
+    auto panel = ld.panel(p);
+    isize bs = panel.cols();
+    isize rem = panel.rows() - bs;
+
+    auto x1 = util::subrows(rhs, p * B, bs);
+    util::submatrix(panel, 0, 0, bs, bs)
+      .template triangularView<Eigen::UnitLower>()
+      .solveInPlace(x1);
+    if (rem > 0) {
+      util::noalias_mul_add(util::subrows(rhs, p * B + bs, rem),
+                            util::submatrix(panel, bs, 0, rem, bs),
+                            x1,
+                            T(-1));
+    }
+  }
+}
+
+// solves L.T×x = rhs in place, where L is the unit lower triangular part of ld
+template<typename T, typename Rhs>
+void
+packed_solve_unit_upper_in_place(PackedLower<T> ld, Rhs rhs)
+{
+  constexpr isize B = packed_tile_size::value;
+  isize p = ld.n_panels();
+  while (p > 0) {
+    --p;
+    auto panel = ld.panel(p);
+    isize bs = panel.cols();
+    isize rem = panel.rows() - bs;
+
+    auto x1 = util::subrows(rhs, p * B, bs);
+    if (rem > 0) {
+      util::noalias_mul_add(x1,
+                            util::trans(util::submatrix(panel, bs, 0, rem, bs)),
+                            util::subrows(rhs, p * B + bs, rem),
+                            T(-1));
+    }
+    util::trans(util::submatrix(panel, 0, 0, bs, bs))
+      .template triangularView<Eigen::UnitUpper>()
+      .solveInPlace(x1);
+  }
+}
+
+template<typename T>
+void
+packed_factorize(PackedLower<T> ld,
+                 proxsuite::linalg::veg::dynstack::DynStackMut stack)
+{
+  // right looking, one panel at a time
+
+  constexpr isize B = packed_tile_size::value;
+  isize n_panels = ld.n_panels();
+
+  for (isize p = 0; p < n_panels; ++p) {
+    auto panel = ld.panel(p);
+    isize bs = panel.cols();
+    isize rem = panel.rows() - bs;
+
+    auto ld11 = util::submatrix(panel, 0, 0, bs, bs);
+    proxsuite::linalg::dense::factorize(ld11, stack);
+    if (rem == 0) {
+      break;
+    }
+
+    auto l21 = util::submatrix(panel, bs, 0, rem, bs);
+    util::trans(ld11)
+      .template triangularView<Eigen::UnitUpper>()
+      .template solveInPlace<Eigen::OnTheRight>(l21);
+
+    LDLT_TEMP_MAT_UNINIT(T, work, rem, bs, stack);
+    work = l21;
+    l21 = l21 * util::diagonal(ld11).asDiagonal().inverse();
+
+    // the trailing panels are updated one after the other, their rows being
+    // a suffix of the rows of l21
+    for (isize q = p + 1; q < n_panels; ++q) {
+      auto panel_q = ld.panel(q);
+      isize bs_q = panel_q.cols();
+      isize rem_q = panel_q.rows() - bs_q;
+      isize first = (q - p - 1) * B;
+
+      // the diagonal tile is stored in full, its strictly upper part is
+      // overwritten but never read
+      auto work_q = util::subrows(work, first, bs_q);
+      util::noalias_mul_add(util::submatrix(panel_q, 0, 0, bs_q, bs_q),
+                            util::subrows(l21, first, bs_q),
+                            util::trans(work_q),
+                            T(-1));
+      if (rem_q > 0) {
+        util::noalias_mul_add(util::submatrix(panel_q, bs_q, 0, rem_q, bs_q),
+                              util::subrows(l21, first + bs_q, rem_q),
+                              util::trans(work_q),
+                              T(-1));
+      }
+    }
+  }
+}
+
+template<typename T>
+void
+packed_solve_in_place(PackedLower<T> ld, T* rhs)
+{
+  isize n = ld.rows();
+  auto x = Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, 1>>{ rhs, n };
+
+  _detail::packed_solve_unit_lower_in_place(ld, x);
+  for (isize i = 0; i < n; ++i) {
+    x[i] /= ld(i, i);
+  }
+  _detail::packed_solve_unit_upper_in_place(ld, x);
+}
+
+template<typename T>
+void
+packed_ldlt_delete_rows_and_cols(
+  PackedLower<T> ld,
+  isize* indices,
+  isize r,
+  proxsuite::linalg::veg::dynstack::DynStackMut stack)
+{
+  // same algorithm as ldlt_delete_rows_and_cols_impl. the packed storage
+  // orders the elements by column then by row, just like the full one, so
+  // the compaction can be done by moving each chunk of column forward
+
+  std::sort(indices, indices + r);
+
+  isize n = ld.rows();
+  isize first = indices[0];
+
+  auto w_stride = _detail::adjusted_stride<T>(n - first - r);
+
+  proxsuite::linalg::veg::Tag<T> tag;
+
+  auto _w = stack.make_new(tag, r * w_stride, _detail::align<T>());
+  auto _alpha = stack.make_new_for_overwrite(tag, r);
+
+  auto pw = _w.ptr_mut();
+  auto palpha = _alpha.ptr_mut();
+
+  for (isize k = 0; k < r; ++k) {
+    isize j = indices[k];
+    palpha[k] = ld(j, j);
+    auto pwk = pw + k * w_stride;
+
+    for (isize chunk_i = k + 1; chunk_i < r + 1; ++chunk_i) {
+      isize i_start = indices[chunk_i - 1] + 1;
+      isize i_finish = chunk_i == r ? n : indices[chunk_i];
+
+      std::move(ld.elem_addr(i_start, j),
+                ld.elem_addr(i_finish, j),
+                pwk + i_start - chunk_i - first);
+    }
+  }
+
+  for (isize chunk_j = 0; chunk_j < r + 1; ++chunk_j) {
+    isize j_start = chunk_j == 0 ? 0 : indices[chunk_j - 1] + 1;
+    isize j_finish = chunk_j == r ? n : indices[chunk_j];
+
+    for (isize j = j_start; j < j_finish; ++j) {
+      for (isize chunk_i = chunk_j; chunk_i < r + 1; ++chunk_i) {
+        isize i_start = chunk_i == chunk_j ? j : indices[chunk_i - 1] + 1;
+        isize i_finish = chunk_i == r ? n : indices[chunk_i];
+
+        if (chunk_i != 0 || chunk_j != 0) {
+          std::move(ld.elem_addr(i_start, j),
+                    ld.elem_addr(i_finish, j),
+                    ld.elem_addr(i_start - chunk_i, j - chunk_j));
+        }
+      }
+    }
+  }
+
+  _detail::rank_r_update_clobber_w_impl(
+    ld.leading(n - r).trailing(first),
+    pw,
+    w_stride,
+    palpha,
+    IndicesR{ first, 0, r, indices });
+}
+
+template<typename T, typename A_1>
+void
+packed_ldlt_insert_rows_and_cols(
+  PackedLower<T> ld,
+  isize pos,
+  A_1 a_1,
+  proxsuite::linalg::veg::dynstack::DynStackMut stack)
+{
+  // same algorithm as ldlt_insert_rows_and_cols_impl, where the blocks that
+  // are spread over several panels are computed in temporaries
+
+  constexpr isize B = packed_tile_size::value;
+
+  isize const new_n = ld.rows();
+  isize const r = a_1.cols();
+  isize const old_n = new_n - r;
+  isize const rem = new_n - pos - r;
+
+  // make room for the new rows and columns. the elements are moved to higher
+  // addresses, so this is done from the last one to the first one
+  for (isize j = old_n - 1; j >= pos; --j) {
+    std::move_backward(ld.elem_addr(j, j),
+                       ld.elem_addr(old_n, j),
+                       ld.elem_addr(new_n, j + r));
+  }
+  for (isize j = pos - 1; j >= 0; --j) {
+    std::move_backward(ld.elem_addr(pos, j),
+                       ld.elem_addr(old_n, j),
+                       ld.elem_addr(new_n, j));
+  }
+
+  // y = L00^-1 a01 = D0 l10.T
+  LDLT_TEMP_MAT_UNINIT(T, y, pos, r, stack);
+  LDLT_TEMP_MAT_UNINIT(T, l10t, pos, r, stack);
+  y = util::subrows(a_1, 0, pos);
+  _detail::packed_solve_unit_lower_in_place(ld.leading(pos), y);
+  for (isize j = 0; j < pos; ++j) {
+    T dj = ld(j, j);
+    for (isize k = 0; k < r; ++k) {
+      T l = y(j, k) / dj;
+      l10t(j, k) = l;
+      ld(pos + k, j) = l;
+    }
+  }
+
+  LDLT_TEMP_MAT_UNINIT(T, ld11, r, r, stack);
+  ld11.template triangularView<Eigen::Lower>() =
+    util::subrows(a_1, pos, r).template triangularView<Eigen::Lower>();
+  // only the lower triangular part of ld11 is read by the factorization
+  util::noalias_mul_add(ld11, util::trans(l10t), y, T(-1));
+
+  LDLT_TEMP_MAT_UNINIT(T, l21, rem, r, stack);
+  l21 = util::subrows(a_1, pos + r, rem);
+  for (isize p = 0; p * B < pos; ++p) {
+    auto panel = ld.panel(p);
+    isize bs = min2(B, pos - p * B);
+    util::noalias_mul_add(
+      l21,
+      util::submatrix(panel, pos + r - p * B, 0, rem, bs),
+      util::subrows(y, p * B, bs),
+      T(-1));
+  }
+
+  proxsuite::linalg::dense::factorize(ld11, stack);
+  util::trans(ld11)
+    .template triangularView<Eigen::UnitUpper>()
+    .template solveInPlace<Eigen::OnTheRight>(l21);
+  l21 = l21 * util::diagonal(ld11).asDiagonal().inverse();
+
+  auto _alpha = stack.make_new_for_overwrite(proxsuite::linalg::veg::Tag<T>{},
+                                             r);
+  auto palpha = _alpha.ptr_mut();
+
+  for (isize k = 0; k < r; ++k) {
+    palpha[k] = -ld11(k, k);
+    T* col = ld.elem_addr(pos + k, pos + k);
+    for (isize i = k; i < r; ++i) {
+      col[i - k] = ld11(i, k);
+    }
+    std::copy(util::matrix_elem_addr(l21, 0, k),
+              util::matrix_elem_addr(l21, 0, k) + rem,
+              col + (r - k));
+  }
+
+  _detail::rank_r_update_clobber_w_impl(ld.trailing(pos + r),
+                                        l21.data(),
+                                        l21.outerStride(),
+                                        palpha,
+                                        ConstantR{ r });
+}
+} // namespace _detail
+
+template<typename T>
+auto
+packed_factorize_req(proxsuite::linalg::veg::Tag<T> tag, isize n) noexcept
+  -> proxsuite::linalg::veg::dynstack::StackReq
+{
+  constexpr isize B = _detail::packed_tile_size::value;
+  return proxsuite::linalg::dense::temp_mat_req(tag, n, B) &
+         proxsuite::linalg::dense::factorize_req(tag, _detail::min2(n, B));
+}
+
+template<typename T>
+auto
+packed_ldlt_insert_rows_and_cols_req(proxsuite::linalg::veg::Tag<T> tag,
+                                     isize n,
+                                     isize r) noexcept
+  -> proxsuite::linalg::veg::dynstack::StackReq
+{
+  return proxsuite::linalg::dense::temp_mat_req(tag, n, r) &
+         proxsuite::linalg::dense::temp_mat_req(tag, n, r) &
+         proxsuite::linalg::dense::temp_mat_req(tag, r, r) &
+         proxsuite::linalg::dense::temp_mat_req(tag, n, r) &
+         (proxsuite::linalg::dense::temp_vec_req(tag, r) |
+          proxsuite::linalg::dense::factorize_req(tag, r));
+}
+} // namespace dense
+} // namespace linalg
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_LINALG_DENSE_LDLT_PACKED_HPP */
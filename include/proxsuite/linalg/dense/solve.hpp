@@ -6,6 +6,7 @@
 #define PROXSUITE_LINALG_DENSE_LDLT_SOLVE_HPP
 
 #include "proxsuite/linalg/dense/core.hpp"
+#include "proxsuite/linalg/dense/dispatch.hpp"
 #include <Eigen/Core>
 
 namespace proxsuite {
@@ -16,6 +17,29 @@ template<typename Mat, typename Rhs>
 void
 solve_impl(Mat ld, Rhs rhs)
 {
+  isize n = ld.rows();
+  if (!Mat::IsRowMajor && ld.innerStride() == 1 && rhs.cols() == 1 &&
+      rhs.innerStride() == 1) {
+    // single right hand side: column oriented substitutions, using the
+    // kernels selected at runtime
+    using T = typename Mat::Scalar;
+    T const* l = ld.data();
+    isize stride = ld.outerStride();
+    T* x = rhs.data();
+    for (isize j = 0; j < n; ++j) {
+      _detail::dispatch<_detail::AxpyKernel, T>(
+        n - j - 1, x[j], l + (stride * j + j + 1), x + (j + 1));
+    }
+    for (isize j = 0; j < n; ++j) {
+      x[j] /= l[stride * j + j];
+    }
+    for (isize j = n - 1; j >= 0; --j) {
+      x[j] -= _detail::dispatch<_detail::DotKernel, T>(
+        n - j - 1, l + (stride * j + j + 1), x + (j + 1));
+    }
+    return;
+  }
+
   auto l = ld.template triangularView<Eigen::UnitLower>();
   auto lt = util::trans(ld).template triangularView<Eigen::UnitUpper>();
   auto d = util::diagonal(ld);
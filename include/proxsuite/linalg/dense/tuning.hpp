@@ -0,0 +1,209 @@
+/** \file */
+//
+// Copyright (c) 2022 INRIA
+//
+#ifndef PROXSUITE_LINALG_DENSE_LDLT_TUNING_HPP
+#define PROXSUITE_LINALG_DENSE_LDLT_TUNING_HPP
+
+#include "proxsuite/linalg/dense/core.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace proxsuite {
+namespace linalg {
+namespace dense {
+
+/*!
+ * Block sizes and algorithm variants of the dense factorization and rank
+ * updates. The best values depend on the cache sizes and the vector width of
+ * the machine, they can be measured with autotune_dense_kernels.
+ */
+struct DenseTuning
+{
+  // block size of factorize_blocked, when called by factorize
+  isize factorize_block_size = 128;
+  // dimension below which factorize_recursive stops recursing
+  isize factorize_recursive_threshold = 32;
+  // dimension above which factorize uses the blocked variant instead of the
+  // recursive one
+  isize factorize_blocked_min_dim = 2048;
+  // number of rank one updates applied in a single sweep over the factor by
+  // the rank r updates, between 1 and 4
+  isize rank_r_update_chunk = 4;
+};
+
+/*!
+ * Returns the path of the cache file the tuning is read from by
+ * load_dense_tuning(): the value of the PROXSUITE_DENSE_TUNING_FILE
+ * environment variable if it is set, and otherwise
+ * $XDG_CACHE_HOME/proxsuite/dense-tuning.txt, or
+ * $HOME/.cache/proxsuite/dense-tuning.txt. The result is empty when none of
+ * these variables is set.
+ */
+inline auto
+dense_tuning_cache_path() -> std::string
+{
+  if (char const* path = std::getenv("PROXSUITE_DENSE_TUNING_FILE")) {
+    return path;
+  }
+  if (char const* cache = std::getenv("XDG_CACHE_HOME")) {
+    return std::string(cache) + "/proxsuite/dense-tuning.txt";
+  }
+  if (char const* home = std::getenv("HOME")) {
+    return std::string(home) + "/.cache/proxsuite/dense-tuning.txt";
+  }
+  return {};
+}
+
+namespace _detail {
+// upper bounds of the tuning parameters, so that the stack requirements do
+// not depend on the current tuning
+using max_factorize_block_size =
+  proxsuite::linalg::veg::meta::constant<isize, 256>;
+using max_factorize_recursive_threshold =
+  proxsuite::linalg::veg::meta::constant<isize, 128>;
+using max_rank_r_update_chunk =
+  proxsuite::linalg::veg::meta::constant<isize, 4>;
+
+inline auto
+clamped_dense_tuning(DenseTuning tuning) noexcept -> DenseTuning
+{
+  auto clamp = [](isize value, isize min, isize max) noexcept -> isize {
+    return min2(max2(value, min), max);
+  };
+  tuning.factorize_block_size =
+    clamp(tuning.factorize_block_size, 1, max_factorize_block_size::value);
+  // the recursion must split matrices of dimension two or more
+  tuning.factorize_recursive_threshold =
+    clamp(tuning.factorize_recursive_threshold,
+          2,
+          max_factorize_recursive_threshold::value);
+  tuning.factorize_blocked_min_dim =
+    max2(tuning.factorize_blocked_min_dim, isize(0));
+  tuning.rank_r_update_chunk =
+    clamp(tuning.rank_r_update_chunk, 1, max_rank_r_update_chunk::value);
+  return tuning;
+}
+
+inline auto
+read_dense_tuning(std::string const& path, DenseTuning& tuning) -> bool
+{
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  DenseTuning read = tuning;
+  std::string key;
+  long long value = 0;
+  while (file >> key >> value) {
+    if (key == "factorize_block_size") {
+      read.factorize_block_size = isize(value);
+    } else if (key == "factorize_recursive_threshold") {
+      read.factorize_recursive_threshold = isize(value);
+    } else if (key == "factorize_blocked_min_dim") {
+      read.factorize_blocked_min_dim = isize(value);
+    } else if (key == "rank_r_update_chunk") {
+      read.rank_r_update_chunk = isize(value);
+    }
+    // unknown keys are skipped, for files written by other versions
+  }
+  if (!file.eof()) {
+    return false;
+  }
+  tuning = _detail::clamped_dense_tuning(read);
+  return true;
+}
+
+inline auto
+dense_tuning_mut() noexcept -> DenseTuning&
+{
+  static DenseTuning tuning;
+  return tuning;
+}
+} // namespace _detail
+
+/*!
+ * Returns the tuning of the dense kernels. The default values are used until
+ * it is overridden with set_dense_tuning or load_dense_tuning: no file is read
+ * implicitly.
+ */
+inline auto
+dense_tuning() noexcept -> DenseTuning
+{
+  return _detail::dense_tuning_mut();
+}
+
+/*!
+ * Overrides the tuning of the dense kernels. The values are clamped to their
+ * valid range. This must not be called while a dense kernel is running. The
+ * stack requirements of the factorization are computed from the block size in
+ * use, so this is meant to be called before the solvers are set up: with a
+ * stack sized for a smaller block size, the factorization falls back to its
+ * recursive variant.
+ *
+ * @param tuning new tuning
+ */
+inline void
+set_dense_tuning(DenseTuning tuning) noexcept
+{
+  _detail::dense_tuning_mut() = _detail::clamped_dense_tuning(tuning);
+}
+
+/*!
+ * Reads the tuning of the dense kernels from a file written by
+ * save_dense_tuning, and uses it from now on. Returns false and keeps the
+ * current tuning if the file can not be read.
+ *
+ * @param path path of the file
+ */
+inline auto
+load_dense_tuning(std::string const& path) -> bool
+{
+  DenseTuning tuning = proxsuite::linalg::dense::dense_tuning();
+  if (!_detail::read_dense_tuning(path, tuning)) {
+    return false;
+  }
+  _detail::dense_tuning_mut() = tuning;
+  return true;
+}
+
+/*!
+ * Reads the tuning of the dense kernels from the cache file given by
+ * dense_tuning_cache_path, e.g. written by a previous autotuning, and uses it
+ * from now on. Returns false and keeps the current tuning if there is no such
+ * file or if it can not be read.
+ */
+inline auto
+load_dense_tuning() -> bool
+{
+  std::string path = proxsuite::linalg::dense::dense_tuning_cache_path();
+  return !path.empty() && proxsuite::linalg::dense::load_dense_tuning(path);
+}
+
+/*!
+ * Writes a tuning of the dense kernels to a file, one "key value" pair per
+ * line. Returns false if the file can not be written. The parent directory is
+ * not created.
+ *
+ * @param path path of the file
+ * @param tuning tuning to save
+ */
+inline auto
+save_dense_tuning(std::string const& path, DenseTuning const& tuning) -> bool
+{
+  std::ofstream file(path);
+  file << "factorize_block_size " << tuning.factorize_block_size << '\n'
+       << "factorize_recursive_threshold "
+       << tuning.factorize_recursive_threshold << '\n'
+       << "factorize_blocked_min_dim " << tuning.factorize_blocked_min_dim
+       << '\n'
+       << "rank_r_update_chunk " << tuning.rank_r_update_chunk << '\n';
+  return bool(file);
+}
+
+} // namespace dense
+} // namespace linalg
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_LINALG_DENSE_LDLT_TUNING_HPP */
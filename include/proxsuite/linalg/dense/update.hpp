@@ -6,6 +6,8 @@
 #define PROXSUITE_LINALG_DENSE_LDLT_UPDATE_HPP
 
 #include "proxsuite/linalg/dense/core.hpp"
+#include "proxsuite/linalg/dense/dispatch.hpp"
+#include "proxsuite/linalg/dense/tuning.hpp"
 
 namespace proxsuite {
 namespace linalg {
@@ -48,39 +50,39 @@ unroll(Fn fn)
                        VEG_FWD(fn));
 }
 
-template<typename T, usize N>
+template<typename Pack>
 struct RankUpdateLoadW
 {
-  _simd::Pack<T, N>* p_wr;
-  T const* pw;
+  Pack* p_wr;
+  typename Pack::ScalarType const* pw;
   isize w_stride;
 
   VEG_INLINE void operator()(usize i) const
   {
-    p_wr[i] = _simd::Pack<T, N>::load_unaligned(pw + w_stride * isize(i));
+    p_wr[i] = Pack::load_unaligned(pw + w_stride * isize(i));
   }
 };
 
-template<typename T, usize N>
+template<typename Pack>
 struct RankUpdateUpdateWAndL
 {
-  _simd::Pack<T, N>* p_wr;
-  _simd::Pack<T, N>& p_in_l;
-  _simd::Pack<T, N> const* p_p;
-  _simd::Pack<T, N> const* p_mu;
+  Pack* p_wr;
+  Pack& p_in_l;
+  Pack const* p_p;
+  Pack const* p_mu;
 
   VEG_INLINE void operator()(usize i) const
   {
-    p_wr[i] = _simd::Pack<T, N>::fnmadd(p_p[i], p_in_l, p_wr[i]);
-    p_in_l = _simd::Pack<T, N>::fmadd(p_mu[i], p_wr[i], p_in_l);
+    p_wr[i] = Pack::fnmadd(p_p[i], p_in_l, p_wr[i]);
+    p_in_l = Pack::fmadd(p_mu[i], p_wr[i], p_in_l);
   }
 };
 
-template<typename T, usize N>
+template<typename Pack>
 struct RankUpdateStoreW
 {
-  _simd::Pack<T, N> const* p_wr;
-  T* pw;
+  Pack const* p_wr;
+  typename Pack::ScalarType* pw;
   isize w_stride;
 
   VEG_INLINE void operator()(usize i) const
@@ -89,73 +91,43 @@ struct RankUpdateStoreW
   }
 };
 
-template<usize R, typename T, usize N>
+template<usize R, typename Pack, typename T>
 VEG_INLINE void
 rank_r_update_inner_loop_iter( //
-  _simd::Pack<T, N> const* p_p,
-  _simd::Pack<T, N> const* p_mu,
+  Pack const* p_p,
+  Pack const* p_mu,
   T* inout_l,
   T* pw,
   isize w_stride)
 {
 
-  _simd::Pack<T, N> p_wr[R];
-  _detail::unroll<R>(RankUpdateLoadW<T, N>{ p_wr, pw, w_stride });
-  _simd::Pack<T, N> p_in_l = _simd::Pack<T, N>::load_unaligned(inout_l);
-  _detail::unroll<R>(RankUpdateUpdateWAndL<T, N>{ p_wr, p_in_l, p_p, p_mu });
-  _detail::unroll<R>(RankUpdateStoreW<T, N>{ p_wr, pw, w_stride });
+  Pack p_wr[R];
+  _detail::unroll<R>(RankUpdateLoadW<Pack>{ p_wr, pw, w_stride });
+  Pack p_in_l = Pack::load_unaligned(inout_l);
+  _detail::unroll<R>(RankUpdateUpdateWAndL<Pack>{ p_wr, p_in_l, p_p, p_mu });
+  _detail::unroll<R>(RankUpdateStoreW<Pack>{ p_wr, pw, w_stride });
 
   p_in_l.store_unaligned(inout_l);
 }
 
-template<bool VECTORIZABLE>
-struct RankRUpdateLoopImpl;
-
-template<typename T, usize N>
+template<typename Pack>
 struct RankUpdateLoadPMu
 {
-  _simd::Pack<T, N>* p_p;
-  _simd::Pack<T, N>* p_mu;
-  T const* p;
-  T const* mu;
+  Pack* p_p;
+  Pack* p_mu;
+  typename Pack::ScalarType const* p;
+  typename Pack::ScalarType const* mu;
   VEG_INLINE void operator()(usize i) const
   {
-    p_p[i] = _simd::Pack<T, N>::broadcast(p[i]);
-    p_mu[i] = _simd::Pack<T, N>::broadcast(mu[i]);
-  }
-};
-
-template<>
-struct RankRUpdateLoopImpl<false>
-{
-  template<usize R, typename T>
-  VEG_INLINE static void fn(isize n,
-                            T* inout_l,
-                            T* pw,
-                            isize w_stride,
-                            T const* p,
-                            T const* mu) noexcept
-  {
-    using Pack_ = _simd::Pack<T, 1>;
-    Pack_ p_p[R];
-    Pack_ p_mu[R];
-
-    _detail::unroll<R>(RankUpdateLoadPMu<T, 1>{ p_p, p_mu, p, mu });
-
-    auto inout_l_finish = inout_l + n;
-    while (inout_l < inout_l_finish) {
-      _detail::rank_r_update_inner_loop_iter<R>(
-        p_p, p_mu, inout_l, pw, w_stride);
-      ++inout_l;
-      ++pw;
-    }
+    p_p[i] = Pack::broadcast(p[i]);
+    p_mu[i] = Pack::broadcast(mu[i]);
   }
 };
 
-template<>
-struct RankRUpdateLoopImpl<true>
+template<usize R>
+struct RankRUpdateLoopKernel
 {
-  template<usize R, typename T>
+  template<typename Pack, typename T>
   VEG_INLINE static void fn(isize n,
                             T* inout_l,
                             T* pw,
@@ -167,17 +139,15 @@ struct RankRUpdateLoopImpl<true>
     // best perf if beginning of each pw is aligned
     // should be enforced by the Ldlt class
 
-    using Info = _simd::NativePackInfo<T>;
-    constexpr usize N = Info::N;
+    constexpr usize N = _simd::PackSize<Pack>::value;
     auto inout_l_vectorized_end = inout_l + usize(n) / N * N;
     auto inout_l_end = inout_l + usize(n);
 
     {
-      using Pack = _simd::NativePack<T>;
       Pack p_p[R];
       Pack p_mu[R];
 
-      _detail::unroll<R>(RankUpdateLoadPMu<T, N>{ p_p, p_mu, p, mu });
+      _detail::unroll<R>(RankUpdateLoadPMu<Pack>{ p_p, p_mu, p, mu });
 
       while (inout_l < inout_l_vectorized_end) {
         _detail::rank_r_update_inner_loop_iter<R>(
@@ -191,7 +161,7 @@ struct RankRUpdateLoopImpl<true>
       Pack_ p_p[R];
       Pack_ p_mu[R];
 
-      _detail::unroll<R>(RankUpdateLoadPMu<T, 1>{ p_p, p_mu, p, mu });
+      _detail::unroll<R>(RankUpdateLoadPMu<Pack_>{ p_p, p_mu, p, mu });
 
       while (inout_l < inout_l_end) {
         _detail::rank_r_update_inner_loop_iter<R>(
@@ -204,7 +174,7 @@ struct RankRUpdateLoopImpl<true>
 };
 
 template<usize R, typename T>
-VEG_INLINE void
+VEG_NO_INLINE void
 rank_r_update_inner_loop(isize n,
                          T* inout_l,
                          T* pw,
@@ -212,18 +182,20 @@ rank_r_update_inner_loop(isize n,
                          T const* p,
                          T const* mu)
 {
-  RankRUpdateLoopImpl<should_vectorize<T>::value>::template fn<R>(
+  _detail::dispatch<RankRUpdateLoopKernel<R>, T>(
     n, inout_l, pw, w_stride, p, mu);
 }
 
+// applies at most max_chunk rank one updates per sweep over the factor
 template<typename LD, typename T, typename Fn>
 void
-rank_r_update_clobber_w_impl( //
+rank_r_update_clobber_w_chunked_impl( //
   LD ld,
   T* pw,
   isize w_stride,
   T* palpha,
-  Fn r_fn)
+  Fn r_fn,
+  isize max_chunk)
 {
   static_assert(LD::InnerStrideAtCompileTime == 1, ".");
   static_assert(!bool(LD::IsRowMajor), ".");
@@ -239,7 +211,7 @@ rank_r_update_clobber_w_impl( //
     }
 
     while (true) {
-      isize r_chunk = min2(isize(4), r - r_done);
+      isize r_chunk = min2(max_chunk, r - r_done);
 
       T p_array[4];
       T mu_array[4];
@@ -269,9 +241,10 @@ rank_r_update_clobber_w_impl( //
         rank_r_update_inner_loop<4, T>,
       };
 
+      // the columns are contiguous, which also holds for the packed storage
       (*fn_table[r_chunk - 1])( //
         rem,
-        util::matrix_elem_addr(ld, j + 1, j),
+        proxsuite::linalg::veg::mem::addressof(ld(j, j)) + 1,
         pw + 1 + r_done * w_stride,
         w_stride,
         p_array,
@@ -285,6 +258,24 @@ rank_r_update_clobber_w_impl( //
     ++pw;
   }
 }
+
+template<typename LD, typename T, typename Fn>
+void
+rank_r_update_clobber_w_impl( //
+  LD ld,
+  T* pw,
+  isize w_stride,
+  T* palpha,
+  Fn r_fn)
+{
+  _detail::rank_r_update_clobber_w_chunked_impl(
+    ld,
+    pw,
+    w_stride,
+    palpha,
+    r_fn,
+    proxsuite::linalg::dense::dense_tuning().rank_r_update_chunk);
+}
 struct ConstantR
 {
   isize r;
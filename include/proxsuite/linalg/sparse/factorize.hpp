@@ -6,6 +6,7 @@
 #define PROXSUITE_LINALG_SPARSE_LDLT_FACTORIZE_HPP
 
 #include "proxsuite/linalg/sparse/core.hpp"
+#include "proxsuite/helpers/omp.hpp"
 #include <Eigen/OrderingMethods>
 
 namespace proxsuite {
@@ -242,6 +243,276 @@ dense_ltsolve(DenseVecMut<T> x, MatRef<T, I> l) noexcept(false)
   }
 }
 
+/*!
+ * Computes the stack memory requirements of the level schedule computation.
+ *
+ * @param n dimension of the matrix.
+ */
+template<typename I>
+auto
+triangular_solve_levels_req(proxsuite::linalg::veg::Tag<I> /*tag*/,
+                            isize n) noexcept
+  -> proxsuite::linalg::veg::dynstack::StackReq
+{
+  return { n * isize{ sizeof(I) }, alignof(I) };
+}
+
+/*!
+ * Computes a level schedule of the columns of a cholesky factor from its
+ * elimination tree, for `dense_lsolve_levels` if `transpose` is false, or for
+ * `dense_ltsolve_levels` otherwise. The columns of a level only depend on the
+ * columns of the previous levels, so that they can be processed concurrently:
+ * these are the columns at the same height (resp. depth) of the elimination
+ * tree. Since the non zero rows of a column of the factor are ancestors of the
+ * column in the tree, the schedule remains valid for the factors of the
+ * matrices whose sparsity pattern is contained in the factorized one, with the
+ * same ordering.
+ * The columns of the level `k` are `level_cols[level_ptrs[k]]`, ...,
+ * `level_cols[level_ptrs[k + 1] - 1]`.
+ *
+ * @param level_ptrs storage for the start of each level, of size `n + 1`.
+ * @param level_cols storage for the columns sorted by level, of size `n`.
+ * @param parent elimination tree of the factor.
+ * @param n dimension of the factor.
+ * @param transpose whether the schedule is computed for the transposed solve.
+ * @param stack temporary allocation stack
+ *
+ * @return the number of levels.
+ */
+template<typename I>
+auto
+triangular_solve_levels(I* level_ptrs,
+                        I* level_cols,
+                        I const* parent,
+                        isize n,
+                        bool transpose,
+                        DynStackMut stack) noexcept -> isize
+{
+  auto _level = stack.make_new(proxsuite::linalg::veg::Tag<I>{}, isize(n));
+  auto plevel = _level.ptr_mut();
+
+  usize nlevels = 0;
+  if (!transpose) {
+    // the column j has to be processed after its descendants, which scatter
+    // into x_j, and the children of a node come before it
+    for (usize j = 0; j < usize(n); ++j) {
+      auto next = util::wrapping_plus(plevel[j], I(1));
+      if (parent[j] != I(-1)) {
+        auto& parent_level = plevel[util::zero_extend(parent[j])];
+        if (util::zero_extend(parent_level) < util::zero_extend(next)) {
+          parent_level = next;
+        }
+      }
+      if (util::zero_extend(plevel[j]) + 1 > nlevels) {
+        nlevels = util::zero_extend(plevel[j]) + 1;
+      }
+    }
+  } else {
+    // the column j has to be processed after its ancestors, whose x_i it
+    // gathers
+    usize j = usize(n);
+    while (j > 0) {
+      --j;
+      usize level = 0;
+      if (parent[j] != I(-1)) {
+        level = util::zero_extend(plevel[util::zero_extend(parent[j])]) + 1;
+      }
+      plevel[j] = I(level);
+      if (level + 1 > nlevels) {
+        nlevels = level + 1;
+      }
+    }
+  }
+
+  // counting sort of the columns by level
+  for (usize k = 0; k <= nlevels; ++k) {
+    level_ptrs[k] = I(0);
+  }
+  for (usize j = 0; j < usize(n); ++j) {
+    auto& count = level_ptrs[util::zero_extend(plevel[j]) + 1];
+    count = util::wrapping_plus(count, I(1));
+  }
+  for (usize k = 0; k < nlevels; ++k) {
+    level_ptrs[k + 1] = util::wrapping_plus(level_ptrs[k + 1], level_ptrs[k]);
+  }
+  for (usize j = 0; j < usize(n); ++j) {
+    auto& next = level_ptrs[util::zero_extend(plevel[j])];
+    level_cols[util::zero_extend(next)] = I(j);
+    next = util::wrapping_plus(next, I(1));
+  }
+  // level_ptrs[k] now holds the end of the level k, shift it back
+  usize k = nlevels;
+  while (k > 0) {
+    level_ptrs[k] = level_ptrs[k - 1];
+    --k;
+  }
+  level_ptrs[0] = I(0);
+
+  return isize(nlevels);
+}
+
+/*!
+ * Computes the stack memory requirements of `dense_lsolve_levels`.
+ *
+ * @param n dimension of the matrix.
+ * @param nthreads number of threads.
+ */
+template<typename T>
+auto
+dense_lsolve_levels_req(proxsuite::linalg::veg::Tag<T> /*tag*/,
+                        isize n,
+                        isize nthreads) noexcept
+  -> proxsuite::linalg::veg::dynstack::StackReq
+{
+  isize nbufs = nthreads > 1 ? nthreads - 1 : 0;
+  return { n * nbufs * isize{ sizeof(T) }, alignof(T) };
+}
+
+/*!
+ * `l` is unit lower triangular whose diagonal elements are ignored.
+ * Solves `l×y = x` and store the solution in `x`, processing the columns of
+ * each level of the schedule concurrently.
+ * The columns of a level scatter into the rows of the next levels, which may
+ * be shared: the first thread updates `x` directly, and the others accumulate
+ * their updates in a private buffer. The buffers are gathered into a row of
+ * `x` when its column is processed, once all the columns scattering into it
+ * are done.
+ *
+ * @param x RHS of the system, solution storage.
+ * @param l matrix to be inverted.
+ * @param level_ptrs start of each level, computed by
+ * `triangular_solve_levels` with `transpose = false`.
+ * @param level_cols columns sorted by level.
+ * @param nlevels number of levels.
+ * @param nthreads number of threads.
+ * @param stack temporary allocation stack, see `dense_lsolve_levels_req`.
+ */
+template<typename T, typename I>
+void
+dense_lsolve_levels(DenseVecMut<T> x,
+                    MatRef<T, I> l,
+                    I const* level_ptrs,
+                    I const* level_cols,
+                    isize nlevels,
+                    isize nthreads,
+                    DynStackMut stack) noexcept(false)
+{
+  using namespace _detail;
+
+  VEG_ASSERT_ALL_OF(
+    l.nrows() == l.ncols(),
+    x.nrows() == l.nrows()
+    /* l is unit lower triangular */
+  );
+
+  isize n = x.nrows();
+  isize nbufs = nthreads > 1 ? nthreads - 1 : 0;
+
+  auto pli = l.row_indices();
+  auto plx = l.values();
+  auto px = x.as_slice_mut().ptr_mut();
+
+  // the buffer of the thread t > 0 starts at (t - 1) * n
+  auto _buf = stack.make_new(proxsuite::linalg::veg::Tag<T>{}, n * nbufs);
+  auto pbuf = _buf.ptr_mut();
+
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+  {
+    isize t = isize(proxsuite::helpers::get_thread_num());
+    T* pxt = t == 0 ? px : pbuf + (t - 1) * n;
+
+    for (isize k = 0; k < nlevels; ++k) {
+      isize level_start = isize(util::zero_extend(level_ptrs[k]));
+      isize level_end = isize(util::zero_extend(level_ptrs[k + 1]));
+
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+      for (isize q = level_start; q < level_end; ++q) {
+        auto j = util::zero_extend(level_cols[q]);
+        auto col_start = l.col_start(j);
+        auto col_end = l.col_end(j);
+
+        auto xj = px[j];
+        for (isize s = 0; s < nbufs; ++s) {
+          xj += pbuf[s * n + isize(j)];
+        }
+        px[j] = xj;
+
+        // skip the diagonal entry
+        for (usize p = col_start + 1; p < col_end; ++p) {
+          auto i = util::zero_extend(pli[p]);
+          pxt[i] -= plx[p] * xj;
+        }
+      }
+    }
+  }
+}
+
+/*!
+ * `l` is unit lower triangular whose diagonal elements are ignored.
+ * Solves `l.T×y = x` and store the solution in `x`, processing the columns of
+ * each level of the schedule concurrently.
+ *
+ * @param x RHS of the system, solution storage.
+ * @param l matrix to be inverted.
+ * @param level_ptrs start of each level, computed by
+ * `triangular_solve_levels` with `transpose = true`.
+ * @param level_cols columns sorted by level.
+ * @param nlevels number of levels.
+ * @param nthreads number of threads.
+ */
+template<typename T, typename I>
+void
+dense_ltsolve_levels(DenseVecMut<T> x,
+                     MatRef<T, I> l,
+                     I const* level_ptrs,
+                     I const* level_cols,
+                     isize nlevels,
+                     isize nthreads) noexcept(false)
+{
+  using namespace _detail;
+
+  VEG_ASSERT_ALL_OF(
+    l.nrows() == l.ncols(),
+    x.nrows() == l.nrows()
+    /* l is unit lower triangular */
+  );
+
+  auto pli = l.row_indices();
+  auto plx = l.values();
+  auto px = x.as_slice_mut().ptr_mut();
+  (void)nthreads;
+
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+  for (isize k = 0; k < nlevels; ++k) {
+    isize level_start = isize(util::zero_extend(level_ptrs[k]));
+    isize level_end = isize(util::zero_extend(level_ptrs[k + 1]));
+
+    // each column only writes its own x_j
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+    for (isize q = level_start; q < level_end; ++q) {
+      auto j = util::zero_extend(level_cols[q]);
+      auto col_start = l.col_start(j);
+      auto col_end = l.col_end(j);
+      T acc = 0;
+
+      // skip the diagonal entry
+      for (usize p = col_start + 1; p < col_end; ++p) {
+        auto i = util::zero_extend(pli[p]);
+        acc += plx[p] * px[i];
+      }
+      px[j] -= acc;
+    }
+  }
+}
+
 /*!
  * Computes the stack memory requirements of etree computation.
  *
@@ -716,12 +987,30 @@ column_counts(I* counts,
 
 template<typename I>
 auto
-amd_req(proxsuite::linalg::veg::Tag<I> /*tag*/, isize /*n*/, isize nnz) noexcept
+amd_req(proxsuite::linalg::veg::Tag<I> /*tag*/, isize n, isize nnz) noexcept
   -> proxsuite::linalg::veg::dynstack::StackReq
 {
-  return { nnz * isize{ sizeof(char) }, alignof(char) };
+  using proxsuite::linalg::veg::dynstack::StackReq;
+  constexpr isize sz{ sizeof(I) };
+  constexpr isize al{ alignof(I) };
+
+  return StackReq{ (n + 1) * sz, al } &   // col ptrs
+         StackReq{ (nnz + n) * sz, al } & // row indices
+         StackReq{ (nnz + n) * isize{ sizeof(char) }, alignof(char) };
 }
 
+/*!
+ * Computes a fill-reducing ordering of the symmetric matrix whose upper
+ * triangular part is given by `mat`.
+ *
+ * The ordering is computed on the pattern of `mat` with an explicit diagonal,
+ * since eigen's amd orders the nodes without a structural diagonal element
+ * last. For a KKT matrix, this would otherwise put every constraint last.
+ *
+ * @param perm storage for the permutation, of size `n`
+ * @param mat upper triangular part of the matrix
+ * @param stack temporary allocation stack
+ */
 template<typename I>
 void
 amd(I* perm, SymbolicMatRef<I> mat, DynStackMut stack) noexcept
@@ -729,21 +1018,47 @@ amd(I* perm, SymbolicMatRef<I> mat, DynStackMut stack) noexcept
   // TODO: reimplement amd under BSD-3
   // https://github.com/DrTimothyAldenDavis/SuiteSparse/tree/master/AMD
 
+  proxsuite::linalg::veg::Tag<I> tag{};
   isize n = mat.nrows();
   isize nnz = mat.nnz();
+  I const* mi = mat.row_indices();
+
+  auto _col_ptrs = stack.make_new_for_overwrite(tag, n + 1);
+  auto _row_indices = stack.make_new_for_overwrite(tag, nnz + n);
+  I* col_ptrs = _col_ptrs.ptr_mut();
+  I* row_indices = _row_indices.ptr_mut();
+
+  // the strictly upper triangular part of each column, followed by its
+  // diagonal element
+  usize pos = 0;
+  col_ptrs[0] = I(0);
+  for (usize j = 0; j < usize(n); ++j) {
+    auto col_start = mat.col_start(j);
+    auto col_end = mat.col_end(j);
+    for (usize p = col_start; p < col_end; ++p) {
+      usize i = util::zero_extend(mi[p]);
+      if (i < j) {
+        row_indices[pos] = I(i);
+        ++pos;
+      }
+    }
+    row_indices[pos] = I(j);
+    ++pos;
+    col_ptrs[j + 1] = I(pos);
+  }
 
   Eigen::PermutationMatrix<-1, -1, I> perm_eigen;
-  auto _ = stack.make_new(proxsuite::linalg::veg::Tag<char>{}, nnz);
+  auto _ = stack.make_new(proxsuite::linalg::veg::Tag<char>{}, isize(pos));
 
   Eigen::AMDOrdering<I>{}(
     Eigen::Map<Eigen::SparseMatrix<char, Eigen::ColMajor, I> const>{
       n,
       n,
-      nnz,
-      mat.col_ptrs(),
-      mat.row_indices(),
+      isize(pos),
+      col_ptrs,
+      row_indices,
       _.ptr(),
-      mat.nnz_per_col(),
+      nullptr,
     }
       .template selfadjointView<Eigen::Upper>(),
 
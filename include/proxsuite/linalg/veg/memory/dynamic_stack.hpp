@@ -222,6 +222,21 @@ public:
   DynStackMut(FromSliceMut /*tag*/, SliceMut<unsigned char> s) VEG_NOEXCEPT
     : stack_data(s.ptr_mut())
     , stack_bytes(s.len())
+    , stack_begin(s.ptr_mut())
+    , peak_bytes(nullptr)
+  {
+  }
+
+  // same as above, and records in *peak the largest number of bytes used
+  // since the beginning of s, by this stack and the ones copied from it. *peak
+  // is only increased, so it can accumulate the usage of several stacks
+  DynStackMut(FromSliceMut /*tag*/,
+              SliceMut<unsigned char> s,
+              isize* peak) VEG_NOEXCEPT
+    : stack_data(s.ptr_mut())
+    , stack_bytes(s.len())
+    , stack_begin(s.ptr_mut())
+    , peak_bytes(peak)
   {
   }
 
@@ -241,6 +256,17 @@ private:
     VEG_INTERNAL_ASSERT_PRECONDITIONS(isize(len) >= 0);
   }
 
+  VEG_INLINE void record_peak() VEG_NOEXCEPT
+  {
+    if (peak_bytes != nullptr) {
+      isize used = isize(static_cast<unsigned char*>(stack_data) -
+                         static_cast<unsigned char*>(stack_begin));
+      if (*peak_bytes < used) {
+        *peak_bytes = used;
+      }
+    }
+  }
+
 public:
   VEG_TEMPLATE((typename T),
                requires VEG_CONCEPT(constructible<T>),
@@ -292,6 +318,8 @@ public:
 private:
   void* stack_data;
   isize stack_bytes;
+  void* stack_begin;
+  isize* peak_bytes;
 
   template<typename T>
   friend struct DynStackAlloc;
@@ -451,6 +479,7 @@ private:
 
       Base::len = alloc_size;
       Base::data = fn.template make<T>(ptr, alloc_size);
+      parent_ref.record_peak();
 
       success = true;
     }
@@ -6,5 +6,6 @@
 #define PROXSUITE_QP_DENSE_DENSE_HPP
 
 #include "proxsuite/proxqp/dense/wrapper.hpp" // includes everything
+#include "proxsuite/proxqp/dense/serialization.hpp"
 
 #endif /* end of include guard PROXSUITE_QP_DENSE_DENSE_HPP */
@@ -22,6 +22,10 @@ template<typename T>
 using VecRef = Eigen::Ref<Eigen::Matrix<T, DYN, 1> const>;
 template<typename T>
 using MatRef = Eigen::Ref<Eigen::Matrix<T, DYN, DYN> const>;
+// matrices stored in the layout of the model, which are copied into it without
+// any transposition
+template<typename T>
+using RowMatRef = Eigen::Ref<Eigen::Matrix<T, DYN, DYN, layout> const>;
 template<typename T>
 using Mat = Eigen::Matrix<T, DYN, DYN, layout>;
 template<typename T>
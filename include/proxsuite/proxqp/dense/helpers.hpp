@@ -71,10 +71,10 @@ setup_factorization(Workspace<T>& qpwork,
                     Results<T>& qpresults)
 {
 
-  proxsuite::linalg::veg::dynstack::DynStackMut stack{
-    proxsuite::linalg::veg::from_slice_mut,
-    qpwork.ldl_stack.as_mut(),
-  };
+  proxsuite::linalg::veg::dynstack::DynStackMut stack = qpwork.ldl_stack_mut(
+    StackSite::FACTORIZATION,
+    proxsuite::linalg::dense::Ldlt<T>::factorize_req(qpmodel.dim +
+                                                     qpmodel.n_eq));
 
   qpwork.kkt.topLeftCorner(qpmodel.dim, qpmodel.dim) = qpwork.H_scaled;
   qpwork.kkt.topLeftCorner(qpmodel.dim, qpmodel.dim).diagonal().array() +=
@@ -100,13 +100,17 @@ setup_factorization(Workspace<T>& qpwork,
  * preconditioner. If set to False, it uses the previous preconditioning
  * variables (initialized to the identity preconditioner if it is the first
  * scaling performed).
+ * @param incremental if set to true together with execute_preconditioner, the
+ * previous preconditioning variables are refined rather than recomputed from
+ * scratch.
  */
 template<typename T>
 void
 setup_equilibration(Workspace<T>& qpwork,
                     const Settings<T>& qpsettings,
                     preconditioner::RuizEquilibration<T>& ruiz,
-                    bool execute_preconditioner)
+                    bool execute_preconditioner,
+                    bool incremental = false)
 {
 
   QpViewBoxMut<T> qp_scaled{
@@ -116,15 +120,25 @@ setup_equilibration(Workspace<T>& qpwork,
     { from_eigen, qpwork.l_scaled }
   };
 
-  proxsuite::linalg::veg::dynstack::DynStackMut stack{
-    proxsuite::linalg::veg::from_slice_mut,
-    qpwork.ldl_stack.as_mut(),
-  };
-  ruiz.scale_qp_in_place(qp_scaled,
-                         execute_preconditioner,
-                         qpsettings.preconditioner_max_iter,
-                         qpsettings.preconditioner_accuracy,
-                         stack);
+  proxsuite::linalg::veg::dynstack::DynStackMut stack = qpwork.ldl_stack_mut(
+    StackSite::EQUILIBRATION,
+    preconditioner::RuizEquilibration<T>::scale_qp_in_place_req(
+      proxsuite::linalg::veg::Tag<T>{},
+      qpwork.H_scaled.rows(),
+      qpwork.A_scaled.rows(),
+      qpwork.C_scaled.rows()));
+  if (execute_preconditioner && incremental) {
+    ruiz.scale_qp_in_place_incremental(qp_scaled,
+                                       qpsettings.preconditioner_max_iter,
+                                       qpsettings.preconditioner_accuracy,
+                                       stack);
+  } else {
+    ruiz.scale_qp_in_place(qp_scaled,
+                           execute_preconditioner,
+                           qpsettings.preconditioner_max_iter,
+                           qpsettings.preconditioner_accuracy,
+                           stack);
+  }
   qpwork.correction_guess_rhs_g = infty_norm(qpwork.g_scaled);
 }
 
@@ -253,54 +267,30 @@ update(std::optional<Mat> H_,
     work.refactorize = true;
     if (A_ != std::nullopt) {
       if (C_ != std::nullopt) {
-        model.H = Eigen::
-          Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-            H_.value());
-        model.A = Eigen::
-          Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-            A_.value());
-        model.C = Eigen::
-          Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-            C_.value());
+        model.H = H_.value();
+        model.A = A_.value();
+        model.C = C_.value();
       } else {
-        model.H = Eigen::
-          Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-            H_.value());
-        model.A = Eigen::
-          Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-            A_.value());
+        model.H = H_.value();
+        model.A = A_.value();
       }
     } else if (C_ != std::nullopt) {
-      model.H = Eigen::
-        Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-          H_.value());
-      model.C = Eigen::
-        Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-          C_.value());
+      model.H = H_.value();
+      model.C = C_.value();
     } else {
-      model.H = Eigen::
-        Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-          H_.value());
+      model.H = H_.value();
     }
   } else if (A_ != std::nullopt) {
     work.refactorize = true;
     if (C_ != std::nullopt) {
-      model.A = Eigen::
-        Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-          A_.value());
-      model.C = Eigen::
-        Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-          C_.value());
+      model.A = A_.value();
+      model.C = C_.value();
     } else {
-      model.A = Eigen::
-        Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-          A_.value());
+      model.A = A_.value();
     }
   } else if (C_ != std::nullopt) {
     work.refactorize = true;
-    model.C = Eigen::
-      Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-        C_.value());
+    model.C = C_.value();
   }
 }
 /*!
@@ -390,19 +380,22 @@ setup( //
       break;
     }
   }
+  // the layout of the factor is chosen before its storage is reserved, so that
+  // a full factor is never allocated when the packed one is requested
+  qpwork.ldl.set_packed_storage(qpsettings.dense_packed_ldlt);
+  qpwork.ldl.reserve_uninit(qpmodel.dim + qpmodel.n_eq + qpmodel.n_in);
+
+  // the matrices are assigned in place, reusing the storage of the model, and
+  // matrices in its row major layout are copied without transposition
   if (H != std::nullopt) {
-    qpmodel.H = Eigen::
-      Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-        H.value());
+    qpmodel.H = H.value();
   } // else qpmodel.H remains initialzed to a matrix with zero elements
   if (g != std::nullopt) {
     qpmodel.g = g.value();
   }
 
   if (A != std::nullopt) {
-    qpmodel.A = Eigen::
-      Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-        A.value());
+    qpmodel.A = A.value();
   } // else qpmodel.A remains initialized to a matrix with zero elements or zero
     // shape
 
@@ -412,9 +405,7 @@ setup( //
     // shape
 
   if (C != std::nullopt) {
-    qpmodel.C = Eigen::
-      Matrix<T, Eigen::Dynamic, Eigen::Dynamic, to_eigen_layout(rowmajor)>(
-        C.value());
+    qpmodel.C = C.value();
   } // else qpmodel.C remains initialized to a matrix with zero elements or zero
     // shape
 
@@ -460,6 +451,10 @@ setup( //
       // keep previous one
       setup_equilibration(qpwork, qpsettings, ruiz, false);
       break;
+    case PreconditionerStatus::INCREMENTAL:
+      // refine previous one
+      setup_equilibration(qpwork, qpsettings, ruiz, true, true);
+      break;
   }
 }
 ////// UPDATES ///////
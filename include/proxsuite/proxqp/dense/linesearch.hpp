@@ -420,10 +420,34 @@ active_set_change(const Model<T>& qpmodel,
 
   // suppression pour le nouvel active set, ajout dans le nouvel unactive set
 
-  proxsuite::linalg::veg::dynstack::DynStackMut stack{
-    proxsuite::linalg::veg::from_slice_mut, qpwork.ldl_stack.as_mut()
+  // numbers of constraints leaving and entering the active set, which
+  // determine the memory needed below
+  isize n_deleted = 0;
+  isize n_added = 0;
+  for (isize i = 0; i < qpmodel.n_in; i++) {
+    bool active = qpwork.current_bijection_map(i) < qpwork.n_c;
+    if (active && !qpwork.active_inequalities(i)) {
+      ++n_deleted;
+    }
+    if (!active && qpwork.active_inequalities(i)) {
+      ++n_added;
+    }
+  }
+  isize n_kept = qpmodel.dim + qpmodel.n_eq + qpwork.n_c - n_deleted;
+  auto indices_req = proxsuite::linalg::veg::dynstack::StackReq{
+    isize{ sizeof(isize) } * qpmodel.n_in, alignof(isize)
   };
 
+  proxsuite::linalg::veg::dynstack::DynStackMut stack = qpwork.ldl_stack_mut(
+    StackSite::ACTIVE_SET_CHANGE,
+    (indices_req & proxsuite::linalg::dense::Ldlt<T>::delete_at_req(
+                     n_kept + n_deleted, n_deleted)) |
+      (indices_req &
+       proxsuite::linalg::dense::temp_mat_req(
+         proxsuite::linalg::veg::Tag<T>{}, n_kept + n_added, n_added) &
+       proxsuite::linalg::dense::Ldlt<T>::insert_block_at_req(n_kept,
+                                                              n_added)));
+
   {
     auto _planned_to_delete = stack.make_new_for_overwrite(
       proxsuite::linalg::veg::Tag<isize>{}, isize(qpmodel.n_in));
@@ -10,6 +10,7 @@
 #include "proxsuite/proxqp/dense/views.hpp"
 #include "proxsuite/proxqp/dense/fwd.hpp"
 #include <proxsuite/linalg/dense/core.hpp>
+#include <proxsuite/helpers/omp.hpp>
 #include <ostream>
 
 #include <Eigen/Core>
@@ -25,6 +26,267 @@ enum struct Symmetry
 namespace dense {
 namespace detail {
 
+/// minimal number of coefficients each thread is given by the parallel
+/// equilibration sweeps, below which the serial sweep is used
+constexpr isize ruiz_min_coeffs_per_thread = 16384;
+
+/*!
+ * Equilibration sweep over the rows [row_begin, row_end) of the concatenation
+ * of H, A and C (stored by rows), in the general storage. If delta is not
+ * null, the rows are scaled in place, those of H being also multiplied by
+ * gamma. In any case, the infinity norms of the (scaled) rows of A and C are
+ * written to cstr_norm, and those of the columns of H (resp. A and C) are
+ * accumulated to h_norm (resp. ac_norm). Each row is processed with vectorized
+ * operations.
+ */
+template<typename T>
+void
+ruiz_sweep_rows_general(T* h_norm,
+                        T* ac_norm,
+                        T* cstr_norm,
+                        QpViewBoxMut<T> qp,
+                        T const* delta,
+                        T gamma,
+                        isize row_begin,
+                        isize row_end)
+{
+  isize n = qp.H.rows;
+  isize n_eq = qp.A.rows;
+
+  auto H = qp.H.to_eigen();
+  auto A = qp.A.to_eigen();
+  auto C = qp.C.to_eigen();
+
+  Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, 1>> h_norm_(h_norm, n);
+  Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, 1>> ac_norm_(ac_norm, n);
+
+  for (isize k = row_begin; k < row_end; ++k) {
+    if (k < n) {
+      auto row = H.row(k);
+      if (delta != nullptr) {
+        Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, 1> const> delta_x(delta,
+                                                                      n);
+        row.array() *= (gamma * delta[k]) * delta_x.transpose().array();
+      }
+      h_norm_ = h_norm_.cwiseMax(row.transpose().cwiseAbs());
+    } else {
+      auto row = (k < n + n_eq) ? A.row(k - n) : C.row(k - n - n_eq);
+      if (delta != nullptr) {
+        Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, 1> const> delta_x(delta,
+                                                                      n);
+        row.array() *= delta[k] * delta_x.transpose().array();
+      }
+      T norm_k = T(0);
+      for (isize j = 0; j < n; ++j) {
+        T akj = std::abs(row(j));
+        norm_k = std::max(norm_k, akj);
+        ac_norm[j] = std::max(ac_norm[j], akj);
+      }
+      cstr_norm[k - n] = norm_k;
+    }
+  }
+}
+
+/*!
+ * Computes the stack memory requirements of ruiz_sweep_general, for the given
+ * number of threads.
+ */
+template<typename T>
+auto
+ruiz_sweep_general_req(proxsuite::linalg::veg::Tag<T> tag,
+                       isize n,
+                       isize nthreads) noexcept
+  -> proxsuite::linalg::veg::dynstack::StackReq
+{
+  if (nthreads <= 1) {
+    return { 0, 1 };
+  }
+  return proxsuite::linalg::dense::temp_mat_req(tag, n, 2 * nthreads);
+}
+
+/*!
+ * Equilibration sweep over H, A and C, see ruiz_sweep_rows_general. The rows
+ * are split among threads in contiguous ranges, the column norms computed by
+ * each thread being reduced at the end. The number of threads is limited by
+ * the memory left in the stack, see ruiz_sweep_general_req.
+ */
+template<typename T>
+void
+ruiz_sweep_general(T* h_norm,
+                   T* ac_norm,
+                   T* cstr_norm,
+                   QpViewBoxMut<T> qp,
+                   T const* delta,
+                   T gamma,
+                   proxsuite::linalg::veg::dynstack::DynStackMut stack)
+{
+  isize n = qp.H.rows;
+  isize n_rows = n + qp.A.rows + qp.C.rows;
+
+  for (isize i = 0; i < n; ++i) {
+    h_norm[i] = 0;
+    ac_norm[i] = 0;
+  }
+
+  isize nthreads = isize(proxsuite::helpers::get_num_threads_for(
+    n * n_rows, ruiz_min_coeffs_per_thread));
+  while (nthreads > 1 &&
+         ruiz_sweep_general_req(proxsuite::linalg::veg::Tag<T>{}, n, nthreads)
+             .alloc_req() > stack.remaining_bytes()) {
+    --nthreads;
+  }
+  if (nthreads == 1) {
+    ruiz_sweep_rows_general(
+      h_norm, ac_norm, cstr_norm, qp, delta, gamma, 0, n_rows);
+    return;
+  }
+
+  LDLT_TEMP_MAT(T, buf, n, 2 * nthreads, stack);
+
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+#endif
+  for (isize t = 0; t < nthreads; ++t) {
+    ruiz_sweep_rows_general(buf.col(2 * t).data(),
+                            buf.col(2 * t + 1).data(),
+                            cstr_norm,
+                            qp,
+                            delta,
+                            gamma,
+                            n_rows * t / nthreads,
+                            n_rows * (t + 1) / nthreads);
+  }
+
+  for (isize t = 0; t < nthreads; ++t) {
+    for (isize i = 0; i < n; ++i) {
+      h_norm[i] = std::max(h_norm[i], buf(i, 2 * t));
+      ac_norm[i] = std::max(ac_norm[i], buf(i, 2 * t + 1));
+    }
+  }
+}
+
+/*!
+ * Ruiz equilibration of a qp whose cost matrix is stored in full. Each
+ * iteration scales H, A and C and computes the norms required by the next one
+ * in a single sweep. If incremental is set to true, the entries of the scaling
+ * whose update is within epsilon of one are kept fixed, so that only the rows
+ * and columns which are not equilibrated yet are rescaled.
+ */
+template<typename T>
+auto
+ruiz_scale_qp_in_place_general( //
+  VectorViewMut<T> delta_,
+  std::ostream* logger_ptr,
+  QpViewBoxMut<T> qp,
+  T epsilon,
+  isize max_iter,
+  proxsuite::linalg::veg::dynstack::DynStackMut stack,
+  bool incremental = false) -> T
+{
+  T c(1);
+  auto S = delta_.to_eigen();
+
+  auto H = qp.H.to_eigen();
+  auto g = qp.g.to_eigen();
+  auto b = qp.b.to_eigen();
+  auto u = qp.u.to_eigen();
+  auto l = qp.l.to_eigen();
+
+  static constexpr T machine_eps = std::numeric_limits<T>::epsilon();
+
+  isize n = qp.H.rows;
+  isize n_eq = qp.A.rows;
+  isize n_in = qp.C.rows;
+
+  T gamma = T(1);
+
+  LDLT_TEMP_VEC(T, delta, n + n_eq + n_in, stack);
+  LDLT_TEMP_VEC(T, h_infty_norm, n, stack);
+  LDLT_TEMP_VEC(T, ac_infty_norm, n, stack);
+  LDLT_TEMP_VEC(T, cstr_infty_norm, n_eq + n_in, stack);
+
+  detail::ruiz_sweep_general(h_infty_norm.data(),
+                             ac_infty_norm.data(),
+                             cstr_infty_norm.data(),
+                             qp,
+                             static_cast<T const*>(nullptr),
+                             T(1),
+                             stack);
+
+  i64 iter = 1;
+
+  // the cost scaling gamma of an iteration is only applied to H by the sweep
+  // of the next one (or at the end), the norms of H being scaled accordingly
+  while (infty_norm((1 - delta.array()).matrix()) > epsilon) {
+    if (logger_ptr != nullptr) {
+      *logger_ptr                                   //
+        << "j : "                                   //
+        << iter                                     //
+        << " ; error : "                            //
+        << infty_norm((1 - delta.array()).matrix()) //
+        << "\n\n";
+    }
+    if (iter == max_iter) {
+      break;
+    } else {
+      ++iter;
+    }
+
+    // normalization vector
+    for (isize k = 0; k < n; ++k) {
+      T aux = sqrt(std::max(gamma * h_infty_norm(k), ac_infty_norm(k)));
+      if (aux == T(0)) {
+        delta(k) = T(1);
+      } else {
+        delta(k) = T(1) / (aux + machine_eps);
+      }
+    }
+    for (isize k = 0; k < n_eq + n_in; ++k) {
+      T aux = sqrt(cstr_infty_norm(k));
+      if (aux == T(0)) {
+        delta(n + k) = T(1);
+      } else {
+        delta(n + k) = T(1) / (aux + machine_eps);
+      }
+    }
+    if (incremental) {
+      for (isize k = 0; k < n + n_eq + n_in; ++k) {
+        if (std::abs(T(1) - delta(k)) <= epsilon) {
+          delta(k) = T(1);
+        }
+      }
+    }
+
+    // normalize H, A and C, and compute the norms of the normalized matrices
+    detail::ruiz_sweep_general(h_infty_norm.data(),
+                               ac_infty_norm.data(),
+                               cstr_infty_norm.data(),
+                               qp,
+                               delta.data(),
+                               gamma,
+                               stack);
+
+    // normalize vectors
+    g.array() *= delta.head(n).array();
+    b.array() *= delta.middleRows(n, n_eq).array();
+    u.array() *= delta.tail(n_in).array();
+    l.array() *= delta.tail(n_in).array();
+
+    // additional normalization for the cost function
+    gamma = 1 / std::max(T(1), h_infty_norm.mean());
+
+    g *= gamma;
+
+    S.array() *= delta.array(); // coefficientwise product
+    c *= gamma;
+  }
+
+  if (gamma != T(1)) {
+    H *= gamma;
+  }
+  return c;
+}
+
 template<typename T>
 auto
 ruiz_scale_qp_in_place( //
@@ -34,8 +296,14 @@ ruiz_scale_qp_in_place( //
   T epsilon,
   isize max_iter,
   Symmetry sym,
-  proxsuite::linalg::veg::dynstack::DynStackMut stack) -> T
+  proxsuite::linalg::veg::dynstack::DynStackMut stack,
+  bool incremental = false) -> T
 {
+  if (sym == Symmetry::general) {
+    return detail::ruiz_scale_qp_in_place_general(
+      delta_, logger_ptr, qp, epsilon, max_iter, stack, incremental);
+  }
+
 
   T c(1);
   auto S = delta_.to_eigen();
@@ -114,20 +382,8 @@ ruiz_scale_qp_in_place( //
             }
             break;
           }
-          case Symmetry::general: {
-
-            T aux = sqrt(std::max({
-              infty_norm(H.col(k)),
-              infty_norm(A.col(k)),
-              infty_norm(C.col(k)),
-            }));
-            if (aux == T(0)) {
-              delta(k) = T(1);
-            } else {
-              delta(k) = T(1) / (aux + machine_eps);
-            }
+          default:
             break;
-          }
         }
       }
 
@@ -183,11 +439,6 @@ ruiz_scale_qp_in_place( //
           }
           break;
         }
-        case Symmetry::general: {
-          // all matrix
-          H = delta.head(n).asDiagonal() * H * delta.head(n).asDiagonal();
-          break;
-        }
         default:
           break;
       }
@@ -212,14 +463,6 @@ ruiz_scale_qp_in_place( //
           gamma = 1 / std::max(tmp / T(n), T(1));
           break;
         }
-        case Symmetry::general: {
-          // all matrix
-          gamma =
-            1 /
-            std::max(T(1),
-                     (H.colwise().template lpNorm<Eigen::Infinity>()).mean());
-          break;
-        }
         default:
           break;
       }
@@ -296,7 +539,12 @@ struct RuizEquilibration
                                     isize n_in)
     -> proxsuite::linalg::veg::dynstack::StackReq
   {
-    return proxsuite::linalg::dense::temp_vec_req(tag, n + n_eq + n_in);
+    return proxsuite::linalg::dense::temp_vec_req(tag, n + n_eq + n_in) &
+           proxsuite::linalg::dense::temp_vec_req(tag, n) &
+           proxsuite::linalg::dense::temp_vec_req(tag, n) &
+           proxsuite::linalg::dense::temp_vec_req(tag, n_eq + n_in) &
+           detail::ruiz_sweep_general_req(
+             tag, n, isize(proxsuite::helpers::get_max_threads()));
   }
 
   // H_new = c * head @ H @ head
@@ -388,6 +636,32 @@ struct RuizEquilibration
       H *= c;
     }
   }
+  /*!
+   * Scales in place a qp whose matrices may differ from those the current
+   * scaling was computed for. The qp is first scaled with the current scaling,
+   * then the equilibration is resumed from it, only rescaling the rows and
+   * columns which are no longer equilibrated.
+   * @param qp qp to be scaled (in place).
+   * @param max_iter maximal number of equilibration iterations.
+   * @param epsilon accuracy of the equilibration.
+   * @param stack stack variable used by the equilibrator.
+   */
+  void scale_qp_in_place_incremental(
+    QpViewBoxMut<T> qp,
+    const isize max_iter,
+    const T epsilon,
+    proxsuite::linalg::veg::dynstack::DynStackMut stack)
+  {
+    scale_qp_in_place(qp, false, max_iter, epsilon, stack);
+    c *= detail::ruiz_scale_qp_in_place({ proxqp::from_eigen, delta },
+                                        logger_ptr,
+                                        qp,
+                                        epsilon,
+                                        max_iter,
+                                        sym,
+                                        stack,
+                                        true);
+  }
   /*!
    * Scales the qp performing the ruiz equilibrator algorithm considering user
    * options.
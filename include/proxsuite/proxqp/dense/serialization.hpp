@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2022 INRIA
+//
+/**
+ * @file serialization.hpp
+ */
+#ifndef PROXSUITE_QP_DENSE_SERIALIZATION_HPP
+#define PROXSUITE_QP_DENSE_SERIALIZATION_HPP
+
+#include <proxsuite/proxqp/serialization.hpp>
+#include <proxsuite/proxqp/dense/wrapper.hpp>
+#include <vector>
+
+namespace proxsuite {
+namespace proxqp {
+namespace dense {
+
+namespace _detail {
+template<typename T, typename Out>
+void
+save(Out& out, QP<T> const& qp)
+{
+  serialization::header(out, QPBackend::DENSE, sizeof(T), 0);
+  out(qp.model.dim);
+  out(qp.model.n_eq);
+  out(qp.model.n_in);
+  serialization::visit_settings(qp.settings, out);
+  // the model is stored unscaled, along with the preconditioner which scales
+  // it, so that the equilibration is not executed again when loading it
+  out.dense(qp.model.H);
+  out.dense(qp.model.g);
+  out.dense(qp.model.A);
+  out.dense(qp.model.b);
+  out.dense(qp.model.C);
+  out.dense(qp.model.u);
+  out.dense(qp.model.l);
+  out.dense(qp.ruiz.delta);
+  out(qp.ruiz.c);
+  serialization::save_results(out, qp.results);
+}
+} // namespace _detail
+
+/*!
+ * Returns the size, in bytes, of the serialized QP object.
+ *
+ * @param qp QP object.
+ */
+template<typename T>
+auto
+serialized_size(QP<T> const& qp) -> std::size_t
+{
+  serialization::Writer out;
+  _detail::save(out, qp);
+  return out.size;
+}
+
+/*!
+ * Serializes the QP object (settings, model, preconditioner and results) into
+ * a buffer of serialized_size(qp) bytes, e.g. a shared memory segment.
+ *
+ * @param qp QP object.
+ * @param data beginning of the buffer.
+ */
+template<typename T>
+void
+serialize(QP<T> const& qp, unsigned char* data)
+{
+  serialization::Writer out;
+  out.data = data;
+  _detail::save(out, qp);
+}
+
+/*!
+ * Serializes the QP object (settings, model, preconditioner and results).
+ *
+ * @param qp QP object.
+ */
+template<typename T>
+auto
+serialize(QP<T> const& qp) -> std::vector<unsigned char>
+{
+  std::vector<unsigned char> buffer(serialized_size(qp));
+  serialize(qp, buffer.data());
+  return buffer;
+}
+
+/*!
+ * Rebuilds a QP object from a buffer written by serialize. The model is set up
+ * with the stored preconditioner instead of equilibrating it again, and the
+ * results (hence a warm start) are the ones of the serialized object. Throws
+ * std::invalid_argument if the buffer is not a valid serialized dense QP
+ * object with the scalar type T.
+ *
+ * @param data beginning of the buffer.
+ * @param size size of the buffer, in bytes.
+ */
+template<typename T>
+auto
+deserialize(unsigned char const* data, std::size_t size) -> QP<T>
+{
+  serialization::Reader in{ data, size };
+  serialization::check_header(in, QPBackend::DENSE, sizeof(T), 0);
+  isize dim = 0;
+  isize n_eq = 0;
+  isize n_in = 0;
+  in(dim);
+  in(n_eq);
+  in(n_in);
+  PROXSUITE_THROW_PRETTY(dim <= 0 || n_eq < 0 || n_in < 0,
+                         std::invalid_argument,
+                         "invalid serialized QP: wrong dimensions.");
+  // the buffer holds at least the matrices of the model
+  in.check_remaining(dim, 1, sizeof(T));
+  in.check_remaining(n_eq, 1, sizeof(T));
+  in.check_remaining(n_in, 1, sizeof(T));
+  in.check_remaining(dim + n_eq + n_in, dim, sizeof(T));
+
+  QP<T> qp(dim, n_eq, n_in);
+  serialization::visit_settings(qp.settings, in);
+  Model<T> model(dim, n_eq, n_in);
+  in.dense(model.H);
+  in.dense(model.g);
+  in.dense(model.A);
+  in.dense(model.b);
+  in.dense(model.C);
+  in.dense(model.u);
+  in.dense(model.l);
+  in.dense(qp.ruiz.delta);
+  in(qp.ruiz.c);
+  Results<T> results(dim, n_eq, n_in);
+  serialization::load_results(in, results);
+
+  qp.template init<RowMatRef<T>>(model.H,
+                                 model.g,
+                                 model.A,
+                                 model.b,
+                                 model.C,
+                                 model.u,
+                                 model.l,
+                                 false,
+                                 results.info.rho,
+                                 results.info.mu_eq,
+                                 results.info.mu_in);
+  qp.results = results;
+  return qp;
+}
+
+} // namespace dense
+} // namespace proxqp
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_QP_DENSE_SERIALIZATION_HPP */
@@ -52,16 +52,19 @@ refactorize(const Model<T>& qpmodel,
   qpwork.kkt.diagonal().segment(qpmodel.dim, qpmodel.n_eq).array() =
     -qpresults.info.mu_eq;
 
-  proxsuite::linalg::veg::dynstack::DynStackMut stack{
-    proxsuite::linalg::veg::from_slice_mut, qpwork.ldl_stack.as_mut()
-  };
-  qpwork.ldl.factorize(qpwork.kkt, stack);
-
   isize n = qpmodel.dim;
   isize n_eq = qpmodel.n_eq;
   isize n_in = qpmodel.n_in;
   isize n_c = qpwork.n_c;
 
+  proxsuite::linalg::veg::dynstack::DynStackMut stack = qpwork.ldl_stack_mut(
+    StackSite::REFACTORIZATION,
+    proxsuite::linalg::dense::Ldlt<T>::factorize_req(n + n_eq) |
+      (proxsuite::linalg::dense::temp_mat_req(
+         proxsuite::linalg::veg::Tag<T>{}, n + n_eq + n_c, n_c) &
+       proxsuite::linalg::dense::Ldlt<T>::insert_block_at_req(n + n_eq, n_c)));
+  qpwork.ldl.factorize(qpwork.kkt, stack);
+
   LDLT_TEMP_MAT(T, new_cols, n + n_eq + n_c, n_c, stack);
   T mu_in_neg = -qpresults.info.mu_in;
   for (isize i = 0; i < n_in; ++i) {
@@ -99,10 +102,6 @@ mu_update(const Model<T>& qpmodel,
           T mu_eq_new,
           T mu_in_new)
 {
-  proxsuite::linalg::veg::dynstack::DynStackMut stack{
-    proxsuite::linalg::veg::from_slice_mut, qpwork.ldl_stack.as_mut()
-  };
-
   isize n = qpmodel.dim;
   isize n_eq = qpmodel.n_eq;
   isize n_c = qpwork.n_c;
@@ -111,6 +110,15 @@ mu_update(const Model<T>& qpmodel,
     return;
   }
 
+  proxsuite::linalg::veg::dynstack::DynStackMut stack = qpwork.ldl_stack_mut(
+    StackSite::MU_UPDATE,
+    proxsuite::linalg::dense::temp_vec_req(proxsuite::linalg::veg::Tag<T>{},
+                                           n_eq + n_c) &
+      proxsuite::linalg::veg::dynstack::StackReq{
+        isize{ sizeof(isize) } * (n_eq + n_c), alignof(isize) } &
+      proxsuite::linalg::dense::Ldlt<T>::diagonal_update_req(n + n_eq + n_c,
+                                                             n_eq + n_c));
+
   LDLT_TEMP_VEC_UNINIT(T, rank_update_alpha, n_eq + n_c, stack);
   rank_update_alpha.head(n_eq).setConstant(qpresults.info.mu_eq - mu_eq_new);
   rank_update_alpha.tail(n_c).setConstant(qpresults.info.mu_in - mu_in_new);
@@ -204,9 +212,9 @@ iterative_solve_with_permut_fact( //
   i32 it_stability = 0;
 
   qpwork.dw_aug.head(inner_pb_dim) = qpwork.rhs.head(inner_pb_dim);
-  proxsuite::linalg::veg::dynstack::DynStackMut stack{
-    proxsuite::linalg::veg::from_slice_mut, qpwork.ldl_stack.as_mut()
-  };
+  proxsuite::linalg::veg::dynstack::DynStackMut stack = qpwork.ldl_stack_mut(
+    StackSite::LINEAR_SOLVE,
+    proxsuite::linalg::dense::Ldlt<T>::solve_in_place_req(inner_pb_dim));
   qpwork.ldl.solve_in_place(qpwork.dw_aug.head(inner_pb_dim), stack);
 
   iterative_residual<T>(qpmodel, qpresults, qpwork, inner_pb_dim);
@@ -258,8 +266,14 @@ iterative_solve_with_permut_fact( //
     it = 0;
     it_stability = 0;
 
+    // the refactorization may have grown a trimmed ldl_stack, which
+    // invalidates the previous stack
+    proxsuite::linalg::veg::dynstack::DynStackMut refact_stack =
+      qpwork.ldl_stack_mut(
+        StackSite::LINEAR_SOLVE,
+        proxsuite::linalg::dense::Ldlt<T>::solve_in_place_req(inner_pb_dim));
     qpwork.dw_aug.head(inner_pb_dim) = qpwork.rhs.head(inner_pb_dim);
-    qpwork.ldl.solve_in_place(qpwork.dw_aug.head(inner_pb_dim), stack);
+    qpwork.ldl.solve_in_place(qpwork.dw_aug.head(inner_pb_dim), refact_stack);
 
     iterative_residual<T>(qpmodel, qpresults, qpwork, inner_pb_dim);
 
@@ -278,7 +292,7 @@ iterative_solve_with_permut_fact( //
         break;
       }
       ++it;
-      qpwork.ldl.solve_in_place(qpwork.err.head(inner_pb_dim), stack);
+      qpwork.ldl.solve_in_place(qpwork.err.head(inner_pb_dim), refact_stack);
       qpwork.dw_aug.head(inner_pb_dim) += qpwork.err.head(inner_pb_dim);
 
       qpwork.err.head(inner_pb_dim).setZero();
@@ -416,7 +430,7 @@ Martinez_update(const Settings<T>& qpsettings,
 
 )
 {
-  bcl_eta_in = std::max(bcl_eta_in * 0.1, eps_in_min);
+  bcl_eta_in = std::max(bcl_eta_in * T(0.1), eps_in_min);
   if (primal_feasibility_lhs_new <= 0.95 * primal_feasibility_lhs_old) {
     /* TO PUT IN DEBUG MODE
     if (qpsettings.verbose) {
@@ -602,9 +616,12 @@ primal_dual_newton_semi_smooth(const Settings<T>& qpsettings,
     primal_dual_semi_smooth_newton_step<T>(
       qpsettings, qpmodel, qpresults, qpwork, eps_int);
 
-    proxsuite::linalg::veg::dynstack::DynStackMut stack{
-      proxsuite::linalg::veg::from_slice_mut, qpwork.ldl_stack.as_mut()
-    };
+    proxsuite::linalg::veg::dynstack::DynStackMut stack = qpwork.ldl_stack_mut(
+      StackSite::NEWTON_STEP,
+      proxsuite::linalg::dense::temp_vec_req(proxsuite::linalg::veg::Tag<T>{},
+                                             qpmodel.dim) &
+        proxsuite::linalg::dense::temp_vec_req(
+          proxsuite::linalg::veg::Tag<T>{}, qpmodel.dim));
     LDLT_TEMP_VEC(T, ATdy, qpmodel.dim, stack);
     LDLT_TEMP_VEC(T, CTdz, qpmodel.dim, stack);
 
@@ -773,6 +790,9 @@ qp_solve( //
   if (qpsettings.verbose) {
     dense::print_setup_header(qpsettings, qpresults, qpmodel);
   }
+  // the layout is chosen at setup, this only applies a change of the settings
+  // made since then
+  qpwork.ldl.set_packed_storage(qpsettings.dense_packed_ldlt);
   if (qpwork.dirty) { // the following is used when a solve has already been
                       // executed (and without any intermediary model update)
     switch (qpsettings.initial_guess) {
@@ -9,7 +9,10 @@
 
 #include <Eigen/Core>
 #include <proxsuite/linalg/dense/ldlt.hpp>
+#include <proxsuite/helpers/huge-pages.hpp>
+#include <proxsuite/helpers/omp.hpp>
 #include <proxsuite/proxqp/timings.hpp>
+#include <proxsuite/proxqp/results.hpp>
 #include <proxsuite/linalg/veg/vec.hpp>
 //#include <proxsuite/proxqp/dense/preconditioner/ruiz.hpp>
 
@@ -17,6 +20,20 @@ namespace proxsuite {
 namespace proxqp {
 namespace dense {
 ///
+/// @brief Call sites of the dense solver allocating from the workspace stack.
+///
+enum struct StackSite
+{
+  EQUILIBRATION,     // ruiz equilibration of the problem
+  FACTORIZATION,     // first factorization of the KKT matrix
+  REFACTORIZATION,   // factorization after a change of the proximal parameters
+  MU_UPDATE,         // update of the dual proximal parameters
+  LINEAR_SOLVE,      // iterative refinement of the newton steps
+  NEWTON_STEP,       // primal dual semi smooth newton step
+  ACTIVE_SET_CHANGE, // update of the factorization with the active set
+  COUNT              // number of call sites
+};
+///
 /// @brief This class defines the workspace of the dense solver.
 ///
 /*!
@@ -29,6 +46,11 @@ struct Workspace
   ///// Cholesky Factorization
   proxsuite::linalg::dense::Ldlt<T> ldl{};
   proxsuite::linalg::veg::Vec<unsigned char> ldl_stack;
+  // largest number of bytes of ldl_stack used by each StackSite
+  isize ldl_stack_peaks[isize(StackSite::COUNT)] = {};
+  // whether ldl_stack was trimmed to its measured usage, in which case it
+  // grows on demand
+  bool ldl_stack_trimmed = false;
   Timer<T> timer;
 
   ///// QP STORAGE
@@ -147,7 +169,14 @@ struct Workspace
     , proximal_parameter_update(false)
 
   {
-    ldl.reserve_uninit(dim + n_eq + n_in);
+    // the large matrices follow the large buffer policy, before they are
+    // first touched by setZero
+    for (Mat<T>* mat : { &H_scaled, &A_scaled, &C_scaled, &kkt }) {
+      proxsuite::helpers::advise_large_buffer(
+        mat->data(), std::size_t(mat->size()) * sizeof(T));
+    }
+    // the storage of ldl is reserved by setup, once the layout of the factor
+    // is known from the settings
     ldl_stack.resize_for_overwrite(
       proxsuite::linalg::veg::dynstack::StackReq(
 
@@ -166,7 +195,22 @@ struct Workspace
            dim + n_eq + n_in, n_in)) |
 
         proxsuite::linalg::dense::Ldlt<T>::solve_in_place_req(dim + n_eq +
-                                                              n_in))
+                                                              n_in) |
+
+        // ruiz equilibration
+        (proxsuite::linalg::dense::temp_vec_req(
+           proxsuite::linalg::veg::Tag<T>{}, dim + n_eq + n_in) &
+         proxsuite::linalg::dense::temp_vec_req(
+           proxsuite::linalg::veg::Tag<T>{}, dim) &
+         proxsuite::linalg::dense::temp_vec_req(
+           proxsuite::linalg::veg::Tag<T>{}, dim) &
+         proxsuite::linalg::dense::temp_vec_req(
+           proxsuite::linalg::veg::Tag<T>{}, n_eq + n_in) &
+         // norms of the columns computed by each thread of a sweep
+         proxsuite::linalg::dense::temp_mat_req(
+           proxsuite::linalg::veg::Tag<T>{},
+           dim,
+           2 * isize(proxsuite::helpers::get_max_threads()))))
 
         .alloc_req());
 
@@ -212,6 +256,59 @@ struct Workspace
     CTz.setZero();
     n_c = 0;
   }
+  /*!
+   * Returns a stack on ldl_stack, which records its usage for the given call
+   * site. If ldl_stack was trimmed, it first grows to the requirement of the
+   * call site.
+   * @param site call site.
+   * @param req requirement of the call site.
+   */
+  auto ldl_stack_mut(StackSite site,
+                     proxsuite::linalg::veg::dynstack::StackReq req)
+    -> proxsuite::linalg::veg::dynstack::DynStackMut
+  {
+    if (ldl_stack_trimmed && ldl_stack.len() < req.alloc_req()) {
+      ldl_stack.resize_for_overwrite(req.alloc_req());
+    }
+    return {
+      proxsuite::linalg::veg::from_slice_mut,
+      ldl_stack.as_mut(),
+      &ldl_stack_peaks[isize(site)],
+    };
+  }
+  /*!
+   * Returns the size of ldl_stack and the largest number of bytes used by the
+   * given call site, or by all of them if site is not given.
+   * @param site call site.
+   */
+  auto ldl_stack_usage(std::optional<StackSite> site = std::nullopt) const
+    -> StackUsage
+  {
+    isize used = 0;
+    for (isize k = 0; k < isize(StackSite::COUNT); ++k) {
+      if (site == std::nullopt || isize(site.value()) == k) {
+        used = std::max(used, ldl_stack_peaks[k]);
+      }
+    }
+    return { ldl_stack.len(), used };
+  }
+  /*!
+   * Shrinks ldl_stack to the largest number of bytes used so far. From then
+   * on, ldl_stack grows back whenever a call site needs more memory, so that
+   * it can not overflow.
+   */
+  void trim_ldl_stack()
+  {
+    // slack for a different alignment of the new allocation
+    isize len = ldl_stack_usage().used_bytes +
+                proxsuite::linalg::dense::_detail::align<T>() - 1;
+    if (len < ldl_stack.len()) {
+      proxsuite::linalg::veg::Vec<unsigned char> trimmed;
+      trimmed.resize_for_overwrite(len);
+      ldl_stack = VEG_FWD(trimmed);
+    }
+    ldl_stack_trimmed = true;
+  }
   /*!
    * Clean-ups solver's workspace.
    */
@@ -10,7 +10,9 @@
 #include <proxsuite/proxqp/dense/solver.hpp>
 #include <proxsuite/proxqp/dense/helpers.hpp>
 #include <proxsuite/proxqp/dense/preconditioner/ruiz.hpp>
+#include <proxsuite/helpers/omp.hpp>
 #include <chrono>
+#include <vector>
 
 namespace proxsuite {
 namespace proxqp {
@@ -127,6 +129,40 @@ struct QP
             std::optional<T> rho = std::nullopt,
             std::optional<T> mu_eq = std::nullopt,
             std::optional<T> mu_in = std::nullopt)
+  {
+    this->template init<MatRef<T>>(
+      H, g, A, b, C, u, l, compute_preconditioner, rho, mu_eq, mu_in);
+  }
+  /*!
+   * Setups the QP model with dense matrices of another type than MatRef, and
+   * equilibrates it if specified by the user. With RowMatRef, the matrices
+   * stored in the row major layout of the model (e.g., C ordered NumPy arrays)
+   * are copied into it without any conversion.
+   * @param H quadratic cost input defining the QP model.
+   * @param g linear cost input defining the QP model.
+   * @param A equality constraint matrix input defining the QP model.
+   * @param b equality constraint vector input defining the QP model.
+   * @param C inequality constraint matrix input defining the QP model.
+   * @param u lower inequality constraint vector input defining the QP model.
+   * @param l lower inequality constraint vector input defining the QP model.
+   * @param compute_preconditioner boolean parameter for executing or not the
+   * preconditioner.
+   * @param rho proximal step size wrt primal variable.
+   * @param mu_eq proximal step size wrt equality constrained multiplier.
+   * @param mu_in proximal step size wrt inequality constrained multiplier.
+   */
+  template<typename MatrixRef>
+  void init(std::optional<MatrixRef> H,
+            std::optional<VecRef<T>> g,
+            std::optional<MatrixRef> A,
+            std::optional<VecRef<T>> b,
+            std::optional<MatrixRef> C,
+            std::optional<VecRef<T>> u,
+            std::optional<VecRef<T>> l,
+            bool compute_preconditioner = true,
+            std::optional<T> rho = std::nullopt,
+            std::optional<T> mu_eq = std::nullopt,
+            std::optional<T> mu_in = std::nullopt)
   {
     // dense case
     if (settings.compute_timings) {
@@ -388,6 +424,40 @@ struct QP
               std::optional<T> rho = std::nullopt,
               std::optional<T> mu_eq = std::nullopt,
               std::optional<T> mu_in = std::nullopt)
+  {
+    this->template update<MatRef<T>>(
+      H, g, A, b, C, u, l, update_preconditioner, rho, mu_eq, mu_in);
+  }
+  /*!
+   * Updates the QP model with dense matrices of another type than MatRef, and
+   * re-equilibrates it if specified by the user. With RowMatRef, the matrices
+   * stored in the row major layout of the model (e.g., C ordered NumPy arrays)
+   * are copied into it without any conversion.
+   * @param H quadratic cost input defining the QP model.
+   * @param g linear cost input defining the QP model.
+   * @param A equality constraint matrix input defining the QP model.
+   * @param b equality constraint vector input defining the QP model.
+   * @param C inequality constraint matrix input defining the QP model.
+   * @param u lower inequality constraint vector input defining the QP model.
+   * @param l lower inequality constraint vector input defining the QP model.
+   * @param update_preconditioner bool parameter for updating or not the
+   * preconditioner and the associated scaled model.
+   * @param rho proximal step size wrt primal variable.
+   * @param mu_eq proximal step size wrt equality constrained multiplier.
+   * @param mu_in proximal step size wrt inequality constrained multiplier.
+   */
+  template<typename MatrixRef>
+  void update(const std::optional<MatrixRef> H,
+              std::optional<Vec<T>> g,
+              const std::optional<MatrixRef> A,
+              std::optional<Vec<T>> b,
+              const std::optional<MatrixRef> C,
+              std::optional<Vec<T>> u,
+              std::optional<Vec<T>> l,
+              bool update_preconditioner = true,
+              std::optional<T> rho = std::nullopt,
+              std::optional<T> mu_eq = std::nullopt,
+              std::optional<T> mu_in = std::nullopt)
   {
     // dense case
     work.refactorize = false;
@@ -398,7 +468,10 @@ struct QP
     }
     PreconditionerStatus preconditioner_status;
     if (update_preconditioner) {
-      preconditioner_status = proxsuite::proxqp::PreconditionerStatus::EXECUTE;
+      preconditioner_status =
+        settings.incremental_preconditioner
+          ? proxsuite::proxqp::PreconditionerStatus::INCREMENTAL
+          : proxsuite::proxqp::PreconditionerStatus::EXECUTE;
     } else {
       preconditioner_status = proxsuite::proxqp::PreconditionerStatus::KEEP;
     }
@@ -465,7 +538,10 @@ struct QP
     }
     PreconditionerStatus preconditioner_status;
     if (update_preconditioner) {
-      preconditioner_status = proxsuite::proxqp::PreconditionerStatus::EXECUTE;
+      preconditioner_status =
+        settings.incremental_preconditioner
+          ? proxsuite::proxqp::PreconditionerStatus::INCREMENTAL
+          : proxsuite::proxqp::PreconditionerStatus::EXECUTE;
     } else {
       preconditioner_status = proxsuite::proxqp::PreconditionerStatus::KEEP;
     }
@@ -533,7 +609,10 @@ struct QP
     }
     PreconditionerStatus preconditioner_status;
     if (update_preconditioner) {
-      preconditioner_status = proxsuite::proxqp::PreconditionerStatus::EXECUTE;
+      preconditioner_status =
+        settings.incremental_preconditioner
+          ? proxsuite::proxqp::PreconditionerStatus::INCREMENTAL
+          : proxsuite::proxqp::PreconditionerStatus::EXECUTE;
     } else {
       preconditioner_status = proxsuite::proxqp::PreconditionerStatus::KEEP;
     }
@@ -630,6 +709,17 @@ struct QP
       work,
       ruiz);
   };
+  /*!
+   * Returns the size of the stack of the workspace, and the largest number of
+   * bytes of it used so far.
+   */
+  auto stack_usage() const -> StackUsage { return work.ldl_stack_usage(); }
+  /*!
+   * Shrinks the stack of the workspace to the largest number of bytes of it
+   * used so far, e.g. after solving representative problems. The stack then
+   * grows back on demand if a later call needs more memory.
+   */
+  void trim_stack() { work.trim_ldl_stack(); }
   /*!
    * Clean-ups solver's results and workspace.
    */
@@ -639,6 +729,89 @@ struct QP
     work.cleanup();
   }
 };
+///
+/// @brief This class defines the API of PROXQP solver with dense backend for
+/// batches of problems of the same dimensions.
+///
+/*!
+ * Wrapper class for solving a batch of small linearly constrained convex QP
+ * problems of the same dimensions (e.g., the problems of learning based
+ * controllers). Each member is a QP object, which is initialized with its own
+ * model, the members being then solved in parallel (when OpenMP support is
+ * enabled).
+ *
+ * Example usage:
+ * ```cpp
+        proxqp::dense::BatchQP<T> batch(batch_size, dim, n_eq, n_in);
+        for (isize i = 0; i < batch_size; ++i) {
+          batch[i].init(H[i], g[i], A[i], b[i], C[i], u[i], l[i]);
+        }
+        batch.solve();
+ * ```
+ */
+template<typename T>
+struct BatchQP
+{
+  std::vector<QP<T>> qps;
+  /*!
+   * Default constructor using the dimensions of the problems of the batch.
+   * @param batch_size number of problems of the batch.
+   * @param dim primal dimension.
+   * @param n_eq number of equality constraints.
+   * @param n_in number of inequality constraints.
+   */
+  BatchQP(isize batch_size, isize dim, isize n_eq, isize n_in)
+  {
+    PROXSUITE_THROW_PRETTY(batch_size <= 0,
+                           std::invalid_argument,
+                           "wrong argument size: the batch size should be "
+                           "strictly positive.");
+    qps.reserve(usize(batch_size));
+    for (isize i = 0; i < batch_size; ++i) {
+      qps.emplace_back(dim, n_eq, n_in);
+    }
+  }
+  /*!
+   * Returns the number of problems of the batch.
+   */
+  auto size() const -> isize { return isize(qps.size()); }
+  /*!
+   * Returns the i-th problem of the batch.
+   * @param i index of the problem.
+   */
+  auto operator[](isize i) -> QP<T>&
+  {
+    VEG_ASSERT(i >= 0 && i < size());
+    return qps[usize(i)];
+  }
+  auto operator[](isize i) const -> QP<T> const&
+  {
+    VEG_ASSERT(i >= 0 && i < size());
+    return qps[usize(i)];
+  }
+  /*!
+   * Calls fn(i, qp) for each problem qp of the batch, of index i, in parallel
+   * when OpenMP support is enabled. An exception thrown for some problems is
+   * rethrown once all of them are processed.
+   * @param fn function called on each problem.
+   * @param num_threads largest number of threads used, all the available ones
+   * when it is not positive.
+   */
+  template<typename Fn>
+  void for_each(Fn&& fn, isize num_threads = 0)
+  {
+    proxsuite::helpers::parallel_for(
+      size(), num_threads, [&](isize i) { fn(i, qps[usize(i)]); });
+  }
+  /*!
+   * Solves the problems of the batch, in parallel when OpenMP support is
+   * enabled.
+   */
+  void solve()
+  {
+    for_each([](isize /*i*/, QP<T>& qp) { qp.solve(); });
+  }
+};
 /*!
  * Solves the QP problem using PROXQP algorithm without the need to define a QP
  * object, with matrices defined by Dense Eigen matrices. It is possible to set
@@ -51,6 +51,18 @@ struct Info
   T dua_res;
 };
 ///
+/// @brief This class stores the memory usage of the stack of the workspace of
+/// PROXQP solvers with sparse and dense backends.
+///
+/*!
+ * Stack usage of dense and sparse solver.
+ */
+struct StackUsage
+{
+  isize requested_bytes; // size of the stack
+  isize used_bytes;      // largest number of bytes used so far
+};
+///
 /// @brief This class stores all the results of PROXQP solvers with sparse and
 /// dense backends.
 ///
@@ -0,0 +1,387 @@
+//
+// Copyright (c) 2022 INRIA
+//
+/**
+ * @file serialization.hpp
+ */
+#ifndef PROXSUITE_QP_SERIALIZATION_HPP
+#define PROXSUITE_QP_SERIALIZATION_HPP
+
+#include <proxsuite/linalg/veg/internal/macros.hpp>
+#include <proxsuite/proxqp/results.hpp>
+#include <proxsuite/proxqp/settings.hpp>
+#include <proxsuite/proxqp/status.hpp>
+#include <Eigen/Core>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace proxsuite {
+namespace proxqp {
+namespace serialization {
+
+/*!
+ * Binary buffer format of the QP objects: a header (magic bytes, version,
+ * backend, sizes of the scalar and index types) followed by the settings, the
+ * model, the preconditioner and the results. The values are stored in the
+ * native byte order, the buffers are meant to be exchanged between processes
+ * of a same machine (e.g., python multiprocessing workers).
+ */
+constexpr char magic[4] = { 'P', 'X', 'Q', 'P' };
+constexpr std::uint32_t version = 1;
+
+/*!
+ * Writes values to a buffer, or only counts their size when the buffer is
+ * nullptr.
+ */
+struct Writer
+{
+  unsigned char* data = nullptr;
+  std::size_t size = 0;
+
+  void write_bytes(void const* src, std::size_t n)
+  {
+    if (data != nullptr && n != 0) {
+      std::memcpy(data + size, src, n);
+    }
+    size += n;
+  }
+  template<typename U>
+  void operator()(U const& value)
+  {
+    if constexpr (std::is_same<U, bool>::value) {
+      std::uint8_t byte = value ? 1 : 0;
+      write_bytes(&byte, 1);
+    } else if constexpr (std::is_enum<U>::value) {
+      std::int32_t raw = std::int32_t(value);
+      write_bytes(&raw, sizeof(raw));
+    } else if constexpr (std::is_integral<U>::value) {
+      std::int64_t raw = std::int64_t(value);
+      write_bytes(&raw, sizeof(raw));
+    } else {
+      static_assert(std::is_floating_point<U>::value, "unsupported type");
+      write_bytes(&value, sizeof(value));
+    }
+  }
+  void operator()(std::string const& value)
+  {
+    (*this)(value.size());
+    write_bytes(value.data(), value.size());
+  }
+  /// dense vector or matrix, in its storage order
+  template<typename Derived>
+  void dense(Eigen::PlainObjectBase<Derived> const& m)
+  {
+    (*this)(m.rows());
+    (*this)(m.cols());
+    write_bytes(m.data(), std::size_t(m.size()) * sizeof(*m.data()));
+  }
+  /// raw array, whose length is known from the previous values
+  template<typename U>
+  void array(U const* ptr, isize len)
+  {
+    write_bytes(ptr, std::size_t(len) * sizeof(U));
+  }
+};
+
+/*!
+ * Last value of each enumeration of status.hpp, whose values are contiguous
+ * from zero, so that the values read from a buffer can be checked.
+ */
+constexpr auto
+enum_last(QPSolverOutput /*tag*/) noexcept -> QPSolverOutput
+{
+  return QPSolverOutput::PROXQP_DUAL_INFEASIBLE;
+}
+constexpr auto
+enum_last(InitialGuessStatus /*tag*/) noexcept -> InitialGuessStatus
+{
+  return InitialGuessStatus::COLD_START_WITH_PREVIOUS_RESULT;
+}
+constexpr auto
+enum_last(PreconditionerStatus /*tag*/) noexcept -> PreconditionerStatus
+{
+  return PreconditionerStatus::INCREMENTAL;
+}
+constexpr auto
+enum_last(MatrixFreePreconditioner /*tag*/) noexcept
+  -> MatrixFreePreconditioner
+{
+  return MatrixFreePreconditioner::INCOMPLETE_LDLT;
+}
+constexpr auto
+enum_last(QPBackend /*tag*/) noexcept -> QPBackend
+{
+  return QPBackend::SPARSE;
+}
+
+/*!
+ * Reads values from a buffer, checking that it is large enough.
+ */
+struct Reader
+{
+  unsigned char const* data;
+  std::size_t size;
+  std::size_t pos = 0;
+
+  void read_bytes(void* dst, std::size_t n)
+  {
+    PROXSUITE_THROW_PRETTY(n > size - pos,
+                           std::invalid_argument,
+                           "invalid serialized QP: the buffer is truncated.");
+    if (n != 0) {
+      std::memcpy(dst, data + pos, n);
+    }
+    pos += n;
+  }
+  template<typename U>
+  void operator()(U& value)
+  {
+    if constexpr (std::is_same<U, bool>::value) {
+      std::uint8_t byte = 0;
+      read_bytes(&byte, 1);
+      value = byte != 0;
+    } else if constexpr (std::is_enum<U>::value) {
+      std::int32_t raw = 0;
+      read_bytes(&raw, sizeof(raw));
+      PROXSUITE_THROW_PRETTY(
+        raw < 0 || raw > std::int32_t(serialization::enum_last(U{})),
+        std::invalid_argument,
+        "invalid serialized QP: invalid enumeration value.");
+      value = U(raw);
+    } else if constexpr (std::is_integral<U>::value) {
+      std::int64_t raw = 0;
+      read_bytes(&raw, sizeof(raw));
+      value = U(raw);
+    } else {
+      static_assert(std::is_floating_point<U>::value, "unsupported type");
+      read_bytes(&value, sizeof(value));
+    }
+  }
+  void operator()(std::string& value)
+  {
+    std::size_t len = 0;
+    (*this)(len);
+    PROXSUITE_THROW_PRETTY(len > size - pos,
+                           std::invalid_argument,
+                           "invalid serialized QP: the buffer is truncated.");
+    value.assign(reinterpret_cast<char const*>(data + pos), len);
+    pos += len;
+  }
+  /// throws if the rest of the buffer cannot hold a rows x cols array of
+  /// elem_size bytes elements, so that dimensions read from the buffer are
+  /// checked before allocating storage for them
+  void check_remaining(isize rows, isize cols, std::size_t elem_size)
+  {
+    PROXSUITE_THROW_PRETTY(
+      rows < 0 || cols < 0 ||
+        (cols != 0 && std::size_t(rows) > (size - pos) / elem_size /
+                                             std::size_t(cols)),
+      std::invalid_argument,
+      "invalid serialized QP: the buffer is truncated.");
+  }
+  /// dense vector or matrix, whose dimensions must be the stored ones
+  template<typename Derived>
+  void dense(Eigen::PlainObjectBase<Derived>& m)
+  {
+    std::int64_t rows = 0;
+    std::int64_t cols = 0;
+    (*this)(rows);
+    (*this)(cols);
+    PROXSUITE_THROW_PRETTY(rows != m.rows() || cols != m.cols(),
+                           std::invalid_argument,
+                           "invalid serialized QP: wrong dimensions.");
+    read_bytes(m.data(), std::size_t(m.size()) * sizeof(*m.data()));
+  }
+  /// raw array, whose length is known from the previous values
+  template<typename U>
+  void array(U* ptr, isize len)
+  {
+    PROXSUITE_THROW_PRETTY(len < 0 ||
+                             std::size_t(len) > (size - pos) / sizeof(U),
+                           std::invalid_argument,
+                           "invalid serialized QP: the buffer is truncated.");
+    read_bytes(ptr, std::size_t(len) * sizeof(U));
+  }
+};
+
+/*!
+ * Writes the header of a serialized QP object.
+ *
+ * @param out writer.
+ * @param backend backend of the QP object.
+ * @param scalar_size size of its scalar type.
+ * @param index_size size of its index type (zero for the dense backend).
+ */
+template<typename Out>
+void
+header(Out& out,
+       QPBackend backend,
+       std::size_t scalar_size,
+       std::size_t index_size)
+{
+  out.write_bytes(magic, sizeof(magic));
+  out(version);
+  out(backend);
+  out(scalar_size);
+  out(index_size);
+}
+
+/*!
+ * Reads and checks the header of a serialized QP object.
+ *
+ * @param in reader.
+ * @param backend expected backend.
+ * @param scalar_size expected size of the scalar type.
+ * @param index_size expected size of the index type.
+ */
+inline void
+check_header(Reader& in,
+             QPBackend backend,
+             std::size_t scalar_size,
+             std::size_t index_size)
+{
+  char read_magic[sizeof(magic)];
+  in.read_bytes(read_magic, sizeof(magic));
+  PROXSUITE_THROW_PRETTY(std::memcmp(read_magic, magic, sizeof(magic)) != 0,
+                         std::invalid_argument,
+                         "invalid serialized QP: wrong magic bytes.");
+  std::uint32_t read_version = 0;
+  QPBackend read_backend = QPBackend::AUTOMATIC;
+  std::size_t read_scalar_size = 0;
+  std::size_t read_index_size = 0;
+  in(read_version);
+  in(read_backend);
+  in(read_scalar_size);
+  in(read_index_size);
+  PROXSUITE_THROW_PRETTY(read_version != version,
+                         std::invalid_argument,
+                         "invalid serialized QP: unsupported version.");
+  PROXSUITE_THROW_PRETTY(read_backend != backend ||
+                           read_scalar_size != scalar_size ||
+                           read_index_size != index_size,
+                         std::invalid_argument,
+                         "invalid serialized QP: it was saved from a QP "
+                         "object of another backend, scalar or index type.");
+}
+
+/*!
+ * Calls fn on each field of the settings, in the order of the buffer format.
+ */
+template<typename S, typename Fn>
+void
+visit_settings(S& settings, Fn&& fn)
+{
+  fn(settings.default_rho);
+  fn(settings.default_mu_eq);
+  fn(settings.default_mu_in);
+  fn(settings.alpha_bcl);
+  fn(settings.beta_bcl);
+  fn(settings.refactor_dual_feasibility_threshold);
+  fn(settings.refactor_rho_threshold);
+  fn(settings.mu_min_eq);
+  fn(settings.mu_min_in);
+  fn(settings.mu_max_eq_inv);
+  fn(settings.mu_max_in_inv);
+  fn(settings.mu_update_factor);
+  fn(settings.mu_update_inv_factor);
+  fn(settings.cold_reset_mu_eq);
+  fn(settings.cold_reset_mu_in);
+  fn(settings.cold_reset_mu_eq_inv);
+  fn(settings.cold_reset_mu_in_inv);
+  fn(settings.eps_abs);
+  fn(settings.eps_rel);
+  fn(settings.max_iter);
+  fn(settings.max_iter_in);
+  fn(settings.safe_guard);
+  fn(settings.nb_iterative_refinement);
+  fn(settings.eps_refact);
+  fn(settings.verbose);
+  fn(settings.initial_guess);
+  fn(settings.update_preconditioner);
+  fn(settings.compute_preconditioner);
+  fn(settings.compute_timings);
+  fn(settings.preconditioner_max_iter);
+  fn(settings.preconditioner_accuracy);
+  fn(settings.eps_primal_inf);
+  fn(settings.eps_dual_inf);
+  fn(settings.bcl_update);
+  fn(settings.sparse_ldlt_memory_budget);
+  fn(settings.matrix_free_preconditioner);
+  fn(settings.sparse_store_unscaled_kkt);
+  fn(settings.incremental_preconditioner);
+  fn(settings.sparse_ldlt_mmap_directory);
+  fn(settings.backend);
+  fn(settings.dense_packed_ldlt);
+}
+
+/*!
+ * Calls fn on each scalar field of the results, in the order of the buffer
+ * format. The vectors are handled by save_results and load_results.
+ */
+template<typename I, typename Fn>
+void
+visit_info(I& info, Fn&& fn)
+{
+  fn(info.mu_eq);
+  fn(info.mu_eq_inv);
+  fn(info.mu_in);
+  fn(info.mu_in_inv);
+  fn(info.rho);
+  fn(info.nu);
+  fn(info.iter);
+  fn(info.iter_ext);
+  fn(info.mu_updates);
+  fn(info.rho_updates);
+  fn(info.status);
+  fn(info.setup_time);
+  fn(info.solve_time);
+  fn(info.run_time);
+  fn(info.objValue);
+  fn(info.pri_res);
+  fn(info.dua_res);
+}
+
+template<typename T>
+void
+save_results(Writer& out, Results<T> const& results)
+{
+  out.dense(results.x);
+  out.dense(results.y);
+  out.dense(results.z);
+  out(results.active_constraints.len());
+  for (isize i = 0; i < results.active_constraints.len(); ++i) {
+    out(results.active_constraints[i]);
+  }
+  visit_info(results.info, out);
+}
+
+template<typename T>
+void
+load_results(Reader& in, Results<T>& results)
+{
+  in.dense(results.x);
+  in.dense(results.y);
+  in.dense(results.z);
+  isize n_active = 0;
+  in(n_active);
+  // the active constraints are only sized by the sparse backend
+  PROXSUITE_THROW_PRETTY(n_active != 0 && n_active != results.z.rows(),
+                         std::invalid_argument,
+                         "invalid serialized QP: wrong dimensions.");
+  results.active_constraints.resize(n_active);
+  for (isize i = 0; i < n_active; ++i) {
+    bool active = false;
+    in(active);
+    results.active_constraints[i] = active;
+  }
+  visit_info(results.info, in);
+}
+
+} // namespace serialization
+} // namespace proxqp
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_QP_SERIALIZATION_HPP */
@@ -11,6 +11,7 @@
 #include <proxsuite/proxqp/status.hpp>
 #include <proxsuite/proxqp/dense/views.hpp>
 #include <proxsuite/proxqp/sparse/fwd.hpp>
+#include <string>
 
 namespace proxsuite {
 namespace proxqp {
@@ -68,6 +69,14 @@ struct Settings
   T eps_primal_inf;
   T eps_dual_inf;
   bool bcl_update;
+
+  isize sparse_ldlt_memory_budget;
+  MatrixFreePreconditioner matrix_free_preconditioner;
+  bool sparse_store_unscaled_kkt;
+  bool incremental_preconditioner;
+  std::string sparse_ldlt_mmap_directory;
+  QPBackend backend;
+  bool dense_packed_ldlt;
   /*!
    * Default constructor.
    * @param default_rho default rho parameter of result class
@@ -121,6 +130,33 @@ struct Settings
    * @param bcl_update_ if set to true, BCL strategy is used for calibrating
    * mu_eq and mu_in. If set to false, a strategy developped by Martinez & al is
    * used.
+   * @param sparse_ldlt_memory_budget_ maximal memory (in bytes) the sparse
+   * backend may use for storing the LDLT factor of the KKT matrix. When the
+   * predicted fill-in exceeds it, the KKT systems are solved with a matrix free
+   * iterative solver instead. Each nonzero of the factor takes the size of a
+   * value and of a row index, so that the default amounts to 1e7 nonzeros with
+   * double values and long long indices, as used by the sparse wrapper.
+   * @param matrix_free_preconditioner_ preconditioner used by the matrix free
+   * iterative solver of the sparse backend.
+   * @param sparse_store_unscaled_kkt_ if set to true, the sparse backend keeps
+   * a copy of the values of the unscaled KKT matrix. If set to false, they are
+   * recomputed in place from the scaled ones and the preconditioner when
+   * needed, which halves the memory used by the KKT values.
+   * @param incremental_preconditioner_ if set to true, updating the model with
+   * update_preconditioner refines the previous equilibration from the new
+   * model, the rows and columns which are still equilibrated being kept, rather
+   * than computing a new one from scratch.
+   * @param sparse_ldlt_mmap_directory_ if not empty, an LDLT factor of the KKT
+   * matrix which does not fit in sparse_ldlt_memory_budget is stored in memory
+   * mapped files created in this directory (out of core), its columns being
+   * ordered by a postorder of the elimination tree, instead of using the matrix
+   * free iterative solver.
+   * @param backend_ backend used by the proxqp::QP front-end. If set to
+   * AUTOMATIC, the faster one is estimated from the dimensions and the sparsity
+   * structure of the problem at initialization.
+   * @param dense_packed_ldlt_ if set to true, the dense backend stores only the
+   * lower triangular part of the LDLT factor of the KKT matrix, in panels of
+   * consecutive columns, which halves the memory it needs.
    */
 
   Settings(T default_rho_ = 1.E-6,
@@ -157,7 +193,15 @@ struct Settings
            T preconditioner_accuracy_ = 1.e-3,
            T eps_primal_inf_ = 1.E-4,
            T eps_dual_inf_ = 1.E-4,
-           bool bcl_update_ = true)
+           bool bcl_update_ = true,
+           isize sparse_ldlt_memory_budget_ = 160000000,
+           MatrixFreePreconditioner matrix_free_preconditioner_ =
+             MatrixFreePreconditioner::BLOCK_DIAGONAL,
+           bool sparse_store_unscaled_kkt_ = true,
+           bool incremental_preconditioner_ = false,
+           std::string sparse_ldlt_mmap_directory_ = "",
+           QPBackend backend_ = QPBackend::AUTOMATIC,
+           bool dense_packed_ldlt_ = false)
     : default_rho(default_rho_)
     , default_mu_eq(default_mu_eq_)
     , default_mu_in(default_mu_in_)
@@ -192,6 +236,13 @@ struct Settings
     , eps_primal_inf(eps_primal_inf_)
     , eps_dual_inf(eps_dual_inf_)
     , bcl_update(bcl_update_)
+    , sparse_ldlt_memory_budget(sparse_ldlt_memory_budget_)
+    , matrix_free_preconditioner(matrix_free_preconditioner_)
+    , sparse_store_unscaled_kkt(sparse_store_unscaled_kkt_)
+    , incremental_preconditioner(incremental_preconditioner_)
+    , sparse_ldlt_mmap_directory(sparse_ldlt_mmap_directory_)
+    , backend(backend_)
+    , dense_packed_ldlt(dense_packed_ldlt_)
   {
   }
   /*
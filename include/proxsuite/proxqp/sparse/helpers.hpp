@@ -183,6 +183,7 @@ qp_setup(QpView<T, I> qp,
     }
   }
   bool execute_preconditioner_or_not = false;
+  bool incremental_preconditioner = false;
   switch (preconditioner_status) {
     case PreconditionerStatus::EXECUTE:
       execute_preconditioner_or_not = true;
@@ -194,6 +195,11 @@ qp_setup(QpView<T, I> qp,
       // keep previous one
       execute_preconditioner_or_not = false;
       break;
+    case PreconditionerStatus::INCREMENTAL:
+      // refine previous one
+      execute_preconditioner_or_not = true;
+      incremental_preconditioner = true;
+      break;
   }
   // performs scaling according to options chosen + stored model value
   work.setup_impl(
@@ -202,7 +208,8 @@ qp_setup(QpView<T, I> qp,
     settings,
     execute_preconditioner_or_not,
     precond,
-    P::scale_qp_in_place_req(proxsuite::linalg::veg::Tag<T>{}, n, n_eq, n_in));
+    P::scale_qp_in_place_req(proxsuite::linalg::veg::Tag<T>{}, n, n_eq, n_in),
+    incremental_preconditioner);
   switch (settings.initial_guess) { // the following is used when initiliazing
                                     // the Qp object or updating it
     case InitialGuessStatus::EQUALITY_CONSTRAINED_INITIAL_GUESS: {
@@ -6,6 +6,7 @@
 #define PROXSUITE_QP_SPARSE_MODEL_HPP
 
 #include <Eigen/Sparse>
+#include <memory>
 #include "proxsuite/linalg/sparse/core.hpp"
 #include "proxsuite/proxqp/sparse/fwd.hpp"
 
@@ -29,13 +30,18 @@ struct Model
   isize A_nnz;
   isize C_nnz;
 
-  proxsuite::linalg::veg::Vec<I> kkt_col_ptrs;
-  proxsuite::linalg::veg::Vec<I> kkt_row_indices;
+  // the sparsity pattern of the kkt matrix is never modified once it has been
+  // formed, it can hence be shared between the models of problems with the
+  // same structure (see BatchQP)
+  std::shared_ptr<proxsuite::linalg::veg::Vec<I>> kkt_col_ptrs;
+  std::shared_ptr<proxsuite::linalg::veg::Vec<I>> kkt_row_indices;
   proxsuite::linalg::veg::Vec<T> kkt_values;
 
-  proxsuite::linalg::veg::Vec<I> kkt_col_ptrs_unscaled;
-  proxsuite::linalg::veg::Vec<I> kkt_row_indices_unscaled;
+  // the unscaled kkt matrix shares the sparsity pattern of the scaled one.
+  // its values are stored only if store_unscaled_kkt is set, otherwise they are
+  // recomputed in place from the scaled ones by the preconditioner when needed
   proxsuite::linalg::veg::Vec<T> kkt_values_unscaled;
+  bool store_unscaled_kkt = true;
 
   Eigen::Matrix<T, Eigen::Dynamic, 1> g;
   Eigen::Matrix<T, Eigen::Dynamic, 1> b;
@@ -52,6 +58,8 @@ struct Model
     : dim(_dim)
     , n_eq(_n_eq)
     , n_in(_n_in)
+    , kkt_col_ptrs(std::make_shared<proxsuite::linalg::veg::Vec<I>>())
+    , kkt_row_indices(std::make_shared<proxsuite::linalg::veg::Vec<I>>())
   {
     PROXSUITE_THROW_PRETTY(_dim == 0,
                            std::invalid_argument,
@@ -67,17 +75,17 @@ struct Model
    */
   auto kkt() const -> proxsuite::linalg::sparse::MatRef<T, I>
   {
-    auto n_tot = kkt_col_ptrs.len() - 1;
-    auto nnz =
-      isize(proxsuite::linalg::sparse::util::zero_extend(kkt_col_ptrs[n_tot]));
+    auto n_tot = kkt_col_ptrs->len() - 1;
+    auto nnz = isize(
+      proxsuite::linalg::sparse::util::zero_extend((*kkt_col_ptrs)[n_tot]));
     return {
       proxsuite::linalg::sparse::from_raw_parts,
       n_tot,
       n_tot,
       nnz,
-      kkt_col_ptrs.ptr(),
+      kkt_col_ptrs->ptr(),
       nullptr,
-      kkt_row_indices.ptr(),
+      kkt_row_indices->ptr(),
       kkt_values.ptr(),
     };
   }
@@ -86,56 +94,63 @@ struct Model
    */
   auto kkt_mut() -> proxsuite::linalg::sparse::MatMut<T, I>
   {
-    auto n_tot = kkt_col_ptrs.len() - 1;
-    auto nnz =
-      isize(proxsuite::linalg::sparse::util::zero_extend(kkt_col_ptrs[n_tot]));
+    auto n_tot = kkt_col_ptrs->len() - 1;
+    auto nnz = isize(
+      proxsuite::linalg::sparse::util::zero_extend((*kkt_col_ptrs)[n_tot]));
     return {
       proxsuite::linalg::sparse::from_raw_parts,
       n_tot,
       n_tot,
       nnz,
-      kkt_col_ptrs.ptr_mut(),
+      kkt_col_ptrs->ptr_mut(),
       nullptr,
-      kkt_row_indices.ptr_mut(),
+      kkt_row_indices->ptr_mut(),
       kkt_values.ptr_mut(),
     };
   }
   /*!
-   * Returns the original (unscaled) KKT matrix of the problem.
+   * Returns the original (unscaled) KKT matrix of the problem. If the unscaled
+   * values are not stored, the values of the scaled KKT matrix are returned
+   * instead, and are only the original ones once they have been unscaled in
+   * place.
    */
   auto kkt_unscaled() const -> proxsuite::linalg::sparse::MatRef<T, I>
   {
-    auto n_tot = kkt_col_ptrs_unscaled.len() - 1;
-    auto nnz = isize(proxsuite::linalg::sparse::util::zero_extend(
-      kkt_col_ptrs_unscaled[n_tot]));
+    auto n_tot = kkt_col_ptrs->len() - 1;
+    auto nnz = isize(
+      proxsuite::linalg::sparse::util::zero_extend((*kkt_col_ptrs)[n_tot]));
     return {
       proxsuite::linalg::sparse::from_raw_parts,
       n_tot,
       n_tot,
       nnz,
-      kkt_col_ptrs_unscaled.ptr(),
+      kkt_col_ptrs->ptr(),
       nullptr,
-      kkt_row_indices_unscaled.ptr(),
-      kkt_values_unscaled.ptr(),
+      kkt_row_indices->ptr(),
+      store_unscaled_kkt ? kkt_values_unscaled.ptr() : kkt_values.ptr(),
     };
   }
   /*!
    * Returns the original (unscaled) KKT matrix of the problem (mutable form).
+   * If the unscaled values are not stored, the values of the scaled KKT matrix
+   * are returned instead, and are only the original ones once they have been
+   * unscaled in place.
    */
   auto kkt_mut_unscaled() -> proxsuite::linalg::sparse::MatMut<T, I>
   {
-    auto n_tot = kkt_col_ptrs_unscaled.len() - 1;
-    auto nnz = isize(proxsuite::linalg::sparse::util::zero_extend(
-      kkt_col_ptrs_unscaled[n_tot]));
+    auto n_tot = kkt_col_ptrs->len() - 1;
+    auto nnz = isize(
+      proxsuite::linalg::sparse::util::zero_extend((*kkt_col_ptrs)[n_tot]));
     return {
       proxsuite::linalg::sparse::from_raw_parts,
       n_tot,
       n_tot,
       nnz,
-      kkt_col_ptrs_unscaled.ptr_mut(),
+      kkt_col_ptrs->ptr_mut(),
       nullptr,
-      kkt_row_indices_unscaled.ptr_mut(),
-      kkt_values_unscaled.ptr_mut(),
+      kkt_row_indices->ptr_mut(),
+      store_unscaled_kkt ? kkt_values_unscaled.ptr_mut()
+                         : kkt_values.ptr_mut(),
     };
   }
 };
@@ -30,6 +30,13 @@ struct Identity
   {
   }
 
+  void unscale_matrices_in_place(
+    proxsuite::linalg::sparse::MatMut<T, I> /*H*/,
+    proxsuite::linalg::sparse::MatMut<T, I> /*AT*/,
+    proxsuite::linalg::sparse::MatMut<T, I> /*CT*/)
+  {
+  }
+
   // modifies variables in place
   void scale_primal_in_place(VectorViewMut<T> /*primal*/) {}
   void scale_dual_in_place(VectorViewMut<T> /*dual*/) {}
@@ -7,6 +7,7 @@
 #define PROXSUITE_QP_SPARSE_PRECOND_RUIZ_HPP
 
 #include "proxsuite/proxqp/sparse/fwd.hpp"
+#include <proxsuite/helpers/omp.hpp>
 
 namespace proxsuite {
 namespace proxqp {
@@ -20,94 +21,226 @@ enum struct Symmetry
 };
 
 namespace detail {
+/// minimal number of non zeros each thread is given by the parallel
+/// equilibration sweeps, below which the serial sweep is used
+constexpr isize ruiz_min_nnz_per_thread = 16384;
+
+/*!
+ * Equilibration sweep over the columns [col_begin, col_end) of the
+ * concatenation of H, AT and CT. If delta is not null, the entries are scaled
+ * in place, those of H being also multiplied by gamma. In any case, the
+ * infinity norms of the (scaled) entries are accumulated: the norms of the
+ * columns of H and of the rows of the constraint matrices are written to
+ * h_norm and cstr_norm for the columns the range owns, while the norms
+ * scattered to the other variables are accumulated in h_scatter (for H) and
+ * ac_scatter (for A and C).
+ */
 template<typename T, typename I>
 void
-rowwise_infty_norm(T* row_norm, proxsuite::linalg::sparse::MatRef<T, I> m)
+ruiz_sweep_cols(T* h_norm,
+                T* cstr_norm,
+                T* h_scatter,
+                T* ac_scatter,
+                QpViewMut<T, I> qp,
+                T const* delta,
+                T gamma,
+                Symmetry sym,
+                usize col_begin,
+                usize col_end)
 {
   using namespace proxsuite::linalg::sparse::util;
 
-  I const* mi = m.row_indices();
-  T const* mx = m.values();
+  usize n = usize(qp.H.nrows());
+  usize n_eq = usize(qp.AT.ncols());
 
-  for (usize j = 0; j < usize(m.ncols()); ++j) {
-    auto col_start = m.col_start(j);
-    auto col_end = m.col_end(j);
+  I const* Hi = qp.H.row_indices();
+  T* Hx = qp.H.values_mut();
 
-    for (usize p = col_start; p < col_end; ++p) {
-      usize i = zero_extend(mi[p]);
-      T mij = fabs(mx[p]);
-      row_norm[i] = std::max(row_norm[i], mij);
+  for (usize k = col_begin; k < col_end; ++k) {
+    if (k < n) {
+      usize j = k;
+      usize col_start = qp.H.col_start(j);
+      usize col_end_ = qp.H.col_end(j);
+      T delta_j = delta == nullptr ? T(1) : delta[j] * gamma;
+      T norm_j = 0;
+
+      for (usize p = col_start; p < col_end_; ++p) {
+        usize i = zero_extend(Hi[p]);
+        if ((sym == Symmetry::UPPER) ? (i > j) : (i < j)) {
+          continue;
+        }
+        if (delta != nullptr) {
+          Hx[p] = delta_j * Hx[p] * delta[i];
+        }
+        T hij = fabs(Hx[p]);
+        norm_j = std::max(norm_j, hij);
+        if (i != j) {
+          h_scatter[i] = std::max(h_scatter[i], hij);
+        }
+      }
+      h_norm[j] = std::max(h_norm[j], norm_j);
+    } else {
+      bool is_eq = k < n + n_eq;
+      usize j = is_eq ? (k - n) : (k - n - n_eq);
+      auto m = is_eq ? qp.AT : qp.CT;
+
+      I const* mi = m.row_indices();
+      T* mx = m.values_mut();
+      usize col_start = m.col_start(j);
+      usize col_end_ = m.col_end(j);
+      T delta_j = delta == nullptr ? T(1) : delta[k];
+      T norm_j = 0;
+
+      for (usize p = col_start; p < col_end_; ++p) {
+        usize i = zero_extend(mi[p]);
+        if (delta != nullptr) {
+          mx[p] = delta[i] * (mx[p] * delta_j);
+        }
+        T mij = fabs(mx[p]);
+        norm_j = std::max(norm_j, mij);
+        ac_scatter[i] = std::max(ac_scatter[i], mij);
+      }
+      cstr_norm[k - n] = norm_j;
     }
   }
 }
 
-template<typename T, typename I>
-void
-colwise_infty_norm_symhi(T* col_norm, proxsuite::linalg::sparse::MatRef<T, I> h)
+/*!
+ * Computes the stack memory requirements of ruiz_sweep, for the given number
+ * of threads.
+ */
+template<typename T>
+auto
+ruiz_sweep_req(proxsuite::linalg::veg::Tag<T> tag,
+               isize n,
+               isize nthreads) noexcept
+  -> proxsuite::linalg::veg::dynstack::StackReq
 {
-  using namespace proxsuite::linalg::sparse::util;
-
-  I const* hi = h.row_indices();
-  T const* hx = h.values();
-
-  for (usize j = 0; j < usize(h.ncols()); ++j) {
-    auto col_start = h.col_start(j);
-    auto col_end = h.col_end(j);
-
-    T norm_j = 0;
-
-    for (usize p = col_start; p < col_end; ++p) {
-      usize i = zero_extend(hi[p]);
-      if (i > j) {
-        break;
-      }
-
-      T hij = fabs(hx[p]);
-      norm_j = std::max(norm_j, hij);
-      col_norm[i] = std::max(col_norm[i], hij);
-    }
-
-    col_norm[j] = norm_j;
+  using proxsuite::linalg::veg::dynstack::StackReq;
+  if (nthreads <= 1) {
+    return { 0, 1 };
   }
+  return StackReq::with_len(proxsuite::linalg::veg::Tag<usize>{},
+                            nthreads + 1) &
+         StackReq::with_len(tag, n * 2 * nthreads);
 }
 
+/*!
+ * Equilibration sweep over H, AT and CT, see ruiz_sweep_cols. The columns are
+ * split among threads in ranges holding roughly the same number of non zeros,
+ * the norms scattered by each thread being reduced at the end. The number of
+ * threads is limited by the memory left in the stack, see ruiz_sweep_req.
+ */
 template<typename T, typename I>
 void
-colwise_infty_norm_symlo(T* col_norm, proxsuite::linalg::sparse::MatRef<T, I> h)
+ruiz_sweep(T* h_norm,
+           T* ac_norm,
+           T* cstr_norm,
+           QpViewMut<T, I> qp,
+           T const* delta,
+           T gamma,
+           Symmetry sym,
+           proxsuite::linalg::veg::dynstack::DynStackMut stack)
 {
-  using namespace proxsuite::linalg::sparse::util;
-
-  I const* hi = h.row_indices();
-  T const* hx = h.values();
+  isize n = qp.H.nrows();
+  isize n_eq = qp.AT.ncols();
+  isize n_in = qp.CT.ncols();
+  usize n_cols = usize(n + n_eq + n_in);
 
-  for (usize j = 0; j < usize(h.ncols()); ++j) {
-    auto col_start = h.col_start(j);
-    auto col_end = h.col_end(j);
+  for (isize i = 0; i < n; ++i) {
+    h_norm[i] = 0;
+    ac_norm[i] = 0;
+  }
 
-    T norm_j = 0;
+  isize nthreads = isize(proxsuite::helpers::get_num_threads_for(
+    qp.H.nnz() + qp.AT.nnz() + qp.CT.nnz(), ruiz_min_nnz_per_thread));
+  while (nthreads > 1 &&
+         ruiz_sweep_req(proxsuite::linalg::veg::Tag<T>{}, n, nthreads)
+             .alloc_req() > stack.remaining_bytes()) {
+    --nthreads;
+  }
+  if (nthreads == 1) {
+    ruiz_sweep_cols(
+      h_norm, cstr_norm, h_norm, ac_norm, qp, delta, gamma, sym, 0, n_cols);
+    return;
+  }
 
-    if (col_end > col_start) {
-      usize p = col_end;
-      while (true) {
-        --p;
-        usize i = zero_extend(hi[p]);
-        if (i < j) {
-          break;
-        }
+  auto col_nnz = [&](usize k) -> usize {
+    if (k < usize(n)) {
+      return qp.H.col_end(k) - qp.H.col_start(k);
+    } else if (k < usize(n + n_eq)) {
+      return qp.AT.col_end(k - usize(n)) - qp.AT.col_start(k - usize(n));
+    } else {
+      return qp.CT.col_end(k - usize(n + n_eq)) -
+             qp.CT.col_start(k - usize(n + n_eq));
+    }
+  };
+  usize nnz = 0;
+  for (usize k = 0; k < n_cols; ++k) {
+    nnz += col_nnz(k);
+  }
+  auto _col_split = stack.make_new_for_overwrite(
+    proxsuite::linalg::veg::Tag<usize>{}, nthreads + 1);
+  usize* col_split = _col_split.ptr_mut();
+  col_split[0] = 0;
+  {
+    usize acc = 0;
+    isize t = 1;
+    for (usize k = 0; k < n_cols; ++k) {
+      acc += col_nnz(k);
+      while (t < nthreads && acc * usize(nthreads) >= nnz * usize(t)) {
+        col_split[t] = k + 1;
+        ++t;
+      }
+    }
+    for (; t <= nthreads; ++t) {
+      col_split[t] = n_cols;
+    }
+  }
 
-        T hij = fabs(hx[p]);
-        norm_j = std::max(norm_j, hij);
-        col_norm[i] = std::max(col_norm[i], hij);
+  // the norms scattered by each thread to the variables are accumulated in a
+  // private buffer, while the norms of the columns a thread owns are written
+  // directly
+  auto _buf =
+    stack.make_new(proxsuite::linalg::veg::Tag<T>{}, n * 2 * nthreads);
+  Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>> buf{
+    _buf.ptr_mut(), n, 2 * nthreads
+  };
+
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+#endif
+  for (isize t = 0; t < nthreads; ++t) {
+    ruiz_sweep_cols(h_norm,
+                    cstr_norm,
+                    buf.col(2 * t).data(),
+                    buf.col(2 * t + 1).data(),
+                    qp,
+                    delta,
+                    gamma,
+                    sym,
+                    col_split[t],
+                    col_split[t + 1]);
+  }
 
-        if (p <= col_start) {
-          break;
-        }
-      }
+  for (isize i = 0; i < n; ++i) {
+    T h_scatter = 0;
+    T ac_scatter = 0;
+    for (isize t = 0; t < nthreads; ++t) {
+      h_scatter = std::max(h_scatter, buf(i, 2 * t));
+      ac_scatter = std::max(ac_scatter, buf(i, 2 * t + 1));
     }
-    col_norm[j] = std::max(col_norm[j], norm_j);
+    h_norm[i] = std::max(h_norm[i], h_scatter);
+    ac_norm[i] = ac_scatter;
   }
 }
 
+/*!
+ * Ruiz equilibration of qp, the scalings being multiplied into delta_ and the
+ * cost scaling being returned. If incremental is set to true, the entries of
+ * the scaling whose update is within epsilon of one are kept fixed, so that
+ * only the rows and columns which are not equilibrated yet are rescaled.
+ */
 template<typename T, typename I>
 auto
 ruiz_scale_qp_in_place( //
@@ -116,7 +249,8 @@ ruiz_scale_qp_in_place( //
   T epsilon,
   isize max_iter,
   Symmetry sym,
-  proxsuite::linalg::veg::dynstack::DynStackMut stack) -> T
+  proxsuite::linalg::veg::dynstack::DynStackMut stack,
+  bool incremental = false) -> T
 {
 
   T c = 1;
@@ -131,17 +265,29 @@ ruiz_scale_qp_in_place( //
 
   LDLT_TEMP_VEC(T, delta, n + n_eq + n_in, stack);
 
-  I* Hi = qp.H.row_indices_mut();
-  T* Hx = qp.H.values_mut();
-
-  I* ATi = qp.AT.row_indices_mut();
-  T* ATx = qp.AT.values_mut();
-
-  I* CTi = qp.CT.row_indices_mut();
-  T* CTx = qp.CT.values_mut();
+  // infinity norms of the columns of H, of the columns of A and C, and of the
+  // rows of A and C, updated by each equilibration sweep
+  auto _h_infty_norm = stack.make_new(proxsuite::linalg::veg::Tag<T>{}, n);
+  auto _ac_infty_norm = stack.make_new(proxsuite::linalg::veg::Tag<T>{}, n);
+  auto _cstr_infty_norm =
+    stack.make_new(proxsuite::linalg::veg::Tag<T>{}, n_eq + n_in);
+  T* h_infty_norm = _h_infty_norm.ptr_mut();
+  T* ac_infty_norm = _ac_infty_norm.ptr_mut();
+  T* cstr_infty_norm = _cstr_infty_norm.ptr_mut();
 
   T const machine_eps = std::numeric_limits<T>::epsilon();
 
+  detail::ruiz_sweep(h_infty_norm,
+                     ac_infty_norm,
+                     cstr_infty_norm,
+                     qp,
+                     static_cast<T const*>(nullptr),
+                     T(1),
+                     sym,
+                     stack);
+
+  // the cost scaling gamma of an iteration is only applied to H by the sweep
+  // of the next one (or at the end), the norms of H being scaled accordingly
   while (infty_norm((1 - delta.array()).matrix()) > epsilon) {
     if (iter == max_iter) {
       break;
@@ -149,139 +295,34 @@ ruiz_scale_qp_in_place( //
       ++iter;
     }
 
-    // norm_infty of each column of A (resp. C), i.e.,
-    // each row of AT (resp. CT)
-    {
-      auto _a_infty_norm = stack.make_new(proxsuite::linalg::veg::Tag<T>{}, n);
-      auto _c_infty_norm = stack.make_new(proxsuite::linalg::veg::Tag<T>{}, n);
-      auto _h_infty_norm = stack.make_new(proxsuite::linalg::veg::Tag<T>{}, n);
-      T* a_infty_norm = _a_infty_norm.ptr_mut();
-      T* c_infty_norm = _c_infty_norm.ptr_mut();
-      T* h_infty_norm = _h_infty_norm.ptr_mut();
-
-      detail::rowwise_infty_norm(a_infty_norm, qp.AT.as_const());
-      detail::rowwise_infty_norm(c_infty_norm, qp.CT.as_const());
-      switch (sym) {
-        case Symmetry::LOWER: {
-          detail::colwise_infty_norm_symlo(h_infty_norm, qp.H.as_const());
-          break;
-        }
-        case Symmetry::UPPER: {
-          detail::colwise_infty_norm_symhi(h_infty_norm, qp.H.as_const());
-          break;
-        }
-      }
-
-      for (isize j = 0; j < n; ++j) {
-        delta(j) = T(1) / (machine_eps + sqrt(std::max({
-                                           h_infty_norm[j],
-                                           a_infty_norm[j],
-                                           c_infty_norm[j],
-                                         })));
-      }
-    }
-    using namespace proxsuite::linalg::sparse::util;
-    for (usize j = 0; j < usize(n_eq); ++j) {
-      T a_row_norm = 0;
-      qp.AT.to_eigen();
-      usize col_start = qp.AT.col_start(j);
-      usize col_end = qp.AT.col_end(j);
-
-      for (usize p = col_start; p < col_end; ++p) {
-        T aji = fabs(ATx[p]);
-        a_row_norm = std::max(a_row_norm, aji);
-      }
-
-      delta(n + isize(j)) = T(1) / (machine_eps + sqrt(a_row_norm));
-    }
-
-    for (usize j = 0; j < usize(n_in); ++j) {
-      T c_row_norm = 0;
-      usize col_start = qp.CT.col_start(j);
-      usize col_end = qp.CT.col_end(j);
-
-      for (usize p = col_start; p < col_end; ++p) {
-        T cji = fabs(CTx[p]);
-        c_row_norm = std::max(c_row_norm, cji);
-      }
-
-      delta(n + n_eq + isize(j)) = T(1) / (machine_eps + sqrt(c_row_norm));
-    }
-
-    // normalize A
-    for (usize j = 0; j < usize(n_eq); ++j) {
-      usize col_start = qp.AT.col_start(j);
-      usize col_end = qp.AT.col_end(j);
-
-      T delta_j = delta(n + isize(j));
-
-      for (usize p = col_start; p < col_end; ++p) {
-        usize i = zero_extend(ATi[p]);
-        T& aji = ATx[p];
-        T delta_i = delta(isize(i));
-        aji = delta_i * (aji * delta_j);
-      }
+    for (isize j = 0; j < n; ++j) {
+      delta(j) = T(1) / (machine_eps + sqrt(std::max({
+                                         gamma * h_infty_norm[j],
+                                         ac_infty_norm[j],
+                                       })));
     }
-
-    // normalize C
-    for (usize j = 0; j < usize(n_in); ++j) {
-      usize col_start = qp.CT.col_start(j);
-      usize col_end = qp.CT.col_end(j);
-
-      T delta_j = delta(n + n_eq + isize(j));
-
-      for (usize p = col_start; p < col_end; ++p) {
-        usize i = zero_extend(CTi[p]);
-        T& cji = CTx[p];
-        T delta_i = delta(isize(i));
-        cji = delta_i * (cji * delta_j);
-      }
+    for (isize j = 0; j < n_eq + n_in; ++j) {
+      delta(n + j) = T(1) / (machine_eps + sqrt(cstr_infty_norm[j]));
     }
-
-    // normalize H
-    switch (sym) {
-      case Symmetry::LOWER: {
-        for (usize j = 0; j < usize(n); ++j) {
-          usize col_start = qp.H.col_start(j);
-          usize col_end = qp.H.col_end(j);
-          T delta_j = delta(isize(j));
-
-          if (col_end > col_start) {
-            usize p = col_end;
-            while (true) {
-              --p;
-              usize i = zero_extend(Hi[p]);
-              if (i < j) {
-                break;
-              }
-              Hx[p] = delta_j * Hx[p] * delta(isize(i));
-
-              if (p <= col_start) {
-                break;
-              }
-            }
-          }
-        }
-        break;
-      }
-      case Symmetry::UPPER: {
-        for (usize j = 0; j < usize(n); ++j) {
-          usize col_start = qp.H.col_start(j);
-          usize col_end = qp.H.col_end(j);
-          T delta_j = delta(isize(j));
-
-          for (usize p = col_start; p < col_end; ++p) {
-            usize i = zero_extend(Hi[p]);
-            if (i > j) {
-              break;
-            }
-            Hx[p] = delta_j * Hx[p] * delta(isize(i));
-          }
+    if (incremental) {
+      for (isize j = 0; j < n + n_eq + n_in; ++j) {
+        if (std::abs(T(1) - delta(j)) <= epsilon) {
+          delta(j) = T(1);
         }
-        break;
       }
     }
 
+    // scales H, A and C, and computes the norms of the scaled matrices in the
+    // same sweep
+    detail::ruiz_sweep(h_infty_norm,
+                       ac_infty_norm,
+                       cstr_infty_norm,
+                       qp,
+                       delta.data(),
+                       gamma,
+                       sym,
+                       stack);
+
     // normalize vectors
     qp.g.to_eigen().array() *= delta.head(n).array();
     qp.b.to_eigen().array() *= delta.segment(n, n_eq).array();
@@ -289,20 +330,6 @@ ruiz_scale_qp_in_place( //
     qp.u.to_eigen().array() *= delta.tail(n_in).array();
 
     // additional normalization
-    auto _h_infty_norm = stack.make_new(proxsuite::linalg::veg::Tag<T>{}, n);
-    T* h_infty_norm = _h_infty_norm.ptr_mut();
-
-    switch (sym) {
-      case Symmetry::LOWER: {
-        detail::colwise_infty_norm_symlo(h_infty_norm, qp.H.as_const());
-        break;
-      }
-      case Symmetry::UPPER: {
-        detail::colwise_infty_norm_symhi(h_infty_norm, qp.H.as_const());
-        break;
-      }
-    }
-
     T avg = 0;
     for (isize i = 0; i < n; ++i) {
       avg += h_infty_norm[i];
@@ -312,11 +339,14 @@ ruiz_scale_qp_in_place( //
     gamma = 1 / std::max(avg, T(1));
 
     qp.g.to_eigen() *= gamma;
-    qp.H.to_eigen() *= gamma;
 
     S.array() *= delta.array();
     c *= gamma;
   }
+
+  if (gamma != T(1)) {
+    qp.H.to_eigen() *= gamma;
+  }
   return c;
 }
 } // namespace detail
@@ -357,7 +387,10 @@ struct RuizEquilibration
     -> proxsuite::linalg::veg::dynstack::StackReq
   {
     return proxsuite::linalg::dense::temp_vec_req(tag, n + n_eq + n_in) &
-           proxsuite::linalg::veg::dynstack::StackReq::with_len(tag, 3 * n);
+           proxsuite::linalg::veg::dynstack::StackReq::with_len(
+             tag, 2 * n + n_eq + n_in) &
+           detail::ruiz_sweep_req(
+             tag, n, isize(proxsuite::helpers::get_max_threads()));
   }
 
   void scale_qp_in_place(QpViewMut<T, I> qp,
@@ -475,6 +508,107 @@ struct RuizEquilibration
     }
   }
 
+  /*!
+   * Scales in place a qp whose matrices may differ from those the current
+   * scaling was computed for. The qp is first scaled with the current scaling,
+   * then the equilibration is resumed from it, only rescaling the rows and
+   * columns which are no longer equilibrated.
+   * @param qp qp to be scaled.
+   * @param max_iter maximal number of equilibration iterations.
+   * @param epsilon accuracy of the equilibration.
+   * @param stack workspace, see scale_qp_in_place_req.
+   */
+  void scale_qp_in_place_incremental(
+    QpViewMut<T, I> qp,
+    const isize max_iter,
+    const T epsilon,
+    proxsuite::linalg::veg::dynstack::DynStackMut stack)
+  {
+    scale_qp_in_place(qp, false, max_iter, epsilon, stack);
+    c *= detail::ruiz_scale_qp_in_place( //
+      { proxqp::from_eigen, delta },
+      qp,
+      epsilon,
+      max_iter,
+      sym,
+      stack,
+      true);
+  }
+
+  /*!
+   * Unscales in place the matrices H, AT and CT of a problem previously scaled
+   * with scale_qp_in_place, so that they recover their original values.
+   * @param H upper (or lower, depending on sym) triangular part of the scaled
+   * cost matrix.
+   * @param AT transposed scaled equality constraint matrix.
+   * @param CT transposed scaled inequality constraint matrix.
+   */
+  void unscale_matrices_in_place(proxsuite::linalg::sparse::MatMut<T, I> H,
+                                 proxsuite::linalg::sparse::MatMut<T, I> AT,
+                                 proxsuite::linalg::sparse::MatMut<T, I> CT)
+  {
+    using proxsuite::linalg::sparse::util::zero_extend;
+    isize n = H.nrows();
+    isize n_eq = AT.ncols();
+    isize n_in = CT.ncols();
+
+    I* Hi = H.row_indices_mut();
+    T* Hx = H.values_mut();
+
+    I* ATi = AT.row_indices_mut();
+    T* ATx = AT.values_mut();
+
+    I* CTi = CT.row_indices_mut();
+    T* CTx = CT.values_mut();
+
+    // unscale A
+    for (usize j = 0; j < usize(n_eq); ++j) {
+      usize col_start = AT.col_start(j);
+      usize col_end = AT.col_end(j);
+
+      T delta_j = delta(n + isize(j));
+
+      for (usize p = col_start; p < col_end; ++p) {
+        usize i = zero_extend(ATi[p]);
+        T& aji = ATx[p];
+        T delta_i = delta(isize(i));
+        aji = (aji / delta_j) / delta_i;
+      }
+    }
+
+    // unscale C
+    for (usize j = 0; j < usize(n_in); ++j) {
+      usize col_start = CT.col_start(j);
+      usize col_end = CT.col_end(j);
+
+      T delta_j = delta(n + n_eq + isize(j));
+
+      for (usize p = col_start; p < col_end; ++p) {
+        usize i = zero_extend(CTi[p]);
+        T& cji = CTx[p];
+        T delta_i = delta(isize(i));
+        cji = (cji / delta_j) / delta_i;
+      }
+    }
+
+    // unscale H
+    for (usize j = 0; j < usize(n); ++j) {
+      usize col_start = H.col_start(j);
+      usize col_end = H.col_end(j);
+      T delta_j = delta(isize(j));
+
+      for (usize p = col_start; p < col_end; ++p) {
+        usize i = zero_extend(Hi[p]);
+        Hx[p] /= c;
+        if ((sym == Symmetry::UPPER && i > j) ||
+            (sym == Symmetry::LOWER && i < j)) {
+          continue;
+        }
+        Hx[p] = (Hx[p] / delta_j) / delta(isize(i));
+      }
+    }
+  }
+
   // modifies variables in place
   void scale_primal_in_place(VectorViewMut<T> primal)
   {
@@ -0,0 +1,261 @@
+//
+// Copyright (c) 2022 INRIA
+//
+/**
+ * @file serialization.hpp
+ */
+#ifndef PROXSUITE_QP_SPARSE_SERIALIZATION_HPP
+#define PROXSUITE_QP_SPARSE_SERIALIZATION_HPP
+
+#include <proxsuite/proxqp/serialization.hpp>
+#include <proxsuite/proxqp/sparse/wrapper.hpp>
+#include <vector>
+
+namespace proxsuite {
+namespace proxqp {
+namespace sparse {
+
+namespace _detail {
+template<typename T, typename I>
+void
+save_matrix(serialization::Writer& out, SparseMat<T, I> const& mat)
+{
+  out(mat.rows());
+  out(mat.cols());
+  out(mat.nonZeros());
+  out.array(mat.outerIndexPtr(), mat.cols() + 1);
+  out.array(mat.innerIndexPtr(), mat.nonZeros());
+  out.array(mat.valuePtr(), mat.nonZeros());
+}
+
+template<typename T, typename I>
+auto
+load_matrix(serialization::Reader& in, isize rows, isize cols)
+  -> SparseMat<T, I>
+{
+  isize read_rows = 0;
+  isize read_cols = 0;
+  isize nnz = 0;
+  in(read_rows);
+  in(read_cols);
+  in(nnz);
+  PROXSUITE_THROW_PRETTY(read_rows != rows || read_cols != cols || nnz < 0,
+                         std::invalid_argument,
+                         "invalid serialized QP: wrong dimensions.");
+  in.check_remaining(nnz, 1, sizeof(I) + sizeof(T));
+  SparseMat<T, I> mat(rows, cols);
+  mat.resizeNonZeros(nnz);
+  in.array(mat.outerIndexPtr(), cols + 1);
+  in.array(mat.innerIndexPtr(), nnz);
+  in.array(mat.valuePtr(), nnz);
+  I const* col_ptrs = mat.outerIndexPtr();
+  I const* row_indices = mat.innerIndexPtr();
+  bool valid = isize(col_ptrs[0]) == 0 && isize(col_ptrs[cols]) == nnz;
+  for (isize j = 0; valid && j < cols; ++j) {
+    valid = col_ptrs[j] <= col_ptrs[j + 1];
+  }
+  // the row indices of each column are in range and strictly increasing
+  for (isize j = 0; valid && j < cols; ++j) {
+    for (isize k = isize(col_ptrs[j]); valid && k < isize(col_ptrs[j + 1]);
+         ++k) {
+      valid = isize(row_indices[k]) >= 0 && isize(row_indices[k]) < rows &&
+              (k == isize(col_ptrs[j]) || row_indices[k - 1] < row_indices[k]);
+    }
+  }
+  PROXSUITE_THROW_PRETTY(!valid,
+                         std::invalid_argument,
+                         "invalid serialized QP: wrong sparsity pattern.");
+  return mat;
+}
+
+/// unscaled upper triangular part of H, and transposed constraint matrices
+template<typename T, typename I>
+struct UnscaledMatrices
+{
+  SparseMat<T, I> H_triu;
+  SparseMat<T, I> AT;
+  SparseMat<T, I> CT;
+};
+
+template<typename T, typename I>
+auto
+unscaled_matrices(QP<T, I> const& qp) -> UnscaledMatrices<T, I>
+{
+  Model<T, I> const& model = qp.model;
+  PROXSUITE_THROW_PRETTY(model.kkt_col_ptrs->len() == 0 ||
+                           model.kkt_values.len() <
+                             model.H_nnz + model.A_nnz + model.C_nnz,
+                         std::invalid_argument,
+                         "the QP object must be initialized before being "
+                         "serialized.");
+  auto kkt_top_n_rows = detail::top_rows_unchecked(
+    proxsuite::linalg::veg::unsafe, model.kkt_unscaled(), model.dim);
+  UnscaledMatrices<T, I> matrices{
+    detail::middle_cols(kkt_top_n_rows, 0, model.dim, model.H_nnz)
+      .to_eigen(),
+    detail::middle_cols(kkt_top_n_rows, model.dim, model.n_eq, model.A_nnz)
+      .to_eigen(),
+    detail::middle_cols(
+      kkt_top_n_rows, model.dim + model.n_eq, model.n_in, model.C_nnz)
+      .to_eigen(),
+  };
+  if (!model.store_unscaled_kkt) {
+    // the kkt matrix holds the scaled values, which are unscaled on the copies
+    // so that the QP object is left untouched
+    preconditioner::RuizEquilibration<T, I> ruiz = qp.ruiz;
+    ruiz.unscale_matrices_in_place(
+      { proxsuite::linalg::sparse::from_eigen, matrices.H_triu },
+      { proxsuite::linalg::sparse::from_eigen, matrices.AT },
+      { proxsuite::linalg::sparse::from_eigen, matrices.CT });
+  }
+  return matrices;
+}
+
+template<typename T, typename I>
+void
+save(serialization::Writer& out,
+     QP<T, I> const& qp,
+     UnscaledMatrices<T, I> const& matrices)
+{
+  serialization::header(out, QPBackend::SPARSE, sizeof(T), sizeof(I));
+  out(qp.model.dim);
+  out(qp.model.n_eq);
+  out(qp.model.n_in);
+  serialization::visit_settings(qp.settings, out);
+  // the model is stored unscaled, along with the preconditioner which scales
+  // it, so that the equilibration is not executed again when loading it
+  save_matrix(out, matrices.H_triu);
+  out.dense(qp.model.g);
+  save_matrix(out, matrices.AT);
+  out.dense(qp.model.b);
+  save_matrix(out, matrices.CT);
+  out.dense(qp.model.u);
+  out.dense(qp.model.l);
+  out.dense(qp.ruiz.delta);
+  out(qp.ruiz.c);
+  serialization::save_results(out, qp.results);
+}
+} // namespace _detail
+
+/*!
+ * Returns the size, in bytes, of the serialized QP object. The QP object must
+ * have been initialized.
+ *
+ * @param qp QP object.
+ */
+template<typename T, typename I>
+auto
+serialized_size(QP<T, I> const& qp) -> std::size_t
+{
+  serialization::Writer out;
+  _detail::save(out, qp, _detail::unscaled_matrices(qp));
+  return out.size;
+}
+
+/*!
+ * Serializes the QP object (settings, model, preconditioner and results) into
+ * a buffer of serialized_size(qp) bytes, e.g. a shared memory segment. The QP
+ * object must have been initialized.
+ *
+ * @param qp QP object.
+ * @param data beginning of the buffer.
+ */
+template<typename T, typename I>
+void
+serialize(QP<T, I> const& qp, unsigned char* data)
+{
+  serialization::Writer out;
+  out.data = data;
+  _detail::save(out, qp, _detail::unscaled_matrices(qp));
+}
+
+/*!
+ * Serializes the QP object (settings, model, preconditioner and results). The
+ * QP object must have been initialized.
+ *
+ * @param qp QP object.
+ */
+template<typename T, typename I>
+auto
+serialize(QP<T, I> const& qp) -> std::vector<unsigned char>
+{
+  auto matrices = _detail::unscaled_matrices(qp);
+  serialization::Writer out;
+  _detail::save(out, qp, matrices);
+  std::vector<unsigned char> buffer(out.size);
+  out = serialization::Writer{};
+  out.data = buffer.data();
+  _detail::save(out, qp, matrices);
+  return buffer;
+}
+
+/*!
+ * Rebuilds a QP object from a buffer written by serialize. The model is set up
+ * with the stored preconditioner instead of equilibrating it again, and the
+ * results (hence a warm start) are the ones of the serialized object. Throws
+ * std::invalid_argument if the buffer is not a valid serialized sparse QP
+ * object with the scalar type T and the index type I.
+ *
+ * @param data beginning of the buffer.
+ * @param size size of the buffer, in bytes.
+ */
+template<typename T, typename I>
+auto
+deserialize(unsigned char const* data, std::size_t size) -> QP<T, I>
+{
+  serialization::Reader in{ data, size };
+  serialization::check_header(in, QPBackend::SPARSE, sizeof(T), sizeof(I));
+  isize dim = 0;
+  isize n_eq = 0;
+  isize n_in = 0;
+  in(dim);
+  in(n_eq);
+  in(n_in);
+  PROXSUITE_THROW_PRETTY(dim <= 0 || n_eq < 0 || n_in < 0,
+                         std::invalid_argument,
+                         "invalid serialized QP: wrong dimensions.");
+  // the buffer holds at least the column pointers of the matrices and the
+  // vectors of the model
+  in.check_remaining(dim, 1, sizeof(I) + sizeof(T));
+  in.check_remaining(n_eq, 1, sizeof(I) + sizeof(T));
+  in.check_remaining(n_in, 1, sizeof(I) + sizeof(T));
+  in.check_remaining(dim + n_eq + n_in, 1, sizeof(I) + sizeof(T));
+
+  QP<T, I> qp(dim, n_eq, n_in);
+  serialization::visit_settings(qp.settings, in);
+  SparseMat<T, I> H_triu = _detail::load_matrix<T, I>(in, dim, dim);
+  Vec<T> g(dim);
+  in.dense(g);
+  SparseMat<T, I> AT = _detail::load_matrix<T, I>(in, dim, n_eq);
+  Vec<T> b(n_eq);
+  in.dense(b);
+  SparseMat<T, I> CT = _detail::load_matrix<T, I>(in, dim, n_in);
+  Vec<T> u(n_in);
+  Vec<T> l(n_in);
+  in.dense(u);
+  in.dense(l);
+  in.dense(qp.ruiz.delta);
+  in(qp.ruiz.c);
+  Results<T> results(dim, n_eq, n_in);
+  serialization::load_results(in, results);
+
+  qp.init(H_triu,
+          g,
+          SparseMat<T, I>(AT.transpose()),
+          b,
+          SparseMat<T, I>(CT.transpose()),
+          u,
+          l,
+          false,
+          results.info.rho,
+          results.info.mu_eq,
+          results.info.mu_in);
+  qp.results = results;
+  return qp;
+}
+
+} // namespace sparse
+} // namespace proxqp
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_QP_SPARSE_SERIALIZATION_HPP */
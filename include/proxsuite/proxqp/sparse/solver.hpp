@@ -33,21 +33,26 @@ namespace proxsuite {
 namespace proxqp {
 namespace sparse {
 
+namespace detail {
+/// minimal average number of columns per level, per thread, for the level
+/// scheduled triangular solves to be used
+constexpr isize trsv_min_level_width_per_thread = 8;
+} // namespace detail
+
 template<typename T, typename I>
 void
 ldl_solve(VectorViewMut<T> sol,
           VectorView<T> rhs,
           isize n_tot,
           proxsuite::linalg::sparse::MatMut<T, I> ldl,
-          Eigen::MINRES<detail::AugmentedKkt<T, I>,
-                        Eigen::Upper | Eigen::Lower,
-                        Eigen::IdentityPreconditioner>& iterative_solver,
+          detail::MatrixFreeSolver<T, I>& iterative_solver,
           bool do_ldlt,
           proxsuite::linalg::veg::dynstack::DynStackMut stack,
           T* ldl_values,
           I* perm,
           I* ldl_col_ptrs,
-          I const* perm_inv)
+          I const* perm_inv,
+          detail::LdlSolveSchedule<I> const* schedule = nullptr)
 {
   LDLT_TEMP_VEC_UNINIT(T, work_, n_tot, stack);
   auto rhs_e = rhs.to_eigen();
@@ -60,17 +65,48 @@ ldl_solve(VectorViewMut<T> sol,
       work_[i] = rhs_e[isize(zx(perm[i]))];
     }
 
-    proxsuite::linalg::sparse::dense_lsolve<T, I>( //
-      { proxsuite::linalg::sparse::from_eigen, work_ },
-      ldl.as_const());
+    if (schedule != nullptr) {
+      // the threads of the level scheduled solve need accumulation buffers,
+      // which are only reserved for as many threads as were available at the
+      // setup of the workspace
+      isize nthreads = schedule->nthreads;
+      while (nthreads > 1 &&
+             proxsuite::linalg::sparse::dense_lsolve_levels_req(
+               proxsuite::linalg::veg::Tag<T>{}, n_tot, nthreads)
+                 .alloc_req() > stack.remaining_bytes()) {
+        --nthreads;
+      }
+      proxsuite::linalg::sparse::dense_lsolve_levels<T, I>( //
+        { proxsuite::linalg::sparse::from_eigen, work_ },
+        ldl.as_const(),
+        schedule->lsolve_level_ptrs,
+        schedule->lsolve_level_cols,
+        schedule->lsolve_nlevels,
+        nthreads,
+        stack);
+    } else {
+      proxsuite::linalg::sparse::dense_lsolve<T, I>( //
+        { proxsuite::linalg::sparse::from_eigen, work_ },
+        ldl.as_const());
+    }
 
     for (isize i = 0; i < n_tot; ++i) {
       work_[i] /= ldl_values[isize(zx(ldl_col_ptrs[i]))];
     }
 
-    proxsuite::linalg::sparse::dense_ltsolve<T, I>( //
-      { proxsuite::linalg::sparse::from_eigen, work_ },
-      ldl.as_const());
+    if (schedule != nullptr) {
+      proxsuite::linalg::sparse::dense_ltsolve_levels<T, I>( //
+        { proxsuite::linalg::sparse::from_eigen, work_ },
+        ldl.as_const(),
+        schedule->ltsolve_level_ptrs,
+        schedule->ltsolve_level_cols,
+        schedule->ltsolve_nlevels,
+        schedule->nthreads);
+    } else {
+      proxsuite::linalg::sparse::dense_ltsolve<T, I>( //
+        { proxsuite::linalg::sparse::from_eigen, work_ },
+        ldl.as_const());
+    }
 
     for (isize i = 0; i < n_tot; ++i) {
       sol_e[i] = work_[isize(zx(perm_inv[i]))];
@@ -91,9 +127,7 @@ ldl_iter_solve_noalias(
   Model<T, I> const& data,
   isize n_tot,
   proxsuite::linalg::sparse::MatMut<T, I> ldl,
-  Eigen::MINRES<detail::AugmentedKkt<T, I>,
-                Eigen::Upper | Eigen::Lower,
-                Eigen::IdentityPreconditioner>& iterative_solver,
+  detail::MatrixFreeSolver<T, I>& iterative_solver,
   bool do_ldlt,
   proxsuite::linalg::veg::dynstack::DynStackMut stack,
   T* ldl_values,
@@ -102,7 +136,9 @@ ldl_iter_solve_noalias(
   I const* perm_inv,
   Settings<T> const& settings,
   proxsuite::linalg::sparse::MatMut<T, I> kkt_active,
-  proxsuite::linalg::veg::SliceMut<bool> active_constraints)
+  proxsuite::linalg::veg::SliceMut<bool> active_constraints,
+  detail::SpmvPartition<T>& kkt_active_spmv,
+  detail::LdlSolveSchedule<I> schedule)
 {
   auto rhs_e = rhs.to_eigen();
   auto sol_e = sol.to_eigen();
@@ -115,6 +151,18 @@ ldl_iter_solve_noalias(
 
   LDLT_TEMP_VEC_UNINIT(T, err, n_tot, stack);
 
+  // the triangular solves are repeated at each refinement step with the same
+  // factor: when it is large enough and the levels of the schedules are wide
+  // enough, the independent columns are solved concurrently
+  isize trsv_nthreads = do_ldlt ? detail::spmv_nthreads(ldl.nnz()) : 1;
+  schedule.nthreads = trsv_nthreads;
+  isize nlevels = schedule.lsolve_nlevels > schedule.ltsolve_nlevels
+                    ? schedule.lsolve_nlevels
+                    : schedule.ltsolve_nlevels;
+  bool use_schedule = trsv_nthreads > 1 && nlevels > 0 &&
+                      n_tot >= nlevels * trsv_nthreads *
+                                 detail::trsv_min_level_width_per_thread;
+
   T prev_err_norm = std::numeric_limits<T>::infinity();
 
   for (isize solve_iter = 0; solve_iter < settings.nb_iterative_refinement;
@@ -133,7 +181,8 @@ ldl_iter_solve_noalias(
     if (solve_iter > 0) {
       T mu_eq_neg = -results.info.mu_eq;
       T mu_in_neg = -results.info.mu_in;
-      detail::noalias_symhiv_add(err, kkt_active.to_eigen(), sol_e);
+      detail::noalias_symhiv_add(
+        err, kkt_active.to_eigen(), sol_e, kkt_active_spmv);
       err_x += results.info.rho * sol_x;
       err_y += mu_eq_neg * sol_y;
       for (isize i = 0; i < data.n_in; ++i) {
@@ -157,7 +206,8 @@ ldl_iter_solve_noalias(
               ldl_values,
               perm,
               ldl_col_ptrs,
-              perm_inv);
+              perm_inv,
+              use_schedule ? &schedule : nullptr);
 
     sol_e -= err;
   }
@@ -185,6 +235,8 @@ ldl_iter_solve_noalias(
  * @param perm_inv pointor the inverse permutation.
  * @param settings solver's settings.
  * @param kkt_active active part of the kkt.
+ * @param kkt_active_spmv column partition of the products with kkt_active.
+ * @param schedule level schedules of the triangular solves with the ldlt.
  */
 template<typename T, typename I>
 void
@@ -195,9 +247,7 @@ ldl_solve_in_place(
   Model<T, I> const& data,
   isize n_tot,
   proxsuite::linalg::sparse::MatMut<T, I> ldl,
-  Eigen::MINRES<detail::AugmentedKkt<T, I>,
-                Eigen::Upper | Eigen::Lower,
-                Eigen::IdentityPreconditioner>& iterative_solver,
+  detail::MatrixFreeSolver<T, I>& iterative_solver,
   bool do_ldlt,
   proxsuite::linalg::veg::dynstack::DynStackMut stack,
   T* ldl_values,
@@ -206,7 +256,9 @@ ldl_solve_in_place(
   I const* perm_inv,
   Settings<T> const& settings,
   proxsuite::linalg::sparse::MatMut<T, I> kkt_active,
-  proxsuite::linalg::veg::SliceMut<bool> active_constraints)
+  proxsuite::linalg::veg::SliceMut<bool> active_constraints,
+  detail::SpmvPartition<T>& kkt_active_spmv,
+  detail::LdlSolveSchedule<I> schedule)
 {
   LDLT_TEMP_VEC_UNINIT(T, tmp, n_tot, stack);
   ldl_iter_solve_noalias({ proxqp::from_eigen, tmp },
@@ -225,7 +277,9 @@ ldl_solve_in_place(
                          perm_inv,
                          settings,
                          kkt_active,
-                         active_constraints);
+                         active_constraints,
+                         kkt_active_spmv,
+                         schedule);
   rhs.to_eigen() = tmp;
 }
 /*!
@@ -346,6 +400,7 @@ qp_solve(Results<T>& results,
         .dirty) // the following is used when a solve has already been executed
                 // (and without any intermediary model update)
   {
+    detail::unscale_kkt_in_place(data, precond);
     proxsuite::linalg::sparse::MatMut<T, I> kkt_unscaled =
       data.kkt_mut_unscaled();
 
@@ -504,6 +559,10 @@ qp_solve(Results<T>& results,
   proxsuite::linalg::sparse::MatMut<T, I> CT_scaled =
     detail::middle_cols_mut(kkt_top_n_rows, n + n_eq, n_in, data.C_nnz);
 
+  auto& spmv = work.internal.spmv;
+  auto& kkt_active_spmv = work.internal.matrix_free_kkt->kkt_active_spmv;
+  auto ldl_schedule = work.internal.ldl.solve_schedule();
+
   auto& g_scaled_e = work.internal.g_scaled;
   auto& b_scaled_e = work.internal.b_scaled;
   auto& l_scaled_e = work.internal.l_scaled;
@@ -548,6 +607,7 @@ qp_solve(Results<T>& results,
   I* kkt_nnz_counts = work.internal.kkt_nnz_counts.ptr_mut();
 
   auto& iterative_solver = *work.internal.matrix_free_solver.get();
+  iterative_solver.preconditioner().kind = settings.matrix_free_preconditioner;
   isize C_active_nnz = 0;
   switch (settings.initial_guess) {
     case InitialGuessStatus::EQUALITY_CONSTRAINED_INITIAL_GUESS: {
@@ -651,11 +711,13 @@ qp_solve(Results<T>& results,
     kkt.row_indices_mut(),
     kkt.values_mut(),
   };
+  // the active set was rebuilt, the previous partition may not match it
+  kkt_active_spmv.reset();
 
   I* etree = work.internal.ldl.etree.ptr_mut();
   I* ldl_nnz_counts = work.internal.ldl.nnz_counts.ptr_mut();
-  I* ldl_row_indices = work.internal.ldl.row_indices.ptr_mut();
-  T* ldl_values = work.internal.ldl.values.ptr_mut();
+  I* ldl_row_indices = work.internal.ldl.row_indices_ptr_mut();
+  T* ldl_values = work.internal.ldl.values_ptr_mut();
   proxsuite::linalg::veg::SliceMut<bool> active_constraints =
     results.active_constraints.as_mut();
 
@@ -704,7 +766,9 @@ qp_solve(Results<T>& results,
                          perm_inv,
                          settings,
                          kkt_active,
-                         active_constraints);
+                         active_constraints,
+                         kkt_active_spmv,
+                         ldl_schedule);
       x_e = rhs.head(n);
       y_e = rhs.segment(n, n_eq);
       z_e = rhs.segment(n + n_eq, n_in);
@@ -799,6 +863,7 @@ qp_solve(Results<T>& results,
                                               detail::vec(x_e),
                                               detail::vec(y_e),
                                               detail::vec(z_e),
+                                              spmv,
                                               stack));
       /*put in debug mode
       if (settings.verbose) {
@@ -817,7 +882,7 @@ qp_solve(Results<T>& results,
       if (settings.verbose) {
         LDLT_TEMP_VEC_UNINIT(T, tmp, n, stack);
         tmp.setZero();
-        detail::noalias_symhiv_add(tmp, qp_scaled.H.to_eigen(), x_e);
+        detail::noalias_symhiv_add(tmp, qp_scaled.H.to_eigen(), x_e, spmv.H);
         precond.unscale_dual_residual_in_place({ proxqp::from_eigen, tmp });
 
         precond.unscale_primal_in_place({ proxqp::from_eigen, x_e });
@@ -939,6 +1004,9 @@ qp_solve(Results<T>& results,
                   active_constraints[i] = new_active_constraints[i];
                 }
               }
+              if (removed || added) {
+                kkt_active_spmv.reset();
+              }
 
               if (!do_ldlt) {
                 if (removed || added) {
@@ -987,7 +1055,9 @@ qp_solve(Results<T>& results,
               perm_inv,
               settings,
               kkt_active,
-              active_constraints);
+              active_constraints,
+              kkt_active_spmv,
+              ldl_schedule);
           }
           auto dx = dw.head(n);
           auto dy = dw.segment(n, n_eq);
@@ -1000,9 +1070,11 @@ qp_solve(Results<T>& results,
           LDLT_TEMP_VEC(T, ATdy, n, stack);
           LDLT_TEMP_VEC(T, CTdz, n, stack);
 
-          detail::noalias_symhiv_add(Hdx, H_scaled.to_eigen(), dx);
-          detail::noalias_gevmmv_add(Adx, ATdy, AT_scaled.to_eigen(), dx, dy);
-          detail::noalias_gevmmv_add(Cdx, CTdz, CT_scaled.to_eigen(), dx, dz);
+          detail::noalias_symhiv_add(Hdx, H_scaled.to_eigen(), dx, spmv.H);
+          detail::noalias_gevmmv_add(
+            Adx, ATdy, AT_scaled.to_eigen(), dx, dy, spmv.AT);
+          detail::noalias_gevmmv_add(
+            Cdx, CTdz, CT_scaled.to_eigen(), dx, dz, spmv.CT);
 
           T alpha = 1;
           // primal dual line search
@@ -1224,6 +1296,7 @@ qp_solve(Results<T>& results,
                                               detail::vec(x_e),
                                               detail::vec(y_e),
                                               detail::vec(z_e),
+                                              spmv,
                                               stack));
 
       if (is_primal_feasible(primal_feasibility_lhs_new) &&
@@ -1281,6 +1354,7 @@ qp_solve(Results<T>& results,
                                               detail::vec(x_e),
                                               detail::vec(y_e),
                                               detail::vec(z_e),
+                                              spmv,
                                               stack));
       proxsuite::linalg::veg::unused(_);
 
@@ -1340,7 +1414,7 @@ qp_solve(Results<T>& results,
   }
   LDLT_TEMP_VEC_UNINIT(T, tmp, n, stack);
   tmp.setZero();
-  detail::noalias_symhiv_add(tmp, qp_scaled.H.to_eigen(), x_e);
+  detail::noalias_symhiv_add(tmp, qp_scaled.H.to_eigen(), x_e, spmv.H);
   precond.unscale_dual_residual_in_place({ proxqp::from_eigen, tmp });
 
   precond.unscale_primal_in_place({ proxqp::from_eigen, x_e });
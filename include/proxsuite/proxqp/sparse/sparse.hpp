@@ -6,5 +6,6 @@
 #define PROXSUITE_QP_SPARSE_SPARSE_HPP
 
 #include "proxsuite/proxqp/sparse/wrapper.hpp" // includes everything
+#include "proxsuite/proxqp/sparse/serialization.hpp"
 
 #endif /* end of include guard PROXSUITE_QP_SPARSE_SPARSE_HPP */
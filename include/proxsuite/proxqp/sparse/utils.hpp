@@ -14,6 +14,7 @@
 #include <proxsuite/proxqp/dense/views.hpp>
 #include <proxsuite/proxqp/settings.hpp>
 #include <proxsuite/linalg/veg/vec.hpp>
+#include <proxsuite/helpers/omp.hpp>
 #include "proxsuite/proxqp/results.hpp"
 #include "proxsuite/proxqp/utils/prints.hpp"
 #include "proxsuite/proxqp/sparse/views.hpp"
@@ -103,39 +104,127 @@ auto
 negative_part(T const& expr)
   VEG_DEDUCE_RET((expr.array() < 0).select(expr, T::Zero(expr.rows())));
 
+/// minimal number of non zeros each thread is given by the parallel sparse
+/// matrix vector products, below which the serial kernels are used
+constexpr isize spmv_min_nnz_per_thread = 16384;
+
+/*!
+ * Returns the number of threads to use for a sparse matrix vector product
+ * involving nnz non zeros.
+ */
+inline auto
+spmv_nthreads(isize nnz) -> isize
+{
+  return isize(
+    proxsuite::helpers::get_num_threads_for(nnz, spmv_min_nnz_per_thread));
+}
+
+/*!
+ * Splits the columns of a in nthreads contiguous ranges holding roughly the
+ * same number of non zeros. The range of the t-th thread is
+ * [col_split[t], col_split[t + 1]).
+ *
+ * @param col_split output array of size nthreads + 1.
+ * @param nthreads number of ranges.
+ * @param a sparse matrix.
+ */
 template<typename T, typename I>
-VEG_NO_INLINE void
-noalias_gevmmv_add_impl( //
-  VectorViewMut<T> out_l,
-  VectorViewMut<T> out_r,
-  proxsuite::linalg::sparse::MatRef<T, I> a,
-  VectorView<T> in_l,
-  VectorView<T> in_r)
+void
+spmv_col_split(usize* col_split,
+               isize nthreads,
+               proxsuite::linalg::sparse::MatRef<T, I> a)
 {
-  VEG_ASSERT_ALL_OF /* NOLINT */ (a.nrows() == out_r.dim,
-                                  a.ncols() == in_r.dim,
-                                  a.ncols() == out_l.dim,
-                                  a.nrows() == in_l.dim);
-  // equivalent to
-  // out_r.to_eigen().noalias() += a.to_eigen() * in_r.to_eigen();
-  // out_l.to_eigen().noalias() += a.to_eigen().transpose() * in_l.to_eigen();
+  usize n = usize(a.ncols());
+  // the nnz of the active kkt is only approximate, so we count it here
+  usize nnz = 0;
+  for (usize j = 0; j < n; ++j) {
+    nnz += a.col_end(j) - a.col_start(j);
+  }
+
+  col_split[0] = 0;
+  usize acc = 0;
+  isize t = 1;
+  for (usize j = 0; j < n; ++j) {
+    acc += a.col_end(j) - a.col_start(j);
+    while (t < nthreads && acc * usize(nthreads) >= nnz * usize(t)) {
+      col_split[t] = j + 1;
+      ++t;
+    }
+  }
+  for (; t <= nthreads; ++t) {
+    col_split[t] = n;
+  }
+}
 
+/*!
+ * Partition of the columns of a sparse matrix between the threads of the
+ * parallel matrix vector products, along with the buffer in which they
+ * accumulate their contributions before the reduction. It only depends on the
+ * sparsity pattern of the matrix and on the number of threads, and is stored
+ * in the workspace so that the products do not allocate.
+ */
+template<typename T>
+struct SpmvPartition
+{
+  /// number of threads of the partition, zero when it is not computed
+  isize nthreads = 0;
+  proxsuite::linalg::veg::Vec<usize> col_split;
+  Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> buf;
+
+  /*!
+   * Invalidates the partition, which must be done whenever the sparsity
+   * pattern of the matrix changes. Its storage is kept.
+   */
+  void reset() noexcept { nthreads = 0; }
+  /*!
+   * Computes the partition of a between nthreads_ threads, and the buffer of
+   * the threads other than the first one, unless the partition is already
+   * computed for as many threads.
+   */
+  template<typename I>
+  void prepare(proxsuite::linalg::sparse::MatRef<T, I> a, isize nthreads_)
+  {
+    if (nthreads == nthreads_) {
+      return;
+    }
+    col_split.resize_for_overwrite(nthreads_ + 1);
+    spmv_col_split(col_split.ptr_mut(), nthreads_, a);
+    buf.resize(a.nrows(), nthreads_ - 1);
+    nthreads = nthreads_;
+  }
+};
+
+/*!
+ * Accumulates the contributions of the columns [col_begin, col_end) of a to
+ * out_r += a * in_r and out_l += a.T * in_l. The entries of out_l that are
+ * updated are those of the column range only.
+ */
+template<typename T, typename I>
+VEG_INLINE void
+gevmmv_add_cols( //
+  T* out_l,
+  T* out_r,
+  proxsuite::linalg::sparse::MatRef<T, I> a,
+  T const* in_l,
+  T const* in_r,
+  usize col_begin,
+  usize col_end)
+{
   auto* ai = a.row_indices();
   auto* ax = a.values();
-  auto n = a.ncols();
 
-  for (usize j = 0; j < usize(n); ++j) {
+  for (usize j = col_begin; j < col_end; ++j) {
     usize col_start = a.col_start(j);
-    usize col_end = a.col_end(j);
+    usize col_end_j = a.col_end(j);
 
     T acc0 = 0;
     T acc1 = 0;
     T acc2 = 0;
     T acc3 = 0;
 
-    T in_rj = in_r(isize(j));
+    T in_rj = in_r[j];
 
-    usize pcount = col_end - col_start;
+    usize pcount = col_end_j - col_start;
 
     usize p = col_start;
 
@@ -152,55 +241,56 @@ noalias_gevmmv_add_impl( //
       T ai2j = ax[p + 2];
       T ai3j = ax[p + 3];
 
-      out_r(i0) += ai0j * in_rj;
-      out_r(i1) += ai1j * in_rj;
-      out_r(i2) += ai2j * in_rj;
-      out_r(i3) += ai3j * in_rj;
+      out_r[i0] += ai0j * in_rj;
+      out_r[i1] += ai1j * in_rj;
+      out_r[i2] += ai2j * in_rj;
+      out_r[i3] += ai3j * in_rj;
 
-      acc0 += ai0j * in_l(i0);
-      acc1 += ai1j * in_l(i1);
-      acc2 += ai2j * in_l(i2);
-      acc3 += ai3j * in_l(i3);
+      acc0 += ai0j * in_l[i0];
+      acc1 += ai1j * in_l[i1];
+      acc2 += ai2j * in_l[i2];
+      acc3 += ai3j * in_l[i3];
     }
 
-    for (; p < col_end; ++p) {
+    for (; p < col_end_j; ++p) {
       auto i = isize(zx(ai[p]));
 
       T aij = ax[p];
-      out_r(i) += aij * in_rj;
-      acc0 += aij * in_l(i);
+      out_r[i] += aij * in_rj;
+      acc0 += aij * in_l[i];
     }
 
     acc0 = ((acc0 + acc1) + (acc2 + acc3));
-    out_l(isize(j)) += acc0;
+    out_l[j] += acc0;
   }
 }
 
+/*!
+ * Accumulates the contributions of the columns [col_begin, col_end) of the
+ * upper triangular part of the symmetric matrix a to out += a * in. The
+ * off-diagonal contributions to the rows below row_split are scattered into
+ * out_lo instead of out, so that the threads owning these rows are not
+ * written to.
+ */
 template<typename T, typename I>
-VEG_NO_INLINE void
-noalias_symhiv_add_impl( //
-  VectorViewMut<T> out,
+VEG_INLINE void
+symhiv_add_cols( //
+  T* out,
+  T* out_lo,
+  isize row_split,
   proxsuite::linalg::sparse::MatRef<T, I> a,
-  VectorView<T> in)
+  T const* in,
+  usize col_begin,
+  usize col_end)
 {
-  VEG_ASSERT_ALL_OF /* NOLINT */ ( //
-    a.nrows() == a.ncols(),
-    a.nrows() == out.dim,
-    a.ncols() == in.dim);
-  // equivalent to
-  // out.to_eigen().noalias() +=
-  // 		a.to_eigen().template selfadjointView<Eigen::Upper>() *
-  // in.to_eigen();
-
   auto* ai = a.row_indices();
   auto* ax = a.values();
-  auto n = a.ncols();
 
-  for (usize j = 0; j < usize(n); ++j) {
+  for (usize j = col_begin; j < col_end; ++j) {
     usize col_start = a.col_start(j);
-    usize col_end = a.col_end(j);
+    usize col_end_j = a.col_end(j);
 
-    if (col_start == col_end) {
+    if (col_start == col_end_j) {
       continue;
     }
 
@@ -209,15 +299,15 @@ noalias_symhiv_add_impl( //
     T acc2 = 0;
     T acc3 = 0;
 
-    T in_j = in(isize(j));
+    T in_j = in[j];
 
-    usize pcount = col_end - col_start;
+    usize pcount = col_end_j - col_start;
 
     auto zx = proxsuite::linalg::sparse::util::zero_extend;
 
-    if (zx(ai[col_end - 1]) == j) {
-      T ajj = ax[col_end - 1];
-      out(isize(j)) += ajj * in_j;
+    if (zx(ai[col_end_j - 1]) == j) {
+      T ajj = ax[col_end_j - 1];
+      out[j] += ajj * in_j;
       pcount -= 1;
     }
 
@@ -234,25 +324,166 @@ noalias_symhiv_add_impl( //
       T ai2j = ax[p + 2];
       T ai3j = ax[p + 3];
 
-      out(i0) += ai0j * in_j;
-      out(i1) += ai1j * in_j;
-      out(i2) += ai2j * in_j;
-      out(i3) += ai3j * in_j;
+      (i0 < row_split ? out_lo : out)[i0] += ai0j * in_j;
+      (i1 < row_split ? out_lo : out)[i1] += ai1j * in_j;
+      (i2 < row_split ? out_lo : out)[i2] += ai2j * in_j;
+      (i3 < row_split ? out_lo : out)[i3] += ai3j * in_j;
 
-      acc0 += ai0j * in(i0);
-      acc1 += ai1j * in(i1);
-      acc2 += ai2j * in(i2);
-      acc3 += ai3j * in(i3);
+      acc0 += ai0j * in[i0];
+      acc1 += ai1j * in[i1];
+      acc2 += ai2j * in[i2];
+      acc3 += ai3j * in[i3];
     }
     for (; p < col_start + pcount; ++p) {
       auto i = isize(zx(ai[p]));
 
       T aij = ax[p];
-      out(i) += aij * in_j;
-      acc0 += aij * in(i);
+      (i < row_split ? out_lo : out)[i] += aij * in_j;
+      acc0 += aij * in[i];
     }
     acc0 = ((acc0 + acc1) + (acc2 + acc3));
-    out(isize(j)) += acc0;
+    out[j] += acc0;
+  }
+}
+
+template<typename T, typename I>
+VEG_NO_INLINE void
+noalias_gevmmv_add_impl( //
+  VectorViewMut<T> out_l,
+  VectorViewMut<T> out_r,
+  proxsuite::linalg::sparse::MatRef<T, I> a,
+  VectorView<T> in_l,
+  VectorView<T> in_r,
+  SpmvPartition<T>& partition)
+{
+  VEG_ASSERT_ALL_OF /* NOLINT */ (a.nrows() == out_r.dim,
+                                  a.ncols() == in_r.dim,
+                                  a.ncols() == out_l.dim,
+                                  a.nrows() == in_l.dim);
+  // equivalent to
+  // out_r.to_eigen().noalias() += a.to_eigen() * in_r.to_eigen();
+  // out_l.to_eigen().noalias() += a.to_eigen().transpose() * in_l.to_eigen();
+
+  isize nthreads = spmv_nthreads(a.nnz());
+  if (nthreads == 1) {
+    gevmmv_add_cols(
+      out_l.data, out_r.data, a, in_l.data, in_r.data, 0, usize(a.ncols()));
+    return;
+  }
+
+  // each thread owns a range of columns, hence a range of out_l, while the
+  // scattered updates of out_r may hit any row: the first thread writes them
+  // to out_r directly, the others to a private buffer that is summed at the
+  // end
+  isize m = a.nrows();
+  partition.prepare(a, nthreads);
+  usize const* col_split = partition.col_split.ptr();
+  auto& buf = partition.buf;
+
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+#endif
+  for (isize t = 0; t < nthreads; ++t) {
+    T* out_rt = out_r.data;
+    if (t > 0) {
+      buf.col(t - 1).setZero();
+      out_rt = buf.col(t - 1).data();
+    }
+    gevmmv_add_cols(out_l.data,
+                    out_rt,
+                    a,
+                    in_l.data,
+                    in_r.data,
+                    col_split[t],
+                    col_split[t + 1]);
+  }
+
+  // the reduction is blocked by rows so that each thread only reads and
+  // writes a contiguous slice of out_r and of the buffers
+  isize block_size = (m + nthreads - 1) / nthreads;
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+#endif
+  for (isize t = 0; t < nthreads; ++t) {
+    isize row_begin = t * block_size < m ? t * block_size : m;
+    isize row_end = row_begin + block_size < m ? row_begin + block_size : m;
+    if (row_begin < row_end) {
+      out_r.to_eigen().segment(row_begin, row_end - row_begin).noalias() +=
+        buf.middleRows(row_begin, row_end - row_begin).rowwise().sum();
+    }
+  }
+}
+
+template<typename T, typename I>
+VEG_NO_INLINE void
+noalias_symhiv_add_impl( //
+  VectorViewMut<T> out,
+  proxsuite::linalg::sparse::MatRef<T, I> a,
+  VectorView<T> in,
+  SpmvPartition<T>& partition)
+{
+  VEG_ASSERT_ALL_OF /* NOLINT */ ( //
+    a.nrows() == a.ncols(),
+    a.nrows() == out.dim,
+    a.ncols() == in.dim);
+  // equivalent to
+  // out.to_eigen().noalias() +=
+  // 		a.to_eigen().template selfadjointView<Eigen::Upper>() *
+  // in.to_eigen();
+
+  isize nthreads = spmv_nthreads(a.nnz());
+  if (nthreads == 1) {
+    symhiv_add_cols(out.data, out.data, 0, a, in.data, 0, usize(a.ncols()));
+    return;
+  }
+
+  // each thread owns a range of columns [c_t, c_{t+1}), hence the same range
+  // of rows of out. since a is upper triangular, the scattered updates of the
+  // t-th thread only hit the rows below c_{t+1}: those of its own range are
+  // written to out directly, those below c_t to a private buffer, which is
+  // summed at the end
+  isize n = a.ncols();
+  partition.prepare(a, nthreads);
+  usize const* col_split = partition.col_split.ptr();
+  auto& buf = partition.buf;
+
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+#endif
+  for (isize t = 0; t < nthreads; ++t) {
+    // the range of the first thread starts at zero, it needs no buffer
+    isize row_split = isize(col_split[t]);
+    T* buf_t = out.data;
+    if (t > 0) {
+      buf.col(t - 1).head(row_split).setZero();
+      buf_t = buf.col(t - 1).data();
+    }
+    symhiv_add_cols(out.data,
+                    buf_t,
+                    row_split,
+                    a,
+                    in.data,
+                    col_split[t],
+                    col_split[t + 1]);
+  }
+
+  // the row i receives contributions from the buffers of the threads t such
+  // that c_t > i, the reduction is blocked by rows
+  isize block_size = (n + nthreads - 1) / nthreads;
+#ifdef PROXSUITE_WITH_OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+#endif
+  for (isize b = 0; b < nthreads; ++b) {
+    isize row_begin = b * block_size < n ? b * block_size : n;
+    isize row_end = row_begin + block_size < n ? row_begin + block_size : n;
+    for (isize t = 1; t < nthreads; ++t) {
+      isize row_split = isize(col_split[t]);
+      isize last = row_end < row_split ? row_end : row_split;
+      if (row_begin < last) {
+        out.to_eigen().segment(row_begin, last - row_begin) +=
+          buf.col(t - 1).segment(row_begin, last - row_begin);
+      }
+    }
   }
 }
 
@@ -262,7 +493,8 @@ noalias_gevmmv_add(OutL&& out_l,
                    OutR&& out_r,
                    A const& a,
                    InL const& in_l,
-                   InR const& in_r)
+                   InR const& in_r,
+                   SpmvPartition<typename A::Scalar>& partition)
 {
   // noalias general vector matrix matrix vector add
   noalias_gevmmv_add_impl<typename A::Scalar, typename A::StorageIndex>(
@@ -270,20 +502,57 @@ noalias_gevmmv_add(OutL&& out_l,
     { proxqp::from_eigen, out_r },
     { proxsuite::linalg::sparse::from_eigen, a },
     { proxqp::from_eigen, in_l },
-    { proxqp::from_eigen, in_r });
+    { proxqp::from_eigen, in_r },
+    partition);
+}
+
+template<typename OutL, typename OutR, typename A, typename InL, typename InR>
+void
+noalias_gevmmv_add(OutL&& out_l,
+                   OutR&& out_r,
+                   A const& a,
+                   InL const& in_l,
+                   InR const& in_r)
+{
+  SpmvPartition<typename A::Scalar> partition;
+  noalias_gevmmv_add(out_l, out_r, a, in_l, in_r, partition);
 }
 
 template<typename Out, typename A, typename In>
 void
-noalias_symhiv_add(Out&& out, A const& a, In const& in)
+noalias_symhiv_add(Out&& out,
+                   A const& a,
+                   In const& in,
+                   SpmvPartition<typename A::Scalar>& partition)
 {
   // noalias symmetric (hi) matrix vector add
   noalias_symhiv_add_impl<typename A::Scalar, typename A::StorageIndex>(
     { proxqp::from_eigen, out },
     { proxsuite::linalg::sparse::from_eigen, a },
-    { proxqp::from_eigen, in });
+    { proxqp::from_eigen, in },
+    partition);
 }
 
+template<typename Out, typename A, typename In>
+void
+noalias_symhiv_add(Out&& out, A const& a, In const& in)
+{
+  SpmvPartition<typename A::Scalar> partition;
+  noalias_symhiv_add(out, a, in, partition);
+}
+
+/*!
+ * Partitions of the matrices of the model used by the parallel matrix vector
+ * products of the solver.
+ */
+template<typename T>
+struct SpmvPartitions
+{
+  SpmvPartition<T> H;
+  SpmvPartition<T> AT;
+  SpmvPartition<T> CT;
+};
+
 template<typename T, typename I>
 struct AugmentedKkt : Eigen::EigenBase<AugmentedKkt<T, I>>
 {
@@ -298,6 +567,10 @@ struct AugmentedKkt : Eigen::EigenBase<AugmentedKkt<T, I>>
     T mu_eq;
     T mu_in;
   } _;
+  // partition of the products with kkt_active, which must be reset whenever
+  // the active set changes. it is also used by the iterative refinement of the
+  // ldlt backend
+  mutable SpmvPartition<T> kkt_active_spmv;
 
   AugmentedKkt /* NOLINT */ (Raw raw) noexcept
     : _{ raw }
@@ -330,6 +603,222 @@ struct AugmentedKkt : Eigen::EigenBase<AugmentedKkt<T, I>>
   }
 };
 
+/*!
+ * Symmetric positive definite preconditioner of the matrix free KKT solver.
+ *
+ * The block diagonal variant uses diag(H) + rho for the primal block, and the
+ * diagonal of the regularized Schur complements mu + A diag(H + rho)^-1 A^T
+ * for the active constraint blocks. The incomplete LDLT variant factorizes the
+ * regularized KKT matrix on its own sparsity pattern (no fill-in), falling back
+ * to the block diagonal pivot when a pivot is too small or has the wrong
+ * inertia, and applies (L |D| L^T)^-1.
+ */
+template<typename T, typename I>
+struct AugmentedKktPreconditioner
+{
+  using Vec = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+
+  MatrixFreePreconditioner kind = MatrixFreePreconditioner::BLOCK_DIAGONAL;
+
+  // signed block diagonal approximation of the regularized KKT matrix
+  Vec diag;
+  // incomplete factor, the column j stores the row j of the strictly lower
+  // part of L
+  proxsuite::linalg::veg::Vec<I> l_col_ptrs;
+  proxsuite::linalg::veg::Vec<I> l_row_indices;
+  proxsuite::linalg::veg::Vec<T> l_values;
+  Vec d;
+
+  auto rows() const noexcept -> isize { return diag.rows(); }
+  auto cols() const noexcept -> isize { return diag.rows(); }
+
+  template<typename Mat>
+  auto analyzePattern(Mat const& /*mat*/) -> AugmentedKktPreconditioner&
+  {
+    return *this;
+  }
+  auto compute(AugmentedKkt<T, I> const& mat) -> AugmentedKktPreconditioner&
+  {
+    return factorize(mat);
+  }
+  auto info() const noexcept -> Eigen::ComputationInfo
+  {
+    return Eigen::Success;
+  }
+
+  auto factorize(AugmentedKkt<T, I> const& mat) -> AugmentedKktPreconditioner&
+  {
+    auto const& raw = mat._;
+    isize n = raw.n;
+    isize n_eq = raw.n_eq;
+    isize n_tot = mat.rows();
+    auto kkt = raw.kkt_active;
+    I const* ki = kkt.row_indices();
+    T const* kx = kkt.values();
+    auto zx = proxsuite::linalg::sparse::util::zero_extend;
+
+    diag.resize(n_tot);
+    if (kind == MatrixFreePreconditioner::IDENTITY) {
+      diag.setOnes();
+      return *this;
+    }
+
+    // the diagonal of H, when stored, is the last element of its column
+    auto has_diag = [&](usize j) -> bool {
+      usize col_start = kkt.col_start(j);
+      usize col_end = kkt.col_end(j);
+      return col_end > col_start && zx(ki[col_end - 1]) == j;
+    };
+    // regularized diagonal of the KKT matrix, sign included
+    auto reg_diag = [&](isize j) -> T {
+      if (j < n) {
+        return raw.rho;
+      } else if (j < n + n_eq) {
+        return -T(1) / raw.mu_eq;
+      } else {
+        return raw.active_constraints[j - n - n_eq] ? -T(1) / raw.mu_in : T(1);
+      }
+    };
+
+    for (isize j = 0; j < n; ++j) {
+      T hjj = has_diag(usize(j)) ? kx[kkt.col_end(usize(j)) - 1] : T(0);
+      diag[j] = std::abs(hjj) + raw.rho;
+      if (diag[j] == T(0)) {
+        diag[j] = T(1);
+      }
+    }
+    for (isize j = n; j < n_tot; ++j) {
+      T reg = reg_diag(j);
+      if (reg > 0) {
+        // inactive constraint
+        diag[j] = reg;
+        continue;
+      }
+      T acc = -reg;
+      for (usize p = kkt.col_start(usize(j)); p < kkt.col_end(usize(j)); ++p) {
+        T aij = kx[p];
+        acc += aij * aij / diag[isize(zx(ki[p]))];
+      }
+      diag[j] = -acc;
+    }
+
+    if (kind != MatrixFreePreconditioner::INCOMPLETE_LDLT) {
+      return *this;
+    }
+
+    l_col_ptrs.resize_for_overwrite(n_tot + 1);
+    I* lp = l_col_ptrs.ptr_mut();
+    lp[0] = I(0);
+    for (isize j = 0; j < n_tot; ++j) {
+      usize col_nnz = kkt.col_end(usize(j)) - kkt.col_start(usize(j));
+      if (has_diag(usize(j))) {
+        --col_nnz;
+      }
+      lp[j + 1] = I(zx(lp[j]) + col_nnz);
+    }
+    isize l_nnz = isize(zx(lp[n_tot]));
+    l_row_indices.resize_for_overwrite(l_nnz);
+    l_values.resize_for_overwrite(l_nnz);
+    d.resize(n_tot);
+    I* li = l_row_indices.ptr_mut();
+    T* lx = l_values.ptr_mut();
+
+    T const eps = std::sqrt(std::numeric_limits<T>::epsilon());
+
+    // up-looking ILDL(0): row k of L only uses the pattern of column k of the
+    // upper triangular KKT matrix
+    for (isize k = 0; k < n_tot; ++k) {
+      usize col_start = kkt.col_start(usize(k));
+      usize l_start = zx(lp[k]);
+      usize l_end = zx(lp[k + 1]);
+
+      T dk = reg_diag(k);
+      if (has_diag(usize(k))) {
+        dk += kx[kkt.col_end(usize(k)) - 1];
+      }
+      for (usize q = l_start; q < l_end; ++q) {
+        li[q] = ki[col_start + (q - l_start)];
+        lx[q] = kx[col_start + (q - l_start)];
+      }
+
+      for (usize q = l_start; q < l_end; ++q) {
+        usize j = zx(li[q]);
+        T acc = lx[q];
+
+        // sparse dot product of the (already computed) heads of rows k and j
+        usize qk = l_start;
+        usize qj = zx(lp[j]);
+        usize qj_end = zx(lp[j + 1]);
+        while (qk < q && qj < qj_end) {
+          usize ik = zx(li[qk]);
+          usize ij = zx(li[qj]);
+          if (ik == ij) {
+            acc -= lx[qk] * d[isize(ik)] * lx[qj];
+            ++qk;
+            ++qj;
+          } else if (ik < ij) {
+            ++qk;
+          } else {
+            ++qj;
+          }
+        }
+
+        T lkj = acc / d[isize(j)];
+        lx[q] = lkj;
+        dk -= lkj * lkj * d[isize(j)];
+      }
+
+      // keep the inertia of the quasi definite KKT matrix
+      if (!(dk * diag[k] > eps * diag[k] * diag[k])) {
+        dk = diag[k];
+      }
+      d[k] = dk;
+    }
+    return *this;
+  }
+
+  template<typename Rhs>
+  auto solve(Eigen::MatrixBase<Rhs> const& b) const -> Vec
+  {
+    switch (kind) {
+      case MatrixFreePreconditioner::IDENTITY:
+        return b;
+      case MatrixFreePreconditioner::BLOCK_DIAGONAL:
+        return (b.array() / diag.array().abs()).matrix();
+      case MatrixFreePreconditioner::INCOMPLETE_LDLT:
+        break;
+    }
+
+    auto zx = proxsuite::linalg::sparse::util::zero_extend;
+    isize n_tot = d.rows();
+    I const* lp = l_col_ptrs.ptr();
+    I const* li = l_row_indices.ptr();
+    T const* lx = l_values.ptr();
+
+    Vec x = b;
+    for (isize k = 0; k < n_tot; ++k) {
+      T acc = x[k];
+      for (usize q = zx(lp[k]); q < zx(lp[k + 1]); ++q) {
+        acc -= lx[q] * x[isize(zx(li[q]))];
+      }
+      x[k] = acc;
+    }
+    x.array() /= d.array().abs();
+    for (isize k = n_tot - 1; k >= 0; --k) {
+      T xk = x[k];
+      for (usize q = zx(lp[k]); q < zx(lp[k + 1]); ++q) {
+        x[isize(zx(li[q]))] -= lx[q] * xk;
+      }
+    }
+    return x;
+  }
+};
+
+template<typename T, typename I>
+using MatrixFreeSolver = Eigen::MINRES<AugmentedKkt<T, I>,
+                                       Eigen::Upper | Eigen::Lower,
+                                       AugmentedKktPreconditioner<T, I>>;
+
 template<typename T>
 using VecMapMut = Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, 1>,
                              Eigen::Unaligned,
@@ -453,6 +942,57 @@ top_rows_mut_unchecked(proxsuite::linalg::veg::Unsafe /*unsafe*/,
     mat.values_mut(),
   };
 }
+/*!
+ * Returns the sparsity structure of a (possibly offset) view on the columns of
+ * a compressed matrix, as a standalone boolean matrix.
+ *
+ * @param mat compressed sparse matrix.
+ */
+template<typename T, typename I>
+auto
+structure_of(proxsuite::linalg::sparse::MatRef<T, I> mat)
+  -> Eigen::SparseMatrix<bool, Eigen::ColMajor, I>
+{
+  using proxsuite::linalg::sparse::util::zero_extend;
+  VEG_ASSERT(mat.is_compressed());
+
+  isize ncols = mat.ncols();
+  usize first = zero_extend(mat.col_ptrs()[0]);
+  usize nnz = zero_extend(mat.col_ptrs()[ncols]) - first;
+
+  Eigen::SparseMatrix<bool, Eigen::ColMajor, I> structure(mat.nrows(), ncols);
+  structure.resizeNonZeros(Eigen::Index(nnz));
+  I* outer = structure.outerIndexPtr();
+  for (isize j = 0; j <= ncols; ++j) {
+    outer[j] = I(zero_extend(mat.col_ptrs()[j]) - first);
+  }
+  std::copy_n(mat.row_indices() + first, nnz, structure.innerIndexPtr());
+  std::fill_n(structure.valuePtr(), nnz, true);
+  return structure;
+}
+/*!
+ * Recovers in place the values of the unscaled KKT matrix from the scaled ones
+ * when the model does not store them. This has no effect otherwise.
+ *
+ * @param data model of the problem.
+ * @param precond preconditioner with which the KKT matrix has been scaled.
+ */
+template<typename T, typename I, typename P>
+void
+unscale_kkt_in_place(Model<T, I>& data, P& precond)
+{
+  if (data.store_unscaled_kkt) {
+    return;
+  }
+  auto kkt_top_n_rows = top_rows_mut_unchecked(
+    proxsuite::linalg::veg::unsafe, data.kkt_mut(), data.dim);
+
+  precond.unscale_matrices_in_place(
+    middle_cols_mut(kkt_top_n_rows, 0, data.dim, data.H_nnz),
+    middle_cols_mut(kkt_top_n_rows, data.dim, data.n_eq, data.A_nnz),
+    middle_cols_mut(
+      kkt_top_n_rows, data.dim + data.n_eq, data.n_in, data.C_nnz));
+}
 /*!
  * Check whether the global primal infeasibility criterion is satisfied.
  *
@@ -609,6 +1149,7 @@ global_dual_residual_infeasibility(VectorViewMut<T> Adx,
  * @param x_e current estimate of primal variable x.
  * @param y_e current estimate of equality constrained lagrange multiplier.
  * @param z_e current estimate of inequality constrained lagrange multiplier.
+ * @param spmv column partitions of the products with the matrices of the model.
  * @param stak stack.
  */
 template<typename T, typename I, typename P>
@@ -629,6 +1170,7 @@ unscaled_primal_dual_residual(
   VecMap<T> x_e,
   VecMap<T> y_e,
   VecMap<T> z_e,
+  SpmvPartitions<T>& spmv,
   proxsuite::linalg::veg::dynstack::DynStackMut stack)
   -> proxsuite::linalg::veg::Tuple<T, T>
 {
@@ -638,7 +1180,7 @@ unscaled_primal_dual_residual(
   dual_residual_scaled = qp_scaled.g.to_eigen();
   {
     tmp.setZero();
-    noalias_symhiv_add(tmp, qp_scaled.H.to_eigen(), x_e);
+    noalias_symhiv_add(tmp, qp_scaled.H.to_eigen(), x_e, spmv.H);
     dual_residual_scaled += tmp;
 
     precond.unscale_dual_residual_in_place({ proxqp::from_eigen, tmp });
@@ -650,8 +1192,12 @@ unscaled_primal_dual_residual(
     ATy.setZero();
     primal_residual_eq_scaled.setZero();
 
-    detail::noalias_gevmmv_add(
-      primal_residual_eq_scaled, ATy, qp_scaled.AT.to_eigen(), x_e, y_e);
+    detail::noalias_gevmmv_add(primal_residual_eq_scaled,
+                               ATy,
+                               qp_scaled.AT.to_eigen(),
+                               x_e,
+                               y_e,
+                               spmv.AT);
 
     dual_residual_scaled += ATy;
 
@@ -664,8 +1210,12 @@ unscaled_primal_dual_residual(
     CTz.setZero();
     primal_residual_in_scaled_up.setZero();
 
-    detail::noalias_gevmmv_add(
-      primal_residual_in_scaled_up, CTz, qp_scaled.CT.to_eigen(), x_e, z_e);
+    detail::noalias_gevmmv_add(primal_residual_in_scaled_up,
+                               CTz,
+                               qp_scaled.CT.to_eigen(),
+                               x_e,
+                               z_e,
+                               spmv.CT);
 
     dual_residual_scaled += CTz;
 
@@ -751,7 +1301,7 @@ struct generic_product_impl<
 
     VEG_ASSERT(alpha == Scalar(1));
     proxsuite::proxqp::sparse::detail::noalias_symhiv_add(
-      dst, lhs._.kkt_active.to_eigen(), rhs);
+      dst, lhs._.kkt_active.to_eigen(), rhs, lhs.kkt_active_spmv);
 
     {
       isize n = lhs._.n;
@@ -12,6 +12,8 @@
 #include <proxsuite/linalg/sparse/update.hpp>
 #include <proxsuite/linalg/sparse/rowmod.hpp>
 #include <proxsuite/proxqp/timings.hpp>
+#include <proxsuite/helpers/huge-pages.hpp>
+#include <proxsuite/helpers/mapped-file.hpp>
 #include <proxsuite/proxqp/settings.hpp>
 #include <proxsuite/proxqp/dense/views.hpp>
 #include <proxsuite/linalg/veg/vec.hpp>
@@ -80,8 +82,8 @@ refactorize(Workspace<T, I>& work,
     }
 
     proxsuite::linalg::sparse::factorize_numeric(
-      work.internal.ldl.values.ptr_mut(),
-      work.internal.ldl.row_indices.ptr_mut(),
+      work.internal.ldl.values_ptr_mut(),
+      work.internal.ldl.row_indices_ptr_mut(),
       diag,
       work.internal.ldl.perm.ptr_mut(),
       work.internal.ldl.col_ptrs.ptr(),
@@ -90,18 +92,37 @@ refactorize(Workspace<T, I>& work,
       kkt_active.as_const(),
       stack);
   } else {
-    *work.internal.matrix_free_kkt = { { kkt_active.as_const(),
+    work.internal.matrix_free_kkt->_ = { kkt_active.as_const(),
                                          active_constraints.as_const(),
                                          data.dim,
                                          data.n_eq,
                                          data.n_in,
                                          results.info.rho,
                                          results.info.mu_eq_inv,
-                                         results.info.mu_in_inv } };
+                                         results.info.mu_in_inv };
+    work.internal.matrix_free_kkt->kkt_active_spmv.reset();
     (*work.internal.matrix_free_solver).compute(*work.internal.matrix_free_kkt);
   }
 }
 
+namespace detail {
+/*!
+ * Level schedules of the triangular solves with the ldlt factor, see
+ * proxsuite::linalg::sparse::triangular_solve_levels.
+ */
+template<typename I>
+struct LdlSolveSchedule
+{
+  I const* lsolve_level_ptrs;
+  I const* lsolve_level_cols;
+  isize lsolve_nlevels;
+  I const* ltsolve_level_ptrs;
+  I const* ltsolve_level_cols;
+  isize ltsolve_nlevels;
+  isize nthreads;
+};
+} // namespace detail
+
 template<typename T, typename I>
 struct Ldlt
 {
@@ -112,6 +133,69 @@ struct Ldlt
   proxsuite::linalg::veg::Vec<I> nnz_counts;
   proxsuite::linalg::veg::Vec<I> row_indices;
   proxsuite::linalg::veg::Vec<T> values;
+  // storage of the row indices and values when the factor is out of core
+  std::unique_ptr<proxsuite::helpers::MappedFile> row_indices_file;
+  std::unique_ptr<proxsuite::helpers::MappedFile> values_file;
+  // level schedules of the triangular solves, computed from the elimination
+  // tree of the whole kkt matrix along with its symbolic factorization
+  proxsuite::linalg::veg::Vec<I> lsolve_level_ptrs;
+  proxsuite::linalg::veg::Vec<I> lsolve_level_cols;
+  proxsuite::linalg::veg::Vec<I> ltsolve_level_ptrs;
+  proxsuite::linalg::veg::Vec<I> ltsolve_level_cols;
+  isize lsolve_nlevels = 0;
+  isize ltsolve_nlevels = 0;
+
+  /*!
+   * Computes the level schedules of the triangular solves, once the
+   * elimination tree of the whole kkt matrix is known. They remain valid for
+   * the factors of its active parts, and after the row updates, whose
+   * sparsity patterns are contained in the one of the whole matrix with the
+   * same ordering.
+   * @param n_tot dimension of the kkt matrix.
+   * @param stack temporary allocation stack.
+   */
+  void compute_solve_levels(isize n_tot,
+                            proxsuite::linalg::veg::dynstack::DynStackMut stack)
+  {
+    lsolve_level_ptrs.resize_for_overwrite(n_tot + 1);
+    lsolve_level_cols.resize_for_overwrite(n_tot);
+    ltsolve_level_ptrs.resize_for_overwrite(n_tot + 1);
+    ltsolve_level_cols.resize_for_overwrite(n_tot);
+    lsolve_nlevels = proxsuite::linalg::sparse::triangular_solve_levels(
+      lsolve_level_ptrs.ptr_mut(),
+      lsolve_level_cols.ptr_mut(),
+      etree.ptr(),
+      n_tot,
+      false,
+      stack);
+    ltsolve_nlevels = proxsuite::linalg::sparse::triangular_solve_levels(
+      ltsolve_level_ptrs.ptr_mut(),
+      ltsolve_level_cols.ptr_mut(),
+      etree.ptr(),
+      n_tot,
+      true,
+      stack);
+  }
+  auto solve_schedule() const noexcept -> detail::LdlSolveSchedule<I>
+  {
+    return {
+      lsolve_level_ptrs.ptr(),  lsolve_level_cols.ptr(),  lsolve_nlevels,
+      ltsolve_level_ptrs.ptr(), ltsolve_level_cols.ptr(), ltsolve_nlevels,
+      1,
+    };
+  }
+
+  auto row_indices_ptr_mut() -> I*
+  {
+    return row_indices_file != nullptr
+             ? static_cast<I*>(row_indices_file->data())
+             : row_indices.ptr_mut();
+  }
+  auto values_ptr_mut() -> T*
+  {
+    return values_file != nullptr ? static_cast<T*>(values_file->data())
+                                  : values.ptr_mut();
+  }
 };
 template<typename T, typename I>
 struct Workspace
@@ -126,6 +210,7 @@ struct Workspace
     Ldlt<T, I> ldl;
     bool do_ldlt;
     bool do_symbolic_fact;
+    bool ldl_overflow; // the predicted fill-in does not fit in the index type
     // persistent allocations
 
     Eigen::Matrix<T, Eigen::Dynamic, 1> g_scaled;
@@ -138,17 +223,21 @@ struct Workspace
     std::unique_ptr<detail::AugmentedKkt<T, I>>
       matrix_free_kkt; // view on active part of the KKT which includes the
                        // regularizations
-    std::unique_ptr<Eigen::MINRES<detail::AugmentedKkt<T, I>,
-                                  Eigen::Upper | Eigen::Lower,
-                                  Eigen::IdentityPreconditioner>>
+    std::unique_ptr<detail::MatrixFreeSolver<T, I>>
       matrix_free_solver; // eigen based method which takes in entry vector, and
                           // performs matrix vector products
+    // column partitions of the parallel matrix vector products
+    detail::SpmvPartitions<T> spmv;
+
+    // largest number of bytes of storage used so far
+    isize stack_peak_bytes = 0;
 
     auto stack_mut() -> proxsuite::linalg::veg::dynstack::DynStackMut
     {
       return {
         proxsuite::linalg::veg::from_slice_mut,
         storage.as_mut(),
+        &stack_peak_bytes,
       };
     } // exploits all available memory in storage
 
@@ -181,7 +270,6 @@ struct Workspace
     auto& ldl = internal.ldl;
 
     auto& storage = internal.storage;
-    auto& do_ldlt = internal.do_ldlt;
     // persistent allocations
 
     data.dim = H.nrows();
@@ -206,12 +294,16 @@ struct Workspace
     // assuming H, AT, CT are sorted
     // and H is upper triangular
     {
-      data.kkt_col_ptrs.resize_for_overwrite(n_tot + 1); //
-      data.kkt_row_indices.resize_for_overwrite(nnz_tot);
+      // a new pattern is formed, as the previous one may be shared
+      data.kkt_col_ptrs = std::make_shared<proxsuite::linalg::veg::Vec<I>>();
+      data.kkt_row_indices =
+        std::make_shared<proxsuite::linalg::veg::Vec<I>>();
+      data.kkt_col_ptrs->resize_for_overwrite(n_tot + 1); //
+      data.kkt_row_indices->resize_for_overwrite(nnz_tot);
       data.kkt_values.resize_for_overwrite(nnz_tot);
 
-      I* kktp = data.kkt_col_ptrs.ptr_mut();
-      I* kkti = data.kkt_row_indices.ptr_mut();
+      I* kktp = data.kkt_col_ptrs->ptr_mut();
+      I* kkti = data.kkt_row_indices->ptr_mut();
 
       kktp[0] = 0;
       usize col = 0;
@@ -249,17 +341,15 @@ struct Workspace
       insert_submatrix(CT, false);
     }
 
-    data.kkt_col_ptrs_unscaled = data.kkt_col_ptrs;
-    data.kkt_row_indices_unscaled = data.kkt_row_indices;
-
     storage.resize_for_overwrite( //
       (StackReq::with_len(itag, n_tot) &
-       proxsuite::linalg::sparse::factorize_symbolic_req( //
-         itag,                                            //
-         n_tot,                                           //
-         nnz_tot,                                         //
-         proxsuite::linalg::sparse::Ordering::amd))       //
-        .alloc_req()                                      //
+       (proxsuite::linalg::sparse::factorize_symbolic_req( //
+          itag,                                            //
+          n_tot,                                           //
+          nnz_tot,                                         //
+          proxsuite::linalg::sparse::Ordering::amd) |      //
+        proxsuite::linalg::sparse::triangular_solve_levels_req(itag, n_tot)))
+        .alloc_req() //
     );
 
     ldl.col_ptrs.resize_for_overwrite(n_tot + 1);
@@ -278,9 +368,9 @@ struct Workspace
         n_tot,
         n_tot,
         nnz_tot,
-        data.kkt_col_ptrs.ptr(),
+        data.kkt_col_ptrs->ptr(),
         nullptr,
-        data.kkt_row_indices.ptr(),
+        data.kkt_row_indices->ptr(),
       };
       proxsuite::linalg::sparse::factorize_symbolic_non_zeros( //
         ldl.col_ptrs.ptr_mut() +
@@ -304,13 +394,54 @@ struct Workspace
         }
         pcol_ptrs[(i + 1)] = I(acc);
       }
+      ldl.compute_solve_levels(n_tot, stack);
     }
 
     lnnz = isize(zero_extend(ldl.col_ptrs[n_tot]));
+    // whether the ldlt is used is decided in setup_impl, once the memory budget
+    // is known from the settings
+    internal.ldl_overflow = overflow;
 
-    // if ldlt is too sparse
-    // do_ldlt = !overflow && lnnz < (10000000);
-    do_ldlt = !overflow && lnnz < 10000000;
+    internal.do_symbolic_fact = false;
+  }
+  /*!
+   * Reuses the symbolic factorization of another workspace, computed for a
+   * problem with the same sparsity structure, instead of computing it again.
+   * The sparsity pattern of the kkt matrix is shared with the other model.
+   * @param data solver's model.
+   * @param other workspace whose symbolic factorization has been computed.
+   * @param other_data model associated to the other workspace.
+   */
+  void share_symbolic_factorization(Model<T, I>& data,
+                                    Workspace const& other,
+                                    Model<T, I> const& other_data)
+  {
+    VEG_ASSERT(!other.internal.do_symbolic_fact);
+
+    data.dim = other_data.dim;
+    data.n_eq = other_data.n_eq;
+    data.n_in = other_data.n_in;
+    data.H_nnz = other_data.H_nnz;
+    data.A_nnz = other_data.A_nnz;
+    data.C_nnz = other_data.C_nnz;
+
+    data.kkt_col_ptrs = other_data.kkt_col_ptrs;
+    data.kkt_row_indices = other_data.kkt_row_indices;
+    data.kkt_values.resize_for_overwrite(data.kkt_row_indices->len());
+
+    // the elimination tree and the permutation are modified by the numeric
+    // factorization and the row updates, so they are copied
+    internal.ldl.col_ptrs = other.internal.ldl.col_ptrs;
+    internal.ldl.perm_inv = other.internal.ldl.perm_inv;
+    internal.ldl.etree = other.internal.ldl.etree;
+    internal.ldl.lsolve_level_ptrs = other.internal.ldl.lsolve_level_ptrs;
+    internal.ldl.lsolve_level_cols = other.internal.ldl.lsolve_level_cols;
+    internal.ldl.ltsolve_level_ptrs = other.internal.ldl.ltsolve_level_ptrs;
+    internal.ldl.ltsolve_level_cols = other.internal.ldl.ltsolve_level_cols;
+    internal.ldl.lsolve_nlevels = other.internal.ldl.lsolve_nlevels;
+    internal.ldl.ltsolve_nlevels = other.internal.ldl.ltsolve_nlevels;
+    internal.ldl_overflow = other.internal.ldl_overflow;
+    lnnz = other.lnnz;
 
     internal.do_symbolic_fact = false;
   }
@@ -323,6 +454,8 @@ struct Workspace
    * preconditioner for scaling the problem (and reduce its ill conditioning).
    * @param precond preconditioner chosen for the solver.
    * @param precond_req storage requirements for the solver's preconditioner.
+   * @param incremental if set to true together with execute_or_not, the
+   * previous preconditioner is refined rather than recomputed from scratch.
    */
   template<typename P>
   void setup_impl(const QpView<T, I> qp,
@@ -330,7 +463,8 @@ struct Workspace
                   const Settings<T>& settings,
                   bool execute_or_not,
                   P& precond,
-                  proxsuite::linalg::veg::dynstack::StackReq precond_req)
+                  proxsuite::linalg::veg::dynstack::StackReq precond_req,
+                  bool incremental = false)
   {
 
     auto& ldl = internal.ldl;
@@ -380,13 +514,22 @@ struct Workspace
       // form the full kkt matrix
       // assuming H, AT, CT are sorted
       // and H is upper triangular
+      // the previous pattern is kept alive until the new one is formed, as the
+      // qp may be a view on the current kkt matrix (e.g., when updating it)
+      auto prev_kkt_col_ptrs = data.kkt_col_ptrs;
+      auto prev_kkt_row_indices = data.kkt_row_indices;
       {
-        data.kkt_col_ptrs.resize_for_overwrite(n_tot + 1);
-        data.kkt_row_indices.resize_for_overwrite(nnz_tot);
+        // a new pattern is formed, as the previous one may be shared
+        data.kkt_col_ptrs =
+          std::make_shared<proxsuite::linalg::veg::Vec<I>>();
+        data.kkt_row_indices =
+          std::make_shared<proxsuite::linalg::veg::Vec<I>>();
+        data.kkt_col_ptrs->resize_for_overwrite(n_tot + 1);
+        data.kkt_row_indices->resize_for_overwrite(nnz_tot);
         data.kkt_values.resize_for_overwrite(nnz_tot);
 
-        I* kktp = data.kkt_col_ptrs.ptr_mut();
-        I* kkti = data.kkt_row_indices.ptr_mut();
+        I* kktp = data.kkt_col_ptrs->ptr_mut();
+        I* kkti = data.kkt_row_indices->ptr_mut();
         T* kktx = data.kkt_values.ptr_mut();
 
         kktp[0] = 0;
@@ -426,18 +569,17 @@ struct Workspace
         insert_submatrix(qp.CT, false);
       }
 
-      data.kkt_col_ptrs_unscaled = data.kkt_col_ptrs;
-      data.kkt_row_indices_unscaled = data.kkt_row_indices;
-      data.kkt_values_unscaled = data.kkt_values;
 
       storage.resize_for_overwrite( //
         (StackReq::with_len(itag, n_tot) &
-         proxsuite::linalg::sparse::factorize_symbolic_req( //
-           itag,                                            //
-           n_tot,                                           //
-           nnz_tot,                                         //
-           proxsuite::linalg::sparse::Ordering::amd))       //
-          .alloc_req()                                      //
+         (proxsuite::linalg::sparse::factorize_symbolic_req( //
+            itag,                                            //
+            n_tot,                                           //
+            nnz_tot,                                         //
+            proxsuite::linalg::sparse::Ordering::amd) |      //
+          proxsuite::linalg::sparse::triangular_solve_levels_req(itag,
+                                                                 n_tot)))
+          .alloc_req() //
       );
 
       ldl.col_ptrs.resize_for_overwrite(n_tot + 1);
@@ -456,9 +598,9 @@ struct Workspace
           n_tot,
           n_tot,
           nnz_tot,
-          data.kkt_col_ptrs.ptr(),
+          data.kkt_col_ptrs->ptr(),
           nullptr,
-          data.kkt_row_indices.ptr(),
+          data.kkt_row_indices->ptr(),
         };
         proxsuite::linalg::sparse::factorize_symbolic_non_zeros( //
           ldl.col_ptrs.ptr_mut() + 1,
@@ -484,13 +626,11 @@ struct Workspace
           }
           pcol_ptrs[(i + 1)] = I(acc);
         }
+        ldl.compute_solve_levels(n_tot, stack);
       }
 
-      auto lnnz = isize(zero_extend(ldl.col_ptrs[n_tot]));
-
-      // if ldlt is too sparse
-      // do_ldlt = !overflow && lnnz < (10000000);
-      do_ldlt = !overflow && lnnz < 10000000;
+      lnnz = isize(zero_extend(ldl.col_ptrs[n_tot]));
+      internal.ldl_overflow = overflow;
     } else {
       T* kktx = data.kkt_values.ptr_mut();
       usize pos = 0;
@@ -514,7 +654,27 @@ struct Workspace
       insert_submatrix(qp.H);
       insert_submatrix(qp.AT);
       insert_submatrix(qp.CT);
+    }
+
+    data.store_unscaled_kkt = settings.sparse_store_unscaled_kkt;
+    if (data.store_unscaled_kkt) {
       data.kkt_values_unscaled = data.kkt_values;
+    } else {
+      data.kkt_values_unscaled = proxsuite::linalg::veg::Vec<T>{};
+    }
+
+    // the ldlt is used only if the storage of its values and row indices fits
+    // in the memory budget, otherwise the matrix free solver takes over
+    do_ldlt = !internal.ldl_overflow &&
+              lnnz * isize(sizeof(T) + sizeof(I)) <
+                settings.sparse_ldlt_memory_budget;
+    // if a directory is provided for it, a factor exceeding the budget is
+    // stored out of core instead, in the postorder of its elimination tree
+    bool ldl_out_of_core = !do_ldlt && !internal.ldl_overflow &&
+                           !settings.sparse_ldlt_mmap_directory.empty();
+    if (ldl_out_of_core) {
+      do_ldlt = true;
+      postorder_ldlt(data);
     }
 #define PROX_QP_ALL_OF(...)                                                    \
   ::proxsuite::linalg::veg::dynstack::StackReq::and_(                          \
@@ -556,6 +716,11 @@ struct Workspace
       x_vec(n_tot), // tmp
       x_vec(n_tot), // err
       x_vec(n_tot), // work
+      do_ldlt ? proxsuite::linalg::sparse::dense_lsolve_levels_req( // trsv
+                  xtag,
+                  n_tot,
+                  detail::spmv_nthreads(lnnz))
+              : SR::with_len(xtag, 0),
     });
 
     auto unscaled_primal_dual_residual_req = x_vec(n); // Hx
@@ -634,8 +799,8 @@ struct Workspace
                         SR::with_len(itag, n_tot), // perm
                         SR::with_len(itag, n_tot), // etree
                         SR::with_len(itag, n_tot), // ldl nnz counts
-                        SR::with_len(itag, lnnz),  // ldl row indices
-                        SR::with_len(xtag, lnnz),  // ldl values
+                        SR::with_len(itag, ldl_out_of_core ? 0 : lnnz),
+                        SR::with_len(xtag, ldl_out_of_core ? 0 : lnnz),
                       })
                     : PROX_QP_ALL_OF({
                         SR::with_len(itag, 0),
@@ -706,13 +871,31 @@ struct Workspace
     };
 
     DynStackMut stack = stack_mut();
-    precond.scale_qp_in_place(qp_scaled,
-                              execute_or_not,
-                              settings.preconditioner_max_iter,
-                              settings.preconditioner_accuracy,
-                              stack);
+    if (execute_or_not && incremental) {
+      precond.scale_qp_in_place_incremental(qp_scaled,
+                                            settings.preconditioner_max_iter,
+                                            settings.preconditioner_accuracy,
+                                            stack);
+    } else {
+      precond.scale_qp_in_place(qp_scaled,
+                                execute_or_not,
+                                settings.preconditioner_max_iter,
+                                settings.preconditioner_accuracy,
+                                stack);
+    }
     kkt_nnz_counts.resize_for_overwrite(n_tot);
 
+    // the partitions of the matrix vector products only depend on the sparsity
+    // patterns: those of the model are computed here, the one of the active
+    // part of the kkt matrix at its first product after an active set change
+    auto& spmv = internal.spmv;
+    spmv.H.reset();
+    spmv.AT.reset();
+    spmv.CT.reset();
+    spmv.H.prepare(H_scaled.as_const(), detail::spmv_nthreads(data.H_nnz));
+    spmv.AT.prepare(AT_scaled.as_const(), detail::spmv_nthreads(data.A_nnz));
+    spmv.CT.prepare(CT_scaled.as_const(), detail::spmv_nthreads(data.C_nnz));
+
     proxsuite::linalg::sparse::MatMut<T, I> kkt_active = {
       proxsuite::linalg::sparse::from_raw_parts,
       n_tot,
@@ -727,9 +910,7 @@ struct Workspace
       kkt.values_mut(),
     };
 
-    using MatrixFreeSolver = Eigen::MINRES<detail::AugmentedKkt<T, I>,
-                                           Eigen::Upper | Eigen::Lower,
-                                           Eigen::IdentityPreconditioner>;
+    using MatrixFreeSolver = detail::MatrixFreeSolver<T, I>;
     matrix_free_solver = std::unique_ptr<MatrixFreeSolver>{
       new MatrixFreeSolver,
     };
@@ -754,8 +935,28 @@ struct Workspace
     isize ldlt_lnnz = do_ldlt ? max_lnnz : 0;
 
     ldl.nnz_counts.resize_for_overwrite(ldlt_ntot);
-    ldl.row_indices.resize_for_overwrite(ldlt_lnnz);
-    ldl.values.resize_for_overwrite(ldlt_lnnz);
+    if (ldl_out_of_core) {
+      usize row_indices_size = usize(ldlt_lnnz) * sizeof(I);
+      usize values_size = usize(ldlt_lnnz) * sizeof(T);
+      if (ldl.row_indices_file == nullptr ||
+          ldl.row_indices_file->size() != row_indices_size) {
+        ldl.row_indices_file = std::make_unique<proxsuite::helpers::MappedFile>(
+          settings.sparse_ldlt_mmap_directory, row_indices_size);
+        ldl.values_file = std::make_unique<proxsuite::helpers::MappedFile>(
+          settings.sparse_ldlt_mmap_directory, values_size);
+      }
+      ldl.row_indices = proxsuite::linalg::veg::Vec<I>{};
+      ldl.values = proxsuite::linalg::veg::Vec<T>{};
+    } else {
+      ldl.row_indices_file = nullptr;
+      ldl.values_file = nullptr;
+      ldl.row_indices.resize_for_overwrite(ldlt_lnnz);
+      ldl.values.resize_for_overwrite(ldlt_lnnz);
+      proxsuite::helpers::advise_large_buffer(ldl.row_indices.ptr_mut(),
+                                              usize(ldlt_lnnz) * sizeof(I));
+      proxsuite::helpers::advise_large_buffer(ldl.values.ptr_mut(),
+                                              usize(ldlt_lnnz) * sizeof(T));
+    }
 
     ldl.perm.resize_for_overwrite(ldlt_ntot);
     if (do_ldlt) {
@@ -767,6 +968,77 @@ struct Workspace
 
     internal.dirty = false;
   }
+  /*!
+   * Relabels the columns of the LDLT factor of the KKT matrix following a
+   * postorder of its elimination tree, so that the columns of each subtree are
+   * contiguous and the factorization and the triangular solves traverse the
+   * factor storage mostly sequentially.
+   * @param data solver's model.
+   */
+  void postorder_ldlt(Model<T, I> const& data)
+  {
+    using namespace proxsuite::linalg::veg::dynstack;
+    using proxsuite::linalg::sparse::util::zero_extend;
+    proxsuite::linalg::veg::Tag<I> itag;
+
+    auto& ldl = internal.ldl;
+    isize n_tot = data.dim + data.n_eq + data.n_in;
+    isize nnz_tot = data.H_nnz + data.A_nnz + data.C_nnz;
+
+    internal.storage.resize_for_overwrite(
+      (StackReq::with_len(itag, 3 * n_tot) &
+       (proxsuite::linalg::sparse::factorize_symbolic_req(
+          itag,
+          n_tot,
+          nnz_tot,
+          proxsuite::linalg::sparse::Ordering::user_provided) |
+        proxsuite::linalg::sparse::postorder_req(itag, n_tot) |
+        proxsuite::linalg::sparse::triangular_solve_levels_req(itag, n_tot)))
+        .alloc_req());
+    DynStackMut stack = stack_mut();
+
+    auto _perm = stack.make_new_for_overwrite(itag, n_tot);
+    auto _post = stack.make_new_for_overwrite(itag, n_tot);
+    auto _post_perm = stack.make_new_for_overwrite(itag, n_tot);
+    I* perm = _perm.ptr_mut();
+    I* post = _post.ptr_mut();
+    I* post_perm = _post_perm.ptr_mut();
+
+    for (isize i = 0; i < n_tot; ++i) {
+      perm[isize(zero_extend(ldl.perm_inv[i]))] = I(i);
+    }
+    auto kkt_sym = data.kkt().symbolic();
+
+    // the elimination tree of the whole kkt matrix, which the numeric
+    // factorization may have overwritten
+    proxsuite::linalg::sparse::factorize_symbolic_non_zeros(
+      ldl.col_ptrs.ptr_mut() + 1,
+      ldl.etree.ptr_mut(),
+      ldl.perm_inv.ptr_mut(),
+      perm,
+      kkt_sym,
+      stack);
+    proxsuite::linalg::sparse::postorder(post, ldl.etree.ptr(), n_tot, stack);
+    for (isize k = 0; k < n_tot; ++k) {
+      post_perm[k] = perm[isize(zero_extend(post[k]))];
+    }
+    proxsuite::linalg::sparse::factorize_symbolic_non_zeros(
+      ldl.col_ptrs.ptr_mut() + 1,
+      ldl.etree.ptr_mut(),
+      ldl.perm_inv.ptr_mut(),
+      post_perm,
+      kkt_sym,
+      stack);
+
+    // the relabeling leaves the total number of non zeros unchanged
+    I* pcol_ptrs = ldl.col_ptrs.ptr_mut();
+    pcol_ptrs[0] = I(0);
+    for (isize i = 0; i < n_tot; ++i) {
+      pcol_ptrs[i + 1] =
+        I(zero_extend(pcol_ptrs[i]) + zero_extend(pcol_ptrs[i + 1]));
+    }
+    ldl.compute_solve_levels(n_tot, stack);
+  }
   Timer<T> timer;
   Workspace() = default;
 
@@ -11,6 +11,10 @@
 #include <proxsuite/proxqp/settings.hpp>
 #include <proxsuite/proxqp/sparse/solver.hpp>
 #include <proxsuite/proxqp/sparse/helpers.hpp>
+#include <proxsuite/helpers/omp.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
 
 namespace proxsuite {
 namespace proxqp {
@@ -347,7 +351,10 @@ struct QP
     work.internal.proximal_parameter_update = false;
     PreconditionerStatus preconditioner_status;
     if (update_preconditioner_) {
-      preconditioner_status = proxsuite::proxqp::PreconditionerStatus::EXECUTE;
+      preconditioner_status =
+        settings.incremental_preconditioner
+          ? proxsuite::proxqp::PreconditionerStatus::INCREMENTAL
+          : proxsuite::proxqp::PreconditionerStatus::EXECUTE;
     } else {
       preconditioner_status = proxsuite::proxqp::PreconditionerStatus::KEEP;
     }
@@ -426,6 +433,8 @@ struct QP
     }
 
     // update the model
+    // (the kkt values are scaled again by qp_setup below)
+    detail::unscale_kkt_in_place(model, ruiz);
 
     if (g_ != std::nullopt) {
       model.g = g_.value();
@@ -603,6 +612,212 @@ struct QP
     }
   };
 
+  /*!
+   * Returns the sparsity structure of the upper triangular part of H, in the
+   * compressed sparse column order in which update_values expects its values.
+   */
+  auto H_structure() const -> SparseMat<bool, I>
+  {
+    return detail::structure_of(
+      detail::middle_cols(
+        detail::top_rows_unchecked(
+          proxsuite::linalg::veg::unsafe, model.kkt(), model.dim),
+        0,
+        model.dim,
+        model.H_nnz));
+  }
+  /*!
+   * Returns the sparsity structure of the transposed equality constraint
+   * matrix, in the compressed sparse column order in which update_values
+   * expects the values of A (i.e., row by row).
+   */
+  auto AT_structure() const -> SparseMat<bool, I>
+  {
+    return detail::structure_of(
+      detail::middle_cols(
+        detail::top_rows_unchecked(
+          proxsuite::linalg::veg::unsafe, model.kkt(), model.dim),
+        model.dim,
+        model.n_eq,
+        model.A_nnz));
+  }
+  /*!
+   * Returns the sparsity structure of the transposed inequality constraint
+   * matrix, in the compressed sparse column order in which update_values
+   * expects the values of C (i.e., row by row).
+   */
+  auto CT_structure() const -> SparseMat<bool, I>
+  {
+    return detail::structure_of(
+      detail::middle_cols(
+        detail::top_rows_unchecked(
+          proxsuite::linalg::veg::unsafe, model.kkt(), model.dim),
+        model.dim + model.n_eq,
+        model.n_in,
+        model.C_nnz));
+  }
+  /*!
+   * Updates the values of the QP model and re-equilibrates it if specified by
+   * the user. Contrary to update, the matrices are given by their values only,
+   * in the internal order exposed by H_structure, AT_structure and
+   * CT_structure, so that no check of their sparsity structure nor temporary
+   * matrix is needed.
+   * @param H_values values of the upper triangular part of the quadratic cost
+   * (of size model.H_nnz).
+   * @param g_ linear cost input defining the QP model.
+   * @param A_values values of the equality constraint matrix (of size
+   * model.A_nnz).
+   * @param b_ equality constraint vector input defining the QP model.
+   * @param C_values values of the inequality constraint matrix (of size
+   * model.C_nnz).
+   * @param u_ lower inequality constraint vector input defining the QP model.
+   * @param l_ lower inequality constraint vector input defining the QP model.
+   * @param update_preconditioner_ bool parameter for updating or not the
+   * preconditioner and the associated scaled model.
+   * @param rho proximal step size wrt primal variable.
+   * @param mu_eq proximal step size wrt equality constrained multiplier.
+   * @param mu_in proximal step size wrt inequality constrained multiplier.
+   */
+  void update_values(std::optional<VecRef<T>> H_values,
+                     std::optional<VecRef<T>> g_,
+                     std::optional<VecRef<T>> A_values,
+                     std::optional<VecRef<T>> b_,
+                     std::optional<VecRef<T>> C_values,
+                     std::optional<VecRef<T>> u_,
+                     std::optional<VecRef<T>> l_,
+                     bool update_preconditioner_ = true,
+                     std::optional<T> rho = std::nullopt,
+                     std::optional<T> mu_eq = std::nullopt,
+                     std::optional<T> mu_in = std::nullopt)
+  {
+    if (settings.compute_timings) {
+      work.timer.stop();
+      work.timer.start();
+    }
+    work.internal.dirty = false;
+    work.internal.proximal_parameter_update = false;
+    PreconditionerStatus preconditioner_status;
+    if (update_preconditioner_) {
+      preconditioner_status =
+        settings.incremental_preconditioner
+          ? proxsuite::proxqp::PreconditionerStatus::INCREMENTAL
+          : proxsuite::proxqp::PreconditionerStatus::EXECUTE;
+    } else {
+      preconditioner_status = proxsuite::proxqp::PreconditionerStatus::KEEP;
+    }
+
+    // check the model is valid
+    PROXSUITE_THROW_PRETTY(model.kkt_col_ptrs->len() == 0,
+                           std::invalid_argument,
+                           "the QP model should be initialized before its "
+                           "values are updated.");
+    if (g_ != std::nullopt) {
+      PROXSUITE_CHECK_ARGUMENT_SIZE(g_.value().rows(),
+                                    model.dim,
+                                    "the dimension wrt the primal variable x "
+                                    "variable for updating g is not valid.");
+    }
+    if (b_ != std::nullopt) {
+      PROXSUITE_CHECK_ARGUMENT_SIZE(b_.value().rows(),
+                                    model.n_eq,
+                                    "the dimension wrt equality constrained "
+                                    "variables for updating b is not valid.");
+    }
+    if (u_ != std::nullopt) {
+      PROXSUITE_CHECK_ARGUMENT_SIZE(u_.value().rows(),
+                                    model.n_in,
+                                    "the dimension wrt inequality constrained "
+                                    "variables for updating u is not valid.");
+    }
+    if (l_ != std::nullopt) {
+      PROXSUITE_CHECK_ARGUMENT_SIZE(l_.value().rows(),
+                                    model.n_in,
+                                    "the dimension wrt inequality constrained "
+                                    "variables for updating l is not valid.");
+    }
+    if (H_values != std::nullopt) {
+      PROXSUITE_CHECK_ARGUMENT_SIZE(
+        H_values.value().rows(),
+        model.H_nnz,
+        "the number of values for updating H is not valid.");
+    }
+    if (A_values != std::nullopt) {
+      PROXSUITE_CHECK_ARGUMENT_SIZE(
+        A_values.value().rows(),
+        model.A_nnz,
+        "the number of values for updating A is not valid.");
+    }
+    if (C_values != std::nullopt) {
+      PROXSUITE_CHECK_ARGUMENT_SIZE(
+        C_values.value().rows(),
+        model.C_nnz,
+        "the number of values for updating C is not valid.");
+    }
+
+    // update the model
+    // (the kkt values are scaled again by qp_setup below)
+    detail::unscale_kkt_in_place(model, ruiz);
+
+    if (g_ != std::nullopt) {
+      model.g = g_.value();
+    }
+    if (b_ != std::nullopt) {
+      model.b = b_.value();
+    }
+    if (u_ != std::nullopt) {
+      model.u = u_.value();
+    }
+    if (l_ != std::nullopt) {
+      model.l = l_.value();
+    }
+
+    // the values of H, AT and CT are stored contiguously in the unscaled kkt
+    proxsuite::linalg::sparse::MatMut<T, I> kkt_unscaled =
+      model.kkt_mut_unscaled();
+    T* kktx = kkt_unscaled.values_mut();
+    if (H_values != std::nullopt) {
+      std::copy_n(H_values.value().data(), model.H_nnz, kktx);
+    }
+    if (A_values != std::nullopt) {
+      std::copy_n(A_values.value().data(), model.A_nnz, kktx + model.H_nnz);
+    }
+    if (C_values != std::nullopt) {
+      std::copy_n(C_values.value().data(),
+                  model.C_nnz,
+                  kktx + (model.H_nnz + model.A_nnz));
+    }
+
+    auto kkt_top_n_rows = detail::top_rows_unchecked(
+      proxsuite::linalg::veg::unsafe, kkt_unscaled.as_const(), model.dim);
+    sparse::QpView<T, I> qp = {
+      detail::middle_cols(kkt_top_n_rows, 0, model.dim, model.H_nnz),
+      { proxsuite::linalg::sparse::from_eigen, model.g },
+      detail::middle_cols(kkt_top_n_rows, model.dim, model.n_eq, model.A_nnz),
+      { proxsuite::linalg::sparse::from_eigen, model.b },
+      detail::middle_cols(
+        kkt_top_n_rows, model.dim + model.n_eq, model.n_in, model.C_nnz),
+      { proxsuite::linalg::sparse::from_eigen, model.l },
+      { proxsuite::linalg::sparse::from_eigen, model.u }
+    };
+    proxsuite::proxqp::sparse::update_proximal_parameters(
+      settings, results, work, rho, mu_eq, mu_in);
+    // the sparsity structure is unchanged, and so is its symbolic analysis
+    bool do_symbolic_fact = work.internal.do_symbolic_fact;
+    work.internal.do_symbolic_fact = false;
+    qp_setup(qp,
+             results,
+             model,
+             work,
+             settings,
+             ruiz,
+             preconditioner_status); // store model value + performs scaling
+                                     // according to chosen options
+    work.internal.do_symbolic_fact = do_symbolic_fact;
+    if (settings.compute_timings) {
+      results.info.setup_time = work.timer.elapsed().user; // in microseconds
+    }
+  };
+
   /*!
    * Solves the QP problem using PRXOQP algorithm.
    */
@@ -637,7 +852,175 @@ struct QP
    * Clean-ups solver's results.
    */
   void cleanup() { results.cleanup(settings); }
+  /*!
+   * Returns the size of the stack of the workspace, and the largest number of
+   * bytes of it used so far.
+   */
+  auto stack_usage() const -> StackUsage
+  {
+    return { work.internal.storage.len(), work.internal.stack_peak_bytes };
+  }
+};
+///
+/// @brief This class defines the API of PROXQP solver with sparse backend for
+/// batches of problems sharing the same sparsity structure.
+///
+/*!
+ * Wrapper class for solving a batch of linearly constrained convex QP problems
+ * whose matrices H, A and C have the same sparsity structure but different
+ * values (e.g., scenario based MPC). The ordering and the symbolic analysis of
+ * the KKT matrix are performed once for the whole batch, whose members share
+ * the sparsity pattern of their KKT matrix. Each member is a QP object which
+ * is initialized with its own values, the numeric solves of the batch being
+ * then run in parallel (when OpenMP support is enabled).
+ *
+ * Example usage:
+ * ```cpp
+        proxqp::sparse::BatchQP<T, I> batch(
+          batch_size, H.cast<bool>(), A.cast<bool>(), C.cast<bool>());
+        for (isize i = 0; i < batch_size; ++i) {
+          batch[i].init(H[i], g[i], A[i], b[i], C[i], u[i], l[i]);
+        }
+        batch.solve();
+ * ```
+ */
+template<typename T, typename I>
+struct BatchQP
+{
+  std::vector<QP<T, I>> qps;
+  /*!
+   * Default constructor using the sparsity structure shared by the problems
+   * of the batch.
+   * @param batch_size number of problems of the batch.
+   * @param H boolean mask of the quadratic cost input defining the QP models.
+   * @param A boolean mask of the equality constraint matrix input defining the
+   * QP models.
+   * @param C boolean mask of the inequality constraint matrix input defining
+   * the QP models.
+   */
+  BatchQP(isize batch_size,
+          const SparseMat<bool, I>& H,
+          const SparseMat<bool, I>& A,
+          const SparseMat<bool, I>& C)
+  {
+    PROXSUITE_THROW_PRETTY(batch_size <= 0,
+                           std::invalid_argument,
+                           "wrong argument size: the batch size should be "
+                           "strictly positive.");
+    qps.reserve(usize(batch_size));
+    qps.emplace_back(H, A, C);
+    for (isize i = 1; i < batch_size; ++i) {
+      qps.emplace_back(H.rows(), A.rows(), C.rows());
+      qps.back().work.share_symbolic_factorization(
+        qps.back().model, qps.front().work, qps.front().model);
+    }
+  }
+  /*!
+   * Returns the number of problems of the batch.
+   */
+  auto size() const -> isize { return isize(qps.size()); }
+  /*!
+   * Returns the i-th problem of the batch.
+   * @param i index of the problem.
+   */
+  auto operator[](isize i) -> QP<T, I>&
+  {
+    VEG_ASSERT(i >= 0 && i < size());
+    return qps[usize(i)];
+  }
+  auto operator[](isize i) const -> QP<T, I> const&
+  {
+    VEG_ASSERT(i >= 0 && i < size());
+    return qps[usize(i)];
+  }
+  /*!
+   * Calls fn(i, qp) for each problem qp of the batch, of index i, in parallel
+   * when OpenMP support is enabled. An exception thrown for some problems is
+   * rethrown once all of them are processed.
+   * @param fn function called on each problem.
+   * @param num_threads largest number of threads used, all the available ones
+   * when it is not positive.
+   */
+  template<typename Fn>
+  void for_each(Fn&& fn, isize num_threads = 0)
+  {
+    proxsuite::helpers::parallel_for(
+      size(), num_threads, [&](isize i) { fn(i, qps[usize(i)]); });
+  }
+  /*!
+   * Solves the problems of the batch, in parallel when OpenMP support is
+   * enabled.
+   */
+  void solve()
+  {
+    for_each([](isize /*i*/, QP<T, I>& qp) { qp.solve(); });
+  }
 };
+/*!
+ * Predicts the number of non zeros of the LDLT factor of the KKT matrix of a
+ * QP with the given sparsity structure, as computed by the symbolic
+ * factorization of the solver. The symbolic factorization is performed with
+ * 64 bit indices, so that the prediction is valid even when it does not fit in
+ * a smaller index type.
+ * @param H boolean mask of the quadratic cost input defining the QP model.
+ * @param A boolean mask of the equality constraint matrix input defining the
+ * QP model.
+ * @param C boolean mask of the inequality constraint matrix input defining
+ * the QP model.
+ */
+template<typename I>
+auto
+predicted_ldlt_nnz(const SparseMat<bool, I>& H,
+                   const SparseMat<bool, I>& A,
+                   const SparseMat<bool, I>& C) -> i64
+{
+  SparseMat<bool, i64> H_triu = H.template triangularView<Eigen::Upper>();
+  SparseMat<bool, i64> AT = A.transpose();
+  SparseMat<bool, i64> CT = C.transpose();
+  proxsuite::linalg::sparse::MatRef<bool, i64> Href = {
+    proxsuite::linalg::sparse::from_eigen, H_triu
+  };
+  proxsuite::linalg::sparse::MatRef<bool, i64> ATref = {
+    proxsuite::linalg::sparse::from_eigen, AT
+  };
+  proxsuite::linalg::sparse::MatRef<bool, i64> CTref = {
+    proxsuite::linalg::sparse::from_eigen, CT
+  };
+  Model<f64, i64> model(H.rows(), A.rows(), C.rows());
+  Workspace<f64, i64> work;
+  work.setup_symbolic_factorizaton(
+    model, Href.symbolic(), ATref.symbolic(), CTref.symbolic());
+  return i64(work.lnnz);
+}
+/*!
+ * Returns whether the index type J is large enough for the KKT matrix of a QP
+ * with the given sparsity structure and for its LDLT factor. When it is not,
+ * the solver falls back to its matrix free path. The factor is only predicted
+ * when it may contain more entries than J can index, i.e., when a dense lower
+ * triangular factor of the KKT matrix would not fit.
+ * @param H boolean mask of the quadratic cost input defining the QP model.
+ * @param A boolean mask of the equality constraint matrix input defining the
+ * QP model.
+ * @param C boolean mask of the inequality constraint matrix input defining
+ * the QP model.
+ */
+template<typename J, typename I>
+auto
+index_type_fits(const SparseMat<bool, I>& H,
+                const SparseMat<bool, I>& A,
+                const SparseMat<bool, I>& C) -> bool
+{
+  i64 max_index = i64(std::numeric_limits<J>::max());
+  i64 n_tot = i64(H.rows()) + i64(A.rows()) + i64(C.rows());
+  i64 nnz_tot = i64(H.nonZeros()) + i64(A.nonZeros()) + i64(C.nonZeros());
+  if (n_tot > max_index || nnz_tot > max_index) {
+    return false;
+  }
+  if (n_tot <= 1 || (n_tot - 1) <= max_index / n_tot * 2) {
+    return true;
+  }
+  return predicted_ldlt_nnz(H, A, C) <= max_index;
+}
 /*!
  * Solves the QP problem using PROXQP algorithm without the need to define a QP
  * object, with matrices defined by Dense Eigen matrices. It is possible to set
@@ -33,10 +33,28 @@ enum struct InitialGuessStatus
 // PRECONDITIONER STATUS
 enum struct PreconditionerStatus
 {
-  EXECUTE, // initialize or update with qp in entry
-  KEEP,    // keep previous preconditioner (for update method)
-  IDENTITY // do not execute, hence use identity preconditioner (for init
-           // method)
+  EXECUTE,    // initialize or update with qp in entry
+  KEEP,       // keep previous preconditioner (for update method)
+  IDENTITY,   // do not execute, hence use identity preconditioner (for init
+              // method)
+  INCREMENTAL // refine the previous preconditioner with qp in entry (for
+              // update method)
+};
+// MATRIX FREE PRECONDITIONER STATUS
+enum struct MatrixFreePreconditioner
+{
+  IDENTITY,       // no preconditioning of the iterative KKT solver
+  BLOCK_DIAGONAL, // regularized diagonal of H and approximate Schur
+                  // complements of the constraint blocks
+  INCOMPLETE_LDLT // zero fill-in LDLT of the regularized KKT matrix
+};
+// QP BACKEND
+enum struct QPBackend
+{
+  AUTOMATIC, // chosen at initialization from the dimensions and the sparsity
+             // structure of the problem
+  DENSE,     // dense backend
+  SPARSE     // sparse backend
 };
 
 } // namespace proxqp
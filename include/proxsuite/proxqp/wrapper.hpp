@@ -0,0 +1,625 @@
+//
+// Copyright (c) 2022 INRIA
+//
+/**
+ * @file wrapper.hpp
+ */
+
+#ifndef PROXSUITE_QP_WRAPPER_HPP
+#define PROXSUITE_QP_WRAPPER_HPP
+#include <proxsuite/proxqp/dense/wrapper.hpp>
+#include <proxsuite/proxqp/sparse/wrapper.hpp>
+#include <optional>
+
+namespace proxsuite {
+namespace proxqp {
+
+/*!
+ * Returns the backend expected to solve faster a QP with the given sparsity
+ * structure. The cost of a factorization of the KKT matrix is modeled for both
+ * backends: (n + n_eq + n_in)^3 / 3 flops for the dense one, and lnnz^2 / n_tot
+ * flops, weighted by the lower efficiency of the sparse kernels, plus a fixed
+ * cost per column for the sparse one, lnnz being the predicted number of
+ * entries of its LDLT factor. The factor is only predicted when the number of
+ * entries of the KKT matrix does not already rule the sparse backend out.
+ * @param H boolean mask of the quadratic cost input defining the QP model.
+ * @param A boolean mask of the equality constraint matrix input defining the
+ * QP model.
+ * @param C boolean mask of the inequality constraint matrix input defining
+ * the QP model.
+ */
+template<typename I>
+auto
+preferred_backend(const sparse::SparseMat<bool, I>& H,
+                  const sparse::SparseMat<bool, I>& A,
+                  const sparse::SparseMat<bool, I>& C) -> QPBackend
+{
+  // a flop of the sparse factorization is several times as expensive as a
+  // flop of the blocked dense one, and each column has a fixed cost of
+  // scattering, permuting and bookkeeping
+  constexpr f64 sparse_flop_cost = 8;
+  constexpr f64 sparse_column_cost = 100;
+
+  f64 n_tot = f64(H.rows()) + f64(A.rows()) + f64(C.rows());
+  if (n_tot == 0) {
+    return QPBackend::DENSE;
+  }
+  f64 dense_cost = n_tot * n_tot * n_tot / 3;
+  auto sparse_cost = [&](f64 lnnz) {
+    return sparse_flop_cost * lnnz * lnnz / n_tot + sparse_column_cost * n_tot;
+  };
+
+  // the factor contains at least the off-diagonal entries of the KKT matrix
+  f64 kkt_nnz = f64(A.nonZeros()) + f64(C.nonZeros());
+  for (isize j = 0; j < H.outerSize(); ++j) {
+    for (typename sparse::SparseMat<bool, I>::InnerIterator it(H, j); it;
+         ++it) {
+      if (isize(it.row()) < j) {
+        kkt_nnz += 1;
+      }
+    }
+  }
+  if (sparse_cost(kkt_nnz) >= dense_cost) {
+    return QPBackend::DENSE;
+  }
+  f64 lnnz = f64(sparse::predicted_ldlt_nnz(H, A, C));
+  return sparse_cost(lnnz) < dense_cost ? QPBackend::SPARSE : QPBackend::DENSE;
+}
+
+///
+/// @brief This class defines the API of PROXQP solver with a backend chosen at
+/// initialization.
+///
+/*!
+ * Wrapper class for using proxsuite API with the dense or the sparse backend,
+ * chosen at initialization with preferred_backend, unless settings.backend
+ * specifies one. The model can be given with dense or sparse matrices,
+ * whatever the backend, and is converted to the format of the backend when
+ * needed.
+ *
+ * Example usage:
+ * ```cpp
+ *      proxqp::QP<T, I> Qp{dim, n_eq, n_in}; // creating QP object
+ *      Qp.settings.eps_abs = eps_abs; // choose accuracy needed
+ *      Qp.init(H, g, A, b, C, u, l); // setup the QP object and its backend
+ *      Qp.solve(); // solve the problem
+ *      T x0 = Qp.results().x[0]; // read the solution
+ * ```
+ */
+template<typename T, typename I>
+struct QP
+{
+  Settings<T> settings;
+  std::optional<dense::QP<T>> dense_qp;
+  std::optional<sparse::QP<T, I>> sparse_qp;
+  /*!
+   * Default constructor using QP model dimensions.
+   * @param _dim primal variable dimension.
+   * @param _n_eq number of equality constraints.
+   * @param _n_in number of inequality constraints.
+   */
+  QP(isize _dim, isize _n_eq, isize _n_in)
+    : settings()
+    , dim(_dim)
+    , n_eq(_n_eq)
+    , n_in(_n_in)
+  {
+  }
+  /*!
+   * Returns the backend chosen at initialization, or AUTOMATIC before it.
+   */
+  auto backend() const -> QPBackend
+  {
+    if (dense_qp) {
+      return QPBackend::DENSE;
+    }
+    if (sparse_qp) {
+      return QPBackend::SPARSE;
+    }
+    return QPBackend::AUTOMATIC;
+  }
+  /*!
+   * Returns the results of the backend.
+   */
+  auto results() const -> Results<T> const&
+  {
+    PROXSUITE_THROW_PRETTY(backend() == QPBackend::AUTOMATIC,
+                           std::runtime_error,
+                           "the QP object has not been initialized.");
+    return dense_qp ? dense_qp->results : sparse_qp->results;
+  }
+  /*!
+   * Setups the QP model (with dense matrix format) and its backend, and
+   * equilibrates it if specified by the user.
+   * @param H quadratic cost input defining the QP model.
+   * @param g linear cost input defining the QP model.
+   * @param A equality constraint matrix input defining the QP model.
+   * @param b equality constraint vector input defining the QP model.
+   * @param C inequality constraint matrix input defining the QP model.
+   * @param u lower inequality constraint vector input defining the QP model.
+   * @param l lower inequality constraint vector input defining the QP model.
+   * @param compute_preconditioner boolean parameter for executing or not the
+   * preconditioner.
+   * @param rho proximal step size wrt primal variable.
+   * @param mu_eq proximal step size wrt equality constrained multiplier.
+   * @param mu_in proximal step size wrt inequality constrained multiplier.
+   */
+  void init(std::optional<dense::MatRef<T>> H,
+            std::optional<dense::VecRef<T>> g,
+            std::optional<dense::MatRef<T>> A,
+            std::optional<dense::VecRef<T>> b,
+            std::optional<dense::MatRef<T>> C,
+            std::optional<dense::VecRef<T>> u,
+            std::optional<dense::VecRef<T>> l,
+            bool compute_preconditioner = true,
+            std::optional<T> rho = std::nullopt,
+            std::optional<T> mu_eq = std::nullopt,
+            std::optional<T> mu_in = std::nullopt)
+  {
+    // the sparse copies of the matrices are only formed for the sparse
+    // backend, the backend is chosen from their dense form
+    if (select_backend(H, A, C) == QPBackend::DENSE) {
+      dense_qp.emplace(dim, n_eq, n_in);
+      dense_qp->settings = settings;
+      dense_qp->init(
+        H, g, A, b, C, u, l, compute_preconditioner, rho, mu_eq, mu_in);
+      settings = dense_qp->settings;
+    } else {
+      sparse_qp.emplace(dim, n_eq, n_in);
+      sparse_qp->settings = settings;
+      sparse_qp->init(to_sparse(H),
+                      g,
+                      to_sparse(A),
+                      b,
+                      to_sparse(C),
+                      u,
+                      l,
+                      compute_preconditioner,
+                      rho,
+                      mu_eq,
+                      mu_in);
+      settings = sparse_qp->settings;
+    }
+  }
+  /*!
+   * Setups the QP model (with sparse matrix format) and its backend, and
+   * equilibrates it if specified by the user. Only the upper triangular part of
+   * H is used.
+   * @param H quadratic cost input defining the QP model.
+   * @param g linear cost input defining the QP model.
+   * @param A equality constraint matrix input defining the QP model.
+   * @param b equality constraint vector input defining the QP model.
+   * @param C inequality constraint matrix input defining the QP model.
+   * @param u lower inequality constraint vector input defining the QP model.
+   * @param l lower inequality constraint vector input defining the QP model.
+   * @param compute_preconditioner boolean parameter for executing or not the
+   * preconditioner.
+   * @param rho proximal step size wrt primal variable.
+   * @param mu_eq proximal step size wrt equality constrained multiplier.
+   * @param mu_in proximal step size wrt inequality constrained multiplier.
+   */
+  void init(std::optional<sparse::SparseMat<T, I>> H,
+            std::optional<dense::VecRef<T>> g,
+            std::optional<sparse::SparseMat<T, I>> A,
+            std::optional<dense::VecRef<T>> b,
+            std::optional<sparse::SparseMat<T, I>> C,
+            std::optional<dense::VecRef<T>> u,
+            std::optional<dense::VecRef<T>> l,
+            bool compute_preconditioner = true,
+            std::optional<T> rho = std::nullopt,
+            std::optional<T> mu_eq = std::nullopt,
+            std::optional<T> mu_in = std::nullopt)
+  {
+    if (select_backend(H, A, C) == QPBackend::DENSE) {
+      std::optional<DenseMat> H_dense = to_dense(H, true);
+      std::optional<DenseMat> A_dense = to_dense(A, false);
+      std::optional<DenseMat> C_dense = to_dense(C, false);
+      dense_qp.emplace(dim, n_eq, n_in);
+      dense_qp->settings = settings;
+      dense_qp->init(as_ref(H_dense),
+                     g,
+                     as_ref(A_dense),
+                     b,
+                     as_ref(C_dense),
+                     u,
+                     l,
+                     compute_preconditioner,
+                     rho,
+                     mu_eq,
+                     mu_in);
+      settings = dense_qp->settings;
+    } else {
+      sparse_qp.emplace(dim, n_eq, n_in);
+      sparse_qp->settings = settings;
+      sparse_qp->init(
+        H, g, A, b, C, u, l, compute_preconditioner, rho, mu_eq, mu_in);
+      settings = sparse_qp->settings;
+    }
+  }
+  /*!
+   * Updates the QP model (with dense matrix format) of the backend chosen at
+   * initialization, and re-equilibrates it if specified by the user. With the
+   * sparse backend, the nonzero entries of an updated matrix must belong to the
+   * sparsity structure used for the initialization, the entries of this
+   * structure being updated whether they are zero or not.
+   * @param H quadratic cost input defining the QP model.
+   * @param g linear cost input defining the QP model.
+   * @param A equality constraint matrix input defining the QP model.
+   * @param b equality constraint vector input defining the QP model.
+   * @param C inequality constraint matrix input defining the QP model.
+   * @param u lower inequality constraint vector input defining the QP model.
+   * @param l lower inequality constraint vector input defining the QP model.
+   * @param update_preconditioner bool parameter for updating or not the
+   * preconditioner and the associated scaled model.
+   * @param rho proximal step size wrt primal variable.
+   * @param mu_eq proximal step size wrt equality constrained multiplier.
+   * @param mu_in proximal step size wrt inequality constrained multiplier.
+   */
+  void update(std::optional<dense::MatRef<T>> H,
+              std::optional<dense::VecRef<T>> g,
+              std::optional<dense::MatRef<T>> A,
+              std::optional<dense::VecRef<T>> b,
+              std::optional<dense::MatRef<T>> C,
+              std::optional<dense::VecRef<T>> u,
+              std::optional<dense::VecRef<T>> l,
+              bool update_preconditioner = true,
+              std::optional<T> rho = std::nullopt,
+              std::optional<T> mu_eq = std::nullopt,
+              std::optional<T> mu_in = std::nullopt)
+  {
+    PROXSUITE_THROW_PRETTY(backend() == QPBackend::AUTOMATIC,
+                           std::runtime_error,
+                           "the QP object has not been initialized.");
+    if (dense_qp) {
+      dense_qp->settings = settings;
+      dense_qp->update(H,
+                       to_vec(g),
+                       A,
+                       to_vec(b),
+                       C,
+                       to_vec(u),
+                       to_vec(l),
+                       update_preconditioner,
+                       rho,
+                       mu_eq,
+                       mu_in);
+      settings = dense_qp->settings;
+    } else {
+      sparse::Model<T, I> const& model = sparse_qp->model;
+      sparse_qp->settings = settings;
+      sparse_qp->update(
+        with_init_structure(H, 0, dim, model.H_nnz, true, "H"),
+        g,
+        with_init_structure(A, dim, n_eq, model.A_nnz, false, "A"),
+        b,
+        with_init_structure(C, dim + n_eq, n_in, model.C_nnz, false, "C"),
+        u,
+        l,
+        update_preconditioner,
+        rho,
+        mu_eq,
+        mu_in);
+      settings = sparse_qp->settings;
+    }
+  }
+  /*!
+   * Updates the QP model (with sparse matrix format) of the backend chosen at
+   * initialization, and re-equilibrates it if specified by the user. Only the
+   * upper triangular part of H is used. With the sparse backend, the update of
+   * a matrix is effective only if its sparsity structure is the same as the
+   * one used for the initialization.
+   * @param H quadratic cost input defining the QP model.
+   * @param g linear cost input defining the QP model.
+   * @param A equality constraint matrix input defining the QP model.
+   * @param b equality constraint vector input defining the QP model.
+   * @param C inequality constraint matrix input defining the QP model.
+   * @param u lower inequality constraint vector input defining the QP model.
+   * @param l lower inequality constraint vector input defining the QP model.
+   * @param update_preconditioner bool parameter for updating or not the
+   * preconditioner and the associated scaled model.
+   * @param rho proximal step size wrt primal variable.
+   * @param mu_eq proximal step size wrt equality constrained multiplier.
+   * @param mu_in proximal step size wrt inequality constrained multiplier.
+   */
+  void update(std::optional<sparse::SparseMat<T, I>> H,
+              std::optional<dense::VecRef<T>> g,
+              std::optional<sparse::SparseMat<T, I>> A,
+              std::optional<dense::VecRef<T>> b,
+              std::optional<sparse::SparseMat<T, I>> C,
+              std::optional<dense::VecRef<T>> u,
+              std::optional<dense::VecRef<T>> l,
+              bool update_preconditioner = true,
+              std::optional<T> rho = std::nullopt,
+              std::optional<T> mu_eq = std::nullopt,
+              std::optional<T> mu_in = std::nullopt)
+  {
+    PROXSUITE_THROW_PRETTY(backend() == QPBackend::AUTOMATIC,
+                           std::runtime_error,
+                           "the QP object has not been initialized.");
+    if (dense_qp) {
+      std::optional<DenseMat> H_dense = to_dense(H, true);
+      std::optional<DenseMat> A_dense = to_dense(A, false);
+      std::optional<DenseMat> C_dense = to_dense(C, false);
+      dense_qp->settings = settings;
+      dense_qp->update(as_ref(H_dense),
+                       to_vec(g),
+                       as_ref(A_dense),
+                       to_vec(b),
+                       as_ref(C_dense),
+                       to_vec(u),
+                       to_vec(l),
+                       update_preconditioner,
+                       rho,
+                       mu_eq,
+                       mu_in);
+      settings = dense_qp->settings;
+    } else {
+      sparse_qp->settings = settings;
+      sparse_qp->update(
+        H, g, A, b, C, u, l, update_preconditioner, rho, mu_eq, mu_in);
+      settings = sparse_qp->settings;
+    }
+  }
+  /*!
+   * Updates the vectors of the QP model of the backend chosen at
+   * initialization, and re-equilibrates it if specified by the user.
+   * @param g linear cost input defining the QP model.
+   * @param b equality constraint vector input defining the QP model.
+   * @param u lower inequality constraint vector input defining the QP model.
+   * @param l lower inequality constraint vector input defining the QP model.
+   * @param update_preconditioner bool parameter for updating or not the
+   * preconditioner and the associated scaled model.
+   * @param rho proximal step size wrt primal variable.
+   * @param mu_eq proximal step size wrt equality constrained multiplier.
+   * @param mu_in proximal step size wrt inequality constrained multiplier.
+   */
+  void update([[maybe_unused]] const std::nullopt_t H,
+              std::optional<dense::VecRef<T>> g,
+              [[maybe_unused]] const std::nullopt_t A,
+              std::optional<dense::VecRef<T>> b,
+              [[maybe_unused]] const std::nullopt_t C,
+              std::optional<dense::VecRef<T>> u,
+              std::optional<dense::VecRef<T>> l,
+              bool update_preconditioner = true,
+              std::optional<T> rho = std::nullopt,
+              std::optional<T> mu_eq = std::nullopt,
+              std::optional<T> mu_in = std::nullopt)
+  {
+    update(std::optional<sparse::SparseMat<T, I>>(std::nullopt),
+           g,
+           std::optional<sparse::SparseMat<T, I>>(std::nullopt),
+           b,
+           std::optional<sparse::SparseMat<T, I>>(std::nullopt),
+           u,
+           l,
+           update_preconditioner,
+           rho,
+           mu_eq,
+           mu_in);
+  }
+  /*!
+   * Solves the QP problem using PROXQP algorithm with the backend chosen at
+   * initialization.
+   */
+  void solve()
+  {
+    PROXSUITE_THROW_PRETTY(backend() == QPBackend::AUTOMATIC,
+                           std::runtime_error,
+                           "the QP object has not been initialized.");
+    if (dense_qp) {
+      dense_qp->settings = settings;
+      dense_qp->solve();
+      settings = dense_qp->settings;
+    } else {
+      sparse_qp->settings = settings;
+      sparse_qp->solve();
+      settings = sparse_qp->settings;
+    }
+  }
+  /*!
+   * Solves the QP problem using PROXQP algorithm with the backend chosen at
+   * initialization, using a warm start.
+   * @param x primal warm start.
+   * @param y dual equality warm start.
+   * @param z dual inequality warm start.
+   */
+  void solve(std::optional<dense::VecRef<T>> x,
+             std::optional<dense::VecRef<T>> y,
+             std::optional<dense::VecRef<T>> z)
+  {
+    PROXSUITE_THROW_PRETTY(backend() == QPBackend::AUTOMATIC,
+                           std::runtime_error,
+                           "the QP object has not been initialized.");
+    if (dense_qp) {
+      dense_qp->settings = settings;
+      dense_qp->solve(x, y, z);
+      settings = dense_qp->settings;
+    } else {
+      sparse_qp->settings = settings;
+      sparse_qp->solve(x, y, z);
+      settings = sparse_qp->settings;
+    }
+  }
+  /*!
+   * Returns the size of the stack of the workspace of the backend, and the
+   * largest number of bytes of it used so far.
+   */
+  auto stack_usage() const -> StackUsage
+  {
+    PROXSUITE_THROW_PRETTY(backend() == QPBackend::AUTOMATIC,
+                           std::runtime_error,
+                           "the QP object has not been initialized.");
+    if (dense_qp) {
+      return dense_qp->stack_usage();
+    }
+    return sparse_qp->stack_usage();
+  }
+  /*!
+   * Clean-ups solver's results of the backend.
+   */
+  void cleanup()
+  {
+    if (dense_qp) {
+      dense_qp->cleanup();
+    } else if (sparse_qp) {
+      sparse_qp->cleanup();
+    }
+  }
+
+private:
+  using SparseMat = sparse::SparseMat<T, I>;
+  using DenseMat = Eigen::Matrix<T, dense::DYN, dense::DYN>;
+
+  isize dim;
+  isize n_eq;
+  isize n_in;
+
+  template<typename Mat>
+  auto select_backend(std::optional<Mat> const& H,
+                      std::optional<Mat> const& A,
+                      std::optional<Mat> const& C) -> QPBackend
+  {
+    dense_qp.reset();
+    sparse_qp.reset();
+    if (settings.backend != QPBackend::AUTOMATIC) {
+      return settings.backend;
+    }
+    return preferred_backend(
+      mask(H, dim, dim), mask(A, n_eq, dim), mask(C, n_in, dim));
+  }
+  static auto mask(std::optional<SparseMat> const& M, isize rows, isize cols)
+    -> sparse::SparseMat<bool, I>
+  {
+    if (M == std::nullopt) {
+      return sparse::SparseMat<bool, I>(rows, cols);
+    }
+    return M.value().template cast<bool>();
+  }
+  static auto mask(std::optional<dense::MatRef<T>> const& M,
+                   isize rows,
+                   isize cols) -> sparse::SparseMat<bool, I>
+  {
+    sparse::SparseMat<bool, I> out(rows, cols);
+    if (M == std::nullopt) {
+      return out;
+    }
+    dense::MatRef<T> mat = M.value();
+    isize nnz = 0;
+    for (isize j = 0; j < mat.cols(); ++j) {
+      for (isize i = 0; i < mat.rows(); ++i) {
+        nnz += isize(mat(i, j) != T(0));
+      }
+    }
+    out.reserve(nnz);
+    for (isize j = 0; j < mat.cols(); ++j) {
+      out.startVec(j);
+      for (isize i = 0; i < mat.rows(); ++i) {
+        if (mat(i, j) != T(0)) {
+          out.insertBack(i, j) = true;
+        }
+      }
+    }
+    out.finalize();
+    return out;
+  }
+  static auto to_sparse(std::optional<dense::MatRef<T>> M)
+    -> std::optional<SparseMat>
+  {
+    if (M == std::nullopt) {
+      return std::nullopt;
+    }
+    return SparseMat(M.value().sparseView());
+  }
+  /*!
+   * Returns the matrix M with the sparsity structure of the corresponding
+   * matrix of the sparse backend, stored transposed in the columns
+   * [first_col, first_col + ncols) of the top rows of its kkt matrix (except for
+   * the symmetric H, of which only the upper triangular part is used). Throws
+   * if one of the nonzero entries of M does not belong to this structure.
+   */
+  auto with_init_structure(std::optional<dense::MatRef<T>> M,
+                           isize first_col,
+                           isize ncols,
+                           isize nnz,
+                           bool symmetric,
+                           char const* name) const -> std::optional<SparseMat>
+  {
+    if (M == std::nullopt) {
+      return std::nullopt;
+    }
+    dense::MatRef<T> mat = M.value();
+    sparse::Model<T, I> const& model = sparse_qp->model;
+    isize rows = symmetric ? model.dim : ncols;
+    PROXSUITE_CHECK_ARGUMENT_SIZE(
+      mat.rows(),
+      rows,
+      std::string("the row dimension for updating ") + name + " is not valid.");
+    PROXSUITE_CHECK_ARGUMENT_SIZE(mat.cols(),
+                                  model.dim,
+                                  std::string("the column dimension for "
+                                              "updating ") +
+                                    name + " is not valid.");
+
+    auto kkt_top_n_rows = sparse::detail::top_rows_unchecked(
+      proxsuite::linalg::veg::unsafe, model.kkt_unscaled(), model.dim);
+    SparseMat out =
+      sparse::detail::middle_cols(kkt_top_n_rows, first_col, ncols, nnz)
+        .to_eigen();
+    isize structure_nnz = 0;
+    for (isize j = 0; j < out.outerSize(); ++j) {
+      for (typename SparseMat::InnerIterator it(out, j); it; ++it) {
+        isize i = isize(it.row());
+        it.valueRef() = symmetric ? mat(i, j) : mat(j, i);
+        structure_nnz += isize(it.value() != T(0));
+      }
+    }
+    isize mat_nnz = 0;
+    for (isize j = 0; j < mat.cols(); ++j) {
+      for (isize i = 0; i < (symmetric ? j + 1 : mat.rows()); ++i) {
+        mat_nnz += isize(mat(i, j) != T(0));
+      }
+    }
+    PROXSUITE_THROW_PRETTY(mat_nnz != structure_nnz,
+                           std::invalid_argument,
+                           std::string("the sparsity structure of ") + name +
+                             " differs from the one used for the "
+                             "initialization of the sparse backend.");
+    if (symmetric) {
+      return out;
+    }
+    return SparseMat(out.transpose());
+  }
+  static auto to_dense(std::optional<SparseMat> const& M, bool symmetric)
+    -> std::optional<DenseMat>
+  {
+    if (M == std::nullopt) {
+      return std::nullopt;
+    }
+    if (symmetric) {
+      SparseMat M_full = M.value().template selfadjointView<Eigen::Upper>();
+      return DenseMat(M_full);
+    }
+    return DenseMat(M.value());
+  }
+  static auto to_vec(std::optional<dense::VecRef<T>> v)
+    -> std::optional<dense::Vec<T>>
+  {
+    if (v == std::nullopt) {
+      return std::nullopt;
+    }
+    return dense::Vec<T>(v.value());
+  }
+  static auto as_ref(std::optional<DenseMat> const& M)
+    -> std::optional<dense::MatRef<T>>
+  {
+    if (M == std::nullopt) {
+      return std::nullopt;
+    }
+    return dense::MatRef<T>(M.value());
+  }
+};
+
+} // namespace proxqp
+} // namespace proxsuite
+
+#endif /* end of include guard PROXSUITE_QP_WRAPPER_HPP */
@@ -0,0 +1,425 @@
+//
+// Copyright (c) 2022 INRIA
+//
+#include <proxsuite/linalg/dense/ldlt.hpp>
+#include <proxsuite/linalg/dense/autotune.hpp>
+#include <proxsuite/proxqp/utils/random_qp_problems.hpp>
+#include <doctest.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace proxsuite::linalg;
+using T = double;
+using isize = veg::isize;
+using ColMat = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+using Vec = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+
+namespace {
+void
+check_ldlt(isize n)
+{
+  isize r = 3;
+  ColMat a = proxsuite::proxqp::utils::rand::positive_definite_rand<T>(n, 1e2);
+  ColMat w = proxsuite::proxqp::utils::rand::matrix_rand<T>(n, r);
+  Vec alpha = proxsuite::proxqp::utils::rand::vector_rand<T>(r).cwiseAbs();
+  Vec rhs = proxsuite::proxqp::utils::rand::vector_rand<T>(n);
+
+  dense::Ldlt<T> ldl;
+  veg::Vec<unsigned char> stack_storage;
+  stack_storage.resize_for_overwrite(
+    (dense::Ldlt<T>::factorize_req(n) |
+     dense::Ldlt<T>::rank_r_update_req(n, r) |
+     dense::Ldlt<T>::solve_in_place_req(n))
+      .alloc_req());
+  veg::dynstack::DynStackMut stack{ veg::from_slice_mut,
+                                    stack_storage.as_mut() };
+
+  ldl.factorize(a, stack);
+  CHECK((ldl.dbg_reconstructed_matrix() - a).norm() <= 1e-9 * a.norm());
+
+  ldl.rank_r_update(w, alpha, stack);
+  a += w * alpha.asDiagonal() * w.transpose();
+  CHECK((ldl.dbg_reconstructed_matrix() - a).norm() <= 1e-9 * a.norm());
+
+  Vec x = rhs;
+  ldl.solve_in_place(x, stack);
+  CHECK((a * x - rhs).norm() <= 1e-9 * rhs.norm());
+}
+} // namespace
+
+TEST_CASE("dense ldlt: factorization, rank updates and solves with every "
+          "available instruction set")
+{
+  std::cout << "---dense ldlt: factorization, rank updates and solves with "
+               "every available instruction set"
+            << std::endl;
+  proxsuite::proxqp::utils::rand::set_seed(1);
+
+  dense::SimdLevel detected = dense::simd_level();
+  for (dense::SimdLevel level : { dense::SimdLevel::SCALAR,
+                                  dense::SimdLevel::SSE2,
+                                  dense::SimdLevel::AVX2,
+                                  dense::SimdLevel::AVX512 }) {
+    dense::set_simd_level(level);
+    CHECK(dense::simd_level() <= detected);
+    for (isize n : { 1, 7, 64, 101 }) {
+      check_ldlt(n);
+    }
+  }
+  dense::set_simd_level(detected);
+  CHECK(dense::simd_level() == detected);
+}
+
+TEST_CASE("dense ldlt: deleting several rows and columns at once")
+{
+  std::cout << "---dense ldlt: deleting several rows and columns at once"
+            << std::endl;
+  proxsuite::proxqp::utils::rand::set_seed(1);
+
+  isize n = 50;
+  ColMat a = proxsuite::proxqp::utils::rand::positive_definite_rand<T>(n, 1e2);
+  isize indices[] = { 0, 3, 4, 17, 30, 49 };
+  isize r = isize(sizeof(indices) / sizeof(indices[0]));
+
+  dense::Ldlt<T> ldl;
+  veg::Vec<unsigned char> stack_storage;
+  stack_storage.resize_for_overwrite((dense::Ldlt<T>::factorize_req(n) |
+                                      dense::Ldlt<T>::delete_at_req(n, r))
+                                       .alloc_req());
+  veg::dynstack::DynStackMut stack{ veg::from_slice_mut,
+                                    stack_storage.as_mut() };
+
+  ldl.factorize(a, stack);
+  ldl.delete_at(indices, r, stack);
+
+  ColMat a_kept(n - r, n - r);
+  isize k_j = 0;
+  for (isize j = 0, j_new = 0; j < n; ++j) {
+    if (k_j < r && indices[k_j] == j) {
+      ++k_j;
+      continue;
+    }
+    isize k_i = 0;
+    for (isize i = 0, i_new = 0; i < n; ++i) {
+      if (k_i < r && indices[k_i] == i) {
+        ++k_i;
+        continue;
+      }
+      a_kept(i_new, j_new) = a(i, j);
+      ++i_new;
+    }
+    ++j_new;
+  }
+
+  CHECK(ldl.dim() == n - r);
+  CHECK((ldl.dbg_reconstructed_matrix() - a_kept).norm() <=
+        1e-9 * a_kept.norm());
+}
+
+TEST_CASE("dense ldlt: in place symmetric permutation")
+{
+  std::cout << "---dense ldlt: in place symmetric permutation" << std::endl;
+  proxsuite::proxqp::utils::rand::set_seed(1);
+
+  isize n = 41;
+  veg::Vec<unsigned char> stack_storage;
+  stack_storage.resize_for_overwrite(
+    dense::_detail::apply_permutation_tri_lower_req(n).alloc_req());
+  veg::dynstack::DynStackMut stack{ veg::from_slice_mut,
+                                    stack_storage.as_mut() };
+
+  std::vector<isize> identity(n);
+  std::vector<isize> long_cycle(n);
+  std::vector<isize> two_cycles(n);
+  for (isize k = 0; k < n; ++k) {
+    identity[k] = k;
+    long_cycle[k] = (k + 1) % n;
+    two_cycles[k] = (k % 2 == 0) ? (k + 1 < n ? k + 1 : k) : k - 1;
+  }
+  // the permutation used by factorize, sorting the diagonal
+  ColMat a = proxsuite::proxqp::utils::rand::positive_definite_rand<T>(n, 1e2);
+  std::vector<isize> sorted_diag(n);
+  std::vector<isize> sorted_diag_inv(n);
+  dense::_detail::compute_permutation(
+    sorted_diag.data(), sorted_diag_inv.data(), a.diagonal());
+
+  for (std::vector<isize> const* perm :
+       { &identity, &long_cycle, &two_cycles, &sorted_diag }) {
+    ColMat mat = proxsuite::proxqp::utils::rand::matrix_rand<T>(n, n);
+
+    // gather into a temporary matrix, as factorize used to
+    ColMat expected = mat;
+    for (isize j = 0; j < n; ++j) {
+      for (isize i = j; i < n; ++i) {
+        isize pi = (*perm)[i];
+        isize pj = (*perm)[j];
+        expected(i, j) = pi >= pj ? mat(pi, pj) : mat(pj, pi);
+      }
+    }
+
+    dense::_detail::apply_permutation_tri_lower(mat, perm->data(), stack);
+    // the strictly upper triangular part is left untouched
+    CHECK(mat == expected);
+  }
+
+  // factorize no longer needs an n×n temporary matrix
+  for (isize m : { 1000, 4000 }) {
+    CHECK(dense::Ldlt<T>::factorize_req(m).alloc_req() <
+          m * m * isize{ sizeof(T) });
+  }
+}
+
+TEST_CASE("dense ldlt: packed storage")
+{
+  std::cout << "---dense ldlt: packed storage" << std::endl;
+  proxsuite::proxqp::utils::rand::set_seed(1);
+
+  // several panels of the packed storage
+  isize n = 150;
+  isize r = 5;
+  isize pos = 60;
+  ColMat m =
+    proxsuite::proxqp::utils::rand::positive_definite_rand<T>(n + r, 1e2);
+  ColMat a(n, n);
+  a.topLeftCorner(pos, pos) = m.topLeftCorner(pos, pos);
+  a.topRightCorner(pos, n - pos) = m.topRightCorner(pos, n - pos);
+  a.bottomLeftCorner(n - pos, pos) = m.bottomLeftCorner(n - pos, pos);
+  a.bottomRightCorner(n - pos, n - pos) =
+    m.bottomRightCorner(n - pos, n - pos);
+  ColMat w = proxsuite::proxqp::utils::rand::matrix_rand<T>(n, r);
+  Vec alpha = proxsuite::proxqp::utils::rand::vector_rand<T>(r).cwiseAbs();
+
+  veg::Vec<unsigned char> stack_storage;
+  stack_storage.resize_for_overwrite(
+    (dense::Ldlt<T>::factorize_req(n + r) |
+     dense::Ldlt<T>::rank_r_update_req(n + r, r) |
+     dense::Ldlt<T>::insert_block_at_req(n, r) |
+     dense::Ldlt<T>::diagonal_update_req(n + r, r) |
+     dense::Ldlt<T>::delete_at_req(n + r, r) |
+     dense::Ldlt<T>::solve_in_place_req(n + r))
+      .alloc_req());
+  veg::dynstack::DynStackMut stack{ veg::from_slice_mut,
+                                    stack_storage.as_mut() };
+
+  dense::Ldlt<T> ldl;
+  ldl.set_packed_storage(true);
+  CHECK(ldl.is_storage_packed());
+  ldl.reserve_uninit(n / 2);
+
+  ldl.factorize(a, stack);
+  CHECK((ldl.dbg_reconstructed_matrix() - a).norm() <= 1e-9 * a.norm());
+
+  ldl.rank_r_update(w, alpha, stack);
+  a += w * alpha.asDiagonal() * w.transpose();
+  CHECK((ldl.dbg_reconstructed_matrix() - a).norm() <= 1e-9 * a.norm());
+
+  // the capacity grows while preserving the decomposition
+  ldl.insert_block_at(pos, m.middleCols(pos, r), stack);
+  {
+    ColMat expected = m;
+    ColMat wm = ColMat::Zero(n + r, r);
+    wm.topRows(pos) = w.topRows(pos);
+    wm.bottomRows(n - pos) = w.bottomRows(n - pos);
+    expected += wm * alpha.asDiagonal() * wm.transpose();
+    // the inserted block is the one given, not the updated one
+    expected.middleCols(pos, r) = m.middleCols(pos, r);
+    expected.middleRows(pos, r) = m.middleCols(pos, r).transpose();
+    m = expected;
+  }
+  CHECK((ldl.dbg_reconstructed_matrix() - m).norm() <= 1e-9 * m.norm());
+
+  isize diag_indices[] = { 3, 70, 120, 121, 150 };
+  isize diag_indices_copy[] = { 3, 70, 120, 121, 150 };
+  ldl.diagonal_update_clobber_indices(diag_indices_copy, r, alpha, stack);
+  for (isize k = 0; k < r; ++k) {
+    m(diag_indices[k], diag_indices[k]) += alpha[k];
+  }
+  CHECK((ldl.dbg_reconstructed_matrix() - m).norm() <= 1e-9 * m.norm());
+
+  // switching between the layouts preserves the decomposition
+  ldl.set_packed_storage(false);
+  CHECK(!ldl.is_storage_packed());
+  CHECK((ldl.dbg_reconstructed_matrix() - m).norm() <= 1e-9 * m.norm());
+  ldl.set_packed_storage(true);
+  CHECK((ldl.dbg_reconstructed_matrix() - m).norm() <= 1e-9 * m.norm());
+
+  isize deleted[] = { 0, 63, 64, 100, 154 };
+  ldl.delete_at(deleted, r, stack);
+  ColMat m_kept(n, n);
+  {
+    isize k_j = 0;
+    for (isize j = 0, j_new = 0; j < n + r; ++j) {
+      if (k_j < r && deleted[k_j] == j) {
+        ++k_j;
+        continue;
+      }
+      isize k_i = 0;
+      for (isize i = 0, i_new = 0; i < n + r; ++i) {
+        if (k_i < r && deleted[k_i] == i) {
+          ++k_i;
+          continue;
+        }
+        m_kept(i_new, j_new) = m(i, j);
+        ++i_new;
+      }
+      ++j_new;
+    }
+  }
+  CHECK((ldl.dbg_reconstructed_matrix() - m_kept).norm() <=
+        1e-9 * m_kept.norm());
+
+  Vec rhs = proxsuite::proxqp::utils::rand::vector_rand<T>(n);
+  Vec x = rhs;
+  ldl.solve_in_place(x, stack);
+  CHECK((m_kept * x - rhs).norm() <= 1e-9 * rhs.norm());
+}
+
+TEST_CASE("dense ldlt: block sizes and algorithm variants")
+{
+  std::cout << "---dense ldlt: block sizes and algorithm variants" << std::endl;
+  proxsuite::proxqp::utils::rand::set_seed(1);
+
+  dense::DenseTuning initial = dense::dense_tuning();
+
+  // the stack remains usable when the tuning is changed after its requirements
+  // are computed
+  isize n = 300;
+  isize r = 4;
+  ColMat a = proxsuite::proxqp::utils::rand::positive_definite_rand<T>(n, 1e2);
+  ColMat w = proxsuite::proxqp::utils::rand::matrix_rand<T>(n, r);
+  Vec alpha = proxsuite::proxqp::utils::rand::vector_rand<T>(r).cwiseAbs();
+  veg::Vec<unsigned char> stack_storage;
+  stack_storage.resize_for_overwrite((dense::Ldlt<T>::factorize_req(n) |
+                                      dense::Ldlt<T>::rank_r_update_req(n, r))
+                                       .alloc_req());
+  veg::dynstack::DynStackMut stack{ veg::from_slice_mut,
+                                    stack_storage.as_mut() };
+
+  dense::DenseTuning tuning;
+  tuning.factorize_block_size = 1000;
+  tuning.factorize_recursive_threshold = 0;
+  tuning.factorize_blocked_min_dim = 0;
+  tuning.rank_r_update_chunk = 3;
+  dense::set_dense_tuning(tuning);
+  tuning = dense::dense_tuning();
+  CHECK(tuning.factorize_block_size == 256);
+  CHECK(tuning.factorize_recursive_threshold == 2);
+
+  dense::Ldlt<T> ldl;
+  ldl.factorize(a, stack);
+  CHECK((ldl.dbg_reconstructed_matrix() - a).norm() <= 1e-9 * a.norm());
+  ldl.rank_r_update(w, alpha, stack);
+  a += w * alpha.asDiagonal() * w.transpose();
+  CHECK((ldl.dbg_reconstructed_matrix() - a).norm() <= 1e-9 * a.norm());
+
+  tuning.factorize_block_size = 7;
+  tuning.factorize_blocked_min_dim = 1000;
+  tuning.rank_r_update_chunk = 1;
+  dense::set_dense_tuning(tuning);
+  for (isize dim : { 1, 7, 64, 101 }) {
+    check_ldlt(dim);
+  }
+
+  // the measured tuning can be saved and reloaded
+  tuning = dense::autotune_dense_kernels<T>(64);
+  std::string path = "proxsuite-dense-tuning-test.txt";
+  CHECK(dense::save_dense_tuning(path, tuning));
+  dense::set_dense_tuning(initial);
+  CHECK(dense::load_dense_tuning(path));
+  dense::DenseTuning loaded = dense::dense_tuning();
+  CHECK(loaded.factorize_block_size == tuning.factorize_block_size);
+  CHECK(loaded.factorize_recursive_threshold ==
+        tuning.factorize_recursive_threshold);
+  CHECK(loaded.factorize_blocked_min_dim == tuning.factorize_blocked_min_dim);
+  CHECK(loaded.rank_r_update_chunk == tuning.rank_r_update_chunk);
+#ifndef _WIN32
+  // the cache file is read on request
+  dense::set_dense_tuning(initial);
+  setenv("PROXSUITE_DENSE_TUNING_FILE", path.c_str(), 1);
+  CHECK(dense::dense_tuning_cache_path() == path);
+  CHECK(dense::load_dense_tuning());
+  CHECK(dense::dense_tuning().rank_r_update_chunk ==
+        tuning.rank_r_update_chunk);
+  std::remove(path.c_str());
+  CHECK(!dense::load_dense_tuning());
+  unsetenv("PROXSUITE_DENSE_TUNING_FILE");
+#endif
+  std::remove(path.c_str());
+  CHECK(!dense::load_dense_tuning(path));
+
+  dense::set_dense_tuning(initial);
+}
+
+TEST_CASE("dense ldlt: storage on huge pages")
+{
+  std::cout << "---dense ldlt: storage on huge pages" << std::endl;
+  proxsuite::proxqp::utils::rand::set_seed(1);
+  using proxsuite::helpers::HugePages;
+  using proxsuite::helpers::LargeBufferPolicy;
+  LargeBufferPolicy initial = proxsuite::helpers::large_buffer_policy();
+
+  // a vector allocated with another policy is released correctly
+  veg::Vec<T, dense::_detail::SimdAlignedSystemAlloc> previous;
+  previous.resize(600000);
+
+  for (HugePages huge_pages : { HugePages::DISABLED,
+                                HugePages::TRANSPARENT,
+                                HugePages::EXPLICIT }) {
+    for (bool numa_first_touch : { false, true }) {
+      LargeBufferPolicy policy;
+      policy.huge_pages = huge_pages;
+      policy.numa_first_touch = numa_first_touch;
+      proxsuite::helpers::set_large_buffer_policy(policy);
+      bool mapped = huge_pages != HugePages::DISABLED || numa_first_touch;
+
+      // vectors growing across the huge page size (by remapping their pages
+      // when they are mapped) and copied into other ones keep their values
+      veg::Vec<T, dense::_detail::SimdAlignedSystemAlloc> values;
+      for (isize i = 0; i < 600000; ++i) {
+        values.push(T(i));
+      }
+      CHECK(values[599999] == T(599999));
+      CHECK(values[0] == T(0));
+      values.reserve_exact(1000000);
+      for (isize i = 0; i < 600000; ++i) {
+        CHECK(values[i] == T(i));
+      }
+      values.pop_several(600000 - 1000);
+      previous = values;
+      previous.reserve_exact(600000);
+      for (isize i = 0; i < 1000; ++i) {
+        CHECK(previous[i] == T(i));
+      }
+
+      for (isize n : { 101, 600 }) {
+        check_ldlt(n);
+      }
+
+      // the storage of a large factor starts on a huge page when it is
+      // mapped
+      isize n = 600;
+      ColMat a =
+        proxsuite::proxqp::utils::rand::positive_definite_rand<T>(n, 1e2);
+      veg::Vec<unsigned char> stack_storage;
+      stack_storage.resize_for_overwrite(
+        dense::Ldlt<T>::factorize_req(n).alloc_req());
+      veg::dynstack::DynStackMut stack{ veg::from_slice_mut,
+                                        stack_storage.as_mut() };
+      dense::Ldlt<T> ldl;
+      ldl.factorize(a, stack);
+      CHECK((ldl.dbg_reconstructed_matrix() - a).norm() <= 1e-9 * a.norm());
+#ifndef _WIN32
+      if (mapped) {
+        CHECK(reinterpret_cast<std::uintptr_t>(ldl.ld_col().data()) %
+                proxsuite::helpers::huge_page_size ==
+              0);
+      }
+#else
+      (void)mapped;
+#endif
+    }
+  }
+  proxsuite::helpers::set_large_buffer_policy(initial);
+}
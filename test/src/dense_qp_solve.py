@@ -362,6 +362,59 @@ class DenseQpWrapper(unittest.TestCase):
             )
         )
 
+    def test_solve_batch(self):
+        print("------------------------test solve of a batch of problems")
+
+        n = 30
+        problems = [generate_mixed_qp(n, seed) for seed in range(6)]
+        H, g, A, b, C, u, l = (
+            np.stack([p.toarray() if spa.issparse(p) else p for p in inputs])
+            for inputs in zip(*problems)
+        )
+
+        results = proxsuite.proxqp.dense.solve_batch(
+            H, g, A, b, C, u, l, eps_abs=1.0e-9, eps_rel=0
+        )
+        assert results["x"].shape == (len(problems), n)
+        assert results["y"].shape == (len(problems), A.shape[1])
+        assert results["z"].shape == (len(problems), C.shape[1])
+        for i in range(len(problems)):
+            expected = proxsuite.proxqp.dense.solve(
+                H[i], g[i], A[i], b[i], C[i], u[i], l[i], eps_abs=1.0e-9, eps_rel=0
+            )
+            assert results["status"][i].name == "PROXQP_SOLVED"
+            assert normInf(results["x"][i] - expected.x) <= 1e-8
+            assert normInf(results["y"][i] - expected.y) <= 1e-8
+            assert normInf(results["z"][i] - expected.z) <= 1e-8
+
+        # the stacked inputs must have consistent shapes
+        with self.assertRaises(ValueError):
+            proxsuite.proxqp.dense.solve_batch(H, g[:, 1:], A, b, C, u, l)
+
+    def test_solve_float32(self):
+        print("------------------------test solve in single precision")
+
+        n = 30
+        H, g, A, b, C, u, l = generate_mixed_qp(n)
+        H, A, C = H.toarray(), A.toarray(), C.toarray()
+        inputs = [v.astype(np.float32) for v in (H, g, A, b, C, u, l)]
+
+        results = proxsuite.proxqp.dense.solve_float32(*inputs, eps_abs=1.0e-4)
+        assert results.info.status.name == "PROXQP_SOLVED"
+        assert results.x.dtype == np.float32
+        assert results.y.dtype == np.float32
+        assert results.z.dtype == np.float32
+        expected = proxsuite.proxqp.dense.solve(
+            H, g, A, b, C, u, l, eps_abs=1.0e-9, eps_rel=0
+        )
+        assert normInf(results.x - expected.x) <= 1e-2
+
+        results = proxsuite.proxqp.dense.solve_batch_float32(
+            *(np.stack([v, v]) for v in inputs), eps_abs=1.0e-4
+        )
+        assert results["x"].dtype == np.float32
+        assert normInf(results["x"][1] - expected.x) <= 1e-2
+
 
 if __name__ == "__main__":
     unittest.main()
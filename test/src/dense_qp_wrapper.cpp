@@ -6663,4 +6663,504 @@ DOCTEST_TEST_CASE("sparse random strongly convex qp with equality and "
     DOCTEST_CHECK(pri_res <= eps_abs);
     DOCTEST_CHECK(dua_res <= eps_abs);
   }
-}
\ No newline at end of file
+}
+DOCTEST_TEST_CASE("sparse random strongly convex qp with equality and "
+                  "inequality constraints: test incremental update of the "
+                  "preconditioner")
+{
+  std::cout << "---testing sparse random strongly convex qp with equality and "
+               "inequality constraints: test incremental update of the "
+               "preconditioner---"
+            << std::endl;
+  double sparsity_factor = 0.15;
+  T eps_abs = T(1e-9);
+  utils::rand::set_seed(1);
+  dense::isize dim = 50;
+
+  dense::isize n_eq(dim / 4);
+  dense::isize n_in(dim / 4);
+  T strong_convexity_factor(1.e-2);
+  proxqp::dense::Model<T> qp_random = proxqp::utils::dense_strongly_convex_qp(
+    dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  dense::QP<T> qp{ dim, n_eq, n_in }; // creating QP object
+  qp.settings.eps_abs = eps_abs;
+  qp.settings.eps_rel = 0;
+  qp.settings.incremental_preconditioner = true;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  qp.solve();
+  Eigen::Matrix<T, Eigen::Dynamic, 1> delta_old = qp.ruiz.delta;
+
+  // only the first inequality rows change, by a large factor
+  qp_random.C.topRows(3) *= T(100);
+  qp_random.u.head(3) *= T(100);
+  qp_random.l.head(3) *= T(100);
+  qp.update(std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            qp_random.C,
+            qp_random.u,
+            qp_random.l);
+  qp.solve();
+
+  // the scaling of the rows which changed is refined
+  for (isize i = 0; i < 3; ++i) {
+    DOCTEST_CHECK(qp.ruiz.delta(dim + n_eq + i) < delta_old(dim + n_eq + i));
+  }
+
+  T pri_res = std::max(
+    (qp_random.A * qp.results.x - qp_random.b).lpNorm<Eigen::Infinity>(),
+    (dense::positive_part(qp_random.C * qp.results.x - qp_random.u) +
+     dense::negative_part(qp_random.C * qp.results.x - qp_random.l))
+      .lpNorm<Eigen::Infinity>());
+  T dua_res = (qp_random.H * qp.results.x + qp_random.g +
+               qp_random.A.transpose() * qp.results.y +
+               qp_random.C.transpose() * qp.results.z)
+                .lpNorm<Eigen::Infinity>();
+  DOCTEST_CHECK(pri_res <= eps_abs);
+  DOCTEST_CHECK(dua_res <= eps_abs);
+  std::cout << "--n = " << dim << " n_eq " << n_eq << " n_in " << n_in
+            << std::endl;
+  std::cout << "; dual residual " << dua_res << "; primal residual " << pri_res
+            << std::endl;
+  std::cout << "total number of iteration: " << qp.results.info.iter
+            << std::endl;
+}
+DOCTEST_TEST_CASE("sparse random strongly convex qp with equality and "
+                  "inequality constraints: test packed storage of the ldlt "
+                  "factor")
+{
+  std::cout << "---testing sparse random strongly convex qp with equality and "
+               "inequality constraints: test packed storage of the ldlt "
+               "factor---"
+            << std::endl;
+  double sparsity_factor = 0.15;
+  T eps_abs = T(1e-9);
+  utils::rand::set_seed(1);
+  dense::isize dim = 100;
+
+  dense::isize n_eq(dim / 4);
+  dense::isize n_in(dim / 4);
+  T strong_convexity_factor(1.e-2);
+  proxqp::dense::Model<T> qp_random = proxqp::utils::dense_strongly_convex_qp(
+    dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  dense::QP<T> qp{ dim, n_eq, n_in }; // creating QP object
+  qp.settings.eps_abs = eps_abs;
+  qp.settings.eps_rel = 0;
+  qp.settings.dense_packed_ldlt = true;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  // the layout is chosen at setup, before the storage of the factor is
+  // reserved
+  DOCTEST_CHECK(qp.work.ldl.is_storage_packed());
+  qp.solve();
+  DOCTEST_CHECK(qp.work.ldl.is_storage_packed());
+
+  T pri_res = std::max(
+    (qp_random.A * qp.results.x - qp_random.b).lpNorm<Eigen::Infinity>(),
+    (dense::positive_part(qp_random.C * qp.results.x - qp_random.u) +
+     dense::negative_part(qp_random.C * qp.results.x - qp_random.l))
+      .lpNorm<Eigen::Infinity>());
+  T dua_res = (qp_random.H * qp.results.x + qp_random.g +
+               qp_random.A.transpose() * qp.results.y +
+               qp_random.C.transpose() * qp.results.z)
+                .lpNorm<Eigen::Infinity>();
+  DOCTEST_CHECK(pri_res <= eps_abs);
+  DOCTEST_CHECK(dua_res <= eps_abs);
+  std::cout << "--n = " << dim << " n_eq " << n_eq << " n_in " << n_in
+            << std::endl;
+  std::cout << "; dual residual " << dua_res << "; primal residual " << pri_res
+            << std::endl;
+  std::cout << "total number of iteration: " << qp.results.info.iter
+            << std::endl;
+}
+DOCTEST_TEST_CASE("sparse random strongly convex qp with equality and "
+                  "inequality constraints: test trimming of the workspace "
+                  "stack")
+{
+  std::cout << "---testing sparse random strongly convex qp with equality and "
+               "inequality constraints: test trimming of the workspace "
+               "stack---"
+            << std::endl;
+  double sparsity_factor = 0.15;
+  T eps_abs = T(1e-9);
+  utils::rand::set_seed(1);
+  dense::isize dim = 50;
+
+  dense::isize n_eq(dim / 4);
+  dense::isize n_in(dim / 4);
+  T strong_convexity_factor(1.e-2);
+  proxqp::dense::Model<T> qp_random = proxqp::utils::dense_strongly_convex_qp(
+    dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  dense::QP<T> qp{ dim, n_eq, n_in }; // creating QP object
+  qp.settings.eps_abs = eps_abs;
+  qp.settings.eps_rel = 0;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  qp.solve();
+
+  StackUsage usage = qp.stack_usage();
+  DOCTEST_CHECK(usage.used_bytes > 0);
+  DOCTEST_CHECK(usage.used_bytes <= usage.requested_bytes);
+  DOCTEST_CHECK(
+    qp.work.ldl_stack_usage(dense::StackSite::FACTORIZATION).used_bytes > 0);
+  DOCTEST_CHECK(
+    qp.work.ldl_stack_usage(dense::StackSite::LINEAR_SOLVE).used_bytes > 0);
+
+  qp.trim_stack();
+  DOCTEST_CHECK(qp.stack_usage().requested_bytes < usage.requested_bytes);
+
+  // the trimmed stack grows back if more constraints become active
+  qp_random.u.setConstant(T(-1));
+  qp_random.l.setConstant(T(-1e20));
+  qp.update(std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            qp_random.u,
+            qp_random.l);
+  qp.solve();
+
+  T pri_res = std::max(
+    (qp_random.A * qp.results.x - qp_random.b).lpNorm<Eigen::Infinity>(),
+    (dense::positive_part(qp_random.C * qp.results.x - qp_random.u) +
+     dense::negative_part(qp_random.C * qp.results.x - qp_random.l))
+      .lpNorm<Eigen::Infinity>());
+  T dua_res = (qp_random.H * qp.results.x + qp_random.g +
+               qp_random.A.transpose() * qp.results.y +
+               qp_random.C.transpose() * qp.results.z)
+                .lpNorm<Eigen::Infinity>();
+  DOCTEST_CHECK(pri_res <= eps_abs);
+  DOCTEST_CHECK(dua_res <= eps_abs);
+  DOCTEST_CHECK(qp.stack_usage().used_bytes <=
+                qp.stack_usage().requested_bytes);
+  std::cout << "--n = " << dim << " n_eq " << n_eq << " n_in " << n_in
+            << std::endl;
+  std::cout << "; requested bytes " << usage.requested_bytes
+            << "; used bytes " << usage.used_bytes << std::endl;
+  std::cout << "total number of iteration: " << qp.results.info.iter
+            << std::endl;
+}
+
+DOCTEST_TEST_CASE("sparse random strongly convex qp with equality and "
+                  "inequality constraints: test refactorization with a trimmed "
+                  "workspace stack")
+{
+  std::cout << "---testing sparse random strongly convex qp with equality and "
+               "inequality constraints: test refactorization with a trimmed "
+               "workspace stack---"
+            << std::endl;
+  double sparsity_factor = 0.15;
+  T eps_abs = T(1e-9);
+  utils::rand::set_seed(1);
+  dense::isize dim = 50;
+
+  dense::isize n_eq(dim / 4);
+  dense::isize n_in(dim / 2);
+  T strong_convexity_factor(1.e-2);
+  proxqp::dense::Model<T> qp_random = proxqp::utils::dense_strongly_convex_qp(
+    dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+  qp_random.u.setConstant(T(-1));
+  qp_random.l.setConstant(T(-1e20));
+
+  dense::QP<T> qp{ dim, n_eq, n_in }; // creating QP object
+  qp.settings.eps_abs = eps_abs;
+  qp.settings.eps_rel = 0;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  qp.solve();
+  DOCTEST_CHECK(qp.work.n_c > 0);
+
+  qp.trim_stack();
+  dense::isize requested_bytes = qp.stack_usage().requested_bytes;
+
+  // a zero accuracy forces the refactorization fallback of the linear solve,
+  // which needs more memory than was measured before trimming the stack
+  dense::isize inner_pb_dim = dim + n_eq + qp.work.n_c;
+  qp.work.rhs.head(inner_pb_dim).setRandom();
+  qp.settings.eps_refact = T(0);
+  qp.work.constraints_changed = true;
+  dense::iterative_solve_with_permut_fact(
+    qp.settings, qp.model, qp.results, qp.work, T(0), inner_pb_dim);
+
+  DOCTEST_CHECK(qp.stack_usage().requested_bytes > requested_bytes);
+  DOCTEST_CHECK(dense::infty_norm(qp.work.err.head(inner_pb_dim)) <= eps_abs);
+  std::cout << "--n = " << dim << " n_eq " << n_eq << " n_in " << n_in
+            << std::endl;
+  std::cout << "; requested bytes before the refactorization "
+            << requested_bytes << "; after it "
+            << qp.stack_usage().requested_bytes << std::endl;
+}
+
+DOCTEST_TEST_CASE("sparse random strongly convex qp with equality and "
+                  "inequality constraints: test batch of problems")
+{
+  std::cout << "---testing sparse random strongly convex qp with equality and "
+               "inequality constraints: test batch of problems---"
+            << std::endl;
+  double sparsity_factor = 0.15;
+  T eps_abs = T(1e-9);
+  utils::rand::set_seed(1);
+  dense::isize dim = 20;
+  dense::isize n_eq(dim / 4);
+  dense::isize n_in(dim / 4);
+  dense::isize batch_size = 6;
+  T strong_convexity_factor(1.e-2);
+
+  dense::BatchQP<T> batch(batch_size, dim, n_eq, n_in);
+  DOCTEST_CHECK(batch.size() == batch_size);
+  std::vector<proxqp::dense::Model<T>> models;
+  for (dense::isize i = 0; i < batch_size; ++i) {
+    models.push_back(proxqp::utils::dense_strongly_convex_qp(
+      dim, n_eq, n_in, sparsity_factor, strong_convexity_factor));
+  }
+
+  // the members are initialized and solved in parallel
+  batch.for_each([&](dense::isize i, dense::QP<T>& qp) {
+    auto const& model = models[std::size_t(i)];
+    qp.settings.eps_abs = eps_abs;
+    qp.settings.eps_rel = 0;
+    qp.init(model.H, model.g, model.A, model.b, model.C, model.u, model.l);
+  });
+  batch.solve();
+
+  for (dense::isize i = 0; i < batch_size; ++i) {
+    auto const& qp = batch[i];
+    auto const& model = models[std::size_t(i)];
+    T pri_res = std::max(
+      (model.A * qp.results.x - model.b).lpNorm<Eigen::Infinity>(),
+      (dense::positive_part(model.C * qp.results.x - model.u) +
+       dense::negative_part(model.C * qp.results.x - model.l))
+        .lpNorm<Eigen::Infinity>());
+    T dua_res = (model.H * qp.results.x + model.g +
+                 model.A.transpose() * qp.results.y +
+                 model.C.transpose() * qp.results.z)
+                  .lpNorm<Eigen::Infinity>();
+    DOCTEST_CHECK(pri_res <= eps_abs);
+    DOCTEST_CHECK(dua_res <= eps_abs);
+    std::cout << "total number of iteration: " << qp.results.info.iter
+              << std::endl;
+  }
+
+  // an error on some members is reported once the batch is processed
+  dense::isize n_called = 0;
+  DOCTEST_CHECK_THROWS_AS(
+    batch.for_each(
+      [&](dense::isize i, dense::QP<T>& /*qp*/) {
+        ++n_called;
+        if (i % 2 == 1) {
+          throw std::runtime_error("failed member");
+        }
+      },
+      1),
+    std::runtime_error);
+  DOCTEST_CHECK(n_called == batch_size);
+}
+
+DOCTEST_TEST_CASE("sparse random strongly convex qp with equality and "
+                  "inequality constraints: test init and update with row "
+                  "major matrices")
+{
+  std::cout << "---testing sparse random strongly convex qp with equality and "
+               "inequality constraints: test init and update with row major "
+               "matrices---"
+            << std::endl;
+  double sparsity_factor = 0.15;
+  T eps_abs = T(1e-9);
+  utils::rand::set_seed(1);
+  dense::isize dim = 20;
+  dense::isize n_eq(dim / 4);
+  dense::isize n_in(dim / 4);
+  T strong_convexity_factor(1.e-2);
+  proxqp::dense::Model<T> qp_random = proxqp::utils::dense_strongly_convex_qp(
+    dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+  using OptionalRowMatRef = std::optional<dense::RowMatRef<T>>;
+
+  // the row major matrices are copied without conversion, with the same
+  // results as the column major ones
+  dense::QP<T> qp(dim, n_eq, n_in);
+  qp.settings.eps_abs = eps_abs;
+  qp.settings.eps_rel = 0;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  qp.solve();
+
+  dense::QP<T> qp_row_major(dim, n_eq, n_in);
+  qp_row_major.settings.eps_abs = eps_abs;
+  qp_row_major.settings.eps_rel = 0;
+  qp_row_major.init(OptionalRowMatRef(qp_random.H),
+                    qp_random.g,
+                    OptionalRowMatRef(qp_random.A),
+                    qp_random.b,
+                    OptionalRowMatRef(qp_random.C),
+                    qp_random.u,
+                    qp_random.l);
+  qp_row_major.solve();
+  DOCTEST_CHECK(qp_row_major.model.H == qp_random.H);
+  DOCTEST_CHECK(qp_row_major.model.A == qp_random.A);
+  DOCTEST_CHECK(qp_row_major.model.C == qp_random.C);
+  DOCTEST_CHECK(qp_row_major.results.x == qp.results.x);
+  DOCTEST_CHECK(qp_row_major.results.y == qp.results.y);
+  DOCTEST_CHECK(qp_row_major.results.z == qp.results.z);
+
+  // same for the updates
+  qp_random.H *= T(2);
+  qp_random.A *= T(2);
+  qp.update(qp_random.H,
+            std::nullopt,
+            qp_random.A,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt);
+  qp.solve();
+  qp_row_major.update(OptionalRowMatRef(qp_random.H),
+                      std::nullopt,
+                      OptionalRowMatRef(qp_random.A),
+                      std::nullopt,
+                      OptionalRowMatRef(std::nullopt),
+                      std::nullopt,
+                      std::nullopt);
+  qp_row_major.solve();
+  DOCTEST_CHECK(qp_row_major.model.H == qp_random.H);
+  DOCTEST_CHECK(qp_row_major.model.A == qp_random.A);
+  DOCTEST_CHECK(qp_row_major.results.x == qp.results.x);
+  DOCTEST_CHECK(qp_row_major.results.y == qp.results.y);
+  DOCTEST_CHECK(qp_row_major.results.z == qp.results.z);
+}
+DOCTEST_TEST_CASE("sparse random strongly convex qp with equality and "
+                  "inequality constraints: test serialization")
+{
+  std::cout << "---testing sparse random strongly convex qp with equality and "
+               "inequality constraints: test serialization---"
+            << std::endl;
+  double sparsity_factor = 0.15;
+  T eps_abs = T(1e-9);
+  utils::rand::set_seed(1);
+  dense::isize dim = 20;
+  dense::isize n_eq(dim / 4);
+  dense::isize n_in(dim / 4);
+  T strong_convexity_factor(1.e-2);
+  proxqp::dense::Model<T> qp_random = proxqp::utils::dense_strongly_convex_qp(
+    dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  dense::QP<T> qp(dim, n_eq, n_in);
+  qp.settings.eps_abs = eps_abs;
+  qp.settings.eps_rel = 0;
+  qp.settings.initial_guess =
+    InitialGuessStatus::WARM_START_WITH_PREVIOUS_RESULT;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  qp.solve();
+
+  std::vector<unsigned char> buffer = dense::serialize(qp);
+  DOCTEST_CHECK(buffer.size() == dense::serialized_size(qp));
+  dense::QP<T> qp2 = dense::deserialize<T>(buffer.data(), buffer.size());
+
+  // the settings, model, preconditioner and results are restored, without
+  // equilibrating the model again
+  DOCTEST_CHECK(qp2.settings.eps_abs == eps_abs);
+  DOCTEST_CHECK(qp2.settings.initial_guess ==
+                InitialGuessStatus::WARM_START_WITH_PREVIOUS_RESULT);
+  DOCTEST_CHECK(qp2.model.H == qp.model.H);
+  DOCTEST_CHECK(qp2.model.A == qp.model.A);
+  DOCTEST_CHECK(qp2.model.C == qp.model.C);
+  DOCTEST_CHECK(qp2.model.l == qp.model.l);
+  DOCTEST_CHECK(qp2.ruiz.delta == qp.ruiz.delta);
+  DOCTEST_CHECK(qp2.ruiz.c == qp.ruiz.c);
+  DOCTEST_CHECK(qp2.work.H_scaled.isApprox(qp.work.H_scaled));
+  DOCTEST_CHECK(qp2.results.x == qp.results.x);
+  DOCTEST_CHECK(qp2.results.z == qp.results.z);
+  DOCTEST_CHECK(qp2.results.info.iter == qp.results.info.iter);
+  DOCTEST_CHECK(qp2.results.info.status == qp.results.info.status);
+
+  // the restored object is warm started from the serialized results
+  qp2.solve();
+  DOCTEST_CHECK(qp2.results.x.isApprox(qp.results.x, T(1e-6)));
+  T pri_res = std::max(
+    (qp_random.A * qp2.results.x - qp_random.b).lpNorm<Eigen::Infinity>(),
+    (dense::positive_part(qp_random.C * qp2.results.x - qp_random.u) +
+     dense::negative_part(qp_random.C * qp2.results.x - qp_random.l))
+      .lpNorm<Eigen::Infinity>());
+  T dua_res = (qp_random.H * qp2.results.x + qp_random.g +
+               qp_random.A.transpose() * qp2.results.y +
+               qp_random.C.transpose() * qp2.results.z)
+                .lpNorm<Eigen::Infinity>();
+  DOCTEST_CHECK(pri_res <= eps_abs);
+  DOCTEST_CHECK(dua_res <= eps_abs);
+
+  // invalid buffers are rejected
+  DOCTEST_CHECK_THROWS_AS(
+    dense::deserialize<T>(buffer.data(), buffer.size() - 1),
+    std::invalid_argument);
+  DOCTEST_CHECK_THROWS_AS(dense::deserialize<float>(buffer.data(),
+                                                    buffer.size()),
+                          std::invalid_argument);
+  // the dimensions are checked against the size of the buffer before
+  // allocating the QP object
+  std::vector<unsigned char> corrupted = buffer;
+  std::int64_t huge_dim = std::int64_t(1) << 40;
+  std::memcpy(corrupted.data() + 32, &huge_dim, sizeof(huge_dim));
+  DOCTEST_CHECK_THROWS_AS(
+    dense::deserialize<T>(corrupted.data(), corrupted.size()),
+    std::invalid_argument);
+  // so are the values out of the range of their enumeration
+  proxqp::serialization::Writer offset;
+  proxqp::serialization::header(offset, QPBackend::DENSE, sizeof(T), 0);
+  offset(qp.model.dim);
+  offset(qp.model.n_eq);
+  offset(qp.model.n_in);
+  bool found = false;
+  proxqp::serialization::visit_settings(qp.settings, [&](auto const& field) {
+    using Field = std::decay_t<decltype(field)>;
+    found = found || std::is_same<Field, InitialGuessStatus>::value;
+    if (!found) {
+      offset(field);
+    }
+  });
+  corrupted = buffer;
+  std::int32_t invalid_guess = 5;
+  std::memcpy(
+    corrupted.data() + offset.size, &invalid_guess, sizeof(invalid_guess));
+  DOCTEST_CHECK_THROWS_AS(
+    dense::deserialize<T>(corrupted.data(), corrupted.size()),
+    std::invalid_argument);
+  buffer[0] = 0;
+  DOCTEST_CHECK_THROWS_AS(dense::deserialize<T>(buffer.data(), buffer.size()),
+                          std::invalid_argument);
+}
@@ -4502,6 +4502,173 @@ class DenseqpWrapper(unittest.TestCase):
             )
         )
 
+    def test_concurrent_solves(self):
+        print("------------------------test solves from several threads")
+        from concurrent.futures import ThreadPoolExecutor
+
+        n = 50
+        problems = [generate_mixed_qp(n, seed) for seed in range(8)]
+
+        def solve(problem):
+            H, g, A, b, C, u, l = problem
+            qp = proxsuite.proxqp.dense.QP(n, A.shape[0], C.shape[0])
+            qp.settings.eps_abs = 1.0e-9
+            qp.init(H, g, A, b, C, u, l)
+            qp.solve()
+            return qp.results.x
+
+        expected = [solve(problem) for problem in problems]
+        # the GIL is released while solving, the QP objects being independent
+        with ThreadPoolExecutor(max_workers=4) as executor:
+            results = list(executor.map(solve, problems))
+        for x, x_expected in zip(results, expected):
+            assert normInf(x - x_expected) <= 1e-12
+
+        # same for the solve function
+        def solve_function(problem):
+            H, g, A, b, C, u, l = problem
+            return proxsuite.proxqp.dense.solve(
+                H, g, A, b, C, u, l, eps_abs=1.0e-9
+            ).x
+
+        with ThreadPoolExecutor(max_workers=4) as executor:
+            results = list(executor.map(solve_function, problems))
+        for x, x_expected in zip(results, expected):
+            assert normInf(x - x_expected) <= 1e-12
+
+    def test_results_views_and_row_major_inputs(self):
+        print("------------------------test results views and row major inputs")
+        n = 50
+        H, g, A, b, C, u, l = generate_mixed_qp(n)
+        H, A, C = H.toarray(), A.toarray(), C.toarray()
+        n_eq, n_in = A.shape[0], C.shape[0]
+
+        # C ordered matrices are copied into the model without conversion, with
+        # the same results as Fortran ordered ones
+        qp = proxsuite.proxqp.dense.QP(n, n_eq, n_in)
+        qp.settings.eps_abs = 1.0e-9
+        qp.init(
+            np.ascontiguousarray(H),
+            g,
+            np.ascontiguousarray(A),
+            b,
+            np.ascontiguousarray(C),
+            u,
+            l,
+        )
+        qp.solve()
+        qp_fortran = proxsuite.proxqp.dense.QP(n, n_eq, n_in)
+        qp_fortran.settings.eps_abs = 1.0e-9
+        qp_fortran.init(
+            np.asfortranarray(H),
+            g,
+            np.asfortranarray(A),
+            b,
+            np.asfortranarray(C),
+            u,
+            l,
+        )
+        qp_fortran.solve()
+        assert np.array_equal(qp.model.A, A)
+        assert np.array_equal(qp.results.x, qp_fortran.results.x)
+        assert np.array_equal(qp.results.z, qp_fortran.results.z)
+
+        # the results are views of the buffers of the solver, updated in place
+        x = qp.results.x
+        assert not x.flags.owndata
+        assert np.shares_memory(x, qp.results.x)
+        x_first = x.copy()
+        qp.update(g=-g)
+        qp.solve()
+        assert np.array_equal(x, qp.results.x)
+        assert not np.array_equal(x, x_first)
+        qp.results.x = x_first
+        assert np.array_equal(x, x_first)
+        with self.assertRaises(ValueError):
+            qp.results.x = np.zeros(n + 1)
+
+        # the results and the model are assigned in place as well
+        qp.results = qp_fortran.results
+        assert np.array_equal(x, qp_fortran.results.x)
+        qp.model = qp_fortran.model
+        with self.assertRaises(ValueError):
+            qp.results = proxsuite.proxqp.dense.QP(n + 1, n_eq, n_in).results
+        with self.assertRaises(ValueError):
+            qp.model = proxsuite.proxqp.dense.QP(n + 1, n_eq, n_in).model
+
+    def test_serialization_and_shared_memory(self):
+        print("------------------------test serialization and shared memory")
+        import pickle
+
+        n = 50
+        H, g, A, b, C, u, l = generate_mixed_qp(n)
+        n_eq, n_in = A.shape[0], C.shape[0]
+        qp = proxsuite.proxqp.dense.QP(n, n_eq, n_in)
+        qp.settings.eps_abs = 1.0e-9
+        qp.settings.initial_guess = (
+            proxsuite.proxqp.InitialGuess.WARM_START_WITH_PREVIOUS_RESULT
+        )
+        qp.init(H, g, A, b, C, u, l)
+        qp.solve()
+
+        def check(qp2):
+            # the settings, model, preconditioner and results are restored
+            assert qp2.settings.eps_abs == 1.0e-9
+            assert np.array_equal(qp2.model.H, qp.model.H)
+            assert np.array_equal(qp2.model.l, qp.model.l)
+            assert np.array_equal(qp2.results.x, qp.results.x)
+            assert qp2.results.info.status == qp.results.info.status
+            qp2.solve()
+            assert normInf(qp2.results.x - qp.results.x) <= 1e-6
+
+        check(pickle.loads(pickle.dumps(qp)))
+        data = qp.serialize()
+        assert len(data) == qp.serialized_size()
+        check(proxsuite.proxqp.dense.QP.deserialize(data))
+        buffer = bytearray(qp.serialized_size())
+        assert qp.serialize_into(buffer) == len(buffer)
+        check(proxsuite.proxqp.dense.QP.deserialize(memoryview(buffer)))
+        with self.assertRaises(ValueError):
+            proxsuite.proxqp.dense.QP.deserialize(data[:-1])
+        with self.assertRaises(ValueError):
+            qp.serialize_into(bytearray(10))
+
+        # the workers of a pool can attach to the segment by its name
+        shm = qp.to_shared_memory()
+        try:
+            check(proxsuite.proxqp.dense.QP.from_shared_memory(shm))
+            check(proxsuite.proxqp.dense.QP.from_shared_memory(shm.name))
+        finally:
+            shm.close()
+            shm.unlink()
+
+    def test_float32_qp_object(self):
+        print("------------------------test QP object in single precision")
+
+        n = 50
+        H, g, A, b, C, u, l = generate_mixed_qp(n)
+        H, A, C = H.toarray(), A.toarray(), C.toarray()
+        n_eq, n_in = A.shape[0], C.shape[0]
+        qp = proxsuite.proxqp.dense.QP_float32(n, n_eq, n_in)
+        assert isinstance(qp.settings, proxsuite.proxqp.Settings_float32)
+        qp.settings.eps_abs = 1.0e-4
+        qp.init(*(v.astype(np.float32) for v in (H, g, A, b, C, u, l)))
+        qp.solve()
+        assert qp.results.info.status.name == "PROXQP_SOLVED"
+        assert qp.results.x.dtype == np.float32
+        assert qp.model.H.dtype == np.float32
+
+        x = qp.results.x.astype(np.float64)
+        dua_res = normInf(
+            H @ x
+            + g
+            + A.transpose() @ qp.results.y.astype(np.float64)
+            + C.transpose() @ qp.results.z.astype(np.float64)
+        )
+        pri_res = max(normInf(A @ x - b), normInf(np.maximum(C @ x - u, 0)))
+        assert dua_res <= 1e-3
+        assert pri_res <= 1e-3
+
 
 if __name__ == "__main__":
     unittest.main()
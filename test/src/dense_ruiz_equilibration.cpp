@@ -65,3 +65,93 @@ DOCTEST_TEST_CASE("ruiz preconditioner")
   DOCTEST_CHECK((A_new - qp.work.A_scaled).norm() <= Scalar(1e-10));
   DOCTEST_CHECK((b_new - qp.work.b_scaled).norm() <= Scalar(1e-10));
 }
+
+DOCTEST_TEST_CASE("ruiz preconditioner: full cost matrix with inequalities")
+{
+  int dim = 50;
+  int n_eq = 10;
+  int n_in = 20;
+
+  Scalar sparsity_factor(0.15);
+  Scalar strong_convexity_factor(0.01);
+  proxqp::dense::Model<Scalar> qp_random =
+    proxqp::utils::dense_strongly_convex_qp(
+      dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  proxqp::dense::QP<Scalar> qp{ dim, n_eq, n_in }; // creating QP object
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+
+  auto head = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>(
+    qp.ruiz.delta.head(dim).asDiagonal());
+  auto tail_eq = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>(
+    qp.ruiz.delta.segment(dim, n_eq).asDiagonal());
+  auto tail_in = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>(
+    qp.ruiz.delta.tail(n_in).asDiagonal());
+  auto c = qp.ruiz.c;
+
+  auto H_new = (c * head * qp_random.H * head).eval();
+  auto g_new = (c * head * qp_random.g).eval();
+  auto A_new = (tail_eq * qp_random.A * head).eval();
+  auto b_new = (tail_eq * qp_random.b).eval();
+  auto C_new = (tail_in * qp_random.C * head).eval();
+  auto u_new = (tail_in * qp_random.u).eval();
+
+  DOCTEST_CHECK((H_new - qp.work.H_scaled).norm() <= Scalar(1e-10));
+  DOCTEST_CHECK((g_new - qp.work.g_scaled).norm() <= Scalar(1e-10));
+  DOCTEST_CHECK((A_new - qp.work.A_scaled).norm() <= Scalar(1e-10));
+  DOCTEST_CHECK((b_new - qp.work.b_scaled).norm() <= Scalar(1e-10));
+  DOCTEST_CHECK((C_new - qp.work.C_scaled).norm() <= Scalar(1e-10));
+  DOCTEST_CHECK((u_new - qp.work.u_scaled).norm() <= Scalar(1e-10));
+
+  // the equilibrated rows and columns have an infinity norm close to one
+  Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> kkt(dim + n_eq + n_in,
+                                                            dim);
+  kkt << qp.work.H_scaled / c, qp.work.A_scaled, qp.work.C_scaled;
+  DOCTEST_CHECK(
+    (kkt.colwise().template lpNorm<Eigen::Infinity>().array() - 1)
+      .abs()
+      .maxCoeff() <= Scalar(0.5));
+}
+
+DOCTEST_TEST_CASE("ruiz preconditioner: parallel sweeps")
+{
+  int dim = 300;
+  int n_eq = 60;
+  int n_in = 120;
+
+  Scalar sparsity_factor(0.15);
+  Scalar strong_convexity_factor(0.01);
+  proxqp::dense::Model<Scalar> qp_random =
+    proxqp::utils::dense_strongly_convex_qp(
+      dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  // the norms are reduced with max, so the scaling does not depend on the
+  // number of threads
+  int initial = proxsuite::helpers::get_max_threads();
+  Eigen::Matrix<Scalar, Eigen::Dynamic, 1> delta[2];
+  Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> H_scaled[2];
+  int nthreads[2] = { 4, 1 };
+  for (int k = 0; k < 2; ++k) {
+    proxsuite::helpers::set_max_threads(nthreads[k]);
+    proxqp::dense::QP<Scalar> qp{ dim, n_eq, n_in }; // creating QP object
+    qp.init(qp_random.H,
+            qp_random.g,
+            qp_random.A,
+            qp_random.b,
+            qp_random.C,
+            qp_random.u,
+            qp_random.l);
+    delta[k] = qp.ruiz.delta;
+    H_scaled[k] = qp.work.H_scaled;
+  }
+  proxsuite::helpers::set_max_threads(initial);
+
+  DOCTEST_CHECK(delta[0] == delta[1]);
+  DOCTEST_CHECK(H_scaled[0] == H_scaled[1]);
+}
@@ -0,0 +1,262 @@
+//
+// Copyright (c) 2022 INRIA
+//
+#include <iostream>
+#include <proxsuite/proxqp/wrapper.hpp>
+#include <proxsuite/proxqp/utils/random_qp_problems.hpp>
+#include <doctest.hpp>
+
+using namespace proxsuite::proxqp;
+using namespace proxsuite::proxqp::utils;
+using T = double;
+using I = c_int;
+
+namespace {
+template<typename Mat>
+auto
+residuals(Mat const& H,
+          dense::Vec<T> const& g,
+          Mat const& A,
+          dense::Vec<T> const& b,
+          Mat const& C,
+          dense::Vec<T> const& u,
+          dense::Vec<T> const& l,
+          Results<T> const& results) -> std::pair<T, T>
+{
+  T pri_res = std::max(
+    dense::infty_norm(A * results.x - b),
+    dense::infty_norm(dense::positive_part(C * results.x - u) +
+                      dense::negative_part(C * results.x - l)));
+  T dua_res = dense::infty_norm(H * results.x + g + A.transpose() * results.y +
+                                C.transpose() * results.z);
+  return { pri_res, dua_res };
+}
+} // namespace
+
+TEST_CASE("automatic backend: dense random strongly convex qp with equality "
+          "and inequality constraints")
+{
+  std::cout << "---automatic backend: dense random strongly convex qp with "
+               "equality and inequality constraints"
+            << std::endl;
+  utils::rand::set_seed(1);
+  isize dim = 30;
+  isize n_eq(dim / 4);
+  isize n_in(dim / 4);
+  T sparsity_factor = 0.6;
+  T strong_convexity_factor = 1.e-2;
+  dense::Model<T> qp_random = utils::dense_strongly_convex_qp(
+    dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  proxqp::QP<T, I> qp(dim, n_eq, n_in);
+  CHECK(qp.backend() == QPBackend::AUTOMATIC);
+  qp.settings.eps_abs = 1.E-9;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  CHECK(qp.backend() == QPBackend::DENSE);
+  qp.solve();
+  auto res = residuals(qp_random.H,
+                       qp_random.g,
+                       qp_random.A,
+                       qp_random.b,
+                       qp_random.C,
+                       qp_random.u,
+                       qp_random.l,
+                       qp.results());
+  CHECK(res.first <= 1e-9);
+  CHECK(res.second <= 1e-9);
+
+  // the choice can be overridden, the model being converted to sparse format
+  qp.settings.backend = QPBackend::SPARSE;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  CHECK(qp.backend() == QPBackend::SPARSE);
+  qp.solve();
+  res = residuals(qp_random.H,
+                  qp_random.g,
+                  qp_random.A,
+                  qp_random.b,
+                  qp_random.C,
+                  qp_random.u,
+                  qp_random.l,
+                  qp.results());
+  CHECK(res.first <= 1e-9);
+  CHECK(res.second <= 1e-9);
+
+  // updates are given to the backend chosen at initialization
+  qp_random.g = utils::rand::vector_rand<T>(dim);
+  qp.update(std::nullopt,
+            qp_random.g,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt);
+  qp.solve();
+  res = residuals(qp_random.H,
+                  qp_random.g,
+                  qp_random.A,
+                  qp_random.b,
+                  qp_random.C,
+                  qp_random.u,
+                  qp_random.l,
+                  qp.results());
+  CHECK(qp.backend() == QPBackend::SPARSE);
+  CHECK(res.first <= 1e-9);
+  CHECK(res.second <= 1e-9);
+}
+
+TEST_CASE("automatic backend: sparse random strongly convex qp with equality "
+          "and inequality constraints")
+{
+  std::cout << "---automatic backend: sparse random strongly convex qp with "
+               "equality and inequality constraints"
+            << std::endl;
+  utils::rand::set_seed(1);
+  isize dim = 500;
+  isize n_eq(dim / 4);
+  isize n_in(dim / 4);
+  T sparsity_factor = 0.002;
+  T strong_convexity_factor = 1.e-2;
+  sparse::SparseModel<T> qp_random = utils::sparse_strongly_convex_qp(
+    dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+  sparse::SparseMat<T, I> H = qp_random.H;
+  sparse::SparseMat<T, I> A = qp_random.A;
+  sparse::SparseMat<T, I> C = qp_random.C;
+  sparse::SparseMat<T, I> H_full = H.selfadjointView<Eigen::Upper>();
+
+  proxqp::QP<T, I> qp(dim, n_eq, n_in);
+  qp.settings.eps_abs = 1.E-9;
+  qp.init(H, qp_random.g, A, qp_random.b, C, qp_random.u, qp_random.l);
+  CHECK(qp.backend() == QPBackend::SPARSE);
+  qp.solve();
+  auto res = residuals(H_full,
+                       qp_random.g,
+                       A,
+                       qp_random.b,
+                       C,
+                       qp_random.u,
+                       qp_random.l,
+                       qp.results());
+  CHECK(res.first <= 1e-9);
+  CHECK(res.second <= 1e-9);
+
+  // the choice can be overridden, the model being converted to dense format
+  qp.settings.backend = QPBackend::DENSE;
+  qp.init(H, qp_random.g, A, qp_random.b, C, qp_random.u, qp_random.l);
+  CHECK(qp.backend() == QPBackend::DENSE);
+  qp.solve();
+  res = residuals(H_full,
+                  qp_random.g,
+                  A,
+                  qp_random.b,
+                  C,
+                  qp_random.u,
+                  qp_random.l,
+                  qp.results());
+  CHECK(res.first <= 1e-9);
+  CHECK(res.second <= 1e-9);
+
+  // updates are given to the backend chosen at initialization
+  H = 2 * H;
+  H_full = 2 * H_full;
+  qp.update(H,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt);
+  qp.solve();
+  res = residuals(H_full,
+                  qp_random.g,
+                  A,
+                  qp_random.b,
+                  C,
+                  qp_random.u,
+                  qp_random.l,
+                  qp.results());
+  CHECK(qp.backend() == QPBackend::DENSE);
+  CHECK(res.first <= 1e-9);
+  CHECK(res.second <= 1e-9);
+}
+
+TEST_CASE("sparse backend: dense updates of the matrices")
+{
+  std::cout << "---sparse backend: dense updates of the matrices" << std::endl;
+  utils::rand::set_seed(1);
+  isize dim = 30;
+  isize n_eq(dim / 4);
+  isize n_in(dim / 4);
+  T sparsity_factor = 0.6;
+  T strong_convexity_factor = 1.e-2;
+  dense::Model<T> qp_random = utils::dense_strongly_convex_qp(
+    dim, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  proxqp::QP<T, I> qp(dim, n_eq, n_in);
+  qp.settings.eps_abs = 1.E-9;
+  qp.settings.backend = QPBackend::SPARSE;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  CHECK(qp.backend() == QPBackend::SPARSE);
+
+  // an entry of the structure used for the initialization may become zero
+  isize i = 0;
+  isize j = 0;
+  for (isize k = 1; k < dim && i == j; ++k) {
+    for (isize l = 0; l < k; ++l) {
+      if (qp_random.A(0, l) != 0 && qp_random.A(0, k) == 0) {
+        i = l;
+        j = k;
+        break;
+      }
+    }
+  }
+  REQUIRE(i != j);
+  qp_random.A(0, i) = 0;
+  qp_random.H = 2 * qp_random.H;
+  qp.update(qp_random.H,
+            std::nullopt,
+            qp_random.A,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt);
+  qp.solve();
+  auto res = residuals(qp_random.H,
+                       qp_random.g,
+                       qp_random.A,
+                       qp_random.b,
+                       qp_random.C,
+                       qp_random.u,
+                       qp_random.l,
+                       qp.results());
+  CHECK(res.first <= 1e-9);
+  CHECK(res.second <= 1e-9);
+
+  // but no entry can be added to it
+  qp_random.A(0, j) = 1;
+  CHECK_THROWS_AS(qp.update(std::nullopt,
+                            std::nullopt,
+                            qp_random.A,
+                            std::nullopt,
+                            std::nullopt,
+                            std::nullopt,
+                            std::nullopt),
+                  std::invalid_argument);
+}
@@ -0,0 +1,94 @@
+#
+# Copyright (c) 2022, INRIA
+#
+import proxsuite
+import numpy as np
+import scipy.sparse as spa
+import unittest
+
+
+def normInf(x):
+    if x.shape[0] == 0:
+        return 0.0
+    else:
+        return np.linalg.norm(x, np.inf)
+
+
+def generate_mixed_qp(n, density, seed=1):
+    """
+    Generate problem in QP format
+    """
+    np.random.seed(seed)
+
+    n_eq = int(n / 4)
+    n_in = int(n / 4)
+    m = n_eq + n_in
+
+    P = spa.random(n, n, density=density, data_rvs=np.random.randn, format="csc")
+    P = (P + P.T) / 2.0
+    P += (abs(P).sum(axis=1).max() + 1e-02) * spa.eye(n, format="csc")
+    q = np.random.randn(n)
+    A = spa.random(m, n, density=density, data_rvs=np.random.randn, format="csc")
+    v = np.random.randn(n)  # Fictitious solution
+    u = A @ v
+    l = -1.0e20 * np.ones(m)
+
+    return P.tocsc(), q, A[:n_eq, :], u[:n_eq], A[n_eq:, :], u[n_eq:], l[n_eq:]
+
+
+class QpWrapper(unittest.TestCase):
+    def check_solution(self, qp, H, g, A, b, C, u, l):
+        x, y, z = qp.results.x, qp.results.y, qp.results.z
+        dua_res = normInf(H @ x + g + A.transpose() @ y + C.transpose() @ z)
+        pri_res = max(
+            normInf(A @ x - b),
+            normInf(np.maximum(C @ x - u, 0) + np.minimum(C @ x - l, 0)),
+        )
+        assert dua_res <= 1e-9
+        assert pri_res <= 1e-9
+
+    def test_automatic_backend(self):
+        print("------------------------automatic backend choice")
+        for n, density, backend in [
+            (10, 0.5, proxsuite.proxqp.QPBackend.DENSE),
+            (1000, 0.001, proxsuite.proxqp.QPBackend.SPARSE),
+        ]:
+            H, g, A, b, C, u, l = generate_mixed_qp(n, density)
+            qp = proxsuite.proxqp.QP(n, A.shape[0], C.shape[0])
+            qp.settings.eps_abs = 1.0e-9
+            assert qp.backend() == proxsuite.proxqp.QPBackend.AUTOMATIC
+            qp.init(H, g, A, b, C, u, l)
+            assert qp.backend() == backend
+            qp.solve()
+            self.check_solution(qp, H, g, A, b, C, u, l)
+
+            # dense matrices are accepted whatever the backend
+            qp.init(H.toarray(), g, A.toarray(), b, C.toarray(), u, l)
+            assert qp.backend() == backend
+            qp.solve()
+            self.check_solution(qp, H, g, A, b, C, u, l)
+
+    def test_forced_backend(self):
+        print("------------------------forced backend")
+        n = 10
+        H, g, A, b, C, u, l = generate_mixed_qp(n, 0.5)
+        for backend in [
+            proxsuite.proxqp.QPBackend.DENSE,
+            proxsuite.proxqp.QPBackend.SPARSE,
+        ]:
+            qp = proxsuite.proxqp.QP(n, A.shape[0], C.shape[0])
+            qp.settings.eps_abs = 1.0e-9
+            qp.settings.backend = backend
+            qp.init(H, g, A, b, C, u, l)
+            assert qp.backend() == backend
+            qp.solve()
+            self.check_solution(qp, H, g, A, b, C, u, l)
+
+            g = np.random.randn(n)
+            qp.update(g=g)
+            qp.solve()
+            self.check_solution(qp, H, g, A, b, C, u, l)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -7,6 +7,7 @@
 #include <proxsuite/linalg/veg/vec.hpp>
 #include <doctest.hpp>
 #include <iostream>
+#include <set>
 
 template<typename T, typename I>
 auto
@@ -629,3 +630,135 @@ TEST_CASE("ldlt: row mod")
   std::cout << to_eigen(ld.as_const()) << '\n' << '\n';
   dump_reconstructed();
 }
+
+TEST_CASE("ldlt: level scheduled triangular solves")
+{
+  using I = int;
+  using T = double;
+
+  isize n = 200;
+
+  // random sparsity pattern of a cholesky factor, closed under the fill-in of
+  // the children of each column into their parent, and its elimination tree
+  std::srand(1);
+  std::vector<std::set<I>> pattern(static_cast<usize>(n));
+  Vec<I> parent;
+  parent.resize_for_overwrite(n);
+  for (isize j = 0; j < n; ++j) {
+    for (isize i = j + 1; i < n; ++i) {
+      if (std::rand() % 50 == 0) {
+        pattern[usize(j)].insert(I(i));
+      }
+    }
+    auto& col = pattern[usize(j)];
+    parent[j] = col.empty() ? I(-1) : *col.begin();
+    for (I i : col) {
+      if (i != parent[j]) {
+        pattern[usize(parent[j])].insert(i);
+      }
+    }
+  }
+
+  Vec<unsigned char> _stack;
+  _stack.resize_for_overwrite(
+    (triangular_solve_levels_req(Tag<I>{}, n) |
+     dense_lsolve_levels_req(Tag<T>{}, n, 4))
+      .alloc_req());
+  dynstack::DynStackMut stack{ from_slice_mut, _stack.as_mut() };
+
+  // the schedules remain valid for the factors whose sparsity pattern is
+  // contained in the one of the elimination tree
+  for (bool sub_pattern : { false, true }) {
+    // random unit lower triangular matrix, with the diagonal stored first in
+    // each column
+    std::vector<Eigen::Triplet<T, I>> triplets;
+    for (isize j = 0; j < n; ++j) {
+      triplets.emplace_back(I(j), I(j), T(1));
+      for (I i : pattern[usize(j)]) {
+        if (!sub_pattern || std::rand() % 2 == 0) {
+          triplets.emplace_back(i, I(j), T(std::rand()) / T(RAND_MAX) - 0.5);
+        }
+      }
+    }
+    Eigen::SparseMatrix<T, Eigen::ColMajor, I> l_eigen(n, n);
+    l_eigen.setFromTriplets(triplets.begin(), triplets.end());
+    l_eigen.makeCompressed();
+
+    auto l = MatRef<T, I>{
+      from_raw_parts,
+      n,
+      n,
+      isize(l_eigen.nonZeros()),
+      l_eigen.outerIndexPtr(),
+      nullptr,
+      l_eigen.innerIndexPtr(),
+      l_eigen.valuePtr(),
+    };
+
+    Eigen::Matrix<T, -1, 1> rhs = Eigen::Matrix<T, -1, 1>::Random(n);
+    Eigen::Matrix<T, -1, -1> l_dense = l_eigen.toDense();
+    Eigen::Matrix<T, -1, 1> lsol =
+      l_dense.triangularView<Eigen::UnitLower>().solve(rhs);
+    Eigen::Matrix<T, -1, 1> ltsol =
+      l_dense.transpose().triangularView<Eigen::UnitUpper>().solve(rhs);
+
+    for (bool transpose : { false, true }) {
+      Vec<I> level_ptrs;
+      Vec<I> level_cols;
+      level_ptrs.resize_for_overwrite(n + 1);
+      level_cols.resize_for_overwrite(n);
+      isize nlevels = triangular_solve_levels(level_ptrs.ptr_mut(),
+                                              level_cols.ptr_mut(),
+                                              parent.ptr(),
+                                              n,
+                                              transpose,
+                                              stack);
+      CHECK(nlevels <= n);
+      CHECK(level_ptrs[0] == 0);
+      CHECK(level_ptrs[nlevels] == n);
+
+      // every column comes after the columns it depends on
+      Eigen::Matrix<isize, -1, 1> level(n);
+      for (isize k = 0; k < nlevels; ++k) {
+        for (I q = level_ptrs[k]; q < level_ptrs[k + 1]; ++q) {
+          level[level_cols[q]] = k;
+        }
+      }
+      bool ordered = true;
+      for (isize j = 0; j < n; ++j) {
+        for (Eigen::SparseMatrix<T, Eigen::ColMajor, I>::InnerIterator it(
+               l_eigen, j);
+             it;
+             ++it) {
+          if (it.row() != j) {
+            ordered = ordered && (transpose ? level[j] > level[it.row()]
+                                            : level[it.row()] > level[j]);
+          }
+        }
+      }
+      CHECK(ordered);
+
+      for (isize nthreads : { 1, 4 }) {
+        Eigen::Matrix<T, -1, 1> x = rhs;
+        if (transpose) {
+          dense_ltsolve_levels<T, I>({ from_eigen, x },
+                                     l,
+                                     level_ptrs.ptr(),
+                                     level_cols.ptr(),
+                                     nlevels,
+                                     nthreads);
+          CHECK((x - ltsol).norm() < T(1e-10));
+        } else {
+          dense_lsolve_levels<T, I>({ from_eigen, x },
+                                    l,
+                                    level_ptrs.ptr(),
+                                    level_cols.ptr(),
+                                    nlevels,
+                                    nthreads,
+                                    stack);
+          CHECK((x - lsol).norm() < T(1e-10));
+        }
+      }
+    }
+  }
+}
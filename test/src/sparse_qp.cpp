@@ -223,3 +223,53 @@ TEST_CASE("random id using the API")
     }
   }
 }
+
+TEST_CASE("sparse matrix vector products")
+{
+  // large enough for the parallel kernels to be used when they are available
+  proxqp::isize n = 1000;
+  proxqp::isize m = 800;
+  double p = 0.1;
+
+  using SparseMat = proxqp::utils::SparseMat<T>;
+
+  SparseMat H = proxqp::utils::rand::sparse_matrix_rand<T>(n, n, p)
+                  .triangularView<Eigen::Upper>();
+  SparseMat AT = proxqp::utils::rand::sparse_matrix_rand<T>(n, m, p);
+  auto x = proxqp::utils::rand::vector_rand<T>(n);
+  auto y = proxqp::utils::rand::vector_rand<T>(m);
+
+  for (bool compressed : { true, false }) {
+    if (!compressed) {
+      H.uncompress();
+      AT.uncompress();
+    }
+
+    proxqp::utils::Vec<T> Hx = x;
+    proxqp::sparse::detail::noalias_symhiv_add(Hx, H, x);
+    CHECK(proxqp::dense::infty_norm(
+            Hx - x - H.selfadjointView<Eigen::Upper>() * x) <= 1e-9);
+
+    proxqp::utils::Vec<T> ATy = x;
+    proxqp::utils::Vec<T> Ax = y;
+    proxqp::sparse::detail::noalias_gevmmv_add(Ax, ATy, AT, x, y);
+    CHECK(proxqp::dense::infty_norm(ATy - x - AT * y) <= 1e-9);
+    CHECK(proxqp::dense::infty_norm(Ax - y - AT.transpose() * x) <= 1e-9);
+
+    // the partitions stored in the workspace are reused across the products
+    proxqp::sparse::detail::SpmvPartition<T> H_partition;
+    proxqp::sparse::detail::SpmvPartition<T> AT_partition;
+    for (int k = 0; k < 2; ++k) {
+      Hx = x;
+      proxqp::sparse::detail::noalias_symhiv_add(Hx, H, x, H_partition);
+      CHECK(proxqp::dense::infty_norm(
+              Hx - x - H.selfadjointView<Eigen::Upper>() * x) <= 1e-9);
+      ATy = x;
+      Ax = y;
+      proxqp::sparse::detail::noalias_gevmmv_add(
+        Ax, ATy, AT, x, y, AT_partition);
+      CHECK(proxqp::dense::infty_norm(ATy - x - AT * y) <= 1e-9);
+      CHECK(proxqp::dense::infty_norm(Ax - y - AT.transpose() * x) <= 1e-9);
+    }
+  }
+}
@@ -356,6 +356,61 @@ class SparseQpWrapper(unittest.TestCase):
             )
         )
 
+    def test_solve_batch(self):
+        print("------------------------test solve of a batch of problems")
+
+        n = 30
+        H, g, A, b, C, u, l = generate_mixed_qp(n)
+        H = spa.csc_matrix(H)
+        H.sort_indices()
+        batch_size = 6
+        # the problems share the sparsity structure of H, with scaled values
+        scales = np.arange(1, batch_size + 1, dtype=np.float64)
+        H_values = np.outer(scales, H.data)
+        g_stacked = np.outer(scales, g) + np.random.randn(batch_size, n)
+
+        results = proxsuite.proxqp.sparse.solve_batch(
+            H,
+            H_values,
+            g_stacked,
+            A,
+            None,
+            np.tile(b, (batch_size, 1)),
+            C,
+            None,
+            np.tile(u, (batch_size, 1)),
+            np.tile(l, (batch_size, 1)),
+            eps_abs=1.0e-9,
+            eps_rel=0,
+        )
+        assert results["x"].shape == (batch_size, n)
+        for i in range(batch_size):
+            expected = proxsuite.proxqp.sparse.solve(
+                scales[i] * H, g_stacked[i], A, b, C, u, l, eps_abs=1.0e-9, eps_rel=0
+            )
+            assert results["status"][i].name == "PROXQP_SOLVED"
+            assert normInf(results["x"][i] - expected.x) <= 1e-8
+            assert normInf(results["y"][i] - expected.y) <= 1e-8
+            assert normInf(results["z"][i] - expected.z) <= 1e-8
+
+    def test_solve_float32(self):
+        print("------------------------test solve in single precision")
+
+        n = 30
+        H, g, A, b, C, u, l = generate_mixed_qp(n)
+        H32, A32, C32 = (spa.csc_matrix(M, dtype=np.float32) for M in (H, A, C))
+        g32, b32, u32, l32 = (v.astype(np.float32) for v in (g, b, u, l))
+
+        results = proxsuite.proxqp.sparse.solve_float32(
+            H32, g32, A32, b32, C32, u32, l32, eps_abs=1.0e-4
+        )
+        assert results.info.status.name == "PROXQP_SOLVED"
+        assert results.x.dtype == np.float32
+        expected = proxsuite.proxqp.sparse.solve(
+            H, g, A, b, C, u, l, eps_abs=1.0e-9, eps_rel=0
+        )
+        assert normInf(results.x - expected.x) <= 1e-2
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -5907,4 +5907,667 @@ DOCTEST_TEST_CASE("sparse random strongly convex qp with equality and "
     DOCTEST_CHECK(pri_res <= eps_abs);
     DOCTEST_CHECK(dua_res <= eps_abs);
   }
-}
\ No newline at end of file
+}
+TEST_CASE("sparse random strongly convex qp with equality and "
+          "inequality constraints: test matrix free solver preconditioners")
+{
+  std::cout << "------------------------sparse random strongly convex qp with "
+               "equality and inequality constraints: test matrix free solver "
+               "preconditioners"
+            << std::endl;
+  for (auto precond : { MatrixFreePreconditioner::IDENTITY,
+                        MatrixFreePreconditioner::BLOCK_DIAGONAL,
+                        MatrixFreePreconditioner::INCOMPLETE_LDLT }) {
+    isize n = 50;
+    isize n_eq = 10;
+    isize n_in = 10;
+
+    T sparsity_factor = 0.15;
+    T strong_convexity_factor = 0.01;
+    T eps_abs = 1.E-9;
+    ::proxsuite::proxqp::utils::rand::set_seed(1);
+    proxqp::sparse::SparseModel<T> qp_random = utils::sparse_strongly_convex_qp(
+      n, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+    proxqp::sparse::QP<T, I> qp(n, n_eq, n_in);
+    qp.settings.eps_abs = eps_abs;
+    // an empty memory budget forces the matrix free solver
+    qp.settings.sparse_ldlt_memory_budget = 0;
+    qp.settings.matrix_free_preconditioner = precond;
+    qp.init(qp_random.H,
+            qp_random.g,
+            qp_random.A,
+            qp_random.b,
+            qp_random.C,
+            qp_random.u,
+            qp_random.l);
+    CHECK(!qp.work.internal.do_ldlt);
+    qp.solve();
+
+    T dua_res = proxqp::dense::infty_norm(
+      qp_random.H.selfadjointView<Eigen::Upper>() * qp.results.x + qp_random.g +
+      qp_random.A.transpose() * qp.results.y +
+      qp_random.C.transpose() * qp.results.z);
+    T pri_res = std::max(
+      proxqp::dense::infty_norm(qp_random.A * qp.results.x - qp_random.b),
+      proxqp::dense::infty_norm(sparse::detail::positive_part(
+                                  qp_random.C * qp.results.x - qp_random.u) +
+                                sparse::detail::negative_part(
+                                  qp_random.C * qp.results.x - qp_random.l)));
+    CHECK(dua_res <= eps_abs);
+    CHECK(pri_res <= eps_abs);
+    std::cout << "; dual residual " << dua_res << "; primal residual "
+              << pri_res << std::endl;
+    std::cout << "total number of iteration: " << qp.results.info.iter
+              << std::endl;
+  }
+}
+TEST_CASE("sparse random strongly convex qp with equality and "
+          "inequality constraints: test without storing the unscaled kkt")
+{
+  std::cout << "------------------------sparse random strongly convex qp with "
+               "equality and inequality constraints: test without storing the "
+               "unscaled kkt"
+            << std::endl;
+  isize n = 50;
+  isize n_eq = 10;
+  isize n_in = 10;
+
+  T sparsity_factor = 0.15;
+  T strong_convexity_factor = 0.01;
+  T eps_abs = 1.E-9;
+  ::proxsuite::proxqp::utils::rand::set_seed(1);
+  proxqp::sparse::SparseModel<T> qp_random = utils::sparse_strongly_convex_qp(
+    n, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  proxqp::sparse::QP<T, I> qp(n, n_eq, n_in);
+  qp.settings.eps_abs = eps_abs;
+  qp.settings.sparse_store_unscaled_kkt = false;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  CHECK(qp.model.kkt_values_unscaled.len() == 0);
+
+  // solving twice goes through the unscaling of the kkt values, as does the
+  // update of a single matrix
+  qp.solve();
+  qp.solve();
+  qp_random.A.coeffs() *= T(2);
+  qp.update(std::nullopt,
+            std::nullopt,
+            qp_random.A,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt,
+            std::nullopt);
+  qp.solve();
+
+  // the kkt values are the scaled ones of the updated problem
+  proxqp::sparse::QP<T, I> qp2(n, n_eq, n_in);
+  qp2.settings.eps_abs = eps_abs;
+  qp2.init(qp_random.H,
+           qp_random.g,
+           qp_random.A,
+           qp_random.b,
+           qp_random.C,
+           qp_random.u,
+           qp_random.l);
+  CHECK(qp.model.kkt_values.len() == qp2.model.kkt_values.len());
+  for (isize p = 0; p < qp.model.kkt_values.len(); ++p) {
+    CHECK(std::abs(qp.model.kkt_values[p] - qp2.model.kkt_values[p]) <=
+          1e-12 * (1 + std::abs(qp2.model.kkt_values[p])));
+  }
+
+  T dua_res = proxqp::dense::infty_norm(
+    qp_random.H.selfadjointView<Eigen::Upper>() * qp.results.x + qp_random.g +
+    qp_random.A.transpose() * qp.results.y +
+    qp_random.C.transpose() * qp.results.z);
+  T pri_res = std::max(
+    proxqp::dense::infty_norm(qp_random.A * qp.results.x - qp_random.b),
+    proxqp::dense::infty_norm(
+      sparse::detail::positive_part(qp_random.C * qp.results.x - qp_random.u) +
+      sparse::detail::negative_part(qp_random.C * qp.results.x - qp_random.l)));
+  CHECK(dua_res <= eps_abs);
+  CHECK(pri_res <= eps_abs);
+  std::cout << "; dual residual " << dua_res << "; primal residual " << pri_res
+            << std::endl;
+  std::cout << "total number of iteration: " << qp.results.info.iter
+            << std::endl;
+}
+TEST_CASE("sparse random strongly convex qp with equality and "
+          "inequality constraints: test batch of problems sharing their "
+          "structure")
+{
+  std::cout << "------------------------sparse random strongly convex qp with "
+               "equality and inequality constraints: test batch of problems "
+               "sharing their structure"
+            << std::endl;
+  isize n = 50;
+  isize n_eq = 10;
+  isize n_in = 10;
+  isize batch_size = 4;
+
+  T sparsity_factor = 0.15;
+  T strong_convexity_factor = 0.01;
+  T eps_abs = 1.E-9;
+  ::proxsuite::proxqp::utils::rand::set_seed(1);
+  proxqp::sparse::SparseModel<T> qp_random = utils::sparse_strongly_convex_qp(
+    n, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  proxqp::sparse::BatchQP<T, I> batch(batch_size,
+                                      qp_random.H.cast<bool>(),
+                                      qp_random.A.cast<bool>(),
+                                      qp_random.C.cast<bool>());
+  CHECK(batch.size() == batch_size);
+
+  // the members differ by the scaling of their matrices and their linear cost
+  std::vector<proxqp::sparse::SparseModel<T>> models;
+  for (isize i = 0; i < batch_size; ++i) {
+    models.push_back(qp_random);
+    models.back().H.coeffs() *= T(1) + T(0.1) * T(i);
+    models.back().A.coeffs() *= T(1) - T(0.1) * T(i);
+    models.back().C.coeffs() *= T(1) + T(0.2) * T(i);
+    models.back().g = utils::rand::vector_rand<T>(n);
+
+    batch[i].settings.eps_abs = eps_abs;
+    batch[i].init(models.back().H,
+                  models.back().g,
+                  models.back().A,
+                  models.back().b,
+                  models.back().C,
+                  models.back().u,
+                  models.back().l);
+    CHECK(batch[i].model.kkt_col_ptrs == batch[0].model.kkt_col_ptrs);
+    CHECK(batch[i].model.kkt_row_indices == batch[0].model.kkt_row_indices);
+  }
+  batch.solve();
+
+  for (isize i = 0; i < batch_size; ++i) {
+    auto const& qp = batch[i];
+    auto const& model = models[usize(i)];
+    T dua_res = proxqp::dense::infty_norm(
+      model.H.selfadjointView<Eigen::Upper>() * qp.results.x + model.g +
+      model.A.transpose() * qp.results.y + model.C.transpose() * qp.results.z);
+    T pri_res = std::max(
+      proxqp::dense::infty_norm(model.A * qp.results.x - model.b),
+      proxqp::dense::infty_norm(
+        sparse::detail::positive_part(model.C * qp.results.x - model.u) +
+        sparse::detail::negative_part(model.C * qp.results.x - model.l)));
+    CHECK(dua_res <= eps_abs);
+    CHECK(pri_res <= eps_abs);
+    std::cout << "; dual residual " << dua_res << "; primal residual "
+              << pri_res << std::endl;
+    std::cout << "total number of iteration: " << qp.results.info.iter
+              << std::endl;
+  }
+}
+TEST_CASE("sparse random strongly convex qp with equality and "
+          "inequality constraints: test update of the values only")
+{
+  std::cout << "------------------------sparse random strongly convex qp with "
+               "equality and inequality constraints: test update of the values "
+               "only"
+            << std::endl;
+  isize n = 50;
+  isize n_eq = 10;
+  isize n_in = 10;
+
+  T sparsity_factor = 0.15;
+  T strong_convexity_factor = 0.01;
+  T eps_abs = 1.E-9;
+  ::proxsuite::proxqp::utils::rand::set_seed(1);
+  proxqp::sparse::SparseModel<T> qp_random = utils::sparse_strongly_convex_qp(
+    n, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  for (bool store_unscaled_kkt : { true, false }) {
+    proxqp::sparse::QP<T, I> qp(n, n_eq, n_in);
+    qp.settings.eps_abs = eps_abs;
+    qp.settings.sparse_store_unscaled_kkt = store_unscaled_kkt;
+    qp.init(qp_random.H,
+            qp_random.g,
+            qp_random.A,
+            qp_random.b,
+            qp_random.C,
+            qp_random.u,
+            qp_random.l);
+    qp.solve();
+
+    SparseMat<bool> H_structure = qp.H_structure();
+    SparseMat<bool> AT_structure = qp.AT_structure();
+    SparseMat<bool> CT_structure = qp.CT_structure();
+    CHECK(H_structure.nonZeros() == qp.model.H_nnz);
+    CHECK(AT_structure.nonZeros() == qp.model.A_nnz);
+    CHECK(CT_structure.nonZeros() == qp.model.C_nnz);
+
+    // new values with the same sparsity structure, written in the internal
+    // order
+    proxqp::sparse::SparseModel<T> qp_new = qp_random;
+    qp_new.H.coeffs() *= T(2);
+    qp_new.A.coeffs() *= T(0.5);
+    qp_new.C.coeffs() *= T(3);
+    Eigen::Matrix<T, Eigen::Dynamic, 1> H_values(qp.model.H_nnz);
+    Eigen::Matrix<T, Eigen::Dynamic, 1> A_values(qp.model.A_nnz);
+    Eigen::Matrix<T, Eigen::Dynamic, 1> C_values(qp.model.C_nnz);
+    isize p = 0;
+    for (isize j = 0; j < n; ++j) {
+      for (SparseMat<bool>::InnerIterator it(H_structure, j); it; ++it) {
+        H_values[p++] = qp_new.H.coeff(it.row(), j);
+      }
+    }
+    p = 0;
+    for (isize j = 0; j < n_eq; ++j) {
+      for (SparseMat<bool>::InnerIterator it(AT_structure, j); it; ++it) {
+        A_values[p++] = qp_new.A.coeff(j, it.row());
+      }
+    }
+    p = 0;
+    for (isize j = 0; j < n_in; ++j) {
+      for (SparseMat<bool>::InnerIterator it(CT_structure, j); it; ++it) {
+        C_values[p++] = qp_new.C.coeff(j, it.row());
+      }
+    }
+
+    qp.update_values(H_values,
+                     std::nullopt,
+                     A_values,
+                     std::nullopt,
+                     C_values,
+                     std::nullopt,
+                     std::nullopt);
+    qp.solve();
+
+    T dua_res = proxqp::dense::infty_norm(
+      qp_new.H.selfadjointView<Eigen::Upper>() * qp.results.x + qp_new.g +
+      qp_new.A.transpose() * qp.results.y +
+      qp_new.C.transpose() * qp.results.z);
+    T pri_res = std::max(
+      proxqp::dense::infty_norm(qp_new.A * qp.results.x - qp_new.b),
+      proxqp::dense::infty_norm(
+        sparse::detail::positive_part(qp_new.C * qp.results.x - qp_new.u) +
+        sparse::detail::negative_part(qp_new.C * qp.results.x - qp_new.l)));
+    CHECK(dua_res <= eps_abs);
+    CHECK(pri_res <= eps_abs);
+    std::cout << "; dual residual " << dua_res << "; primal residual "
+              << pri_res << std::endl;
+    std::cout << "total number of iteration: " << qp.results.info.iter
+              << std::endl;
+  }
+}
+
+TEST_CASE("sparse random strongly convex qp with equality and "
+          "inequality constraints: test with dense inequality rows")
+{
+  std::cout << "------------------------sparse random strongly convex qp with "
+               "equality and inequality constraints: test with dense "
+               "inequality rows"
+            << std::endl;
+  isize n = 500;
+  isize n_eq = 50;
+  isize n_in = 50;
+  T sparsity_factor = 0.01;
+  T strong_convexity_factor = 0.01;
+  T eps_abs = 1.E-9;
+  ::proxsuite::proxqp::utils::rand::set_seed(1);
+  proxqp::sparse::SparseModel<T> qp_random = utils::sparse_strongly_convex_qp(
+    n, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  // the first two inequality constraints involve all the variables (e.g.,
+  // budget constraints)
+  for (isize i = 0; i < 2; ++i) {
+    for (isize j = 0; j < n; ++j) {
+      qp_random.C.coeffRef(i, j) = T(1) + T(i * j % 3);
+    }
+  }
+  qp_random.C.makeCompressed();
+  Eigen::Matrix<T, Eigen::Dynamic, 1> x_feasible =
+    utils::rand::vector_rand<T>(n);
+  qp_random.b = qp_random.A * x_feasible;
+  qp_random.u = qp_random.C * x_feasible +
+                Eigen::Matrix<T, Eigen::Dynamic, 1>::Ones(n_in);
+  qp_random.l = qp_random.C * x_feasible -
+                Eigen::Matrix<T, Eigen::Dynamic, 1>::Ones(n_in);
+
+  proxqp::sparse::QP<T, I> qp(n, n_eq, n_in);
+  qp.settings.eps_abs = eps_abs;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  qp.solve();
+
+  // the constraints are ordered among the variables, and not all last
+  isize n_constraints_first = 0;
+  for (isize i = n; i < n + n_eq + n_in; ++i) {
+    if (isize(qp.work.internal.ldl.perm_inv[i]) < n) {
+      ++n_constraints_first;
+    }
+  }
+  CHECK(n_constraints_first > 0);
+
+  T dua_res = proxqp::dense::infty_norm(
+    qp_random.H.selfadjointView<Eigen::Upper>() * qp.results.x + qp_random.g +
+    qp_random.A.transpose() * qp.results.y +
+    qp_random.C.transpose() * qp.results.z);
+  T pri_res = std::max(
+    proxqp::dense::infty_norm(qp_random.A * qp.results.x - qp_random.b),
+    proxqp::dense::infty_norm(
+      sparse::detail::positive_part(qp_random.C * qp.results.x - qp_random.u) +
+      sparse::detail::negative_part(qp_random.C * qp.results.x - qp_random.l)));
+  CHECK(dua_res <= eps_abs);
+  CHECK(pri_res <= eps_abs);
+  std::cout << "; dual residual " << dua_res << "; primal residual " << pri_res
+            << std::endl;
+  std::cout << "total number of iteration: " << qp.results.info.iter
+            << std::endl;
+}
+TEST_CASE("sparse random strongly convex qp with equality and "
+          "inequality constraints: test incremental update of the "
+          "preconditioner")
+{
+  std::cout << "------------------------sparse random strongly convex qp with "
+               "equality and inequality constraints: test incremental update "
+               "of the preconditioner"
+            << std::endl;
+  isize n = 50;
+  isize n_eq = 10;
+  isize n_in = 10;
+
+  T sparsity_factor = 0.15;
+  T strong_convexity_factor = 0.01;
+  T eps_abs = 1.E-9;
+  ::proxsuite::proxqp::utils::rand::set_seed(1);
+  proxqp::sparse::SparseModel<T> qp_random = utils::sparse_strongly_convex_qp(
+    n, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  proxqp::sparse::QP<T, I> qp(n, n_eq, n_in);
+  qp.settings.eps_abs = eps_abs;
+  qp.settings.incremental_preconditioner = true;
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  qp.solve();
+  Eigen::Matrix<T, Eigen::Dynamic, 1> delta_old = qp.ruiz.delta;
+
+  // only the first inequality rows change, by a large factor
+  proxqp::sparse::SparseModel<T> qp_new = qp_random;
+  for (isize i = 0; i < 3; ++i) {
+    qp_new.C.row(i) *= T(100);
+  }
+  qp_new.u.head(3) *= T(100);
+  qp_new.l.head(3) *= T(100);
+  qp.update(qp_new.H,
+            qp_new.g,
+            qp_new.A,
+            qp_new.b,
+            qp_new.C,
+            qp_new.u,
+            qp_new.l);
+  qp.solve();
+
+  // the scaling of the rows which changed is refined
+  for (isize i = 0; i < 3; ++i) {
+    CHECK(qp.ruiz.delta(n + n_eq + i) < delta_old(n + n_eq + i));
+  }
+
+  T dua_res = proxqp::dense::infty_norm(
+    qp_new.H.selfadjointView<Eigen::Upper>() * qp.results.x + qp_new.g +
+    qp_new.A.transpose() * qp.results.y + qp_new.C.transpose() * qp.results.z);
+  T pri_res = std::max(
+    proxqp::dense::infty_norm(qp_new.A * qp.results.x - qp_new.b),
+    proxqp::dense::infty_norm(
+      sparse::detail::positive_part(qp_new.C * qp.results.x - qp_new.u) +
+      sparse::detail::negative_part(qp_new.C * qp.results.x - qp_new.l)));
+  CHECK(dua_res <= eps_abs);
+  CHECK(pri_res <= eps_abs);
+  std::cout << "; dual residual " << dua_res << "; primal residual " << pri_res
+            << std::endl;
+  std::cout << "total number of iteration: " << qp.results.info.iter
+            << std::endl;
+}
+TEST_CASE("sparse random strongly convex qp with equality and "
+          "inequality constraints: test 32 and 64 bit index types")
+{
+  std::cout << "------------------------sparse random strongly convex qp with "
+               "equality and inequality constraints: test 32 and 64 bit index "
+               "types"
+            << std::endl;
+  isize n = 50;
+  isize n_eq = 10;
+  isize n_in = 10;
+
+  T sparsity_factor = 0.15;
+  T strong_convexity_factor = 0.01;
+  T eps_abs = 1.E-9;
+  ::proxsuite::proxqp::utils::rand::set_seed(1);
+  proxqp::sparse::SparseModel<T> qp_random = utils::sparse_strongly_convex_qp(
+    n, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  SparseMat<bool> H_mask = qp_random.H.cast<bool>();
+  SparseMat<bool> A_mask = qp_random.A.cast<bool>();
+  SparseMat<bool> C_mask = qp_random.C.cast<bool>();
+
+  proxqp::sparse::QP<T, I> qp(H_mask, A_mask, C_mask);
+  CHECK(proxqp::sparse::predicted_ldlt_nnz(H_mask, A_mask, C_mask) ==
+        qp.work.lnnz);
+  CHECK(proxqp::sparse::index_type_fits<std::int32_t>(H_mask, A_mask, C_mask));
+  CHECK(!proxqp::sparse::index_type_fits<std::int8_t>(H_mask, A_mask, C_mask));
+
+  using I32 = std::int32_t;
+  proxqp::sparse::SparseMat<bool, I32> H_mask32 = H_mask;
+  proxqp::sparse::SparseMat<bool, I32> A_mask32 = A_mask;
+  proxqp::sparse::SparseMat<bool, I32> C_mask32 = C_mask;
+  proxqp::sparse::QP<T, I32> qp32(H_mask32, A_mask32, C_mask32);
+  CHECK(qp32.work.lnnz == qp.work.lnnz);
+  qp32.settings.eps_abs = eps_abs;
+  qp32.init(proxqp::sparse::SparseMat<T, I32>(qp_random.H),
+            qp_random.g,
+            proxqp::sparse::SparseMat<T, I32>(qp_random.A),
+            qp_random.b,
+            proxqp::sparse::SparseMat<T, I32>(qp_random.C),
+            qp_random.u,
+            qp_random.l);
+  qp32.solve();
+
+  T dua_res = proxqp::dense::infty_norm(
+    qp_random.H.selfadjointView<Eigen::Upper>() * qp32.results.x +
+    qp_random.g + qp_random.A.transpose() * qp32.results.y +
+    qp_random.C.transpose() * qp32.results.z);
+  T pri_res = std::max(
+    proxqp::dense::infty_norm(qp_random.A * qp32.results.x - qp_random.b),
+    proxqp::dense::infty_norm(
+      sparse::detail::positive_part(qp_random.C * qp32.results.x -
+                                    qp_random.u) +
+      sparse::detail::negative_part(qp_random.C * qp32.results.x -
+                                    qp_random.l)));
+  CHECK(dua_res <= eps_abs);
+  CHECK(pri_res <= eps_abs);
+  std::cout << "; dual residual " << dua_res << "; primal residual " << pri_res
+            << std::endl;
+  std::cout << "total number of iteration: " << qp32.results.info.iter
+            << std::endl;
+}
+#ifndef _WIN32
+TEST_CASE("sparse random strongly convex qp with equality and "
+          "inequality constraints: test out of core ldlt factor")
+{
+  std::cout << "------------------------sparse random strongly convex qp with "
+               "equality and inequality constraints: test out of core ldlt "
+               "factor"
+            << std::endl;
+  isize n = 50;
+  isize n_eq = 10;
+  isize n_in = 10;
+
+  T sparsity_factor = 0.15;
+  T strong_convexity_factor = 0.01;
+  T eps_abs = 1.E-9;
+  ::proxsuite::proxqp::utils::rand::set_seed(1);
+  proxqp::sparse::SparseModel<T> qp_random = utils::sparse_strongly_convex_qp(
+    n, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  proxqp::sparse::QP<T, I> qp(n, n_eq, n_in);
+  qp.settings.eps_abs = eps_abs;
+  // the factor does not fit in the memory budget, and is stored out of core
+  qp.settings.sparse_ldlt_memory_budget = 0;
+  qp.settings.sparse_ldlt_mmap_directory = ".";
+  qp.init(qp_random.H,
+          qp_random.g,
+          qp_random.A,
+          qp_random.b,
+          qp_random.C,
+          qp_random.u,
+          qp_random.l);
+  CHECK(qp.work.internal.do_ldlt);
+  CHECK(qp.work.internal.ldl.values_file != nullptr);
+  CHECK(qp.work.internal.ldl.row_indices_file != nullptr);
+
+  // the columns of the factor follow a postorder of the elimination tree of
+  // the kkt matrix, i.e., each column comes before its parent
+  isize n_tot = n + n_eq + n_in;
+  for (isize j = 0; j < n_tot; ++j) {
+    I parent = qp.work.internal.ldl.etree[j];
+    CHECK((parent == I(-1) || parent > I(j)));
+  }
+  qp.solve();
+
+  T dua_res = proxqp::dense::infty_norm(
+    qp_random.H.selfadjointView<Eigen::Upper>() * qp.results.x + qp_random.g +
+    qp_random.A.transpose() * qp.results.y +
+    qp_random.C.transpose() * qp.results.z);
+  T pri_res = std::max(
+    proxqp::dense::infty_norm(qp_random.A * qp.results.x - qp_random.b),
+    proxqp::dense::infty_norm(
+      sparse::detail::positive_part(qp_random.C * qp.results.x - qp_random.u) +
+      sparse::detail::negative_part(qp_random.C * qp.results.x - qp_random.l)));
+  CHECK(dua_res <= eps_abs);
+  CHECK(pri_res <= eps_abs);
+  std::cout << "; dual residual " << dua_res << "; primal residual " << pri_res
+            << std::endl;
+  std::cout << "total number of iteration: " << qp.results.info.iter
+            << std::endl;
+}
+#endif
+
+TEST_CASE("sparse random strongly convex qp with equality and "
+          "inequality constraints: test serialization")
+{
+  std::cout << "------------------------sparse random strongly convex qp with "
+               "equality and inequality constraints: test serialization"
+            << std::endl;
+  isize n = 50;
+  isize n_eq = 10;
+  isize n_in = 10;
+
+  T sparsity_factor = 0.15;
+  T strong_convexity_factor = 0.01;
+  T eps_abs = 1.E-9;
+  ::proxsuite::proxqp::utils::rand::set_seed(1);
+  proxqp::sparse::SparseModel<T> qp_random = utils::sparse_strongly_convex_qp(
+    n, n_eq, n_in, sparsity_factor, strong_convexity_factor);
+
+  // with and without storing the unscaled kkt matrix, in which case it is
+  // unscaled on a copy when serializing
+  for (bool store_unscaled_kkt : { true, false }) {
+    proxqp::sparse::QP<T, I> qp(n, n_eq, n_in);
+    qp.settings.eps_abs = eps_abs;
+    qp.settings.sparse_store_unscaled_kkt = store_unscaled_kkt;
+    qp.init(qp_random.H,
+            qp_random.g,
+            qp_random.A,
+            qp_random.b,
+            qp_random.C,
+            qp_random.u,
+            qp_random.l);
+    qp.solve();
+
+    std::vector<unsigned char> buffer = proxqp::sparse::serialize(qp);
+    CHECK(buffer.size() == proxqp::sparse::serialized_size(qp));
+    proxqp::sparse::QP<T, I> qp2 =
+      proxqp::sparse::deserialize<T, I>(buffer.data(), buffer.size());
+
+    // the settings, model, preconditioner and results are restored, without
+    // equilibrating the model again
+    CHECK(qp2.settings.eps_abs == eps_abs);
+    CHECK(qp2.settings.sparse_store_unscaled_kkt == store_unscaled_kkt);
+    CHECK(qp2.model.H_nnz == qp.model.H_nnz);
+    CHECK(qp2.model.A_nnz == qp.model.A_nnz);
+    CHECK(qp2.model.C_nnz == qp.model.C_nnz);
+    CHECK(qp2.model.l == qp.model.l);
+    CHECK(qp2.ruiz.delta == qp.ruiz.delta);
+    CHECK(qp2.ruiz.c == qp.ruiz.c);
+    isize nnz = qp.model.H_nnz + qp.model.A_nnz + qp.model.C_nnz;
+    for (isize k = 0; k < nnz; ++k) {
+      CHECK(std::abs(qp2.model.kkt_values[k] - qp.model.kkt_values[k]) <=
+            1e-12 * std::abs(qp.model.kkt_values[k]));
+    }
+    CHECK(qp2.results.x == qp.results.x);
+    CHECK(qp2.results.y == qp.results.y);
+    CHECK(qp2.results.info.status == qp.results.info.status);
+
+    qp2.solve();
+    T dua_res = proxqp::dense::infty_norm(
+      qp_random.H.selfadjointView<Eigen::Upper>() * qp2.results.x +
+      qp_random.g + qp_random.A.transpose() * qp2.results.y +
+      qp_random.C.transpose() * qp2.results.z);
+    T pri_res = std::max(
+      proxqp::dense::infty_norm(qp_random.A * qp2.results.x - qp_random.b),
+      proxqp::dense::infty_norm(
+        sparse::detail::positive_part(qp_random.C * qp2.results.x -
+                                      qp_random.u) +
+        sparse::detail::negative_part(qp_random.C * qp2.results.x -
+                                      qp_random.l)));
+    CHECK(dua_res <= eps_abs);
+    CHECK(pri_res <= eps_abs);
+
+    // invalid buffers are rejected
+    CHECK_THROWS_AS(
+      (proxqp::sparse::deserialize<T, I>(buffer.data(), buffer.size() / 2)),
+      std::invalid_argument);
+    CHECK_THROWS_AS(
+      (proxqp::sparse::deserialize<float, I>(buffer.data(), buffer.size())),
+      std::invalid_argument);
+    // the dimensions are checked against the size of the buffer before
+    // allocating the QP object
+    std::vector<unsigned char> corrupted = buffer;
+    std::int64_t huge_dim = std::int64_t(1) << 40;
+    std::memcpy(corrupted.data() + 32, &huge_dim, sizeof(huge_dim));
+    CHECK_THROWS_AS(
+      (proxqp::sparse::deserialize<T, I>(corrupted.data(), corrupted.size())),
+      std::invalid_argument);
+  }
+
+  // so is the number of nonzero entries of a matrix, and its row indices must
+  // be strictly increasing in each column
+  proxqp::sparse::SparseMat<T, I> mat(2, 1);
+  mat.insert(0, 0) = 1;
+  mat.insert(1, 0) = 2;
+  mat.makeCompressed();
+  std::swap(mat.innerIndexPtr()[0], mat.innerIndexPtr()[1]);
+  proxqp::serialization::Writer out;
+  proxqp::sparse::_detail::save_matrix(out, mat);
+  std::vector<unsigned char> buffer(out.size);
+  out = proxqp::serialization::Writer{};
+  out.data = buffer.data();
+  proxqp::sparse::_detail::save_matrix(out, mat);
+  proxqp::serialization::Reader in{ buffer.data(), buffer.size() };
+  CHECK_THROWS_AS((proxqp::sparse::_detail::load_matrix<T, I>(in, 2, 1)),
+                  std::invalid_argument);
+  std::int64_t huge_nnz = std::int64_t(1) << 40;
+  std::memcpy(buffer.data() + 2 * sizeof(std::int64_t),
+              &huge_nnz,
+              sizeof(huge_nnz));
+  in = proxqp::serialization::Reader{ buffer.data(), buffer.size() };
+  CHECK_THROWS_AS((proxqp::sparse::_detail::load_matrix<T, I>(in, 2, 1)),
+                  std::invalid_argument);
+}
@@ -4520,6 +4520,140 @@ class SparseqpWrapper(unittest.TestCase):
             )
         )
 
+    def test_index_types(self):
+        print(
+            "------------------------sparse random strongly convex qp with equality and inequality constraints: test 32 and 64 bit index types"
+        )
+        n = 50
+        H, g, A, b, C, u, l = generate_mixed_qp(n)
+
+        H_ = H != 0.0
+        A_ = A != 0.0
+        C_ = C != 0.0
+        assert proxsuite.proxqp.sparse.predicted_ldlt_nnz(H_, A_, C_) > 0
+        # the problem is small enough for 32 bit indices
+        qp_auto = proxsuite.proxqp.sparse.make_qp(H_, A_, C_)
+        assert isinstance(qp_auto, proxsuite.proxqp.sparse.QP_int32)
+
+        for qp in [
+            qp_auto,
+            proxsuite.proxqp.sparse.QP_int64(H_, A_, C_),
+        ]:
+            qp.settings.eps_abs = 1.0e-9
+            qp.init(H, g, A, b, C, u, l)
+            qp.solve()
+            dua_res = normInf(
+                H @ qp.results.x
+                + g
+                + A.transpose() @ qp.results.y
+                + C.transpose() @ qp.results.z
+            )
+            pri_res = max(
+                normInf(A @ qp.results.x - b),
+                normInf(
+                    np.maximum(C @ qp.results.x - u, 0)
+                    + np.minimum(C @ qp.results.x - l, 0)
+                ),
+            )
+            assert dua_res <= 1e-9
+            assert pri_res <= 1e-9
+            print("dual residual = {} ; primal residual = {}".format(dua_res, pri_res))
+            print("total number of iteration: {}".format(qp.results.info.iter))
+
+    def test_serialization_and_shared_memory(self):
+        print("------------------------test serialization and shared memory")
+        import pickle
+
+        n = 50
+        H, g, A, b, C, u, l = generate_mixed_qp(n)
+        n_eq, n_in = A.shape[0], C.shape[0]
+        for QP in [proxsuite.proxqp.sparse.QP, proxsuite.proxqp.sparse.QP_int64]:
+            qp = QP(n, n_eq, n_in)
+            qp.settings.eps_abs = 1.0e-9
+            qp.init(H, g, A, b, C, u, l)
+            qp.solve()
+
+            def check(qp2):
+                assert isinstance(qp2, QP)
+                assert qp2.settings.eps_abs == 1.0e-9
+                assert np.array_equal(qp2.results.x, qp.results.x)
+                assert qp2.results.info.status == qp.results.info.status
+                qp2.solve()
+                dua_res = normInf(
+                    H @ qp2.results.x
+                    + g
+                    + A.transpose() @ qp2.results.y
+                    + C.transpose() @ qp2.results.z
+                )
+                pri_res = max(
+                    normInf(A @ qp2.results.x - b),
+                    normInf(
+                        np.maximum(C @ qp2.results.x - u, 0)
+                        + np.minimum(C @ qp2.results.x - l, 0)
+                    ),
+                )
+                assert dua_res <= 1e-9
+                assert pri_res <= 1e-9
+
+            check(pickle.loads(pickle.dumps(qp)))
+            data = qp.serialize()
+            assert len(data) == qp.serialized_size()
+            check(QP.deserialize(data))
+            with self.assertRaises(ValueError):
+                QP.deserialize(data[: len(data) // 2])
+
+            shm = qp.to_shared_memory()
+            try:
+                check(QP.from_shared_memory(shm))
+                check(QP.from_shared_memory(shm.name))
+            finally:
+                shm.close()
+                shm.unlink()
+
+        # the index type is part of the format
+        with self.assertRaises(ValueError):
+            proxsuite.proxqp.sparse.QP.deserialize(
+                proxsuite.proxqp.sparse.QP_int64.serialize(qp)
+            )
+
+    def test_float32_qp_object(self):
+        print("------------------------test QP object in single precision")
+
+        n = 50
+        H, g, A, b, C, u, l = generate_mixed_qp(n)
+        n_eq, n_in = A.shape[0], C.shape[0]
+        qp = proxsuite.proxqp.sparse.QP_float32(n, n_eq, n_in)
+        qp.settings.eps_abs = 1.0e-4
+        qp.init(
+            spa.csc_matrix(H, dtype=np.float32),
+            g.astype(np.float32),
+            spa.csc_matrix(A, dtype=np.float32),
+            b.astype(np.float32),
+            spa.csc_matrix(C, dtype=np.float32),
+            u.astype(np.float32),
+            l.astype(np.float32),
+        )
+        qp.solve()
+        assert qp.results.info.status.name == "PROXQP_SOLVED"
+        assert qp.results.x.dtype == np.float32
+
+        x = qp.results.x.astype(np.float64)
+        dua_res = normInf(
+            H @ x
+            + g
+            + A.transpose() @ qp.results.y.astype(np.float64)
+            + C.transpose() @ qp.results.z.astype(np.float64)
+        )
+        pri_res = max(normInf(A @ x - b), normInf(np.maximum(C @ x - u, 0)))
+        assert dua_res <= 1e-3
+        assert pri_res <= 1e-3
+
+        # a single precision QP object is serialized with its scalar type
+        qp2 = proxsuite.proxqp.sparse.QP_float32.deserialize(qp.serialize())
+        assert np.array_equal(qp2.results.x, qp.results.x)
+        with self.assertRaises(ValueError):
+            proxsuite.proxqp.sparse.QP.deserialize(qp.serialize())
+
 
 if __name__ == "__main__":
     unittest.main()
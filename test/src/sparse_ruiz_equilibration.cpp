@@ -176,3 +176,64 @@ TEST_CASE("lower part")
   CHECK(l_scaled == (l_scaled_dense));
   CHECK(u_scaled == (u_scaled_dense));
 }
+
+TEST_CASE("parallel sweeps")
+{
+  isize n = 400;
+  isize n_eq = 40;
+  isize n_in = 80;
+
+  auto H = utils::rand::sparse_positive_definite_rand(n, T(10.0), 0.5);
+  auto g = utils::rand::vector_rand<T>(n);
+  auto AT = utils::rand::sparse_matrix_rand<T>(n, n_eq, 0.5);
+  auto b = utils::rand::vector_rand<T>(n_eq);
+  auto CT = utils::rand::sparse_matrix_rand<T>(n, n_in, 0.5);
+  auto l = utils::rand::vector_rand<T>(n_in);
+  auto u = utils::rand::vector_rand<T>(n_in);
+
+  proxsuite::proxqp::Settings<T> settings;
+
+  // the norms are reduced with max, so the scaling does not depend on the
+  // number of threads
+  int initial = proxsuite::helpers::get_max_threads();
+  Eigen::Matrix<T, -1, 1> delta[2];
+  Eigen::Matrix<T, -1, -1> H_scaled_dense[2];
+  int nthreads[2] = { 4, 1 };
+  for (int k = 0; k < 2; ++k) {
+    proxsuite::helpers::set_max_threads(nthreads[k]);
+    auto H_scaled = H;
+    auto g_scaled = g;
+    auto AT_scaled = AT;
+    auto b_scaled = b;
+    auto CT_scaled = CT;
+    auto l_scaled = l;
+    auto u_scaled = u;
+
+    proxqp::sparse::preconditioner::RuizEquilibration<T, I> ruiz{
+      n, n_eq + n_in, 1e-3, 10, proxqp::sparse::preconditioner::Symmetry::UPPER,
+    };
+    VEG_MAKE_STACK(stack,
+                   ruiz.scale_qp_in_place_req(
+                     proxsuite::linalg::veg::Tag<T>{}, n, n_eq, n_in));
+    ruiz.scale_qp_in_place(
+      {
+        { proxsuite::linalg::sparse::from_eigen, H_scaled },
+        { proxsuite::linalg::sparse::from_eigen, g_scaled },
+        { proxsuite::linalg::sparse::from_eigen, AT_scaled },
+        { proxsuite::linalg::sparse::from_eigen, b_scaled },
+        { proxsuite::linalg::sparse::from_eigen, CT_scaled },
+        { proxsuite::linalg::sparse::from_eigen, l_scaled },
+        { proxsuite::linalg::sparse::from_eigen, u_scaled },
+      },
+      true,
+      settings.preconditioner_max_iter,
+      settings.preconditioner_accuracy,
+      stack);
+    delta[k] = ruiz.delta;
+    H_scaled_dense[k] = H_scaled.toDense();
+  }
+  proxsuite::helpers::set_max_threads(initial);
+
+  CHECK(delta[0] == delta[1]);
+  CHECK(H_scaled_dense[0] == H_scaled_dense[1]);
+}